@@ -141,6 +141,10 @@ public:
 	/// \brief Returns the absolute filename for a relative \p name, or "" if not found.
 	virtual std::string findFile(const std::string& name) = 0;
 
+	/// \brief Returns the absolute path of the archive (PK4 file or directory) which
+	/// openFile() would load the file \p name from, or "" if not found.
+	virtual std::string findArchive(const std::string& name) = 0;
+
 	/// \brief Returns the filesystem root for an absolute \p name, or "" if not found.
 	/// This can be used to convert an absolute name to a relative name.
 	virtual std::string findRoot(const std::string& name) = 0;
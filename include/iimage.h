@@ -100,6 +100,15 @@ public:
      */
     virtual ImagePtr imageFromVFS(const std::string& vfsPath) const = 0;
 
+    /**
+     * \brief
+     * Return the name of the file imageFromVFS() would load for the given
+     * VFS path, including the directory prefix and the file extension (e.g.
+     * "dds/textures/blah/bleh.dds"). Returns an empty string if none of the
+     * candidate files exists.
+     */
+    virtual std::string findImageFileInVFS(const std::string& vfsPath) const = 0;
+
 	/**
      * \brief
      * Load an image from a filesystem path.
@@ -2,6 +2,9 @@
 
 #include <set>
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
 #include <functional>
 #include "imodule.h"
 #include <sigc++/signal.h>
@@ -15,6 +18,168 @@ typedef std::shared_ptr<INode> INodePtr;
 // A list of named layers
 typedef std::set<int> LayerList;
 
+/**
+ * A set of layer IDs stored as bits. Layer IDs are handed out
+ * starting at 0, so the first 64 of them fit into a single word, which
+ * is held in place. Higher IDs are stored in additional words.
+ *
+ * Checking whether a node is part of any visible layer is a single AND
+ * of its mask and the mask of the visible layers.
+ */
+class LayerMask
+{
+private:
+	static const int BITS_PER_WORD = 64;
+
+	std::uint64_t _bits;
+
+	// The words holding layer IDs 64 and above, without trailing empty words
+	std::vector<std::uint64_t> _extraBits;
+
+public:
+	LayerMask() :
+		_bits(0)
+	{}
+
+	explicit LayerMask(const LayerList& layers) :
+		_bits(0)
+	{
+		for (int layerId : layers)
+		{
+			set(layerId);
+		}
+	}
+
+	bool test(int layerId) const
+	{
+		const std::uint64_t* word = getWord(layerId);
+		return word != nullptr && (*word & getBit(layerId)) != 0;
+	}
+
+	// Adds the given layer ID, negative IDs are ignored
+	void set(int layerId)
+	{
+		if (layerId < 0) return;
+
+		if (layerId < BITS_PER_WORD)
+		{
+			_bits |= getBit(layerId);
+			return;
+		}
+
+		std::size_t index = layerId / BITS_PER_WORD - 1;
+
+		if (index >= _extraBits.size())
+		{
+			_extraBits.resize(index + 1, 0);
+		}
+
+		_extraBits[index] |= getBit(layerId);
+	}
+
+	void reset(int layerId)
+	{
+		if (layerId < 0) return;
+
+		if (layerId < BITS_PER_WORD)
+		{
+			_bits &= ~getBit(layerId);
+			return;
+		}
+
+		std::size_t index = layerId / BITS_PER_WORD - 1;
+
+		if (index >= _extraBits.size()) return;
+
+		_extraBits[index] &= ~getBit(layerId);
+
+		while (!_extraBits.empty() && _extraBits.back() == 0)
+		{
+			_extraBits.pop_back();
+		}
+	}
+
+	void clear()
+	{
+		_bits = 0;
+		_extraBits.clear();
+	}
+
+	bool none() const
+	{
+		// Trailing empty words are removed, so any extra word has a bit set
+		return _bits == 0 && _extraBits.empty();
+	}
+
+	// Returns true if the two masks have at least one layer in common
+	bool intersects(const LayerMask& other) const
+	{
+		if ((_bits & other._bits) != 0) return true;
+
+		std::size_t numWords = std::min(_extraBits.size(), other._extraBits.size());
+
+		for (std::size_t i = 0; i < numWords; ++i)
+		{
+			if ((_extraBits[i] & other._extraBits[i]) != 0) return true;
+		}
+
+		return false;
+	}
+
+	// Invokes the given function with each layer ID in ascending order
+	void foreachLayer(const std::function<void(int)>& func) const
+	{
+		for (std::size_t word = 0; word <= _extraBits.size(); ++word)
+		{
+			std::uint64_t bits = word == 0 ? _bits : _extraBits[word - 1];
+
+			for (int bit = 0; bits != 0; ++bit, bits >>= 1)
+			{
+				if ((bits & 1) != 0)
+				{
+					func(static_cast<int>(word * BITS_PER_WORD) + bit);
+				}
+			}
+		}
+	}
+
+	LayerList getLayers() const
+	{
+		LayerList layers;
+
+		foreachLayer([&](int layerId) { layers.insert(layerId); });
+
+		return layers;
+	}
+
+	bool operator==(const LayerMask& other) const
+	{
+		return _bits == other._bits && _extraBits == other._extraBits;
+	}
+
+	bool operator!=(const LayerMask& other) const
+	{
+		return !operator==(other);
+	}
+
+private:
+	static std::uint64_t getBit(int layerId)
+	{
+		return std::uint64_t(1) << (layerId % BITS_PER_WORD);
+	}
+
+	const std::uint64_t* getWord(int layerId) const
+	{
+		if (layerId < 0) return nullptr;
+
+		if (layerId < BITS_PER_WORD) return &_bits;
+
+		std::size_t index = layerId / BITS_PER_WORD - 1;
+
+		return index < _extraBits.size() ? &_extraBits[index] : nullptr;
+	}
+};
+
 /**
  * greebo: Interface of a Layered object.
  */
@@ -45,6 +210,12 @@ public:
      */
     virtual LayerList getLayers() const = 0;
 
+	/**
+	 * Return the layers this object is assigned to as bitset,
+	 * which is cheaper to test than the LayerList.
+	 */
+	virtual const LayerMask& getLayerMask() const = 0;
+
 	/**
 	 * greebo: This assigns the given node to the given set of layers. Any previous
 	 * assignments of the node will be overwritten by this routine.
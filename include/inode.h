@@ -238,7 +238,7 @@ public:
 
 	// Undo/Redo events - some nodes need to do extra legwork after undo or redo
 	// This is called by the TraversableNodeSet after a undo/redo operation
-	// not by the UndoSystem itself, at least not yet.
+	// changed the set of child nodes, not by the UndoSystem itself.
 	virtual void onPostUndo() {}
 	virtual void onPostRedo() {}
     
@@ -184,6 +184,16 @@ public:
     /// Return true if this light intersects the given AABB
 	virtual bool intersectsAABB(const AABB& aabb) const = 0;
 
+    /**
+     * \brief
+     * Return the world-space bounds of the light volume.
+     *
+     * intersectsAABB() must return false for any AABB not intersecting these
+     * bounds, the renderer uses them to find the objects this light may
+     * illuminate.
+     */
+    virtual AABB lightAABB() const = 0;
+
     /**
      * \brief
      * Return the light origin in world space.
@@ -230,6 +240,16 @@ public:
     /// Test if the given light intersects the LitObject
     virtual bool intersectsLight(const RendererLight& light) const = 0;
 
+    /**
+     * \brief
+     * Return the world-space bounds of this object.
+     *
+     * intersectsLight() must return false for any light whose lightAABB()
+     * doesn't intersect these bounds. The renderer uses them to limit the
+     * intersection tests to the lights near the object.
+     */
+    virtual const AABB& getLitObjectBounds() const = 0;
+
     /// Add a light to the set of lights which do intersect this object
     virtual void insertLight(const RendererLight& light) {}
 
@@ -270,14 +290,16 @@ typedef std::function<void(const RendererLight&)> RendererLightCallback;
  * it invokes LightList::calculateIntersectingLights() on the stored LightList
  * reference.
  * 4. calculateIntersectingLights() first checks to see if the lights need
- * updating, which is true if EITHER this LightList's setDirty() method OR the
- * RenderSystem's lightChanged() has been called since the last calculation. If
+ * updating, which is true if EITHER this LightList's setDirty() method has
+ * been called OR the RenderSystem's lightChanged() has been called for a light
+ * whose old or new volume is near the object since the last calculation. If
  * no update is needed, it returns.
- * 5. If an update IS needed, the LightList iterates over all lights in the
- * scene, and tests if each one intersects its associated lit object (which is
- * the one that just invoked calculateIntersectingLights(), although nothing
- * enforces this). This intersection test is performed by passing the light to
- * the LitObject::intersectsLight() method.
+ * 5. If an update IS needed, the LightList iterates over the lights whose
+ * lightAABB() intersects the object's bounds, and tests if each one intersects
+ * its associated lit object (which is the one that just invoked
+ * calculateIntersectingLights(), although nothing enforces this). This
+ * intersection test is performed by passing the light to the
+ * LitObject::intersectsLight() method.
  * 6. For each light which passes the intersection test, the LightList both adds
  * it to its internal list of "active" (i.e. intersecting) lights for its
  * object, and passes it to the object's insertLight() method. Some object
@@ -376,6 +398,51 @@ public:
     }
 };
 
+/**
+ * \brief
+ * Single-precision vertex as stored in the geometry batches of the render
+ * system. The layout matches what the interaction programs expect.
+ */
+struct BatchVertex
+{
+    float vertex[3];
+    float texcoord[2];
+    float normal[3];
+    float tangent[3];
+    float bitangent[3];
+};
+
+/**
+ * \brief
+ * Interface for renderables consisting of a single static convex polygon in
+ * world space (e.g. brush face windings).
+ *
+ * If batching is enabled, the render system packs the vertices of such
+ * objects into per-shader vertex buffers and draws all of them in one call,
+ * instead of invoking OpenGLRenderable::render() for each of them. The packed
+ * data is only refreshed when the geometry revision changes.
+ */
+class BatchableRenderable
+{
+public:
+    virtual ~BatchableRenderable() {}
+
+    /**
+     * \brief
+     * Return a number identifying the current state of the geometry. It must
+     * change whenever the geometry changes, and must not be handed out by any
+     * other BatchableRenderable instance, as the render system uses it to
+     * detect outdated buffer contents.
+     */
+    virtual std::size_t getGeometryRevision() const = 0;
+
+    /// Return the number of polygon vertices
+    virtual std::size_t getNumBatchVertices() const = 0;
+
+    /// Write the polygon vertices in winding order to the given array
+    virtual void writeBatchVertices(BatchVertex* vertices) const = 0;
+};
+
 /**
  * \brief
  * Interface for objects which can render themselves in OpenGL.
@@ -398,6 +465,16 @@ public:
      * Submit OpenGL render calls.
      */
     virtual void render(const RenderInfo& info) const = 0;
+
+    /**
+     * \brief
+     * Return the batchable interface of this object, or nullptr if its
+     * geometry cannot be packed into the render system's vertex buffers.
+     */
+    virtual const BatchableRenderable* getBatchable() const
+    {
+        return nullptr;
+    }
 };
 
 class Matrix4;
@@ -81,7 +81,8 @@ public:
 	/// \todo Move to a separate class.
 	virtual void boundsChanged() = 0;
 
-	// A specific node has changed its bounds
+	// A specific node has changed its bounds. The space partition is updated
+	// in batches, before it is used the next time.
 	virtual void nodeBoundsChanged(const scene::INodePtr& node) = 0;
 
 	// A walker class to be used in "foreachNodeInVolume"
@@ -112,6 +113,13 @@ public:
 	// Same as above, but culls any hidden nodes
 	virtual void foreachVisibleNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor) = 0;
 
+	// Visits the visible scene nodes in the given volume front to back, see
+	// ISpacePartitionSystem::foreachMemberInVolumeFrontToBack(). The functor receives
+	// the nearest depth of the node's bounds, no node visited later is any closer.
+	// Traversal stops as soon as the functor returns false.
+	typedef std::function<bool(const INodePtr&, double)> DepthSortedVisitorFunc;
+	virtual void foreachVisibleNodeInVolumeFrontToBack(const VolumeTest& volume, const DepthSortedVisitorFunc& functor) = 0;
+
 	// Returns the associated spacepartition
 	virtual ISpacePartitionSystemPtr getSpacePartition() = 0;
 };
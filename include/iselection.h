@@ -281,6 +281,8 @@ public:
 	// Feedback events invoked by the ManipulationMouseTool
 	virtual void onManipulationStart() = 0;
 	virtual void onManipulationChanged() = 0;
+
+	// Freezes the transformations of the manipulated nodes
 	virtual void onManipulationEnd() = 0;
 
     virtual void SelectPoint(const render::View& view, const Vector2& devicePoint, const Vector2& deviceEpsilon, EModifier modifier, bool face) = 0;
@@ -49,6 +49,13 @@ public:
 	{
 		return _depth;
 	}
+
+	// The squared distance to the selection point in device coordinates,
+	// this is 0 if the tested geometry covers the point
+	float distance() const
+	{
+		return _distance;
+	}
 	
 	bool isValid() const
 	{
@@ -268,6 +275,19 @@ class SelectionTestable
 public:
     virtual ~SelectionTestable() {}
 	virtual void testSelect(Selector& selector, SelectionTest& test) = 0;
+
+	/**
+	 * Called on the main thread before testSelect() is invoked from a worker
+	 * thread, like during rubber-band area selection. Implementations bring
+	 * any lazily evaluated data used by testSelect() up to date and return true
+	 * if the test is then safe to run concurrently with the ones of other nodes
+	 * (each thread is using its own SelectionTest). Nodes returning false are
+	 * tested on the main thread.
+	 */
+	virtual bool prepareConcurrentSelectionTest()
+	{
+		return false;
+	}
 };
 typedef std::shared_ptr<SelectionTestable> SelectionTestablePtr;
 
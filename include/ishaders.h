@@ -173,6 +173,15 @@ public:
      */
     virtual TexturePtr getEditorImage() = 0;
 
+    /**
+     * \brief
+     * Return a downscaled preview of the editor image, suitable for the
+     * tiles of the texture browser. The returned texture reports
+     * the dimensions of the full editor image. It is served from a disk cache
+     * so that the full image does not need to be loaded.
+     */
+    virtual TexturePtr getEditorImageThumbnail() = 0;
+
     /**
      * \brief
      * Return true if the editor image is no tex for this shader.
@@ -404,6 +413,13 @@ public:
      */
     virtual void foreachMaterial(const std::function<void(const MaterialPtr&)>& func) = 0;
 
+    /**
+     * Write the index of the editor image thumbnail cache to disk. To be called
+     * after a batch of thumbnails has been requested, e.g. once the texture
+     * browser has been populated. Does nothing if no thumbnail has been added.
+     */
+    virtual void saveThumbnailCache() = 0;
+
     // Set the callback to be invoked when the active shaders list has changed
 	virtual sigc::signal<void> signal_activeShadersChanged() const = 0;
 
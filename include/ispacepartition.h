@@ -3,10 +3,12 @@
 
 #include <list>
 #include <vector>
+#include <functional>
 #include "imodule.h"
 
 // Forward declaration
 class AABB;
+class VolumeTest;
 
 namespace scene
 {
@@ -88,8 +90,43 @@ public:
 	// (node had been linked before)
 	virtual bool unlink(const scene::INodePtr& sceneNode) = 0;
 
+	/**
+	 * Moves the given nodes to the place matching their current bounds,
+	 * as if each of them was unlinked and linked again. Nodes which are not
+	 * linked are ignored. This is meant for bulk updates after many nodes
+	 * have been transformed at once, the nodes are re-bucketed in one pass.
+	 */
+	virtual void relink(const std::vector<scene::INodePtr>& sceneNodes) = 0;
+
 	// Returns the root node of this SP tree (the largest one, encompassing everything)
 	virtual ISPNodePtr getRoot() const = 0;
+
+	typedef std::function<bool(const scene::INodePtr&)> MemberVisitor;
+
+	/**
+	 * Invokes the visitor for each linked node which might intersect the given volume,
+	 * members of larger nodes are visited before the ones of their children.
+	 * Traversal stops as soon as the visitor returns false, in which case this
+	 * method returns false too.
+	 *
+	 * No nodes must be linked or unlinked during traversal.
+	 */
+	virtual bool foreachMemberInVolume(const VolumeTest& volume, const MemberVisitor& visitor) = 0;
+
+	typedef std::function<bool(const scene::INodePtr&, double)> DepthSortedMemberVisitor;
+
+	/**
+	 * Invokes the visitor for each linked node which might intersect the given volume,
+	 * front to back: ordered by the nearest depth of their bounds, in normalised device
+	 * coordinates [-1..1] of the volume's projection and modelview. This depth is passed
+	 * to the visitor, it is a lower bound for the depth of anything within the bounds
+	 * of the visited node and of the ones visited after it.
+	 * Traversal stops as soon as the visitor returns false, in which case this
+	 * method returns false too.
+	 *
+	 * No nodes must be linked or unlinked during traversal.
+	 */
+	virtual bool foreachMemberInVolumeFrontToBack(const VolumeTest& volume, const DepthSortedMemberVisitor& visitor) = 0;
 };
 typedef std::shared_ptr<ISpacePartitionSystem> ISpacePartitionSystemPtr;
 
@@ -33,6 +33,13 @@ public:
 	virtual void freezeTransform() = 0;
 	virtual void revertTransform() = 0;
 
+    // Starts previewing the transformation, like during a manipulator drag.
+    // Until the next freezeTransform() or revertTransform() call, primitive
+    // transformations only change the matrix the node is rendered and tested with,
+    // its geometry is transformed once when the transformation is frozen.
+    // Transformables not supporting this keep updating their geometry right away.
+    virtual void beginTransformPreview() = 0;
+
     // For pivoted rotations the code needs to know the object center
     // before the operation started.
     virtual const Vector3& getUntransformedOrigin() = 0;
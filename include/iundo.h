@@ -19,6 +19,17 @@ class IUndoMemento
 {
 public:
     virtual ~IUndoMemento() {}
+
+    /**
+     * Returns the approximate number of bytes occupied by this memento,
+     * used to keep the undo stack within its memory budget. Data shared
+     * between several mementos is only accounted to the one allocating it.
+     * Mementos not overriding this are not taken into account.
+     */
+    virtual std::size_t getMemoryUsage() const
+    {
+        return 0;
+    }
 };
 typedef std::shared_ptr<IUndoMemento> IUndoMementoPtr;
 
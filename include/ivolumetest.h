@@ -30,6 +30,7 @@ class Plane3;
 class Matrix4;
 class AABB;
 class Segment;
+class Frustum;
 
 class VolumeTest
 {
@@ -50,6 +51,11 @@ public:
   /// \brief Returns the intersection of \p aabb transformed by \p localToWorld and volume.
   virtual VolumeIntersectionValue TestAABB(const AABB& aabb, const Matrix4& localToWorld) const = 0;
 
+  /// \brief Returns the world-space frustum this volume is culling against, or
+  /// nullptr if the volume can only be tested through the methods above.
+  /// An AABB is outside of the volume if it is behind any of the frustum planes.
+  virtual const Frustum* getCullingFrustum() const { return nullptr; }
+
   virtual bool fill() const = 0;
 
   virtual const Matrix4& GetViewport() const = 0;
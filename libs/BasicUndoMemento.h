@@ -2,20 +2,66 @@
 
 #include "iundo.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace undo
 {
 
+/**
+ * Returns the approximate number of bytes a value has allocated on the
+ * heap, not including the size of the value itself. Types not listed
+ * below are assumed to own no heap memory (or to share it, like pointers).
+ */
+template<typename T>
+inline std::size_t getAllocatedSize(const T& value)
+{
+	return 0;
+}
+
+template<typename First, typename Second>
+inline std::size_t getAllocatedSize(const std::pair<First, Second>& pair);
+
+template<typename Element>
+inline std::size_t getAllocatedSize(const std::vector<Element>& vector);
+
+inline std::size_t getAllocatedSize(const std::string& string)
+{
+	// Short strings are stored in place
+	return string.capacity() >= sizeof(std::string) ? string.capacity() + 1 : 0;
+}
+
+template<typename First, typename Second>
+inline std::size_t getAllocatedSize(const std::pair<First, Second>& pair)
+{
+	return getAllocatedSize(pair.first) + getAllocatedSize(pair.second);
+}
+
+template<typename Element>
+inline std::size_t getAllocatedSize(const std::vector<Element>& vector)
+{
+	std::size_t size = vector.capacity() * sizeof(Element);
+
+	for (const Element& element : vector)
+	{
+		size += getAllocatedSize(element);
+	}
+
+	return size;
+}
+
 /**
  * An UndoMemento implementation capable of holding a single
  * copyable object, which is stored by value.
  */
 template<typename Copyable>
-class BasicUndoMemento : 
+class BasicUndoMemento :
 	public IUndoMemento
 {
 	Copyable _data;
 public:
-	BasicUndoMemento(const Copyable& data) : 
+	BasicUndoMemento(const Copyable& data) :
 		_data(data)
 	{}
 
@@ -23,6 +69,11 @@ public:
 	{
 		return _data;
 	}
+
+	std::size_t getMemoryUsage() const override
+	{
+		return sizeof(*this) + getAllocatedSize(_data);
+	}
 };
 
 } // namespace
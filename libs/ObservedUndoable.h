@@ -19,6 +19,10 @@ class ObservedUndoable :
 	IUndoStateSaver* _undoStateSaver;
     IMapFileChangeTracker* _changeTracker;
 
+	// The most recently exported or imported memento. It's shared with the next
+	// operation if the object still equals its data, like when undoing and redoing.
+	mutable std::shared_ptr<BasicUndoMemento<Copyable> > _lastState;
+
 public:
 	ObservedUndoable<Copyable>(Copyable& object, const ImportCallback& importCallback) :
 		_object(object), 
@@ -40,6 +44,7 @@ public:
 
     void disconnectUndoSystem(IMapFileChangeTracker& map)
 	{
+        _lastState.reset();
         _undoStateSaver = nullptr;
         _changeTracker = nullptr;
 		GlobalUndoSystem().releaseStateSaver(*this);
@@ -53,16 +58,27 @@ public:
 		}
 	}
 
+	// Copyable needs to be equality-comparable, mementos are immutable and can be shared
 	IUndoMementoPtr exportState() const
 	{
-		return IUndoMementoPtr(new BasicUndoMemento<Copyable>(_object));
+		if (!_lastState || !(_lastState->data() == _object))
+		{
+			_lastState = std::make_shared<BasicUndoMemento<Copyable> >(_object);
+		}
+
+		return _lastState;
 	}
 
 	void importState(const IUndoMementoPtr& state)
 	{
 		save();
 
-		_importCallback(std::static_pointer_cast<BasicUndoMemento<Copyable> >(state)->data());
+		std::shared_ptr<BasicUndoMemento<Copyable> > memento =
+			std::static_pointer_cast<BasicUndoMemento<Copyable> >(state);
+
+		_importCallback(memento->data());
+
+		_lastState = memento;
 	}
 };
 
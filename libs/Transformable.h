@@ -33,6 +33,9 @@ private:
 
     unsigned int _transformationType;
 
+    // True while the transformation is only previewed, see beginTransformPreview()
+    bool _transformPreview;
+
 public:
 
 	Transformable() :
@@ -40,7 +43,8 @@ public:
 		_rotation(Quaternion::Identity()),
 		_scale(c_scale_identity),
 		_type(TRANSFORM_PRIMITIVE),
-        _transformationType(NoTransform)
+        _transformationType(NoTransform),
+        _transformPreview(false)
 	{}
 
 	void setType(TransformModifierType type) override
@@ -104,8 +108,16 @@ public:
 		_onTransformationChanged();
 	}
 
+	void beginTransformPreview() override
+	{
+		_transformPreview = true;
+	}
+
 	void freezeTransform() override
 	{
+		// The geometry is going to be transformed now
+		_transformPreview = false;
+
 		if (_translation != c_translation_identity ||
 			_rotation != c_rotation_identity ||
 			_scale != c_scale_identity)
@@ -129,6 +141,8 @@ public:
 	*/
 	void revertTransform() override
 	{
+		_transformPreview = false;
+
 		_translation = c_translation_identity;
 		_rotation = c_rotation_identity;
 		_scale = c_scale_identity;
@@ -168,6 +182,17 @@ protected:
         return _transformationType;
     }
 
+    /**
+     * Returns true if the current transformation is only previewed, in which
+     * case subclasses supporting it leave their geometry untouched and render
+     * it using calculateTransform() instead, until the transform is frozen.
+     * Component transformations are never previewed.
+     */
+    bool isPreviewingTransform() const
+    {
+        return _transformPreview && _type == TRANSFORM_PRIMITIVE;
+    }
+
 	/**
 	 * greebo: Signal method for subclasses. This gets called
 	 * as soon as anything (translation, scale, rotation) is changed.
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Matrix4.h"
+#include "AABB.h"
+
+#include <algorithm>
 
 /**
  * Specialisation of the Matrix4 class offering convenience methods
@@ -21,6 +24,13 @@ public:
 	bool testPoint(const Vector3& point) const;
 
 	bool testPoint(const Vector3& point, const Matrix4& localToWorld) const;
+
+	/**
+	 * Returns a lower bound for the normalised device depth [-1..1] of the points
+	 * within the given bounds. Bounds reaching behind the viewer and invalid ones
+	 * return -1, which is the depth of the near plane.
+	 */
+	double getNearestDepth(const AABB& aabb) const;
 };
 
 inline bool ViewProjection::testPoint(const Vector3& point) const
@@ -41,3 +51,47 @@ inline bool ViewProjection::testPoint(const Vector3& point, const Matrix4& local
 {
 	return testPoint(localToWorld.transformPoint(point));
 }
+
+inline double ViewProjection::getNearestDepth(const AABB& aabb) const
+{
+	if (!aabb.isValid())
+	{
+		return -1;
+	}
+
+	const Vector3& origin = aabb.origin;
+	const Vector3& extents = aabb.extents;
+
+	// Only the z and w rows are needed, evaluated at the centre and along the extents
+	double centreZ = xz() * origin.x() + yz() * origin.y() + zz() * origin.z() + tz();
+	double centreW = xw() * origin.x() + yw() * origin.y() + zw() * origin.z() + tw();
+
+	double extentsZ[3] = { xz() * extents.x(), yz() * extents.y(), zz() * extents.z() };
+	double extentsW[3] = { xw() * extents.x(), yw() * extents.y(), zw() * extents.z() };
+
+	// The depth is monotonic along the view direction, the nearest point of the box is one of the corners
+	double nearest = 1;
+
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		double z = centreZ;
+		double w = centreW;
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			double sign = (corner & (1 << axis)) ? 1 : -1;
+
+			z += sign * extentsZ[axis];
+			w += sign * extentsW[axis];
+		}
+
+		if (w <= 0)
+		{
+			return -1;
+		}
+
+		nearest = std::min(nearest, z / w);
+	}
+
+	return std::max(nearest, -1.0);
+}
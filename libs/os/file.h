@@ -3,6 +3,7 @@
 #include "itextstream.h"
 #include "fs.h"
 #include "debugging/debugging.h"
+#include <cstdint>
 
 /// \file
 /// \brief OS file-system querying and manipulation.
@@ -113,4 +114,23 @@ inline std::size_t getFileSize(const std::string& path)
 	}
 }
 
+// Returns the last modification time of the given file as integer, or 0 on failure.
+// The unit is implementation-specific, use this for change detection only.
+inline std::int64_t getModificationTime(const std::string& path)
+{
+	try
+	{
+#ifdef DR_USE_STD_FILESYSTEM
+		return static_cast<std::int64_t>(fs::last_write_time(path).time_since_epoch().count());
+#else
+		return static_cast<std::int64_t>(fs::last_write_time(path));
+#endif
+	}
+	catch (fs::filesystem_error& err)
+	{
+		rError() << "Error checking modification time: " << err.what() << std::endl;
+		return 0;
+	}
+}
+
 } // namespace
@@ -29,18 +29,19 @@ public:
 	// Returns true if the node has been "fixed"
 	static bool ProcessNode(const INodePtr& node)
 	{
-		LayerList list = node->getLayers();
+		// Copy the mask, the node's one is changed during iteration
+		LayerMask layers = node->getLayerMask();
 
 		bool fixed = false;
 
-		for (LayerList::iterator i = list.begin(); i != list.end(); ++i)
+		layers.foreachLayer([&](int layerId)
 		{
-			if (!GlobalLayerSystem().layerExists(*i))
+			if (!GlobalLayerSystem().layerExists(layerId))
 			{
-				node->removeFromLayer(*i);
+				node->removeFromLayer(layerId);
 				fixed = true;
 			}
-		}
+		});
 
 		return fixed;
 	}
@@ -53,7 +53,7 @@ Node::Node() :
     _renderEntity(nullptr)
 {
 	// Each node is part of layer 0 by default
-	_layers.insert(0);
+	_layers.set(0);
 }
 
 Node::Node(const Node& other) :
@@ -130,31 +130,34 @@ bool Node::excluded() const
 
 void Node::addToLayer(int layerId)
 {
-	_layers.insert(layerId);
+	_layers.set(layerId);
 }
 
 void Node::moveToLayer(int layerId)
 {
 	_layers.clear();
-	_layers.insert(layerId);
+	_layers.set(layerId);
 }
 
 void Node::removeFromLayer(int layerId)
 {
 	// Look up the layer ID and remove it from the list
-	LayerList::iterator found = _layers.find(layerId);
-
-	if (found != _layers.end()) {
-		_layers.erase(found);
+	if (_layers.test(layerId)) {
+		_layers.reset(layerId);
 
 		// greebo: Make sure that every node is at least member of layer 0
-		if (_layers.empty()) {
-			_layers.insert(0);
+		if (_layers.none()) {
+			_layers.set(0);
 		}
 	}
 }
 
 LayerList Node::getLayers() const
+{
+	return _layers.getLayers();
+}
+
+const LayerMask& Node::getLayerMask() const
 {
 	return _layers;
 }
@@ -163,7 +166,7 @@ void Node::assignToLayers(const LayerList& newLayers)
 {
 	if (!newLayers.empty())
     {
-        _layers = newLayers;
+        _layers = LayerMask(newLayers);
     }
 }
 
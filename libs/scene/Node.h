@@ -61,8 +61,8 @@ private:
 	// We use this to force the rendering of hidden but selected nodes
 	bool _forceVisible;
 
-	// The list of layers this object is associated to
-	LayerList _layers;
+	// The layers this object is associated to
+	LayerMask _layers;
 
 protected:
 	// If this node is attached to a parent entity, this is the reference to it
@@ -106,6 +106,7 @@ public:
     virtual void removeFromLayer(int layerId) override;
 	virtual void moveToLayer(int layerId) override;
     virtual LayerList getLayers() const override;
+	virtual const LayerMask& getLayerMask() const override;
 	virtual void assignToLayers(const LayerList& newLayers) override;
 
 	virtual void addChildNode(const INodePtr& node) override;
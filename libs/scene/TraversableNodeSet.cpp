@@ -260,22 +260,36 @@ void TraversableNodeSet::importState(const IUndoMementoPtr& state)
 		ObserverOutputIterator(_owner, collectFunctor)
 	);
 
-	if (!_undoInsertBuffer.empty())
+	// The owning node is notified once the operation is complete, but only if its children
+	// actually changed - the UndoSystem doesn't walk the whole scene after undo/redo
+	if (before_sorted != after_sorted && !_undoHandler.connected())
 	{
 		// Register to get notified when the undo operation is complete
 		_undoHandler = GlobalUndoSystem().signal_postUndo().connect(
-			sigc::mem_fun(this, &TraversableNodeSet::onUndoRedoOperationFinished));
+			sigc::mem_fun(this, &TraversableNodeSet::onUndoOperationFinished));
 		_redoHandler = GlobalUndoSystem().signal_postRedo().connect(
-			sigc::mem_fun(this, &TraversableNodeSet::onUndoRedoOperationFinished));
+			sigc::mem_fun(this, &TraversableNodeSet::onRedoOperationFinished));
 	}
 }
 
-void TraversableNodeSet::onUndoRedoOperationFinished()
+void TraversableNodeSet::onUndoOperationFinished()
 {
 	_undoHandler.disconnect();
 	_redoHandler.disconnect();
 
 	processInsertBuffer();
+
+	_owner.onPostUndo();
+}
+
+void TraversableNodeSet::onRedoOperationFinished()
+{
+	_undoHandler.disconnect();
+	_redoHandler.disconnect();
+
+	processInsertBuffer();
+
+	_owner.onPostRedo();
 }
 
 void TraversableNodeSet::processInsertBuffer()
@@ -99,8 +99,9 @@ public:
 	void setRenderSystem(const RenderSystemPtr& renderSystem);
 
 private:
-	// UndoSystem event handler
-	void onUndoRedoOperationFinished();
+	// UndoSystem event handlers, processing the insert buffer and notifying the owner
+	void onUndoOperationFinished();
+	void onRedoOperationFinished();
 
 	// Sends the current state to the undosystem
 	void undoSave();
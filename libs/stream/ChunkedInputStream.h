@@ -0,0 +1,140 @@
+#pragma once
+
+#include "idatastream.h"
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+namespace stream
+{
+
+/**
+ * An InputStream wrapper reading the underlying stream in fixed-size chunks.
+ *
+ * Apart from the usual read() method, clients can request a pointer
+ * to a contiguous block of the next N bytes through acquire(), which avoids
+ * copying the data out of the internal buffer when decoding whole blocks
+ * (like image rows) at once. The buffer is grown if a single request exceeds
+ * the chunk size, so the whole file never needs to be held in memory.
+ */
+class ChunkedInputStream :
+	public InputStream
+{
+public:
+	static const std::size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+private:
+	InputStream& _inputStream;
+
+	std::vector<byte_type> _buffer;
+
+	// The unconsumed range within _buffer
+	std::size_t _cur;
+	std::size_t _end;
+
+	bool _exhausted;
+
+public:
+	ChunkedInputStream(InputStream& inputStream, std::size_t chunkSize = DEFAULT_CHUNK_SIZE) :
+		_inputStream(inputStream),
+		_buffer(chunkSize),
+		_cur(0),
+		_end(0),
+		_exhausted(false)
+	{}
+
+	// Returns a pointer to the next <length> bytes and advances the read position.
+	// The pointer stays valid until the next call to any method of this stream.
+	// Returns nullptr if the underlying stream doesn't have enough data left.
+	const byte_type* acquire(std::size_t length)
+	{
+		if (_end - _cur < length && !fill(length))
+		{
+			return nullptr;
+		}
+
+		const byte_type* block = _buffer.data() + _cur;
+		_cur += length;
+
+		return block;
+	}
+
+	std::size_t read(byte_type* buffer, std::size_t length) override
+	{
+		std::size_t total = 0;
+
+		while (total < length)
+		{
+			if (_cur == _end && !fill(1))
+			{
+				break;
+			}
+
+			std::size_t count = std::min(_end - _cur, length - total);
+			std::memcpy(buffer + total, _buffer.data() + _cur, count);
+
+			_cur += count;
+			total += count;
+		}
+
+		return total;
+	}
+
+	// Skips the given number of bytes, returns false if the stream ended before
+	bool seek(std::size_t length)
+	{
+		while (length > 0)
+		{
+			if (_cur == _end && !fill(1))
+			{
+				return false;
+			}
+
+			std::size_t count = std::min(_end - _cur, length);
+
+			_cur += count;
+			length -= count;
+		}
+
+		return true;
+	}
+
+private:
+	// Ensures that at least <length> unconsumed bytes are present in the buffer
+	bool fill(std::size_t length)
+	{
+		// Move the remaining bytes to the front
+		std::size_t remaining = _end - _cur;
+
+		if (remaining > 0 && _cur > 0)
+		{
+			std::memmove(_buffer.data(), _buffer.data() + _cur, remaining);
+		}
+
+		_cur = 0;
+		_end = remaining;
+
+		if (_buffer.size() < length)
+		{
+			_buffer.resize(length);
+		}
+
+		// Some streams (e.g. deflated ones) return less than requested, keep reading
+		while (_end < length && !_exhausted)
+		{
+			std::size_t bytesRead = _inputStream.read(_buffer.data() + _end, _buffer.size() - _end);
+
+			if (bytesRead == 0)
+			{
+				_exhausted = true;
+				break;
+			}
+
+			_end += bytesRead;
+		}
+
+		return _end >= length;
+	}
+};
+
+}
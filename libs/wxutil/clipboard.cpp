@@ -5,6 +5,47 @@
 namespace wxutil
 {
 
+namespace
+{
+	const char* const CONTENT_ID_FORMAT = "application/x-darkradiant-content-id";
+
+	// Text data object calling the generator function the first time the text is requested
+	class LazyTextDataObject :
+		public wxTextDataObject
+	{
+	private:
+		std::function<std::string()> _generateText;
+		mutable bool _generated;
+
+	public:
+		LazyTextDataObject(const std::function<std::string()>& generateText) :
+			_generateText(generateText),
+			_generated(false)
+		{}
+
+		size_t GetTextLength() const override
+		{
+			ensureGenerated();
+			return wxTextDataObject::GetTextLength();
+		}
+
+		wxString GetText() const override
+		{
+			ensureGenerated();
+			return wxTextDataObject::GetText();
+		}
+
+	private:
+		void ensureGenerated() const
+		{
+			if (_generated) return;
+
+			_generated = true;
+			const_cast<LazyTextDataObject*>(this)->SetText(_generateText());
+		}
+	};
+}
+
 void copyToClipboard(const std::string& contents)
 {
 	if (wxTheClipboard->Open())
@@ -15,6 +56,22 @@ void copyToClipboard(const std::string& contents)
 	}
 }
 
+void copyToClipboard(const std::function<std::string()>& generateText, const std::string& contentId)
+{
+	if (wxTheClipboard->Open())
+	{
+		wxCustomDataObject* id = new wxCustomDataObject(wxDataFormat(CONTENT_ID_FORMAT));
+		id->SetData(contentId.size(), contentId.c_str());
+
+		wxDataObjectComposite* data = new wxDataObjectComposite;
+		data->Add(new LazyTextDataObject(generateText), true);
+		data->Add(id);
+
+		wxTheClipboard->SetData(data);
+		wxTheClipboard->Close();
+	}
+}
+
 std::string pasteFromClipboard()
 {
 	std::string returnValue;
@@ -34,4 +91,30 @@ std::string pasteFromClipboard()
 	return returnValue;
 }
 
+void flushClipboard()
+{
+	wxTheClipboard->Flush();
+}
+
+std::string getClipboardContentId()
+{
+	std::string returnValue;
+
+	if (wxTheClipboard->Open())
+	{
+		wxDataFormat format(CONTENT_ID_FORMAT);
+
+		if (wxTheClipboard->IsSupported(format))
+		{
+			wxCustomDataObject data(format);
+			wxTheClipboard->GetData(data);
+			returnValue.assign(static_cast<const char*>(data.GetData()), data.GetSize());
+		}
+
+		wxTheClipboard->Close();
+	}
+
+	return returnValue;
+}
+
 } // namespace gtkutil
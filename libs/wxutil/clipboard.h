@@ -1,12 +1,30 @@
 #pragma once
 
 #include <string>
+#include <functional>
 
 namespace wxutil
 {
     /// Copy the given string to the system clipboard
     void copyToClipboard(const std::string& str);
 
+    /**
+     * Publish text to the system clipboard which is only generated once it is
+     * requested (by another application or pasteFromClipboard()). The given
+     * ID is stored alongside, it identifies the content as long as the
+     * clipboard is holding it, see getClipboardContentId().
+     */
+    void copyToClipboard(const std::function<std::string()>& generateText, const std::string& contentId);
+
     /// Return the contents of the clipboard as a string
     std::string pasteFromClipboard();
+
+    /// Keep the current contents of the clipboard available after the
+    /// application has exited, on the platforms supporting this
+    void flushClipboard();
+
+    /// Return the ID passed to copyToClipboard() together with the current
+    /// contents, or an empty string if the contents have been copied
+    /// without an ID (e.g. by a different application)
+    std::string getClipboardContentId();
 }
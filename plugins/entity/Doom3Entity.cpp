@@ -274,6 +274,8 @@ void Doom3Entity::insert(const std::string& key, const KeyValuePtr& keyValue)
 		KeyValuePair(key, keyValue)
 	);
 
+	_keyIndex.insert(key, _keyValues.size() - 1);
+
 	// Dereference the iterator to get a KeyValue& reference and notify the observers
 	notifyInsert(key, *i->second);
 
@@ -322,6 +324,7 @@ void Doom3Entity::erase(const KeyValues::iterator& i)
 	KeyValuePtr value(i->second);
 
 	// Actually delete the object from the list
+	_keyIndex.erase(key, i - _keyValues.begin());
 	_keyValues.erase(i);
 
 	// Notify about the deletion
@@ -345,34 +348,16 @@ void Doom3Entity::erase(const std::string& key)
 
 Doom3Entity::KeyValues::const_iterator Doom3Entity::find(const std::string& key) const
 {
-	for (KeyValues::const_iterator i = _keyValues.begin();
-		 i != _keyValues.end();
-		 ++i)
-	{
-		if (string::iequals(i->first, key))
-		{
-			return i;
-		}
-	}
+	std::size_t position = _keyIndex.find(key);
 
-	// Not found
-	return _keyValues.end();
+	return position != KeyIndex::NOT_FOUND ? _keyValues.begin() + position : _keyValues.end();
 }
 
 Doom3Entity::KeyValues::iterator Doom3Entity::find(const std::string& key)
 {
-	for (KeyValues::iterator i = _keyValues.begin();
-		 i != _keyValues.end();
-		 ++i)
-	{
-		if (string::iequals(i->first, key))
-		{
-			return i;
-		}
-	}
+	std::size_t position = _keyIndex.find(key);
 
-	// Not found
-	return _keyValues.end();
+	return position != KeyIndex::NOT_FOUND ? _keyValues.begin() + position : _keyValues.end();
 }
 
 } // namespace entity
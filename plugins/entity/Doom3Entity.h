@@ -2,6 +2,7 @@
 
 #include <vector>
 #include "KeyValue.h"
+#include "KeyIndex.h"
 #include <memory>
 
 /** greebo: This is the implementation of the class Entity.
@@ -20,6 +21,7 @@ namespace entity {
 /// - Notifies observers when a pair is inserted or removed.
 /// - Provides undo support through the global undo system.
 /// - New keys are appended to the end of the list.
+/// - Keys are looked up case-insensitively through a hash index.
 class Doom3Entity :
 	public Entity
 {
@@ -34,6 +36,9 @@ class Doom3Entity :
 	typedef std::vector<KeyValuePair> KeyValues;
 	KeyValues _keyValues;
 
+	// Position of each key in the above list
+	KeyIndex _keyIndex;
+
 	typedef std::set<Observer*> Observers;
 	Observers _observers;
 
@@ -0,0 +1,66 @@
+#include "KeyIndex.h"
+
+#include "string/predicate.h"
+#include <cctype>
+
+namespace entity
+{
+
+const std::size_t KeyIndex::NOT_FOUND = std::string::npos;
+
+std::size_t KeyIndex::CaseInsensitiveHash::operator()(const std::string& key) const
+{
+	// FNV-1a on the lowercase characters
+	std::size_t hash = 14695981039346656037ULL;
+
+	for (std::string::value_type c : key)
+	{
+		hash ^= static_cast<unsigned char>(::tolower(c));
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+bool KeyIndex::CaseInsensitiveEqual::operator()(const std::string& a, const std::string& b) const
+{
+	return string::iequals(a, b);
+}
+
+std::size_t KeyIndex::find(const std::string& key) const
+{
+	Positions::const_iterator found = _positions.find(key);
+
+	return found != _positions.end() ? found->second : NOT_FOUND;
+}
+
+void KeyIndex::insert(const std::string& key, std::size_t position)
+{
+	_positions.emplace(key, position);
+}
+
+void KeyIndex::erase(const std::string& key, std::size_t position)
+{
+	_positions.erase(key);
+
+	// Removing the last key (or the only one) doesn't move any others
+	if (position == _positions.size())
+	{
+		return;
+	}
+
+	for (Positions::value_type& pair : _positions)
+	{
+		if (pair.second > position)
+		{
+			--pair.second;
+		}
+	}
+}
+
+void KeyIndex::clear()
+{
+	_positions.clear();
+}
+
+} // namespace entity
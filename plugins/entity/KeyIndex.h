@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+namespace entity
+{
+
+/**
+ * Case-insensitive hash index of the keys stored in an ordered list,
+ * mapping each key to its position in that list. The list itself keeps
+ * the insertion order (which is the one the spawnargs are saved in),
+ * the index is used to look up a key without scanning the whole list.
+ *
+ * The owner is responsible for keeping the index in sync with its list.
+ */
+class KeyIndex
+{
+public:
+	// Hashes the lowercase characters of the key
+	struct CaseInsensitiveHash
+	{
+		std::size_t operator()(const std::string& key) const;
+	};
+
+	struct CaseInsensitiveEqual
+	{
+		bool operator()(const std::string& a, const std::string& b) const;
+	};
+
+private:
+	typedef std::unordered_map<std::string, std::size_t, CaseInsensitiveHash, CaseInsensitiveEqual> Positions;
+	Positions _positions;
+
+public:
+	// Returned by find() if the key is not in the list
+	static const std::size_t NOT_FOUND;
+
+	// Returns the position of the given key, regardless of its case
+	std::size_t find(const std::string& key) const;
+
+	// Adds the key at the given position, which has to be the end of the list
+	void insert(const std::string& key, std::size_t position);
+
+	// Removes the key at the given position, the keys after it are moved up by one
+	void erase(const std::string& key, std::size_t position);
+
+	void clear();
+};
+
+} // namespace entity
@@ -20,6 +20,11 @@ private:
 	{
 		scene::INodePtr node;
 		std::string path;
+
+		bool operator==(const ModelNodeAndPath& other) const
+		{
+			return node == other.node && path == other.path;
+		}
 	};
 
 	ModelNodeAndPath _model;
@@ -760,19 +760,17 @@ bool Light::intersectsAABB(const AABB& other) const
 
     if (isProjected())
     {
-        // Update the projection, including the Frustum (we don't care about the
-        // projection matrix itself).
-        updateProjection();
-
-        // Construct a transformation with the rotation and translation of the
-        // frustum
-        Matrix4 transRot = Matrix4::getIdentity();
-        transRot.translateBy(worldOrigin());
-        transRot.multiplyBy(rotation());
+        // The plane test alone lets through some AABBs near the corners of
+        // the frustum, reject everything outside of the frustum bounds first.
+        // This also updates the projection, including the Frustum.
+        if (!other.intersects(volumeAABB()))
+        {
+            return false;
+        }
 
         // Transform the frustum with the rotate/translate matrix and test its
         // intersection with the AABB
-		Frustum frustumTrans = _frustum.getTransformedBy(transRot);
+		Frustum frustumTrans = _frustum.getTransformedBy(getFrustumTransform());
 
 		VolumeIntersectionValue intersects = frustumTrans.testIntersection(other);
 
@@ -781,28 +779,110 @@ bool Light::intersectsAABB(const AABB& other) const
     else
     {
         // test against an AABB which contains the rotated bounds of this light.
-        AABB bounds = localAABB();
-        bounds.origin += worldOrigin();
-
-        returnVal = other.intersects(AABB(
-            bounds.origin,
-            Vector3(
-                static_cast<float>(fabs(m_rotation[0] * bounds.extents[0])
-                                    + fabs(m_rotation[3] * bounds.extents[1])
-                                    + fabs(m_rotation[6] * bounds.extents[2])),
-                static_cast<float>(fabs(m_rotation[1] * bounds.extents[0])
-                                    + fabs(m_rotation[4] * bounds.extents[1])
-                                    + fabs(m_rotation[7] * bounds.extents[2])),
-                static_cast<float>(fabs(m_rotation[2] * bounds.extents[0])
-                                    + fabs(m_rotation[5] * bounds.extents[1])
-                                    + fabs(m_rotation[8] * bounds.extents[2]))
-            )
-        ));
+        returnVal = other.intersects(volumeAABB());
     }
 
     return returnVal;
 }
 
+namespace
+{
+    // Like Plane3::intersect(), but fails for (nearly) parallel planes
+    // instead of dividing by a vanishing determinant
+    bool intersectPlanes(const Plane3& plane1, const Plane3& plane2, const Plane3& plane3,
+                         Vector3& point)
+    {
+        const Vector3& n1 = plane1.normal();
+        const Vector3& n2 = plane2.normal();
+        const Vector3& n3 = plane3.normal();
+
+        double det = n1.dot(n2.crossProduct(n3));
+        double scale = n1.getLength() * n2.getLength() * n3.getLength();
+
+        // Also catches NaN normals of an invalid frustum
+        if (!(std::fabs(det) > 1e-6 * scale))
+        {
+            return false;
+        }
+
+        point = Plane3::intersect(plane1, plane2, plane3);
+
+        return std::isfinite(point.x()) && std::isfinite(point.y()) && std::isfinite(point.z());
+    }
+}
+
+AABB Light::volumeAABB() const
+{
+    if (isProjected())
+    {
+        updateProjection();
+
+        const Plane3* corners[8][3] = {
+            { &_frustum.left, &_frustum.top, &_frustum.front },
+            { &_frustum.left, &_frustum.bottom, &_frustum.front },
+            { &_frustum.right, &_frustum.top, &_frustum.front },
+            { &_frustum.right, &_frustum.bottom, &_frustum.front },
+            { &_frustum.left, &_frustum.top, &_frustum.back },
+            { &_frustum.left, &_frustum.bottom, &_frustum.back },
+            { &_frustum.right, &_frustum.top, &_frustum.back },
+            { &_frustum.right, &_frustum.bottom, &_frustum.back }
+        };
+
+        // The bounds of the eight corners of the frustum
+        Vector3 points[8];
+
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            // A degenerate frustum (e.g. while dragging the target onto the
+            // start point) has no corners, it may reach anywhere
+            if (!intersectPlanes(*corners[i][0], *corners[i][1], *corners[i][2], points[i]))
+            {
+                return AABB::createInfinite();
+            }
+        }
+
+        Matrix4 transRot = getFrustumTransform();
+
+        AABB bounds;
+
+        for (const Vector3& point : points)
+        {
+            bounds.includePoint(transRot.transformPoint(point));
+        }
+
+        return bounds;
+    }
+
+    // An AABB which contains the rotated bounds of this light
+    AABB bounds = localAABB();
+    bounds.origin += worldOrigin();
+
+    return AABB(
+        bounds.origin,
+        Vector3(
+            static_cast<float>(fabs(m_rotation[0] * bounds.extents[0])
+                                + fabs(m_rotation[3] * bounds.extents[1])
+                                + fabs(m_rotation[6] * bounds.extents[2])),
+            static_cast<float>(fabs(m_rotation[1] * bounds.extents[0])
+                                + fabs(m_rotation[4] * bounds.extents[1])
+                                + fabs(m_rotation[7] * bounds.extents[2])),
+            static_cast<float>(fabs(m_rotation[2] * bounds.extents[0])
+                                + fabs(m_rotation[5] * bounds.extents[1])
+                                + fabs(m_rotation[8] * bounds.extents[2]))
+        )
+    );
+}
+
+Matrix4 Light::getFrustumTransform() const
+{
+    // The rotation and translation of the frustum
+    Matrix4 transRot = Matrix4::getIdentity();
+    transRot.translateBy(worldOrigin());
+    transRot.multiplyBy(rotation());
+
+    return transRot;
+}
+
 const Matrix4& Light::rotation() const {
     m_doom3Rotation = m_rotation.getMatrix4();
     return m_doom3Rotation;
@@ -152,6 +152,9 @@ private:
     // Update the bounds of the renderable radius box
 	void updateRenderableRadius() const;
 
+    // The rotation and translation of the projected light's frustum
+    Matrix4 getFrustumTransform() const;
+
 public:
 
     const Vector3& getUntransformedOrigin() const;
@@ -257,6 +260,10 @@ public:
 
     Matrix4 getLightTextureTransformation() const;
   	bool intersectsAABB(const AABB& other) const;
+
+    // The world-space bounds of the whole light volume, containing everything
+    // intersectsAABB() can return true for
+    AABB volumeAABB() const;
 	const Matrix4& rotation() const;
 	Vector3 getLightOrigin() const;
 	const Vector3& colour() const;
@@ -497,6 +497,11 @@ bool LightNode::intersectsAABB(const AABB& aabb) const
 	return _light.intersectsAABB(aabb);
 }
 
+AABB LightNode::lightAABB() const
+{
+	return _light.volumeAABB();
+}
+
 Vector3 LightNode::getLightOrigin() const {
 	return _light.getLightOrigin();
 }
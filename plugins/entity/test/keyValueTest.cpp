@@ -0,0 +1,251 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE keyValueTest
+#include <boost/test/unit_test.hpp>
+
+#include "KeyIndex.h"
+
+#include "string/predicate.h"
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Spawnarg lists searched linearly (like Doom3Entity did before) and
+    // through a KeyIndex, the generated keys are named like those of an AI
+    typedef std::pair<std::string, std::string> KeyValuePair;
+    typedef std::vector<KeyValuePair> KeyValues;
+
+    const char* const KEY_PREFIXES[] =
+    {
+        "def_attach", "snd_", "anim", "editor_var ", "target", "bind", "ragdoll", "spawn_", "inv_", "def_damage"
+    };
+
+    // The key list as it was searched before
+    class LinearKeyValues
+    {
+    public:
+        KeyValues keyValues;
+
+        KeyValues::iterator find(const std::string& key)
+        {
+            for (KeyValues::iterator i = keyValues.begin(); i != keyValues.end(); ++i)
+            {
+                if (string::iequals(i->first, key))
+                {
+                    return i;
+                }
+            }
+
+            return keyValues.end();
+        }
+
+        void insert(const std::string& key, const std::string& value)
+        {
+            keyValues.push_back(KeyValuePair(key, value));
+        }
+
+        void erase(KeyValues::iterator i)
+        {
+            keyValues.erase(i);
+        }
+    };
+
+    // The key list kept in sync with a KeyIndex, like Doom3Entity does
+    class IndexedKeyValues
+    {
+        entity::KeyIndex _index;
+
+    public:
+        KeyValues keyValues;
+
+        KeyValues::iterator find(const std::string& key)
+        {
+            std::size_t position = _index.find(key);
+
+            return position != entity::KeyIndex::NOT_FOUND ? keyValues.begin() + position : keyValues.end();
+        }
+
+        void insert(const std::string& key, const std::string& value)
+        {
+            keyValues.push_back(KeyValuePair(key, value));
+            _index.insert(key, keyValues.size() - 1);
+        }
+
+        void erase(KeyValues::iterator i)
+        {
+            _index.erase(i->first, i - keyValues.begin());
+            keyValues.erase(i);
+        }
+    };
+
+    // Deterministic pseudo-random numbers in [0..1)
+    double random(std::size_t& seed)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>((seed >> 11) & 0xfffff) / 0x100000;
+    }
+
+    std::size_t randomIndex(std::size_t& seed, std::size_t size)
+    {
+        return static_cast<std::size_t>(random(seed) * size);
+    }
+
+    std::vector<std::string> createKeys(std::size_t numKeys)
+    {
+        std::vector<std::string> keys;
+
+        for (std::size_t i = 0; i < numKeys; ++i)
+        {
+            keys.push_back(KEY_PREFIXES[i % 10] + std::to_string(i / 10));
+        }
+
+        return keys;
+    }
+
+    std::string changeCase(const std::string& key, std::size_t& seed)
+    {
+        std::string result(key);
+
+        for (std::string::value_type& c : result)
+        {
+            if (random(seed) < 0.5)
+            {
+                c = static_cast<std::string::value_type>(::toupper(c));
+            }
+        }
+
+        return result;
+    }
+
+    // A quarter of the looked up keys are not defined on the entity
+    std::vector<std::string> createLookups(const std::vector<std::string>& keys, std::size_t numLookups, std::size_t& seed)
+    {
+        std::vector<std::string> lookups;
+
+        for (std::size_t i = 0; i < numLookups; ++i)
+        {
+            const std::string& key = keys[randomIndex(seed, keys.size())];
+
+            lookups.push_back(changeCase(random(seed) < 0.25 ? "inherited_" + key : key, seed));
+        }
+
+        return lookups;
+    }
+
+    // Changes existing values, erases and re-adds keys the way setKeyValue() does
+    template<typename Store>
+    void mutate(Store& store, const std::vector<std::string>& keys, std::size_t numMutations, std::size_t seed)
+    {
+        for (std::size_t i = 0; i < numMutations; ++i)
+        {
+            std::string key = changeCase(keys[randomIndex(seed, keys.size())], seed);
+            KeyValues::iterator found = store.find(key);
+
+            if (random(seed) < 0.75)
+            {
+                // Change the value
+                found->second = std::to_string(i);
+            }
+            else
+            {
+                // Erase the key and add it again, moving it to the end of the list
+                std::string originalKey = found->first;
+
+                store.erase(found);
+                store.insert(originalKey, std::to_string(i));
+            }
+        }
+    }
+
+    const std::size_t NUM_LOOKUPS = 10000;
+    const std::size_t NUM_MUTATIONS = 2000;
+
+    struct Stores
+    {
+        std::vector<std::string> keys;
+
+        LinearKeyValues linear;
+        IndexedKeyValues indexed;
+
+        Stores(std::size_t numKeys) :
+            keys(createKeys(numKeys))
+        {
+            for (const std::string& key : keys)
+            {
+                linear.insert(key, key);
+                indexed.insert(key, key);
+            }
+        }
+    };
+
+    template<typename Store>
+    std::vector<std::size_t> findAll(Store& store, const std::vector<std::string>& lookups)
+    {
+        std::vector<std::size_t> positions;
+
+        for (const std::string& key : lookups)
+        {
+            positions.push_back(store.find(key) - store.keyValues.begin());
+        }
+
+        return positions;
+    }
+
+    void checkLookups(Stores& stores, const std::vector<std::string>& lookups)
+    {
+        std::vector<std::size_t> expected = findAll(stores.linear, lookups);
+        std::vector<std::size_t> positions = findAll(stores.indexed, lookups);
+
+        BOOST_CHECK(expected == positions);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(lookupIgnoresCase)
+{
+    for (std::size_t numKeys : { 10, 100, 1000 })
+    {
+        Stores stores(numKeys);
+
+        std::size_t seed = 1;
+        checkLookups(stores, createLookups(stores.keys, NUM_LOOKUPS, seed));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(lookupAfterMutations)
+{
+    for (std::size_t numKeys : { 10, 100, 1000 })
+    {
+        Stores stores(numKeys);
+
+        std::size_t seed = 1;
+        std::vector<std::string> lookups = createLookups(stores.keys, NUM_LOOKUPS, seed);
+
+        // Re-added keys are moved to the end, the positions of the others are shifted
+        mutate(stores.linear, stores.keys, NUM_MUTATIONS, seed);
+        mutate(stores.indexed, stores.keys, NUM_MUTATIONS, seed);
+
+        BOOST_CHECK(stores.linear.keyValues == stores.indexed.keyValues);
+        checkLookups(stores, lookups);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(eraseFirstAndLastKey)
+{
+    IndexedKeyValues indexed;
+    indexed.insert("classname", "atdm:ai_builder_guard");
+    indexed.insert("name", "guard");
+    indexed.insert("origin", "0 0 0");
+
+    indexed.erase(indexed.find("ORIGIN"));
+    BOOST_CHECK(indexed.find("origin") == indexed.keyValues.end());
+    BOOST_CHECK(indexed.find("Name") == indexed.keyValues.begin() + 1);
+
+    indexed.erase(indexed.find("classname"));
+    BOOST_CHECK(indexed.find("name") == indexed.keyValues.begin());
+
+    indexed.erase(indexed.find("name"));
+    BOOST_CHECK(indexed.keyValues.empty());
+    BOOST_CHECK(indexed.find("name") == indexed.keyValues.end());
+}
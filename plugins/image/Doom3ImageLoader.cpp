@@ -105,6 +105,31 @@ ImagePtr Doom3ImageLoader::imageFromVFS(const std::string& name) const
 	return ImagePtr();
 }
 
+std::string Doom3ImageLoader::findImageFileInVFS(const std::string& name) const
+{
+	const ImageTypeLoader::Extensions exts = getGameFileImageExtensions();
+
+	for (const std::string& extension : exts)
+	{
+		auto loaderIter = _loadersByExtension.find(extension);
+
+		if (loaderIter == _loadersByExtension.end())
+		{
+			continue;
+		}
+
+		// Same naming scheme as in imageFromVFS()
+		std::string fullName = loaderIter->second->getPrefix() + name + "." + extension;
+
+		if (!GlobalFileSystem().findArchive(fullName).empty())
+		{
+			return fullName;
+		}
+	}
+
+	return std::string();
+}
+
 ImagePtr Doom3ImageLoader::imageFromFile(const std::string& filename) const
 {
     ImagePtr image;
@@ -26,6 +26,7 @@ public:
 
     // ImageLoader implementation
     ImagePtr imageFromVFS(const std::string& vfsPath) const;
+    std::string findImageFileInVFS(const std::string& vfsPath) const;
 	ImagePtr imageFromFile(const std::string& filename) const;
 
     // RegisterableModule implementation
@@ -28,11 +28,10 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 typedef unsigned char byte;
 
 #include <stdlib.h>
+#include <algorithm>
 
-#include "stream/ScopedArchiveBuffer.h"
-#include "stream/PointerInputStream.h"
+#include "stream/ChunkedInputStream.h"
 #include "RGBAImage.h"
-#include "stream/utils.h"
 
 namespace image
 {
@@ -43,230 +42,233 @@ class Flip01 {}; // vertical flip only
 class Flip10 {}; // horizontal flip only
 class Flip11 {}; // both
 
-template<typename PixelDecoder>
-void image_decode(stream::PointerInputStream& istream, PixelDecoder& decode, RGBAImage& image, const Flip00&)
+// Returns the start of the image row the n-th decoded row is stored into.
+// TGA images are stored bottom-up unless the vertical flip bit is set.
+inline RGBAPixel* targa_row(RGBAImage& image, std::size_t n, const Flip00&)
 {
-  RGBAPixel* end = image.pixels + (image.height * image.width);
-  for(RGBAPixel* row = end; row != image.pixels; row -= image.width)
-  {
-    for(RGBAPixel* pixel = row - image.width; pixel != row; ++pixel)
-    {
-      decode(istream, *pixel);
-    }
-  }
+  return image.pixels + (image.height - 1 - n) * image.width;
 }
 
-template<typename PixelDecoder>
-void image_decode(stream::PointerInputStream& istream, PixelDecoder& decode, RGBAImage& image, const Flip01&)
+inline RGBAPixel* targa_row(RGBAImage& image, std::size_t n, const Flip01&)
 {
-  RGBAPixel* end = image.pixels + (image.height * image.width);
-  for(RGBAPixel* row = image.pixels; row != end; row += image.width)
-  {
-    for(RGBAPixel* pixel = row; pixel != row + image.width; ++pixel)
-    {
-      decode(istream, *pixel);
-    }
-  }
+  return image.pixels + n * image.width;
 }
 
-template<typename PixelDecoder>
-void image_decode(stream::PointerInputStream& istream, PixelDecoder& decode, RGBAImage& image, const Flip10&)
+inline RGBAPixel* targa_row(RGBAImage& image, std::size_t n, const Flip10&)
 {
-  RGBAPixel* end = image.pixels + (image.height * image.width);
-  for(RGBAPixel* row = end; row != image.pixels; row -= image.width)
-  {
-    for(RGBAPixel* pixel = row; pixel != row - image.width;)
-    {
-      decode(istream, *--pixel);
-    }
-  }
+  return targa_row(image, n, Flip00());
 }
 
-template<typename PixelDecoder>
-void image_decode(stream::PointerInputStream& istream, PixelDecoder& decode, RGBAImage& image, const Flip11&)
+inline RGBAPixel* targa_row(RGBAImage& image, std::size_t n, const Flip11&)
 {
-  RGBAPixel* end = image.pixels + (image.height * image.width);
-  for(RGBAPixel* row = image.pixels; row != end; row += image.width)
-  {
-    for(RGBAPixel* pixel = row + image.width; pixel != row;)
-    {
-      decode(istream, *--pixel);
-    }
-  }
+  return targa_row(image, n, Flip01());
 }
 
-inline void istream_read_gray(stream::PointerInputStream& istream, RGBAPixel& pixel)
-{
-  istream.read(&pixel.blue, 1);
-  pixel.red = pixel.green = pixel.blue;
-  pixel.alpha = 0xff;
-}
+// Rows are always decoded left-to-right, horizontally flipped images
+// get their rows reversed afterwards.
+inline void targa_finish_row(RGBAPixel*, std::size_t, const Flip00&) {}
+inline void targa_finish_row(RGBAPixel*, std::size_t, const Flip01&) {}
 
-inline void istream_read_rgb(stream::PointerInputStream& istream, RGBAPixel& pixel)
+inline void targa_finish_row(RGBAPixel* row, std::size_t width, const Flip10&)
 {
-  istream.read(&pixel.blue, 1);
-  istream.read(&pixel.green, 1);
-  istream.read(&pixel.red, 1);
-  pixel.alpha = 0xff;
+  std::reverse(row, row + width);
 }
 
-inline void istream_read_rgba(stream::PointerInputStream& istream, RGBAPixel& pixel)
+inline void targa_finish_row(RGBAPixel* row, std::size_t width, const Flip11&)
 {
-  istream.read(&pixel.blue, 1);
-  istream.read(&pixel.green, 1);
-  istream.read(&pixel.red, 1);
-  istream.read(&pixel.alpha, 1);
+  std::reverse(row, row + width);
 }
 
-class TargaDecodeGrayPixel
+// Decodes the image row by row, the RowDecoder is asked to deliver
+// a whole row of pixels per call. Returns false on premature end of file.
+template<typename RowDecoder, typename Flip>
+bool image_decode(stream::ChunkedInputStream& istream, RowDecoder& decode, RGBAImage& image, const Flip& flip)
 {
-public:
-  void operator()(stream::PointerInputStream& istream, RGBAPixel& pixel)
+  for (std::size_t n = 0; n < image.height; ++n)
   {
-    istream_read_gray(istream, pixel);
+    RGBAPixel* row = targa_row(image, n, flip);
+
+    if (!decode(istream, row, image.width))
+    {
+      return false;
+    }
+
+    targa_finish_row(row, image.width, flip);
   }
-};
 
-template<typename Flip>
-void targa_decode_grayscale(stream::PointerInputStream& istream, RGBAImage& image, const Flip& flip)
-{
-  TargaDecodeGrayPixel decode;
-  image_decode(istream, decode, image, flip);
+  return true;
 }
 
-class TargaDecodeRGBPixel
+// The pixel formats convert a whole run of source pixels at once.
+// These are plain loops without any branches or calls, which allows
+// the compiler to vectorise the swizzling.
+class TargaPixelGray
 {
 public:
-  void operator()(stream::PointerInputStream& istream, RGBAPixel& pixel)
+  static const std::size_t SIZE = 1;
+
+  static void convert(const byte* source, RGBAPixel* pixels, std::size_t count)
   {
-    istream_read_rgb(istream, pixel);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      pixels[i].red = source[i];
+      pixels[i].green = source[i];
+      pixels[i].blue = source[i];
+      pixels[i].alpha = 0xff;
+    }
   }
 };
 
-template<typename Flip>
-void targa_decode_rgb(stream::PointerInputStream& istream, RGBAImage& image, const Flip& flip)
+class TargaPixelBGR
 {
-  TargaDecodeRGBPixel decode;
-  image_decode(istream, decode, image, flip);
-}
+public:
+  static const std::size_t SIZE = 3;
 
-class TargaDecodeRGBAPixel
+  static void convert(const byte* source, RGBAPixel* pixels, std::size_t count)
+  {
+    for (std::size_t i = 0; i < count; ++i, source += SIZE)
+    {
+      pixels[i].red = source[2];
+      pixels[i].green = source[1];
+      pixels[i].blue = source[0];
+      pixels[i].alpha = 0xff;
+    }
+  }
+};
+
+class TargaPixelBGRA
 {
 public:
-  void operator()(stream::PointerInputStream& istream, RGBAPixel& pixel)
+  static const std::size_t SIZE = 4;
+
+  static void convert(const byte* source, RGBAPixel* pixels, std::size_t count)
   {
-    istream_read_rgba(istream, pixel);
+    for (std::size_t i = 0; i < count; ++i, source += SIZE)
+    {
+      pixels[i].red = source[2];
+      pixels[i].green = source[1];
+      pixels[i].blue = source[0];
+      pixels[i].alpha = source[3];
+    }
   }
 };
 
-template<typename Flip>
-void targa_decode_rgba(stream::PointerInputStream& istream, RGBAImage& image, const Flip& flip)
+// Uncompressed data: the source row is taken from the input chunk as a whole
+template<typename PixelFormat>
+class TargaDecodeRaw
 {
-  TargaDecodeRGBAPixel decode;
-  image_decode(istream, decode, image, flip);
-}
+public:
+  bool operator()(stream::ChunkedInputStream& istream, RGBAPixel* pixels, std::size_t count)
+  {
+    const byte* source = istream.acquire(count * PixelFormat::SIZE);
 
-typedef byte TargaPacket;
-typedef byte TargaPacketSize;
+    if (source == nullptr)
+    {
+      return false;
+    }
 
-inline void targa_packet_read_istream(TargaPacket& packet, stream::PointerInputStream& istream)
-{
-  istream.read(&packet, 1);
-}
+    PixelFormat::convert(source, pixels, count);
+    return true;
+  }
+};
+
+typedef byte TargaPacket;
 
 inline bool targa_packet_is_rle(const TargaPacket& packet)
 {
   return (packet & 0x80) != 0;
 }
 
-inline TargaPacketSize targa_packet_size(const TargaPacket& packet)
+inline std::size_t targa_packet_size(const TargaPacket& packet)
 {
   return 1 + (packet & 0x7f);
 }
 
-
-class TargaDecodeRGBPixelRLE
+// RLE-compressed data: run-length packets are expanded in bulk, raw packets
+// are converted like uncompressed rows. Packets may span across rows, so the
+// state of the current packet is kept between calls.
+template<typename PixelFormat>
+class TargaDecodeRLE
 {
-  TargaPacketSize m_packetSize;
+  std::size_t m_packetSize;
+  bool m_isRunLength;
   RGBAPixel m_pixel;
-  TargaPacket m_packet;
 public:
-  TargaDecodeRGBPixelRLE() : m_packetSize(0)
+  TargaDecodeRLE() :
+    m_packetSize(0),
+    m_isRunLength(false)
   {
   }
-  void operator()(stream::PointerInputStream& istream, RGBAPixel& pixel)
+
+  bool operator()(stream::ChunkedInputStream& istream, RGBAPixel* pixels, std::size_t count)
   {
-    if(m_packetSize == 0)
+    while (count > 0)
     {
-      targa_packet_read_istream(m_packet, istream);
-      m_packetSize = targa_packet_size(m_packet);
+      if (m_packetSize == 0 && !readPacketHeader(istream))
+      {
+        return false;
+      }
+
+      std::size_t runSize = std::min(m_packetSize, count);
 
-      if(targa_packet_is_rle(m_packet))
+      if (m_isRunLength)
       {
-        istream_read_rgb(istream, m_pixel);
+        std::fill(pixels, pixels + runSize, m_pixel);
       }
-    }
+      else
+      {
+        const byte* source = istream.acquire(runSize * PixelFormat::SIZE);
 
-    if(targa_packet_is_rle(m_packet))
-    {
-      pixel = m_pixel;
-    }
-    else
-    {
-      istream_read_rgb(istream, pixel);
-    }
+        if (source == nullptr)
+        {
+          return false;
+        }
 
-    --m_packetSize;
-  }
-};
+        PixelFormat::convert(source, pixels, runSize);
+      }
 
-template<typename Flip>
-void targa_decode_rle_rgb(stream::PointerInputStream& istream, RGBAImage& image, const Flip& flip)
-{
-	TargaDecodeRGBPixelRLE decode;
-  image_decode(istream, decode, image, flip);
-}
+      pixels += runSize;
+      count -= runSize;
+      m_packetSize -= runSize;
+    }
 
-class TargaDecodeRGBAPixelRLE
-{
-  TargaPacketSize m_packetSize;
-  RGBAPixel m_pixel;
-  TargaPacket m_packet;
-public:
-  TargaDecodeRGBAPixelRLE() : m_packetSize(0)
-  {
+    return true;
   }
-  void operator()(stream::PointerInputStream& istream, RGBAPixel& pixel)
+
+private:
+  bool readPacketHeader(stream::ChunkedInputStream& istream)
   {
-    if(m_packetSize == 0)
+    const byte* packet = istream.acquire(1);
+
+    if (packet == nullptr)
     {
-      targa_packet_read_istream(m_packet, istream);
-      m_packetSize = targa_packet_size(m_packet);
+      return false;
+    }
+
+    m_isRunLength = targa_packet_is_rle(*packet);
+    m_packetSize = targa_packet_size(*packet);
+
+    if (m_isRunLength)
+    {
+      const byte* source = istream.acquire(PixelFormat::SIZE);
 
-      if(targa_packet_is_rle(m_packet))
+      if (source == nullptr)
       {
-        istream_read_rgba(istream, m_pixel);
+        return false;
       }
-    }
 
-    if(targa_packet_is_rle(m_packet))
-    {
-      pixel = m_pixel;
-    }
-    else
-    {
-      istream_read_rgba(istream, pixel);
+      PixelFormat::convert(source, &m_pixel, 1);
     }
 
-    --m_packetSize;
+    return true;
   }
 };
 
-template<typename Flip>
-void targa_decode_rle_rgba(stream::PointerInputStream& istream, RGBAImage& image, const Flip& flip)
+template<typename RowDecoder, typename Flip>
+bool targa_decode(stream::ChunkedInputStream& istream, RGBAImage& image, const Flip& flip)
 {
-	TargaDecodeRGBAPixelRLE decode;
-  image_decode(istream, decode, image, flip);
+  RowDecoder decode;
+  return image_decode(istream, decode, image, flip);
 }
 
 struct TargaHeader
@@ -278,26 +280,40 @@ struct TargaHeader
   unsigned char pixel_size, attributes;
 };
 
-inline void targa_header_read_istream(TargaHeader& targa_header, stream::PointerInputStream& istream)
+// Size of the TGA file header, without the image ID following it
+const std::size_t TARGA_HEADER_SIZE = 18;
+
+inline unsigned short targa_read_uint16(const byte* source)
 {
-	static_assert(sizeof(unsigned short) == sizeof(uint16_t), "TGA Loader Code relies on unsigned short being 16 bits wide!");
-
-	targa_header.id_length = stream::readByte(istream);
-	targa_header.colormap_type = stream::readByte(istream);
-	targa_header.image_type = stream::readByte(istream);
-
-	targa_header.colormap_index = stream::readLittleEndian<uint16_t>(istream);
-	targa_header.colormap_length = stream::readLittleEndian<uint16_t>(istream);
-	targa_header.colormap_size = stream::readByte(istream);
-	targa_header.x_origin = stream::readLittleEndian<uint16_t>(istream);
-	targa_header.y_origin = stream::readLittleEndian<uint16_t>(istream);
-	targa_header.width = stream::readLittleEndian<uint16_t>(istream);
-	targa_header.height = stream::readLittleEndian<uint16_t>(istream);
-	targa_header.pixel_size = stream::readByte(istream);
-	targa_header.attributes = stream::readByte(istream);
-
-  if (targa_header.id_length != 0)
-    istream.seek(targa_header.id_length);	// skip TARGA image comment
+  return static_cast<unsigned short>(source[0] | (source[1] << 8));
+}
+
+inline bool targa_header_read_istream(TargaHeader& targa_header, stream::ChunkedInputStream& istream)
+{
+  // Acquire the header as a whole, this fails on a truncated file
+  const byte* header = istream.acquire(TARGA_HEADER_SIZE);
+
+  if (header == nullptr)
+  {
+    return false;
+  }
+
+  targa_header.id_length = header[0];
+  targa_header.colormap_type = header[1];
+  targa_header.image_type = header[2];
+
+  targa_header.colormap_index = targa_read_uint16(header + 3);
+  targa_header.colormap_length = targa_read_uint16(header + 5);
+  targa_header.colormap_size = header[7];
+  targa_header.x_origin = targa_read_uint16(header + 8);
+  targa_header.y_origin = targa_read_uint16(header + 10);
+  targa_header.width = targa_read_uint16(header + 12);
+  targa_header.height = targa_read_uint16(header + 14);
+  targa_header.pixel_size = header[16];
+  targa_header.attributes = header[17];
+
+  // skip TARGA image comment
+  return istream.seek(targa_header.id_length);
 }
 
 template<typename Type>
@@ -321,22 +337,24 @@ public:
 };
 
 template<typename Flip>
-RGBAImagePtr Targa_decodeImageData(const TargaHeader& targa_header, stream::PointerInputStream& istream, const Flip& flip)
+RGBAImagePtr Targa_decodeImageData(const TargaHeader& targa_header, stream::ChunkedInputStream& istream, const Flip& flip)
 {
   RGBAImagePtr image (new RGBAImage(targa_header.width, targa_header.height));
 
+  bool success = false;
+
   if (targa_header.image_type == 2 || targa_header.image_type == 3)
   {
     switch (targa_header.pixel_size)
     {
     case 8:
-      targa_decode_grayscale(istream, *image, flip);
+      success = targa_decode<TargaDecodeRaw<TargaPixelGray> >(istream, *image, flip);
       break;
     case 24:
-      targa_decode_rgb(istream, *image, flip);
+      success = targa_decode<TargaDecodeRaw<TargaPixelBGR> >(istream, *image, flip);
       break;
     case 32:
-      targa_decode_rgba(istream, *image, flip);
+      success = targa_decode<TargaDecodeRaw<TargaPixelBGRA> >(istream, *image, flip);
       break;
     default:
       rError() << "LoadTGA: illegal pixel_size '" << targa_header.pixel_size << "'\n";
@@ -348,10 +366,10 @@ RGBAImagePtr Targa_decodeImageData(const TargaHeader& targa_header, stream::Poin
     switch (targa_header.pixel_size)
     {
     case 24:
-      targa_decode_rle_rgb(istream, *image, flip);
+      success = targa_decode<TargaDecodeRLE<TargaPixelBGR> >(istream, *image, flip);
       break;
     case 32:
-      targa_decode_rle_rgba(istream, *image, flip);
+      success = targa_decode<TargaDecodeRLE<TargaPixelBGRA> >(istream, *image, flip);
       break;
     default:
       rError() << "LoadTGA: illegal pixel_size '" << targa_header.pixel_size << "'\n";
@@ -359,18 +377,29 @@ RGBAImagePtr Targa_decodeImageData(const TargaHeader& targa_header, stream::Poin
     }
   }
 
+  if (!success)
+  {
+    rError() << "LoadTGA: unexpected end of file\n";
+    return RGBAImagePtr();
+  }
+
   return image;
 }
 
 const unsigned int TGA_FLIP_HORIZONTAL = 0x10;
 const unsigned int TGA_FLIP_VERTICAL = 0x20;
 
-RGBAImagePtr LoadTGABuff(const byte* buffer)
+RGBAImagePtr LoadTGAStream(InputStream& inputStream)
 {
-	stream::PointerInputStream istream(buffer);
+  // Read the file in chunks, no need to buffer the whole file
+  stream::ChunkedInputStream istream(inputStream);
   TargaHeader targa_header;
 
-  targa_header_read_istream(targa_header, istream);
+  if (!targa_header_read_istream(targa_header, istream))
+  {
+    rError() << "LoadTGA: unexpected end of file\n";
+    return RGBAImagePtr();
+  }
 
   if (targa_header.image_type != 2 && targa_header.image_type != 10 && targa_header.image_type != 3)
   {
@@ -421,8 +450,7 @@ RGBAImagePtr LoadTGABuff(const byte* buffer)
 
 ImagePtr TGALoader::load(ArchiveFile& file) const
 {
-    archive::ScopedArchiveBuffer buffer(file);
-    return LoadTGABuff(buffer.buffer);
+    return LoadTGAStream(file.getInputStream());
 }
 
 ImageTypeLoader::Extensions TGALoader::getExtensions() const
@@ -0,0 +1,263 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE tgaTest
+#include <boost/test/unit_test.hpp>
+
+#include "TGALoader.h"
+#include "RGBAImage.h"
+#include "iarchive.h"
+#include "idatastream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Feeds the data to the loader in small blocks, like the VFS streams do
+    class MemoryInputStream :
+        public InputStream
+    {
+        const std::vector<byte_type>& _data;
+        std::size_t _pos;
+
+    public:
+        MemoryInputStream(const std::vector<byte_type>& data) :
+            _data(data),
+            _pos(0)
+        {}
+
+        size_type read(byte_type* buffer, size_type length) override
+        {
+            std::size_t count = std::min(std::min(length, std::size_t(16384)), _data.size() - _pos);
+            std::memcpy(buffer, _data.data() + _pos, count);
+            _pos += count;
+
+            return count;
+        }
+    };
+
+    class MemoryArchiveFile :
+        public ArchiveFile
+    {
+        std::string _name;
+        const std::vector<InputStream::byte_type>& _data;
+        MemoryInputStream _stream;
+
+    public:
+        MemoryArchiveFile(const std::string& name, const std::vector<InputStream::byte_type>& data) :
+            _name(name),
+            _data(data),
+            _stream(data)
+        {}
+
+        std::size_t size() const override { return _data.size(); }
+        const std::string& getName() const override { return _name; }
+        InputStream& getInputStream() override { return _stream; }
+    };
+
+    typedef std::vector<InputStream::byte_type> Buffer;
+
+    // Pixel pattern containing horizontal runs of equal colour, so that
+    // the RLE encoder produces both run-length and raw packets
+    RGBAPixel getPixel(std::size_t x, std::size_t y)
+    {
+        std::size_t run = (x / 8) % 2 == 0 ? x / 8 : x;
+
+        RGBAPixel pixel;
+        pixel.red = static_cast<unsigned char>(run * 7 + y);
+        pixel.green = static_cast<unsigned char>(run * 13 + y * 3);
+        pixel.blue = static_cast<unsigned char>(run * 29 + y * 5);
+        pixel.alpha = static_cast<unsigned char>(run + y * 11);
+
+        return pixel;
+    }
+
+    bool samePixel(const RGBAPixel& a, const RGBAPixel& b)
+    {
+        return a.red == b.red && a.green == b.green && a.blue == b.blue && a.alpha == b.alpha;
+    }
+
+    void writeHeader(Buffer& buf, unsigned char type, std::size_t size)
+    {
+        unsigned char header[18] = { 0 };
+        header[2] = type;
+        header[12] = size & 0xff;
+        header[13] = (size >> 8) & 0xff;
+        header[14] = size & 0xff;
+        header[15] = (size >> 8) & 0xff;
+        header[16] = 32;
+        header[17] = 0x20; // top-down
+
+        buf.insert(buf.end(), header, header + 18);
+    }
+
+    void writePixel(Buffer& buf, const RGBAPixel& pixel)
+    {
+        buf.push_back(pixel.blue);
+        buf.push_back(pixel.green);
+        buf.push_back(pixel.red);
+        buf.push_back(pixel.alpha);
+    }
+
+    Buffer createUncompressed(std::size_t size)
+    {
+        Buffer buf;
+        writeHeader(buf, 2, size);
+
+        for (std::size_t y = 0; y < size; ++y)
+        {
+            for (std::size_t x = 0; x < size; ++x)
+            {
+                writePixel(buf, getPixel(x, y));
+            }
+        }
+
+        return buf;
+    }
+
+    Buffer createRLE(std::size_t size)
+    {
+        Buffer buf;
+        writeHeader(buf, 10, size);
+
+        for (std::size_t y = 0; y < size; ++y)
+        {
+            std::size_t x = 0;
+
+            while (x < size)
+            {
+                // Count the pixels equal to the current one
+                std::size_t count = 1;
+
+                while (x + count < size && count < 128 &&
+                    samePixel(getPixel(x, y), getPixel(x + count, y)))
+                {
+                    ++count;
+                }
+
+                if (count > 1)
+                {
+                    buf.push_back(static_cast<unsigned char>(0x80 | (count - 1)));
+                    writePixel(buf, getPixel(x, y));
+                    x += count;
+                    continue;
+                }
+
+                // Raw packet up to the next run
+                count = 0;
+
+                while (x + count < size && count < 128 &&
+                    (x + count + 1 == size ||
+                     !samePixel(getPixel(x + count, y), getPixel(x + count + 1, y))))
+                {
+                    ++count;
+                }
+
+                count = std::max(count, std::size_t(1));
+
+                buf.push_back(static_cast<unsigned char>(count - 1));
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    writePixel(buf, getPixel(x + i, y));
+                }
+
+                x += count;
+            }
+        }
+
+        return buf;
+    }
+
+    // Larger than one read block of the memory stream, so that rows and
+    // RLE packets are spanning the chunk boundaries
+    const std::size_t SIZE = 300;
+
+    ImagePtr load(const Buffer& data)
+    {
+        image::TGALoader loader;
+        MemoryArchiveFile file("test.tga", data);
+
+        return loader.load(file);
+    }
+
+    void checkPixels(const ImagePtr& image, std::size_t size)
+    {
+        RGBAImagePtr rgba = std::dynamic_pointer_cast<RGBAImage>(image);
+
+        BOOST_REQUIRE(rgba);
+        BOOST_REQUIRE_EQUAL(rgba->width, size);
+        BOOST_REQUIRE_EQUAL(rgba->height, size);
+
+        for (std::size_t y = 0; y < size; ++y)
+        {
+            for (std::size_t x = 0; x < size; ++x)
+            {
+                if (!samePixel(rgba->pixels[y * size + x], getPixel(x, y)))
+                {
+                    BOOST_ERROR("Pixel mismatch at " << x << "," << y);
+                    return;
+                }
+            }
+        }
+    }
+
+    Buffer truncate(Buffer data, std::size_t size)
+    {
+        data.resize(size);
+        return data;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(decodeUncompressed)
+{
+    checkPixels(load(createUncompressed(SIZE)), SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(decodeRLE)
+{
+    checkPixels(load(createRLE(SIZE)), SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(skipImageComment)
+{
+    Buffer data = createRLE(SIZE);
+
+    // Insert an image ID between the header and the pixel data
+    const char comment[] = "comment";
+    data[0] = sizeof(comment);
+    data.insert(data.begin() + 18, comment, comment + sizeof(comment));
+
+    checkPixels(load(data), SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(truncatedHeader)
+{
+    Buffer data = createUncompressed(SIZE);
+
+    BOOST_CHECK(!load(truncate(data, 0)));
+    BOOST_CHECK(!load(truncate(data, 11)));
+    BOOST_CHECK(!load(truncate(data, 17)));
+
+    // The header announces an image ID which is missing
+    Buffer comment = truncate(data, 18);
+    comment[0] = 20;
+
+    BOOST_CHECK(!load(comment));
+}
+
+BOOST_AUTO_TEST_CASE(truncatedPixelData)
+{
+    Buffer uncompressed = createUncompressed(SIZE);
+
+    BOOST_CHECK(!load(truncate(uncompressed, 18)));
+    BOOST_CHECK(!load(truncate(uncompressed, uncompressed.size() / 2)));
+    BOOST_CHECK(!load(truncate(uncompressed, uncompressed.size() - 1)));
+
+    Buffer rle = createRLE(SIZE);
+
+    BOOST_CHECK(!load(truncate(rle, 18)));
+    BOOST_CHECK(!load(truncate(rle, rle.size() / 2)));
+    BOOST_CHECK(!load(truncate(rle, rle.size() - 1)));
+}
@@ -1,4 +1,5 @@
 #include "MD5AnimationCache.h"
+#include "MD5PoseCache.h"
 
 #include "iarchive.h"
 #include "ifilesystem.h"
@@ -64,6 +65,7 @@ void MD5AnimationCache::initialiseModule(const ApplicationContext& ctx)
 
 void MD5AnimationCache::shutdownModule()
 {
+	GlobalPoseCache().clear();
 	_animations.clear();
 }
 
@@ -8,6 +8,7 @@
 #include "math/Quaternion.h"
 #include "math/Ray.h"
 #include "MD5DataStructures.h"
+#include "MD5PoseCache.h"
 
 namespace md5 {
 
@@ -381,12 +382,55 @@ void MD5Model::updateAnim(std::size_t time)
 {
 	if (!_anim) return; // nothing to do
 
-	// Update our joint hierarchy first
-	_skeleton.update(_anim, time);
+	// Pose the joint hierarchy at the start of the tick, that's the time the
+	// cached poses are showing
+	std::size_t tick = MD5PoseCache::getTick(*_anim, time);
+	_skeleton.update(_anim, tick * MD5PoseCache::TICK_MSEC);
 
+	MD5PoseCache& poseCache = GlobalPoseCache();
+
+	// Take the poses shown before from the cache, skin the other surfaces
+	std::vector<MD5SkinningKernel::Job> jobs;
+	std::vector<MD5Surface*> skinnedSurfaces;
+
+	for (SurfaceList::iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
+	{
+		const MD5Surface::Vertices* pose = poseCache.find(i->surface->getMesh(), _anim, tick);
+
+		if (pose != nullptr)
+		{
+			i->surface->setVertices(*pose);
+		}
+		else
+		{
+			jobs.push_back(i->surface->getSkinningJob());
+			skinnedSurfaces.push_back(i->surface.get());
+		}
+	}
+
+	if (!jobs.empty())
+	{
+		// All surfaces are sharing the joint transforms
+		MD5SkinningKernel::JointTransforms joints(_skeleton.size());
+
+		for (std::size_t i = 0; i < joints.size(); ++i)
+		{
+			const IMD5Anim::Key& key = _skeleton.getKey(i);
+			joints[i] = MD5SkinningKernel::getJointTransform(key.orientation, key.origin);
+		}
+
+		MD5SkinningKernel::skinInParallel(jobs, joints);
+
+		for (MD5Surface* surface : skinnedSurfaces)
+		{
+			poseCache.insert(surface->getMesh(), _anim, tick, surface->getVertices());
+		}
+	}
+
+	// The display lists are built by the main thread
 	for (SurfaceList::iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
 	{
-		i->surface->updateToSkeleton(_skeleton);
+		i->surface->updateGeometry();
 	}
 }
 
@@ -0,0 +1,109 @@
+#include "MD5PoseCache.h"
+
+#include <functional>
+
+namespace md5
+{
+
+namespace
+{
+	// The number of skinned vertices kept by the pose cache (~70 MB)
+	const std::size_t MAX_CACHED_POSE_VERTICES = 1 << 19;
+}
+
+std::size_t MD5PoseCache::KeyHash::operator()(const Key& key) const
+{
+	std::size_t seed = std::hash<const void*>()(key.mesh);
+
+	seed ^= std::hash<const void*>()(key.anim) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	seed ^= std::hash<std::size_t>()(key.tick) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+
+	return seed;
+}
+
+MD5PoseCache::MD5PoseCache(std::size_t maxVertices) :
+	_numVertices(0),
+	_maxVertices(maxVertices)
+{}
+
+std::size_t MD5PoseCache::getTick(const IMD5Anim& anim, std::size_t time)
+{
+	std::size_t length = anim.getFrameRate() > 0 ?
+		anim.getNumFrames() * 1000 / anim.getFrameRate() : 0;
+
+	// Animations without a length are not looped
+	return (length > 0 ? time % length : time) / TICK_MSEC;
+}
+
+const MD5SkinningKernel::Vertices* MD5PoseCache::find(const MD5MeshPtr& mesh,
+	const IMD5AnimPtr& anim, std::size_t tick)
+{
+	Key key = { mesh.get(), anim.get(), tick };
+
+	auto found = _index.find(key);
+
+	if (found == _index.end())
+	{
+		return nullptr;
+	}
+
+	// Move the pose to the front
+	_poses.splice(_poses.begin(), _poses, found->second);
+
+	return &found->second->vertices;
+}
+
+void MD5PoseCache::insert(const MD5MeshPtr& mesh, const IMD5AnimPtr& anim, std::size_t tick,
+	const MD5SkinningKernel::Vertices& vertices)
+{
+	Key key = { mesh.get(), anim.get(), tick };
+
+	if (vertices.size() > _maxVertices || _index.find(key) != _index.end())
+	{
+		return;
+	}
+
+	// Discard the least recently used poses of other animations
+	while (_numVertices + vertices.size() > _maxVertices && _poses.back().key.anim != key.anim)
+	{
+		_numVertices -= _poses.back().vertices.size();
+		_index.erase(_poses.back().key);
+		_poses.pop_back();
+	}
+
+	if (_numVertices + vertices.size() > _maxVertices)
+	{
+		return;
+	}
+
+	_poses.push_front(Pose());
+
+	Pose& pose = _poses.front();
+	pose.key = key;
+	pose.mesh = mesh;
+	pose.anim = anim;
+	pose.vertices = vertices;
+
+	_index[key] = _poses.begin();
+	_numVertices += vertices.size();
+}
+
+std::size_t MD5PoseCache::getNumVertices() const
+{
+	return _numVertices;
+}
+
+void MD5PoseCache::clear()
+{
+	_index.clear();
+	_poses.clear();
+	_numVertices = 0;
+}
+
+MD5PoseCache& GlobalPoseCache()
+{
+	static MD5PoseCache _poses(MAX_CACHED_POSE_VERTICES);
+	return _poses;
+}
+
+} // namespace
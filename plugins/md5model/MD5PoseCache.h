@@ -0,0 +1,96 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "imd5anim.h"
+#include "MD5SkinningKernel.h"
+
+namespace md5
+{
+
+/**
+ * Keeps the skinned vertices of MD5 meshes, one set per mesh and
+ * animation tick. The animation time is taken modulo the length of the
+ * animation and quantised to ticks of TICK_MSEC, the step the preview advances
+ * its time by. Looping through an animation or scrubbing back and forth in the
+ * preview therefore finds the poses it has been showing before, the skeleton
+ * has to be posed at the time of the tick for this to be correct.
+ *
+ * The number of cached vertices is limited, the least recently used poses
+ * are discarded first. Poses of the animation being inserted for are never
+ * discarded to make room though, an animation not fitting into the cache
+ * would otherwise replace all of its poses before any of them is re-used.
+ */
+class MD5PoseCache
+{
+	struct Key
+	{
+		const MD5Mesh* mesh;
+		const IMD5Anim* anim;
+		std::size_t tick;
+
+		bool operator==(const Key& other) const
+		{
+			return mesh == other.mesh && anim == other.anim && tick == other.tick;
+		}
+	};
+
+	struct KeyHash
+	{
+		std::size_t operator()(const Key& key) const;
+	};
+
+	struct Pose
+	{
+		Key key;
+
+		// Keep the mesh and the anim alive, their addresses are part of the key
+		MD5MeshPtr mesh;
+		IMD5AnimPtr anim;
+
+		MD5SkinningKernel::Vertices vertices;
+	};
+
+	// Most recently used poses first
+	typedef std::list<Pose> Poses;
+	Poses _poses;
+
+	std::unordered_map<Key, Poses::iterator, KeyHash> _index;
+
+	std::size_t _numVertices;
+	std::size_t _maxVertices;
+
+public:
+	// The resolution of the cached animation time
+	static const std::size_t TICK_MSEC = 16;
+
+	MD5PoseCache(std::size_t maxVertices);
+
+	/**
+	 * Returns the tick of the given animation time, counting from the start
+	 * of the current loop. The time of the tick is getTick() * TICK_MSEC.
+	 */
+	static std::size_t getTick(const IMD5Anim& anim, std::size_t time);
+
+	/**
+	 * Returns the cached vertices of the given mesh at the given animation
+	 * tick, or NULL if this pose is not in the cache.
+	 */
+	const MD5SkinningKernel::Vertices* find(const MD5MeshPtr& mesh, const IMD5AnimPtr& anim,
+		std::size_t tick);
+
+	// Stores a copy of the given vertices for later lookups
+	void insert(const MD5MeshPtr& mesh, const IMD5AnimPtr& anim, std::size_t tick,
+		const MD5SkinningKernel::Vertices& vertices);
+
+	// Returns the number of vertices of all cached poses
+	std::size_t getNumVertices() const;
+
+	void clear();
+};
+
+// The pose cache shared by all MD5 models of this plugin
+MD5PoseCache& GlobalPoseCache();
+
+} // namespace
@@ -0,0 +1,263 @@
+#include "MD5SkinningKernel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MD5_SKINNING_SSE
+#include <emmintrin.h>
+#endif
+
+namespace md5
+{
+
+namespace
+{
+	// Models with fewer weights are skinned by the calling thread,
+	// it's not worth starting threads for a few hundred vertices
+	const std::size_t PARALLEL_THRESHOLD = 8192;
+}
+
+MD5SkinningKernel::MD5SkinningKernel(const MD5Mesh& mesh)
+{
+	_weightCounts.reserve(mesh.vertices.size());
+	_texcoords.reserve(mesh.vertices.size());
+
+	for (const MD5Vert& vert : mesh.vertices)
+	{
+		for (std::size_t k = 0; k < vert.weight_count; ++k)
+		{
+			const MD5Weight& weight = mesh.weights[vert.weight_index + k];
+
+			_weights.push_back(weight.v.x() * weight.t);
+			_weights.push_back(weight.v.y() * weight.t);
+			_weights.push_back(weight.v.z() * weight.t);
+			_weights.push_back(weight.t);
+
+			_weightJoints.push_back(weight.joint);
+		}
+
+		_weightCounts.push_back(vert.weight_count);
+		_texcoords.push_back(TexCoord2f(vert.u, vert.v));
+	}
+
+	_indices.reserve(mesh.triangles.size() * 3);
+	_tangentFactors.reserve(mesh.triangles.size() * 4);
+
+	for (const MD5Tri& tri : mesh.triangles)
+	{
+		_indices.push_back(tri.a);
+		_indices.push_back(tri.b);
+		_indices.push_back(tri.c);
+
+		// The tangents are the solutions of ArbitraryMeshTriangle_calcTangents,
+		// whose denominator only depends on the texture coordinates
+		TexCoord2f ab = _texcoords[tri.b] - _texcoords[tri.a];
+		TexCoord2f ac = _texcoords[tri.c] - _texcoords[tri.a];
+
+		double denominator = ab.x() * ac.y() - ab.y() * ac.x();
+
+		if (std::fabs(denominator) > 0.000001f)
+		{
+			_tangentFactors.push_back(ac.y() / denominator);
+			_tangentFactors.push_back(ab.y() / denominator);
+			_tangentFactors.push_back(ab.x() / denominator);
+			_tangentFactors.push_back(ac.x() / denominator);
+		}
+		else
+		{
+			_tangentFactors.insert(_tangentFactors.end(), 4, 0.0);
+		}
+	}
+}
+
+std::size_t MD5SkinningKernel::getNumVertices() const
+{
+	return _weightCounts.size();
+}
+
+std::size_t MD5SkinningKernel::getNumWeights() const
+{
+	return _weightJoints.size();
+}
+
+Matrix4 MD5SkinningKernel::getJointTransform(const Quaternion& orientation, const Vector3& origin)
+{
+	// The columns are the rotated axes, like Quaternion::transformPoint rotates them
+	Vector3 x = orientation.transformPoint(Vector3(1, 0, 0));
+	Vector3 y = orientation.transformPoint(Vector3(0, 1, 0));
+	Vector3 z = orientation.transformPoint(Vector3(0, 0, 1));
+
+	return Matrix4::byColumns(
+		x.x(), x.y(), x.z(), 0,
+		y.x(), y.y(), y.z(), 0,
+		z.x(), z.y(), z.z(), 0,
+		origin.x(), origin.y(), origin.z(), 1
+	);
+}
+
+void MD5SkinningKernel::skin(const JointTransforms& joints, Vertices& vertices) const
+{
+	if (vertices.size() != _weightCounts.size())
+	{
+		vertices.resize(_weightCounts.size());
+	}
+
+	skinPositions(joints, vertices);
+	buildNormalsAndTangents(vertices);
+}
+
+void MD5SkinningKernel::skinPositions(const JointTransforms& joints, Vertices& vertices) const
+{
+	const double* weight = _weights.data();
+	const std::size_t* joint = _weightJoints.data();
+
+	for (std::size_t v = 0; v < _weightCounts.size(); ++v)
+	{
+		ArbitraryMeshVertex& vertex = vertices[v];
+
+#ifdef MD5_SKINNING_SSE
+		// The x,y and z,w components of the sum of the transformed weights
+		__m128d xy = _mm_setzero_pd();
+		__m128d zw = _mm_setzero_pd();
+
+		for (std::size_t k = 0; k < _weightCounts[v]; ++k, weight += 4, ++joint)
+		{
+			// The matrix columns are stored one after the other
+			const double* m = joints[*joint];
+
+			for (std::size_t c = 0; c < 4; ++c)
+			{
+				__m128d component = _mm_set1_pd(weight[c]);
+
+				xy = _mm_add_pd(xy, _mm_mul_pd(_mm_loadu_pd(m + c * 4), component));
+				zw = _mm_add_pd(zw, _mm_mul_pd(_mm_loadu_pd(m + c * 4 + 2), component));
+			}
+		}
+
+		double xyz[2];
+		_mm_storeu_pd(xyz, xy);
+
+		vertex.vertex = Vertex3f(xyz[0], xyz[1], _mm_cvtsd_f64(zw));
+#else
+		double x = 0, y = 0, z = 0;
+
+		for (std::size_t k = 0; k < _weightCounts[v]; ++k, weight += 4, ++joint)
+		{
+			const double* m = joints[*joint];
+
+			// Same summation order as the SSE2 path
+			for (std::size_t c = 0; c < 4; ++c)
+			{
+				x += m[c * 4] * weight[c];
+				y += m[c * 4 + 1] * weight[c];
+				z += m[c * 4 + 2] * weight[c];
+			}
+		}
+
+		vertex.vertex = Vertex3f(x, y, z);
+#endif
+
+		vertex.texcoord = _texcoords[v];
+		vertex.normal = Normal3f(0, 0, 0);
+		vertex.tangent = Normal3f(0, 0, 0);
+		vertex.bitangent = Normal3f(0, 0, 0);
+	}
+}
+
+void MD5SkinningKernel::buildNormalsAndTangents(Vertices& vertices) const
+{
+	const double* factors = _tangentFactors.data();
+
+	for (std::size_t i = 0; i + 2 < _indices.size(); i += 3, factors += 4)
+	{
+		ArbitraryMeshVertex& a = vertices[_indices[i]];
+		ArbitraryMeshVertex& b = vertices[_indices[i + 1]];
+		ArbitraryMeshVertex& c = vertices[_indices[i + 2]];
+
+		Vector3 ab = b.vertex - a.vertex;
+		Vector3 ac = c.vertex - a.vertex;
+
+		Vector3 weightedNormal(ac.crossProduct(ab));
+
+		a.normal += weightedNormal;
+		b.normal += weightedNormal;
+		c.normal += weightedNormal;
+
+		Vector3 tangent = ab * factors[0] - ac * factors[1];
+		Vector3 bitangent = ac * factors[2] - ab * factors[3];
+
+		a.tangent += tangent;
+		b.tangent += tangent;
+		c.tangent += tangent;
+
+		a.bitangent += bitangent;
+		b.bitangent += bitangent;
+		c.bitangent += bitangent;
+	}
+
+	for (ArbitraryMeshVertex& vertex : vertices)
+	{
+		vertex.normal = Normal3f(vertex.normal.getNormalised());
+		vertex.tangent.normalise();
+		vertex.bitangent.normalise();
+	}
+}
+
+void MD5SkinningKernel::skinInParallel(const std::vector<Job>& jobs, const JointTransforms& joints,
+	std::size_t numThreads)
+{
+	std::size_t numWeights = 0;
+
+	for (const Job& job : jobs)
+	{
+		numWeights += job.kernel->getNumWeights();
+	}
+
+	if (numThreads == 0)
+	{
+		numThreads = std::thread::hardware_concurrency();
+	}
+
+	numThreads = std::min(numThreads, jobs.size());
+
+	if (numThreads <= 1 || numWeights < PARALLEL_THRESHOLD)
+	{
+		for (const Job& job : jobs)
+		{
+			job.kernel->skin(joints, *job.vertices);
+		}
+
+		return;
+	}
+
+	// Surfaces are large enough to be handed out one by one
+	std::atomic<std::size_t> nextJob(0);
+
+	auto skinJobs = [&]()
+	{
+		for (std::size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+		{
+			jobs[i].kernel->skin(joints, *jobs[i].vertices);
+		}
+	};
+
+	std::vector<std::future<void>> threads;
+
+	for (std::size_t i = 1; i < numThreads; ++i)
+	{
+		threads.push_back(std::async(std::launch::async, skinJobs));
+	}
+
+	skinJobs();
+
+	for (std::future<void>& thread : threads)
+	{
+		thread.get();
+	}
+}
+
+} // namespace
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "math/Matrix4.h"
+#include "render/ArbitraryMeshVertex.h"
+#include "MD5DataStructures.h"
+
+namespace md5
+{
+
+/**
+ * Deforms the vertices of an MD5Mesh to fit a skeleton pose and generates
+ * their normals and tangents.
+ *
+ * The weights of the mesh are rearranged in vertex order on construction,
+ * each weight is stored as homogeneous vector (bias * offset, bias). The
+ * skinned vertex position is the sum of these vectors transformed by the
+ * matrices of their joints, which are calculated once per pose and are
+ * shared by all surfaces of a model. On SSE2 targets the weights are
+ * transformed using packed doubles, a scalar fallback is used elsewhere.
+ */
+class MD5SkinningKernel
+{
+public:
+	typedef std::vector<ArbitraryMeshVertex> Vertices;
+
+	// The rotation and translation of each joint
+	typedef std::vector<Matrix4> JointTransforms;
+
+	// A set of vertices to be skinned by skinInParallel()
+	struct Job
+	{
+		const MD5SkinningKernel* kernel;
+		Vertices* vertices;
+	};
+
+private:
+	// The weight vectors in vertex order, 4 doubles per weight
+	std::vector<double> _weights;
+
+	// The joint index of each weight
+	std::vector<std::size_t> _weightJoints;
+
+	// The number of weights of each vertex
+	std::vector<std::size_t> _weightCounts;
+
+	std::vector<TexCoord2f> _texcoords;
+
+	// Three vertex indices per triangle
+	std::vector<std::size_t> _indices;
+
+	// The tangent and bitangent of each triangle are linear combinations
+	// of its edges, 4 factors per triangle calculated from the texcoords
+	std::vector<double> _tangentFactors;
+
+public:
+	MD5SkinningKernel(const MD5Mesh& mesh);
+
+	std::size_t getNumVertices() const;
+	std::size_t getNumWeights() const;
+
+	// Returns the transform of a joint with the given orientation and position
+	static Matrix4 getJointTransform(const Quaternion& orientation, const Vector3& origin);
+
+	/**
+	 * Calculates the positions, normals and tangents of all vertices.
+	 * This doesn't change any state other than the given vertices, meshes
+	 * can be skinned by several threads at the same time.
+	 */
+	void skin(const JointTransforms& joints, Vertices& vertices) const;
+
+	/**
+	 * Skins the given vertex sets to the same pose. Smaller batches are
+	 * processed by the calling thread, larger ones are distributed over
+	 * the given number of threads (0 = hardware concurrency).
+	 */
+	static void skinInParallel(const std::vector<Job>& jobs, const JointTransforms& joints,
+		std::size_t numThreads = 0);
+
+private:
+	void skinPositions(const JointTransforms& joints, Vertices& vertices) const;
+	void buildNormalsAndTangents(Vertices& vertices) const;
+};
+typedef std::shared_ptr<MD5SkinningKernel> MD5SkinningKernelPtr;
+
+} // namespace
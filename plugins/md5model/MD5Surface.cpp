@@ -18,6 +18,7 @@ inline VertexPointer vertexpointer_arbitrarymeshvertex(const ArbitraryMeshVertex
 MD5Surface::MD5Surface() : 
 	_originalShaderName(""),
 	_mesh(new MD5Mesh),
+	_kernel(new MD5SkinningKernel(*_mesh)),
 	_normalList(0),
 	_lightingList(0)
 {}
@@ -26,6 +27,7 @@ MD5Surface::MD5Surface(const MD5Surface& other) :
 	_aabb_local(other._aabb_local),
 	_originalShaderName(other._originalShaderName),
 	_mesh(other._mesh),
+	_kernel(other._kernel),
 	_normalList(0),
 	_lightingList(0)
 {}
@@ -46,25 +48,6 @@ void MD5Surface::updateGeometry()
 		_aabb_local.includePoint(i->vertex);
 	}
 
-	for (Indices::iterator i = _indices.begin();
-		 i != _indices.end();
-		 i += 3)
-	{
-		ArbitraryMeshVertex& a = _vertices[*(i + 0)];
-		ArbitraryMeshVertex& b = _vertices[*(i + 1)];
-		ArbitraryMeshVertex& c = _vertices[*(i + 2)];
-
-		ArbitraryMeshTriangle_sumTangents(a, b, c);
-	}
-
-	for (Vertices::iterator i = _vertices.begin();
-		 i != _vertices.end();
-		 ++i)
-	{
-		i->tangent.normalise();
-		i->bitangent.normalise();
-	}
-
 	// Build the display lists
 	createDisplayLists();
 }
@@ -268,102 +251,53 @@ const std::string& MD5Surface::getDefaultMaterial() const
 
 void MD5Surface::updateToDefaultPose(const MD5Joints& joints)
 {
-	if (_vertices.size() != _mesh->vertices.size())
-	{
-		_vertices.resize(_mesh->vertices.size());
-	}
+	MD5SkinningKernel::JointTransforms transforms(joints.size());
 
-	for (std::size_t j = 0; j < _mesh->vertices.size(); ++j)
+	for (std::size_t i = 0; i < joints.size(); ++i)
 	{
-		MD5Vert& vert = _mesh->vertices[j];
-
-		Vector3 skinned(0, 0, 0);
-
-		for (std::size_t k = 0; k != vert.weight_count; ++k)
-		{
-			MD5Weight& weight = _mesh->weights[vert.weight_index + k];
-			const MD5Joint& joint = joints[weight.joint];
-
-			Vector3 rotatedPoint = joint.rotation.transformPoint(weight.v);
-			skinned += (rotatedPoint + joint.position) * weight.t;
-		}
-
-		_vertices[j].vertex = skinned;
-		_vertices[j].texcoord = TexCoord2f(vert.u, vert.v);
-		_vertices[j].normal = Normal3f(0,0,0);
+		transforms[i] = MD5SkinningKernel::getJointTransform(joints[i].rotation, joints[i].position);
 	}
 
+	_kernel->skin(transforms, _vertices);
+
 	// Ensure the index array is ok
 	if (_indices.empty())
 	{
 		buildIndexArray();
 	}
 
-	buildVertexNormals();
-
 	updateGeometry();
 }
 
-void MD5Surface::updateToSkeleton(const MD5Skeleton& skeleton)
+MD5SkinningKernel::Job MD5Surface::getSkinningJob()
 {
-	// Ensure we have all vertices allocated
-	if (_vertices.size() != _mesh->vertices.size())
-	{
-		_vertices.resize(_mesh->vertices.size());
-	}
-
-	// Deform vertices to fit the skeleton
-	for (std::size_t j = 0; j < _mesh->vertices.size(); ++j)
-	{
-		MD5Vert& vert = _mesh->vertices[j];
-
-		Vector3 skinned(0, 0, 0);
-
-		for (std::size_t k = 0; k != vert.weight_count; ++k)
-		{
-			MD5Weight& weight = _mesh->weights[vert.weight_index + k];
-			const IMD5Anim::Key& key = skeleton.getKey(weight.joint);
-			//const Joint& joint = skeleton.getJoint(weight.joint);
-
-			Vector3 rotatedPoint = key.orientation.transformPoint(weight.v);
-			skinned += (rotatedPoint + key.origin) * weight.t;
-		}
-
-		_vertices[j].vertex = skinned;
-		_vertices[j].texcoord = TexCoord2f(vert.u, vert.v);
-		_vertices[j].normal = Normal3f(0,0,0);
-	}
-    
 	// Ensure the index array is ok
 	if (_indices.empty())
 	{
 		buildIndexArray();
 	}
 
-	buildVertexNormals();
-
-	updateGeometry();
+	MD5SkinningKernel::Job job = { _kernel.get(), &_vertices };
+	return job;
 }
 
-void MD5Surface::buildVertexNormals()
+const MD5MeshPtr& MD5Surface::getMesh() const
 {
-	for (Indices::iterator j = _indices.begin(); j != _indices.end(); j += 3)
-	{
-		ArbitraryMeshVertex& a = _vertices[*(j + 0)];
-		ArbitraryMeshVertex& b = _vertices[*(j + 1)];
-		ArbitraryMeshVertex& c = _vertices[*(j + 2)];
+	return _mesh;
+}
 
-		Vector3 weightedNormal((c.vertex - a.vertex).crossProduct(b.vertex - a.vertex));
+const MD5Surface::Vertices& MD5Surface::getVertices() const
+{
+	return _vertices;
+}
 
-		a.normal += weightedNormal;
-		b.normal += weightedNormal;
-		c.normal += weightedNormal;
-	}
+void MD5Surface::setVertices(const Vertices& vertices)
+{
+	_vertices = vertices;
 
-	// Normalise all normal vectors
-	for (Vertices::iterator j = _vertices.begin(); j != _vertices.end(); ++j)
+	if (_indices.empty())
 	{
-		j->normal = Normal3f(j->normal.getNormalised());
+		buildIndexArray();
 	}
 }
 
@@ -476,6 +410,8 @@ void MD5Surface::parseFromTokens(parser::DefTokeniser& tok)
 	// ----- END OF MESH DECL -----
 
 	tok.assertNextToken("}");
+
+	_kernel.reset(new MD5SkinningKernel(mesh));
 }
 
 } // namespace md5
@@ -10,6 +10,7 @@
 #include "imodelsurface.h"
 
 #include "MD5DataStructures.h"
+#include "MD5SkinningKernel.h"
 #include "parser/DefTokeniser.h"
 
 class Ray;
@@ -17,14 +18,12 @@ class Ray;
 namespace md5
 {
 
-class MD5Skeleton;
-
 class MD5Surface :
 	public model::IModelSurface,
 	public OpenGLRenderable
 {
 public:
-	typedef std::vector<ArbitraryMeshVertex> Vertices;
+	typedef MD5SkinningKernel::Vertices Vertices;
 	typedef IndexBuffer Indices;
 
 private:
@@ -37,6 +36,9 @@ private:
 	// Several MD5Surfaces can share the same mesh
 	MD5MeshPtr _mesh;
 
+	// Deforms the mesh to the skeleton, shared like the mesh
+	MD5SkinningKernelPtr _kernel;
+
 	// Our render data
 	Vertices _vertices;
 	Indices _indices;
@@ -53,9 +55,6 @@ private:
     // Frees any display list in use
     void releaseDisplayLists();
 
-	// Re-calculate the normal vectors
-	void buildVertexNormals();
-
 public:
 
 	/**
@@ -85,8 +84,19 @@ public:
 	// It needs the joints defined in that file as reference
 	void updateToDefaultPose(const MD5Joints& joints);
 
-	// Updates this mesh to the state of the given skeleton
-	void updateToSkeleton(const MD5Skeleton& skeleton);
+	/**
+	 * Returns the job deforming this surface's vertices to a skeleton pose,
+	 * which can be run in parallel to the jobs of other surfaces.
+	 * updateGeometry() needs to be called once the job is done.
+	 */
+	MD5SkinningKernel::Job getSkinningJob();
+
+	// The mesh definition, shared by copies of this surface
+	const MD5MeshPtr& getMesh() const;
+
+	// Direct access to the vertices, to store and restore poses
+	const Vertices& getVertices() const;
+	void setVertices(const Vertices& vertices);
 
 	// Applies the given Skin to this surface.
 	void applySkin(const ModelSkin& skin);
@@ -0,0 +1,398 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE skinningTest
+#include <boost/test/unit_test.hpp>
+
+#include "MD5SkinningKernel.h"
+#include "MD5PoseCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    const std::size_t NUM_JOINTS = 80;
+
+    typedef md5::MD5SkinningKernel::Vertices Vertices;
+    typedef std::vector<md5::IMD5Anim::Key> Pose;
+
+    // Deterministic pseudo-random numbers in [0..1)
+    double random(std::size_t& seed)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>((seed >> 11) & 0xfffff) / 0x100000;
+    }
+
+    // Only used as key of the cached poses and to calculate their ticks
+    class GeneratedAnim :
+        public md5::IMD5Anim
+    {
+        md5::Joint _joint;
+        Key _key;
+        FrameKeys _frameKeys;
+
+        std::size_t _numFrames;
+
+    public:
+        GeneratedAnim(std::size_t numFrames) :
+            _numFrames(numFrames)
+        {}
+
+        std::size_t getNumJoints() const override { return 0; }
+        const md5::Joint& getJoint(std::size_t) const override { return _joint; }
+        const Key& getBaseFrameKey(std::size_t) const override { return _key; }
+        int getFrameRate() const override { return 24; }
+        std::size_t getNumFrames() const override { return _numFrames; }
+        const FrameKeys& getFrameKeys(std::size_t) const override { return _frameKeys; }
+    };
+
+    // A grid of vertices, bent around the joints it's attached to
+    md5::MD5MeshPtr createMesh(std::size_t numVertices, std::size_t& seed)
+    {
+        md5::MD5MeshPtr mesh = std::make_shared<md5::MD5Mesh>();
+
+        std::size_t width = static_cast<std::size_t>(std::sqrt(static_cast<double>(numVertices)));
+        std::size_t height = std::max<std::size_t>(numVertices / width, 2);
+
+        for (std::size_t v = 0; v < width * height; ++v)
+        {
+            md5::MD5Vert vert;
+            vert.index = v;
+            vert.u = static_cast<float>(v % width) / width;
+            vert.v = static_cast<float>(v / width) / height;
+            vert.weight_index = mesh->weights.size();
+            vert.weight_count = 1 + static_cast<std::size_t>(random(seed) * 4);
+
+            double remaining = 1;
+
+            for (std::size_t k = 0; k < vert.weight_count; ++k)
+            {
+                md5::MD5Weight weight;
+                weight.index = mesh->weights.size();
+                weight.joint = static_cast<std::size_t>(random(seed) * NUM_JOINTS);
+                weight.t = static_cast<float>(k + 1 == vert.weight_count ? remaining : remaining * random(seed));
+                weight.v = Vector3(random(seed) - 0.5, random(seed) - 0.5, random(seed) - 0.5) * 32;
+
+                remaining -= weight.t;
+                mesh->weights.push_back(weight);
+            }
+
+            mesh->vertices.push_back(vert);
+        }
+
+        for (std::size_t row = 0; row + 1 < height; ++row)
+        {
+            for (std::size_t col = 0; col + 1 < width; ++col)
+            {
+                std::size_t v = row * width + col;
+
+                md5::MD5Tri first = { mesh->triangles.size(), v, v + width, v + 1 };
+                mesh->triangles.push_back(first);
+
+                md5::MD5Tri second = { mesh->triangles.size(), v + 1, v + width, v + width + 1 };
+                mesh->triangles.push_back(second);
+            }
+        }
+
+        return mesh;
+    }
+
+    // The joint keys of a random pose
+    Pose createPose(std::size_t& seed)
+    {
+        Pose keys(NUM_JOINTS);
+
+        for (md5::IMD5Anim::Key& key : keys)
+        {
+            key.origin = Vector3(random(seed) - 0.5, random(seed) - 0.5, random(seed)) * 64;
+            key.orientation = Quaternion(random(seed) - 0.5, random(seed) - 0.5,
+                random(seed) - 0.5, random(seed) - 0.5).getNormalised();
+        }
+
+        return keys;
+    }
+
+    // The per-weight quaternion transformation MD5Surface used to perform
+    void skinReference(const md5::MD5Mesh& mesh, const Pose& keys, Vertices& vertices)
+    {
+        vertices.resize(mesh.vertices.size());
+
+        for (std::size_t j = 0; j < mesh.vertices.size(); ++j)
+        {
+            const md5::MD5Vert& vert = mesh.vertices[j];
+
+            Vector3 skinned(0, 0, 0);
+
+            for (std::size_t k = 0; k != vert.weight_count; ++k)
+            {
+                const md5::MD5Weight& weight = mesh.weights[vert.weight_index + k];
+                const md5::IMD5Anim::Key& key = keys[weight.joint];
+
+                Vector3 rotatedPoint = key.orientation.transformPoint(weight.v);
+                skinned += (rotatedPoint + key.origin) * weight.t;
+            }
+
+            vertices[j].vertex = skinned;
+            vertices[j].texcoord = TexCoord2f(vert.u, vert.v);
+            vertices[j].normal = Normal3f(0, 0, 0);
+            vertices[j].tangent = Normal3f(0, 0, 0);
+            vertices[j].bitangent = Normal3f(0, 0, 0);
+        }
+
+        for (const md5::MD5Tri& tri : mesh.triangles)
+        {
+            ArbitraryMeshVertex& a = vertices[tri.a];
+            ArbitraryMeshVertex& b = vertices[tri.b];
+            ArbitraryMeshVertex& c = vertices[tri.c];
+
+            Vector3 weightedNormal((c.vertex - a.vertex).crossProduct(b.vertex - a.vertex));
+
+            a.normal += weightedNormal;
+            b.normal += weightedNormal;
+            c.normal += weightedNormal;
+        }
+
+        for (ArbitraryMeshVertex& vertex : vertices)
+        {
+            vertex.normal = Normal3f(vertex.normal.getNormalised());
+        }
+
+        for (const md5::MD5Tri& tri : mesh.triangles)
+        {
+            ArbitraryMeshTriangle_sumTangents(vertices[tri.a], vertices[tri.b], vertices[tri.c]);
+        }
+
+        for (ArbitraryMeshVertex& vertex : vertices)
+        {
+            vertex.tangent.normalise();
+            vertex.bitangent.normalise();
+        }
+    }
+
+    md5::MD5SkinningKernel::JointTransforms getJointTransforms(const Pose& keys)
+    {
+        md5::MD5SkinningKernel::JointTransforms joints(keys.size());
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            joints[i] = md5::MD5SkinningKernel::getJointTransform(keys[i].orientation, keys[i].origin);
+        }
+
+        return joints;
+    }
+
+    // Skins all meshes to the given pose
+    void skinMeshes(const std::vector<md5::MD5SkinningKernelPtr>& kernels, const Pose& pose,
+        std::vector<Vertices>& results, std::size_t numThreads)
+    {
+        std::vector<md5::MD5SkinningKernel::Job> jobs;
+
+        for (std::size_t m = 0; m < kernels.size(); ++m)
+        {
+            md5::MD5SkinningKernel::Job job = { kernels[m].get(), &results[m] };
+            jobs.push_back(job);
+        }
+
+        md5::MD5SkinningKernel::skinInParallel(jobs, getJointTransforms(pose), numThreads);
+    }
+
+    const std::size_t NUM_MESHES = 4;
+    const std::size_t VERTICES_PER_MESH = 400;
+
+    // One second at the frame rate of the generated animations
+    const std::size_t NUM_FRAMES = 24;
+    const std::size_t LOOP_MSEC = 1000;
+
+    struct Meshes
+    {
+        std::vector<md5::MD5MeshPtr> meshes;
+        std::vector<md5::MD5SkinningKernelPtr> kernels;
+
+        Meshes()
+        {
+            std::size_t seed = 1;
+
+            for (std::size_t i = 0; i < NUM_MESHES; ++i)
+            {
+                meshes.push_back(createMesh(VERTICES_PER_MESH, seed));
+                kernels.push_back(std::make_shared<md5::MD5SkinningKernel>(*meshes.back()));
+            }
+        }
+    };
+
+    bool isIdentical(const Vertices& a, const Vertices& b)
+    {
+        if (a.size() != b.size()) return false;
+
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].vertex != b[i].vertex || a[i].normal != b[i].normal ||
+                a[i].tangent != b[i].tangent || a[i].bitangent != b[i].bitangent ||
+                a[i].texcoord != b[i].texcoord)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    double getMaxDeviation(const Vertices& a, const Vertices& b)
+    {
+        BOOST_REQUIRE_EQUAL(a.size(), b.size());
+
+        double deviation = 0;
+
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            deviation = std::max<double>(deviation, (a[i].vertex - b[i].vertex).getLength());
+            deviation = std::max<double>(deviation, (a[i].normal - b[i].normal).getLength());
+            deviation = std::max<double>(deviation, (a[i].tangent - b[i].tangent).getLength());
+            deviation = std::max<double>(deviation, (a[i].bitangent - b[i].bitangent).getLength());
+        }
+
+        return deviation;
+    }
+
+    // The skeleton pose at the given tick
+    Pose getTickPose(std::size_t tick)
+    {
+        std::size_t seed = tick + 1;
+        return createPose(seed);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(kernelMatchesQuaternions, Meshes)
+{
+    std::size_t seed = 2;
+
+    for (std::size_t p = 0; p < 4; ++p)
+    {
+        Pose pose = createPose(seed);
+
+        for (std::size_t m = 0; m < NUM_MESHES; ++m)
+        {
+            Vertices reference;
+            skinReference(*meshes[m], pose, reference);
+
+            Vertices skinned;
+            kernels[m]->skin(getJointTransforms(pose), skinned);
+
+            // The kernel sums the weights as doubles, they differ in rounding only
+            BOOST_CHECK_LT(getMaxDeviation(reference, skinned), 0.0001);
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(threadedSkinningIsIdentical, Meshes)
+{
+    std::size_t seed = 3;
+    Pose pose = createPose(seed);
+
+    std::vector<Vertices> single(NUM_MESHES);
+    std::vector<Vertices> threaded(NUM_MESHES);
+
+    skinMeshes(kernels, pose, single, 1);
+    skinMeshes(kernels, pose, threaded, 4);
+
+    for (std::size_t m = 0; m < NUM_MESHES; ++m)
+    {
+        BOOST_CHECK(isIdentical(single[m], threaded[m]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ticksWrapAroundTheLoop)
+{
+    GeneratedAnim anim(NUM_FRAMES);
+
+    BOOST_CHECK_EQUAL(md5::MD5PoseCache::getTick(anim, 0), 0);
+    BOOST_CHECK_EQUAL(md5::MD5PoseCache::getTick(anim, md5::MD5PoseCache::TICK_MSEC - 1), 0);
+    BOOST_CHECK_EQUAL(md5::MD5PoseCache::getTick(anim, md5::MD5PoseCache::TICK_MSEC), 1);
+    BOOST_CHECK_EQUAL(md5::MD5PoseCache::getTick(anim, LOOP_MSEC + 17), 1);
+    BOOST_CHECK_EQUAL(md5::MD5PoseCache::getTick(anim, 5 * LOOP_MSEC), 0);
+
+    // Animations without frames are not looped
+    GeneratedAnim empty(0);
+    BOOST_CHECK_EQUAL(md5::MD5PoseCache::getTick(empty, 5 * LOOP_MSEC), 5 * LOOP_MSEC / md5::MD5PoseCache::TICK_MSEC);
+}
+
+BOOST_FIXTURE_TEST_CASE(secondLoopHitsPoseCache, Meshes)
+{
+    md5::IMD5AnimPtr anim = std::make_shared<GeneratedAnim>(NUM_FRAMES);
+    md5::MD5PoseCache poseCache(NUM_MESHES * VERTICES_PER_MESH * LOOP_MSEC);
+
+    std::vector<Vertices> skinned(NUM_MESHES);
+    std::size_t hits[2] = { 0, 0 };
+    std::size_t lookups[2] = { 0, 0 };
+
+    // Advance the time like the preview does, the loop is not a multiple of the
+    // time step, so the second pass sees other times than the first one
+    for (std::size_t time = 0; time < 2 * LOOP_MSEC; time += md5::MD5PoseCache::TICK_MSEC)
+    {
+        std::size_t pass = time / LOOP_MSEC;
+        std::size_t tick = md5::MD5PoseCache::getTick(*anim, time);
+
+        skinMeshes(kernels, getTickPose(tick), skinned, 1);
+
+        for (std::size_t m = 0; m < NUM_MESHES; ++m)
+        {
+            const Vertices* pose = poseCache.find(meshes[m], anim, tick);
+            ++lookups[pass];
+
+            if (pose != nullptr)
+            {
+                ++hits[pass];
+                BOOST_CHECK(isIdentical(*pose, skinned[m]));
+            }
+            else
+            {
+                poseCache.insert(meshes[m], anim, tick, skinned[m]);
+            }
+        }
+    }
+
+    BOOST_CHECK_EQUAL(hits[0], 0);
+    BOOST_CHECK_GT(lookups[1], 0);
+    BOOST_CHECK_EQUAL(hits[1], lookups[1]);
+}
+
+BOOST_FIXTURE_TEST_CASE(evictOtherAnimations, Meshes)
+{
+    md5::IMD5AnimPtr first = std::make_shared<GeneratedAnim>(NUM_FRAMES);
+    md5::IMD5AnimPtr second = std::make_shared<GeneratedAnim>(NUM_FRAMES);
+
+    // Room for two poses of all meshes
+    md5::MD5PoseCache poseCache(2 * NUM_MESHES * VERTICES_PER_MESH);
+
+    std::vector<Vertices> skinned(NUM_MESHES);
+    skinMeshes(kernels, getTickPose(0), skinned, 1);
+
+    for (std::size_t tick = 0; tick < 2; ++tick)
+    {
+        for (std::size_t m = 0; m < NUM_MESHES; ++m)
+        {
+            poseCache.insert(meshes[m], first, tick, skinned[m]);
+        }
+    }
+
+    BOOST_CHECK_EQUAL(poseCache.getNumVertices(), 2 * NUM_MESHES * VERTICES_PER_MESH);
+
+    // Poses of the animation being inserted for are kept, a full cache refuses
+    poseCache.insert(meshes[0], first, 2, skinned[0]);
+
+    BOOST_CHECK(poseCache.find(meshes[0], first, 2) == nullptr);
+    BOOST_CHECK(poseCache.find(meshes[0], first, 0) != nullptr);
+
+    // The least recently used poses of other animations are discarded
+    poseCache.insert(meshes[1], second, 0, skinned[1]);
+
+    BOOST_CHECK(poseCache.find(meshes[1], second, 0) != nullptr);
+    BOOST_CHECK(poseCache.find(meshes[1], first, 0) == nullptr);
+    BOOST_CHECK(poseCache.find(meshes[0], first, 0) != nullptr);
+    BOOST_CHECK_EQUAL(poseCache.getNumVertices(), 2 * NUM_MESHES * VERTICES_PER_MESH);
+
+    poseCache.clear();
+
+    BOOST_CHECK_EQUAL(poseCache.getNumVertices(), 0);
+    BOOST_CHECK(poseCache.find(meshes[0], first, 0) == nullptr);
+}
@@ -38,15 +38,20 @@ void RenderableParticle::update(const Matrix4& viewRotation)
 	// the camera rotation.
 	Matrix4 invViewRotation = viewRotation.getInverse();
 
-	// Traverse the stages and call update
+	// Traverse the stages and collect the bunches which need an update
+	_updateJobs.clear();
+
 	for (ShaderMap::const_iterator i = _shaderMap.begin(); i != _shaderMap.end(); ++i)
 	{
 		for (RenderableParticleStageList::const_iterator stage = i->second.stages.begin();
 			 stage != i->second.stages.end(); ++stage)
 		{
-			(*stage)->update(time, invViewRotation);
+			(*stage)->prepareUpdate(time, invViewRotation, _updateJobs);
 		}
 	}
+
+	// Bunches of all stages are updated in one go, large systems use several threads
+	RenderableParticleBunch::updateInParallel(_updateJobs);
 }
 
 // Front-end render methods
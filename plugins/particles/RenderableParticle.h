@@ -54,6 +54,9 @@ class RenderableParticle : public IRenderableParticle,
 	// The associated rendersystem, needed to get time an shaders
 	RenderSystemWeakPtr _renderSystem;
 
+	// The bunches of all stages to be updated, re-used by every update
+	std::vector<RenderableParticleBunch::Job> _updateJobs;
+
 public:
 	RenderableParticle(const IParticleDefPtr& particleDef);
 
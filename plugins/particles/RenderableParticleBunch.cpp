@@ -5,9 +5,21 @@
 
 #include "string/string.h"
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
 namespace particles
 {
 
+namespace
+{
+    // Batches generating fewer quads are updated by the calling thread,
+    // most emitters only consist of a few dozen particles
+    const std::size_t PARALLEL_THRESHOLD = 4096;
+}
+
 RenderableParticleBunch::RenderableParticleBunch(std::size_t index,
 	Rand48::result_type randSeed, const IStageDef& stage, const Matrix4& viewRotation,
     const Vector3& direction, const Vector3& entityColour) :
@@ -19,26 +31,84 @@ RenderableParticleBunch::RenderableParticleBunch(std::size_t index,
     _offset(_stage.getOffset()),
     _viewRotation(viewRotation),
     _direction(direction),
-    _entityColour(entityColour)
+    _entityColour(entityColour),
+    _directionRotation(Matrix4::getIdentity()),
+    _particlesValid(false),
+    _particleTime(0),
+    _quadsValid(false),
+    _quadViewRotation(Matrix4::getIdentity())
 {
     // Geometry is written in update(), just reserve the space
 }
 
+void RenderableParticleBunch::reset(std::size_t index, Rand48::result_type randSeed)
+{
+    _index = index;
+    _randSeed = randSeed;
+
+    // Keep the containers, only their contents are outdated
+    _particlesValid = false;
+    _quadsValid = false;
+}
+
 void RenderableParticleBunch::update(std::size_t time)
 {
-    _bounds = AABB();
-    _quads.clear();
+    bool particlesChanged = simulate(time);
+
+    // The view rotation only changes for view and aimed orientation,
+    // otherwise the quads stay valid as long as the particles do
+    if (!particlesChanged && _quadsValid && _quadViewRotation == _viewRotation)
+    {
+        return;
+    }
+
+    buildQuads();
+}
+
+bool RenderableParticleBunch::isUpToDate(std::size_t time) const
+{
+    return _particlesValid && _quadsValid && _particleTime == time &&
+           _particleDirection == _direction && _particleEntityColour == _entityColour &&
+           _quadViewRotation == _viewRotation;
+}
+
+bool RenderableParticleBunch::simulate(std::size_t time)
+{
+    if (_particlesValid && _particleTime == time &&
+        _particleDirection == _direction && _particleEntityColour == _entityColour)
+    {
+        return false;
+    }
+
+    _particlesValid = true;
+    _particleTime = time;
+    _particleDirection = _direction;
+    _particleEntityColour = _entityColour;
+
+    _particles.clear();
+    _trailOrigins.clear();
 
     // Length of one cycle (duration + deadtime)
     std::size_t cycleMsec = static_cast<std::size_t>(_stage.getCycleMsec());
 
     if (cycleMsec == 0)
     {
-        return;
+        return true;
     }
 
-    // Reserve enough space for all the particles (non-animated case)
-    _quads.reserve(_stage.getCount() * 4);
+    // Check if the main direction is different to the z axis
+    Vector3 dir = _direction.getNormalised();
+    Vector3 zDir(0,0,1);
+
+    double deviation = dir.angle(zDir);
+
+    _directionRotation = deviation != 0 ? Matrix4::getRotation(zDir, dir) : Matrix4::getIdentity();
+
+    // if "world" is set, use -z as gravity direction, otherwise use the reverse emitter direction
+    _gravity = _stage.getWorldGravityFlag() ? Vector3(0,0,-1) : -dir;
+
+    // Reserve enough space for all the particles
+    _particles.reserve(_stage.getCount());
 
     // Normalise the global input time into local cycle time
     // The cycleTime may be larger than the _stage.cycleMsec argument if bunching is turned off
@@ -56,7 +126,7 @@ void RenderableParticleBunch::update(std::size_t time)
     // This is the spacing between each particle
     std::size_t spawnSpacingMsec = static_cast<std::size_t>(spawnSpacing);
 
-    // Generate all particle quads, regardless of their visibility
+    // Simulate all particles, regardless of their visibility
     // Visibility is considered by not rendering particles that haven't been spawned yet
     for (std::size_t i = 0; i < static_cast<std::size_t>(_stage.getCount()); ++i)
     {
@@ -129,10 +199,44 @@ void RenderableParticleBunch::update(std::size_t time)
             calculateAnim(particle);
         }
 
+        _particles.push_back(particle);
+
+        // The trails of aimed particles don't depend on the view either
+        if (_stage.getOrientationType() == IStageDef::ORIENTATION_AIMED)
+        {
+            calculateTrailOrigins(particle, stageDurationMsec);
+        }
+    }
+
+    return true;
+}
+
+void RenderableParticleBunch::buildQuads()
+{
+    _quadsValid = true;
+    _quadViewRotation = _viewRotation;
+
+    _bounds = AABB();
+    _quads.clear();
+
+    if (_particles.empty())
+    {
+        return;
+    }
+
+    // Reserve enough space for all the particles, this only allocates on the first update
+    _quads.reserve(getEstimatedNumQuads());
+
+    std::size_t numAimedQuads = getNumAimedQuads();
+
+    for (std::size_t p = 0; p < _particles.size(); ++p)
+    {
+        ParticleRenderInfo& particle = _particles[p];
+
         // For aimed orientation, we need to override particle height and aspect
         if (_stage.getOrientationType() == IStageDef::ORIENTATION_AIMED)
         {
-            pushAimedParticles(particle, stageDurationMsec);
+            pushAimedParticles(particle, &_trailOrigins[p * numAimedQuads]);
         }
         else
         {
@@ -149,6 +253,73 @@ void RenderableParticleBunch::update(std::size_t time)
             }
         }
     }
+
+    // Calculate the bounds right away, this might happen in a worker thread
+    calculateBounds();
+}
+
+std::size_t RenderableParticleBunch::getEstimatedNumQuads() const
+{
+    std::size_t numQuads = static_cast<std::size_t>(std::max(_stage.getCount(), 0));
+
+    if (_stage.getOrientationType() == IStageDef::ORIENTATION_AIMED)
+    {
+        numQuads *= getNumAimedQuads();
+    }
+
+    return _stage.getAnimationFrames() > 0 ? numQuads * 2 : numQuads;
+}
+
+void RenderableParticleBunch::updateInParallel(const std::vector<Job>& jobs, std::size_t numThreads)
+{
+    std::size_t numQuads = 0;
+
+    for (const Job& job : jobs)
+    {
+        numQuads += job.bunch->getEstimatedNumQuads();
+    }
+
+    if (numThreads == 0)
+    {
+        numThreads = std::thread::hardware_concurrency();
+    }
+
+    numThreads = std::min(numThreads, jobs.size());
+
+    if (numThreads <= 1 || numQuads < PARALLEL_THRESHOLD)
+    {
+        for (const Job& job : jobs)
+        {
+            job.bunch->update(job.time);
+        }
+
+        return;
+    }
+
+    // Bunches are handed out one by one, their sizes vary a lot
+    std::atomic<std::size_t> nextJob(0);
+
+    auto updateJobs = [&]()
+    {
+        for (std::size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+        {
+            jobs[i].bunch->update(jobs[i].time);
+        }
+    };
+
+    std::vector<std::future<void>> threads;
+
+    for (std::size_t i = 1; i < numThreads; ++i)
+    {
+        threads.push_back(std::async(std::launch::async, updateJobs));
+    }
+
+    updateJobs();
+
+    for (std::future<void>& thread : threads)
+    {
+        thread.get();
+    }
 }
 
 void RenderableParticleBunch::render(const RenderInfo& info) const
@@ -179,40 +350,33 @@ const AABB& RenderableParticleBunch::getBounds()
     return _bounds;
 }
 
+const RenderableParticleBunch::Quads& RenderableParticleBunch::getQuads() const
+{
+    return _quads;
+}
+
 Matrix4 RenderableParticleBunch::getAimedMatrix(const Vector3& particleVelocity)
 {
     // Get the velocity direction in object space, use the same velocity for all trailing quads
     Vector3 vel = particleVelocity.getNormalised();
 
-    // Construct the matrices
-    const Matrix4& camera2Object = _viewRotation;
-
-    // The matrix rotating the particle into velocity space
-    Matrix4 object2Vel = Matrix4::getRotation(Vector3(0,1,0), vel);
-
     // Transform the view (-z) vector into object space
-    Vector3 view = camera2Object.transformPoint(Vector3(0,0,-1));
-
-    // Project the view vector onto the plane defined by the velocity vector
-    Vector3 viewProj = view - vel * view.dot(vel);
-
-    // This is the particle normal in object space (after being oriented such that y || velocity)
-    Vector3 z = object2Vel.z().getVector3();
-
-    // The particle needs to be rotated by this angle around the velocity axis
-    double aimedAngle = z.angle(-viewProj);
-
-    // Use the cross to check whether to rotate in negative or positive direction
-    if (z.crossProduct(-viewProj).dot(vel) > 0)
-    {
-        aimedAngle *= -1;
-    }
-
-    // Calculate the rotation of the particle normal towards the view vector, around the velocity axis
-    Matrix4 vel2aimed = Matrix4::getRotation(vel, aimedAngle);
-
-    // Combine the matrices object2Vel => vel2aimed;
-    return vel2aimed.getMultipliedBy(object2Vel);
+    Vector3 view = _viewRotation.transformPoint(Vector3(0,0,-1));
+
+    // Project the view vector onto the plane defined by the velocity vector,
+    // the particle normal is pointing against it
+    Vector3 z = -(view - vel * view.dot(vel)).getNormalised();
+
+    // The quad is rotated such that y || velocity and its normal faces the viewer,
+    // construct this basis directly instead of combining two rotation matrices
+    Vector3 x = vel.crossProduct(z);
+
+    return Matrix4::byColumns(
+        x.x(), x.y(), x.z(), 0,
+        vel.x(), vel.y(), vel.z(), 0,
+        z.x(), z.y(), z.z(), 0,
+        0, 0, 0, 1
+    );
 }
 
 void RenderableParticleBunch::calculateAnim(ParticleRenderInfo& particle)
@@ -295,13 +459,7 @@ void RenderableParticleBunch::calculateColour(ParticleRenderInfo& particle)
 
 void RenderableParticleBunch::calculateOrigin(ParticleRenderInfo& particle)
 {
-    // Check if the main direction is different to the z axis
-    Vector3 dir = _direction.getNormalised();
-    Vector3 zDir(0,0,1);
-
-    double deviation = dir.angle(zDir);
-
-    Matrix4 rotation = deviation != 0 ? Matrix4::getRotation(zDir, dir) : Matrix4::getIdentity();
+    const Matrix4& rotation = _directionRotation;
 
     // Consider offset as starting point
     particle.origin = rotation.transformPoint(_offset);
@@ -404,10 +562,7 @@ void RenderableParticleBunch::calculateOrigin(ParticleRenderInfo& particle)
     };
 
     // Consider gravity
-    // if "world" is set, use -z as gravity direction, otherwise use the reverse emitter direction
-    Vector3 gravity = _stage.getWorldGravityFlag() ? Vector3(0,0,-1) : -_direction.getNormalised();
-
-    particle.origin += gravity * _stage.getGravity() * particle.timeSecs * particle.timeSecs * 0.5f;
+    particle.origin += _gravity * _stage.getGravity() * particle.timeSecs * particle.timeSecs * 0.5f;
 }
 
 Vector3 RenderableParticleBunch::getDirection(ParticleRenderInfo& particle, const Matrix4& rotation, const Vector3& distributionOffset)
@@ -570,15 +725,17 @@ void RenderableParticleBunch::pushQuad(ParticleRenderInfo& particle, const Vecto
     _quads.back().translate(particle.origin);
 }
 
-void RenderableParticleBunch::pushAimedParticles(ParticleRenderInfo& particle, std::size_t stageDurationMsec)
+std::size_t RenderableParticleBunch::getNumAimedQuads() const
 {
     int trails = static_cast<int>(_stage.getOrientationParm(0)); // trails
-    float aimedTime = _stage.getOrientationParm(1); // time
 
-    if (trails < 0)
-    {
-        trails = 0;
-    }
+    return trails > 0 ? static_cast<std::size_t>(trails) + 1 : 1;
+}
+
+void RenderableParticleBunch::calculateTrailOrigins(const ParticleRenderInfo& particle,
+    std::size_t stageDurationMsec)
+{
+    float aimedTime = _stage.getOrientationParm(1); // time
 
     // The time parameter defaults to 0.5 if not specified
     if (aimedTime == 0.0f)
@@ -587,25 +744,39 @@ void RenderableParticleBunch::pushAimedParticles(ParticleRenderInfo& particle, s
     }
 
     // The time delta to step into the past
-    int numQuads = trails + 1;
+    int numQuads = static_cast<int>(getNumAimedQuads());
 
     // The time delta between quads
     float timeStep = aimedTime / numQuads;
 
-    Vector3 lastOrigin = particle.origin;
-
     for (int i = 1; i <= numQuads; ++i)
     {
-        // Copy over the info of the incoming particle (contains anim info, colour, etc.)
         ParticleRenderInfo aimedParticle = particle;
 
         // Get the time of the i-th particle in seconds, plus the fraction
         aimedParticle.timeSecs = particle.timeSecs - timeStep * i;
         aimedParticle.timeFraction = SEC2MS(aimedParticle.timeSecs) / stageDurationMsec;
 
-        // Get origin and velocity at that time
+        // Get origin at that time
         calculateOrigin(aimedParticle);
 
+        _trailOrigins.push_back(aimedParticle.origin);
+    }
+}
+
+void RenderableParticleBunch::pushAimedParticles(ParticleRenderInfo& particle, const Vector3* trailOrigins)
+{
+    int numQuads = static_cast<int>(getNumAimedQuads());
+
+    Vector3 lastOrigin = particle.origin;
+
+    for (int i = 1; i <= numQuads; ++i)
+    {
+        // Copy over the info of the incoming particle (contains anim info, colour, etc.)
+        ParticleRenderInfo aimedParticle = particle;
+
+        aimedParticle.origin = trailOrigins[i - 1];
+
         // Gotcha: don't bother calculating the actual velocity at the given time, just use the
         // difference vector of the two origins, this is enough to receive the "aimed" direction
         Vector3 velocity = lastOrigin - aimedParticle.origin;
@@ -11,6 +11,8 @@
 #include "ParticleQuad.h"
 #include "ParticleRenderInfo.h"
 
+#include <vector>
+
 namespace particles
 {
 
@@ -18,17 +20,44 @@ namespace particles
 #define SEC2MS(x) ((x)*1000)
 #define MS2SEC(x) ((x)*0.001f)
 
-/// A single bunch of particles, consisting of a renderable set of quads
+/**
+ * A single bunch of particles, consisting of a renderable set of quads.
+ *
+ * The geometry is generated in two steps: the particles are simulated first,
+ * which depends on the time, the emitter direction and the entity colour
+ * only. The quads are then built from the particles using the view rotation.
+ * Both results are kept until their input changes, so a bunch is only
+ * re-evaluated if time is running, and only its quads are re-built if the
+ * camera is rotated. The containers are re-used by every update.
+ */
 class RenderableParticleBunch : public OpenGLRenderable
 {
+public:
+	typedef std::vector<ParticleQuad> Quads;
+
+	// A bunch to be updated by updateInParallel(), time as passed to update()
+	struct Job
+	{
+		RenderableParticleBunch* bunch;
+		std::size_t time;
+	};
+
+private:
 	// The bunch index
 	std::size_t _index;
 
 	// The stage this bunch is part of
 	const IStageDef& _stage;
 
+	// The simulated particles which have been spawned at the current time
+	typedef std::vector<ParticleRenderInfo> Particles;
+	Particles _particles;
+
+	// The origins of the trailing quads of aimed particles, stored one after
+	// the other, getNumAimedQuads() for each simulated particle
+	std::vector<Vector3> _trailOrigins;
+
 	// The quads of this particle bunch
-	typedef std::vector<ParticleQuad> Quads;
 	Quads _quads;
 
 	// The seed for our local randomiser, as passed by the parent stage
@@ -55,6 +84,21 @@ class RenderableParticleBunch : public OpenGLRenderable
 	// The entity colour (instance owned by RenderableParticle)
 	const Vector3& _entityColour;
 
+	// The rotation of the emitter direction and the gravity vector,
+	// calculated once per simulation
+	Matrix4 _directionRotation;
+	Vector3 _gravity;
+
+	// The input the particles have been simulated with
+	bool _particlesValid;
+	std::size_t _particleTime;
+	Vector3 _particleDirection;
+	Vector3 _particleEntityColour;
+
+	// The view rotation the quads have been built with
+	bool _quadsValid;
+	Matrix4 _quadViewRotation;
+
 public:
 	// Each bunch has a defined zero-based index
 	RenderableParticleBunch(std::size_t index,
@@ -69,15 +113,42 @@ public:
 		return _index;
 	}
 
+	// Assigns a new cycle index and seed, the bunch is re-evaluated on the next update
+	void reset(std::size_t index, Rand48::result_type randSeed);
+
 	// Update the particle geometry and render information.
 	// Time is specified in stage time without offset,in msecs.
 	void update(std::size_t time);
 
+	// Returns true if update() wouldn't change anything at the given time
+	bool isUpToDate(std::size_t time) const;
+
+	/**
+	 * Updates the given bunches. Bunches don't share any mutable state, so
+	 * batches with enough particles are distributed over the given number of
+	 * threads (0 = hardware concurrency), smaller ones are updated by the
+	 * calling thread.
+	 */
+	static void updateInParallel(const std::vector<Job>& jobs, std::size_t numThreads = 0);
+
 	void render(const RenderInfo& info) const;
 
 	const AABB& getBounds();
 
+	const Quads& getQuads() const;
+
 private:
+	// Re-calculates the particles if the time, direction or entity colour
+	// changed since the last call. Returns true if the particles changed.
+	bool simulate(std::size_t time);
+
+	// Generates the quads of the simulated particles
+	void buildQuads();
+
+	// The approximate number of quads generated by this bunch, used to
+	// decide whether an update is worth to be distributed over threads
+	std::size_t getEstimatedNumQuads() const;
+
 	// Time is measured in seconds!
 	float integrate(const IParticleParameter& param, float time)
 	{
@@ -92,6 +163,7 @@ private:
 	void calculateColour(ParticleRenderInfo& particle);
 
 	// Calculates origin at the given time, write result back to the given struct
+	// Uses the direction rotation and gravity of the current simulation
 	void calculateOrigin(ParticleRenderInfo& particle);
 
 	// Handles animFrame stuff, may only be called if animFrames > 0
@@ -105,8 +177,14 @@ private:
 	// Calculates the matrix which rotates faces towards the viewer (used for "aimed" orientation)
 	Matrix4 getAimedMatrix(const Vector3& particleVelocity);
 
-	// Handles aimed particles
-	void pushAimedParticles(ParticleRenderInfo& particle, std::size_t stageDurationMsec);
+	// The number of quads drawn for each aimed particle (trails + 1)
+	std::size_t getNumAimedQuads() const;
+
+	// Calculates the origins of the trailing quads of an aimed particle
+	void calculateTrailOrigins(const ParticleRenderInfo& particle, std::size_t stageDurationMsec);
+
+	// Handles aimed particles, using the trail origins calculated during simulation
+	void pushAimedParticles(ParticleRenderInfo& particle, const Vector3* trailOrigins);
 
 	// Generates a new quad using the given struct as data source.
 	// colour, s0 and sWidth override the values in info
@@ -40,6 +40,50 @@ void RenderableParticleStage::render(const RenderInfo& info) const
 
 // Generate particle geometry, time is absolute in msecs
 void RenderableParticleStage::update(std::size_t time, const Matrix4& viewRotation)
+{
+	std::size_t localTimeMsec = 0;
+
+	if (!prepareBunches(time, viewRotation, localTimeMsec))
+	{
+		return;
+	}
+
+	// The 0 bunch is the active one, the 1 bunch is the previous one if not null
+
+	// Tell the particle batches to update their geometry
+	if (_bunches[0] != NULL)
+	{
+		_bunches[0]->update(localTimeMsec);
+	}
+
+	if (_bunches[1] != NULL)
+	{
+		_bunches[1]->update(localTimeMsec);
+	}
+}
+
+void RenderableParticleStage::prepareUpdate(std::size_t time, const Matrix4& viewRotation,
+	std::vector<RenderableParticleBunch::Job>& jobs)
+{
+	std::size_t localTimeMsec = 0;
+
+	if (!prepareBunches(time, viewRotation, localTimeMsec))
+	{
+		return;
+	}
+
+	for (const RenderableParticleBunchPtr& bunch : _bunches)
+	{
+		if (bunch && !bunch->isUpToDate(localTimeMsec))
+		{
+			RenderableParticleBunch::Job job = { bunch.get(), localTimeMsec };
+			jobs.push_back(job);
+		}
+	}
+}
+
+bool RenderableParticleStage::prepareBunches(std::size_t time, const Matrix4& viewRotation,
+	std::size_t& localTimeMsec)
 {
 	// Invalidate our bounds information
 	_bounds = AABB();
@@ -50,35 +94,28 @@ void RenderableParticleStage::update(std::size_t time, const Matrix4& viewRotati
 	if (time < timeOffset)
 	{
 		// We're still in the timeoffset zone where particle spawn is inhibited
+		RenderableParticleBunchPtr previous[2] = { _bunches[0], _bunches[1] };
+
 		_bunches[0].reset();
 		_bunches[1].reset();
-		return;
+
+		releaseBunch(previous[0]);
+		releaseBunch(previous[1]);
+		return false;
 	}
 
 	// Time >= timeOffset at this point
 
 	// Get rid of the time offset
-	std::size_t localtimeMsec = time - timeOffset;
+	localTimeMsec = time - timeOffset;
 
 	// Consider stage orientation (x,y,z,view,aimed)
 	calculateStageViewRotation(viewRotation);
 
 	// Make sure the correct bunches are allocated for this stage time
-	ensureBunches(localtimeMsec);
+	ensureBunches(localTimeMsec);
 
-	// The 0 bunch is the active one, the 1 bunch is the previous one if not null
-
-	// Tell the particle batches to update their geometry
-	if (_bunches[0] != NULL)
-	{
-		// Get one of our seed values
-		_bunches[0]->update(localtimeMsec);
-	}
-
-	if (_bunches[1] != NULL)
-	{
-		_bunches[1]->update(localtimeMsec);
-	}
+	return true;
 }
 
 const AABB& RenderableParticleStage::getBounds()
@@ -91,6 +128,11 @@ const AABB& RenderableParticleStage::getBounds()
 	return _bounds;
 }
 
+const RenderableParticleBunchPtr& RenderableParticleStage::getBunch(std::size_t index) const
+{
+	return _bunches[index];
+}
+
 const IStageDef& RenderableParticleStage::getDef() const
 {
 	return _stageDef;
@@ -130,6 +172,9 @@ void RenderableParticleStage::calculateStageViewRotation(const Matrix4& viewRota
 
 void RenderableParticleStage::ensureBunches(std::size_t localTimeMSec)
 {
+	// Bunches dropped below are kept for the next cycles
+	RenderableParticleBunchPtr previous[2] = { _bunches[0], _bunches[1] };
+
 	// Check which bunches is active at this time
 	float cycleFrac = floor(static_cast<float>(localTimeMSec) / _stageDef.getCycleMsec());
 
@@ -187,10 +232,31 @@ void RenderableParticleStage::ensureBunches(std::size_t localTimeMSec)
 			_bunches[1] = createBunch(prevCycleIndex);
 		}
 	}
+
+	releaseBunch(previous[0]);
+	releaseBunch(previous[1]);
+}
+
+void RenderableParticleStage::releaseBunch(const RenderableParticleBunchPtr& bunch)
+{
+	if (bunch && bunch != _bunches[0] && bunch != _bunches[1])
+	{
+		_unusedBunches.push_back(bunch);
+	}
 }
 
 RenderableParticleBunchPtr RenderableParticleStage::createBunch(std::size_t cycleIndex)
 {
+	if (!_unusedBunches.empty())
+	{
+		// Re-use an old bunch, it keeps the capacity of its particle and quad buffers
+		RenderableParticleBunchPtr bunch = _unusedBunches.back();
+		_unusedBunches.pop_back();
+
+		bunch->reset(cycleIndex, getSeed(cycleIndex));
+		return bunch;
+	}
+
 	return RenderableParticleBunchPtr(new RenderableParticleBunch(
 		cycleIndex, getSeed(cycleIndex), _stageDef, _viewRotation, _direction, _entityColour));
 }
@@ -29,6 +29,9 @@ class RenderableParticleStage :
 
 	std::vector<RenderableParticleBunchPtr> _bunches;
 
+	// Bunches of past cycles, re-used by createBunch() instead of allocating new ones
+	std::vector<RenderableParticleBunchPtr> _unusedBunches;
+
 	// The rotation matrix to orient particles
 	Matrix4 _viewRotation;
 
@@ -52,8 +55,19 @@ public:
 	// Generate particle geometry, time is absolute in msecs
 	void update(std::size_t time, const Matrix4& viewRotation);
 
+	/**
+	 * Prepares the update to the given time like update() does, but leaves
+	 * the geometry to the caller: the bunches which need to be updated are
+	 * appended to the given jobs, see RenderableParticleBunch::updateInParallel().
+	 */
+	void prepareUpdate(std::size_t time, const Matrix4& viewRotation,
+		std::vector<RenderableParticleBunch::Job>& jobs);
+
 	const AABB& getBounds();
 
+	// Returns the active (0) or the previous (1) bunch, either of which might be empty
+	const RenderableParticleBunchPtr& getBunch(std::size_t index) const;
+
     /// Return the stage definition associated with this renderable
 	const IStageDef& getDef() const;
 
@@ -61,8 +75,15 @@ private:
 	// Returns the correct rotation matrix required by the stage orientation settings
 	void calculateStageViewRotation(const Matrix4& viewRotation);
 
+	// Sets up the bunches active at the given time and calculates the stage-local
+	// time. Returns false if the stage time offset hasn't passed yet.
+	bool prepareBunches(std::size_t time, const Matrix4& viewRotation, std::size_t& localTimeMsec);
+
 	void ensureBunches(std::size_t localTimeMSec);
 
+	// Keeps the given bunch for re-use unless it's still active
+	void releaseBunch(const RenderableParticleBunchPtr& bunch);
+
 	RenderableParticleBunchPtr createBunch(std::size_t cycleIndex);
 
 	Rand48::result_type getSeed(std::size_t cycleIndex);
@@ -0,0 +1,348 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE particleTest
+#include <boost/test/unit_test.hpp>
+
+#include "ParticleDef.h"
+#include "RenderableParticleStage.h"
+
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    const char* const SAMPLE_DECLS =
+        "particle test_smoke\n"
+        "{\n"
+        "	{\n"
+        "		count 60\n"
+        "		material textures/particles/smoke\n"
+        "		time 4.0\n"
+        "		bunching 1.0\n"
+        "		distribution sphere 16 16 8 0.25\n"
+        "		direction cone 30\n"
+        "		orientation view\n"
+        "		speed 20 to 40\n"
+        "		size 8 to 32\n"
+        "		aspect 1\n"
+        "		rotation 10 to 30\n"
+        "		fadeIn 0.2\n"
+        "		fadeOut 0.5\n"
+        "		color 0.6 0.6 0.6 1\n"
+        "		fadeColor 0 0 0 0\n"
+        "		gravity world -8\n"
+        "		randomDistribution 1\n"
+        "	}\n"
+        "}\n"
+        "particle test_sparks\n"
+        "{\n"
+        "	depthHack 0.001\n"
+        "	{\n"
+        "		count 40\n"
+        "		material textures/particles/spark\n"
+        "		time 1.2\n"
+        "		deadTime 0.5\n"
+        "		bunching 0.3\n"
+        "		distribution rect 4 4 2\n"
+        "		direction outward 0.5\n"
+        "		orientation aimed 4 0.2\n"
+        "		speed 80 to 120\n"
+        "		size 1 to 0.5\n"
+        "		gravity 120\n"
+        "		fadeOut 0.7\n"
+        "		color 1 0.8 0.4 1\n"
+        "	}\n"
+        "}\n"
+        "particle test_fire\n"
+        "{\n"
+        "	{\n"
+        "		count 30\n"
+        "		material textures/particles/fire\n"
+        "		time 1.5\n"
+        "		bunching 0.8\n"
+        "		distribution cylinder 12 12 2 1.5\n"
+        "		direction cone 15\n"
+        "		orientation view\n"
+        "		animationFrames 8\n"
+        "		animationrate 12\n"
+        "		speed 30\n"
+        "		size 12 to 4\n"
+        "		angle 0\n"
+        "		fadeIndex 0.3\n"
+        "		entityColor 1\n"
+        "	}\n"
+        "	{\n"
+        "		count 12\n"
+        "		material textures/particles/embers\n"
+        "		time 2.0\n"
+        "		timeOffset 0.4\n"
+        "		cycles 3\n"
+        "		distribution rect 8 8 0\n"
+        "		orientation z\n"
+        "		size 2\n"
+        "		rotation 90\n"
+        "	}\n"
+        "}\n"
+        "particle test_flies\n"
+        "{\n"
+        "	{\n"
+        "		count 24\n"
+        "		material textures/particles/fly\n"
+        "		time 6.0\n"
+        "		customPath flies 2 1.5 24\n"
+        "		orientation view\n"
+        "		size 0.8\n"
+        "	}\n"
+        "	{\n"
+        "		count 20\n"
+        "		material textures/particles/wisp\n"
+        "		time 3.0\n"
+        "		customPath helix 16 16 32 4 8\n"
+        "		orientation x\n"
+        "		size 3 to 1\n"
+        "		aspect 1 to 2\n"
+        "	}\n"
+        "}\n";
+
+    // Deterministic pseudo-random numbers in [0..1)
+    double random(std::size_t& seed)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>((seed >> 11) & 0xfffff) / 0x100000;
+    }
+
+    std::vector<particles::ParticleDefPtr> parseDecls()
+    {
+        std::vector<particles::ParticleDefPtr> defs;
+
+        std::istringstream stream(SAMPLE_DECLS);
+        parser::BasicDefTokeniser<std::istream> tok(stream);
+
+        while (tok.hasMoreTokens())
+        {
+            tok.assertNextToken("particle");
+
+            defs.push_back(std::make_shared<particles::ParticleDef>(tok.nextToken()));
+            tok.assertNextToken("{");
+
+            defs.back()->parseFromTokens(tok);
+        }
+
+        return defs;
+    }
+
+    // The per-emitter state the stages are referencing, like RenderableParticle
+    struct Emitter
+    {
+        particles::ParticleDefPtr def;
+        Rand48::result_type seed;
+        Vector3 direction;
+        Vector3 entityColour;
+    };
+
+    typedef std::vector<particles::RenderableParticleStagePtr> Stages;
+
+    // Creates the stages of all emitters, the same way RenderableParticle::setupStages does
+    Stages createStages(const std::vector<Emitter>& emitters)
+    {
+        Stages stages;
+
+        for (const Emitter& emitter : emitters)
+        {
+            Rand48 random(emitter.seed);
+
+            for (std::size_t i = 0; i < emitter.def->getNumStages(); ++i)
+            {
+                stages.push_back(std::make_shared<particles::RenderableParticleStage>(
+                    emitter.def->getStage(i), random, emitter.direction, emitter.entityColour));
+            }
+        }
+
+        return stages;
+    }
+
+    // Places the given number of emitters, using the sample decls in turn
+    std::vector<Emitter> createEmitters(std::size_t numEmitters)
+    {
+        std::vector<particles::ParticleDefPtr> defs = parseDecls();
+
+        std::size_t seed = 1;
+        std::vector<Emitter> emitters(numEmitters);
+
+        for (std::size_t i = 0; i < numEmitters; ++i)
+        {
+            emitters[i].def = defs[i % defs.size()];
+            emitters[i].seed = static_cast<Rand48::result_type>(random(seed) * 0x100000);
+            emitters[i].direction = Vector3(random(seed) - 0.5, random(seed) - 0.5, 1);
+            emitters[i].entityColour = Vector3(random(seed), random(seed), random(seed));
+        }
+
+        return emitters;
+    }
+
+    // Frame time in msecs and camera rotation
+    std::size_t getTime(std::size_t frame)
+    {
+        return frame * 16;
+    }
+
+    Matrix4 getView(std::size_t frame)
+    {
+        return Matrix4::getRotationAboutZDegrees(frame * 1.5);
+    }
+
+    // Updates the persistent stages like RenderableParticle::update does
+    void updateStages(const Stages& stages, std::size_t time, const Matrix4& view,
+        std::size_t numThreads)
+    {
+        std::vector<particles::RenderableParticleBunch::Job> jobs;
+
+        for (const particles::RenderableParticleStagePtr& stage : stages)
+        {
+            stage->prepareUpdate(time, view, jobs);
+        }
+
+        particles::RenderableParticleBunch::updateInParallel(jobs, numThreads);
+    }
+
+    // Generates the geometry of new stages from scratch, nothing is cached or re-used
+    Stages createUpdatedStages(const std::vector<Emitter>& emitters, std::size_t time,
+        const Matrix4& view)
+    {
+        Stages stages = createStages(emitters);
+
+        for (const particles::RenderableParticleStagePtr& stage : stages)
+        {
+            stage->update(time, view);
+        }
+
+        return stages;
+    }
+
+    std::size_t countQuads(const Stages& stages)
+    {
+        std::size_t numQuads = 0;
+
+        for (const particles::RenderableParticleStagePtr& stage : stages)
+        {
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                if (stage->getBunch(i))
+                {
+                    numQuads += stage->getBunch(i)->getQuads().size();
+                }
+            }
+        }
+
+        return numQuads;
+    }
+
+    const std::size_t NUM_EMITTERS = 16;
+    const std::size_t NUM_FRAMES = 120;
+
+    bool isIdentical(const particles::RenderableParticleBunch::Quads& a,
+                     const particles::RenderableParticleBunch::Quads& b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+
+        // Compare the bits, degenerate trails of aimed particles have NaN vertices
+        return a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(particles::ParticleQuad)) == 0;
+    }
+
+    void checkIdentical(const Stages& expected, const Stages& stages)
+    {
+        BOOST_REQUIRE_EQUAL(expected.size(), stages.size());
+
+        for (std::size_t s = 0; s < expected.size(); ++s)
+        {
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                const particles::RenderableParticleBunchPtr& bunchA = expected[s]->getBunch(i);
+                const particles::RenderableParticleBunchPtr& bunchB = stages[s]->getBunch(i);
+
+                if (!bunchA || !bunchB)
+                {
+                    // An inactive bunch must not be matched by one having geometry
+                    BOOST_CHECK(!bunchA || bunchA->getQuads().empty());
+                    BOOST_CHECK(!bunchB || bunchB->getQuads().empty());
+                    continue;
+                }
+
+                if (!isIdentical(bunchA->getQuads(), bunchB->getQuads()))
+                {
+                    BOOST_ERROR("Geometry of stage " << s << ", bunch " << i << " differs");
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(runningTime)
+{
+    std::vector<Emitter> emitters = createEmitters(NUM_EMITTERS);
+
+    Stages single = createStages(emitters);
+    Stages threaded = createStages(emitters);
+
+    std::size_t numQuads = 0;
+
+    for (std::size_t f = 0; f < NUM_FRAMES; ++f)
+    {
+        Stages fresh = createUpdatedStages(emitters, getTime(f), getView(f));
+
+        updateStages(single, getTime(f), getView(f), 1);
+        updateStages(threaded, getTime(f), getView(f), 4);
+
+        checkIdentical(fresh, single);
+        checkIdentical(fresh, threaded);
+
+        numQuads += countQuads(fresh);
+    }
+
+    BOOST_CHECK_GT(numQuads, 0);
+}
+
+BOOST_AUTO_TEST_CASE(stoppedTime)
+{
+    std::vector<Emitter> emitters = createEmitters(NUM_EMITTERS);
+    Stages stages = createStages(emitters);
+
+    std::size_t stoppedTime = getTime(NUM_FRAMES / 2);
+
+    // The camera keeps rotating, only the quads are re-built
+    for (std::size_t f = 0; f < NUM_FRAMES; ++f)
+    {
+        updateStages(stages, stoppedTime, getView(f), 4);
+        checkIdentical(createUpdatedStages(emitters, stoppedTime, getView(f)), stages);
+    }
+
+    // Repeated passes with a fixed camera
+    Stages fresh = createUpdatedStages(emitters, stoppedTime, getView(0));
+
+    for (std::size_t f = 0; f < 3; ++f)
+    {
+        updateStages(stages, stoppedTime, getView(0), 4);
+        checkIdentical(fresh, stages);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rewindTime)
+{
+    std::vector<Emitter> emitters = createEmitters(NUM_EMITTERS);
+    Stages stages = createStages(emitters);
+
+    for (std::size_t f = 0; f < NUM_FRAMES; ++f)
+    {
+        updateStages(stages, getTime(f), getView(f), 4);
+    }
+
+    // Jumping back, e.g. when restarting the preview, re-creates past cycles
+    for (std::size_t f : { std::size_t(0), NUM_FRAMES / 4, NUM_FRAMES / 8 })
+    {
+        updateStages(stages, getTime(f), getView(f), 4);
+        checkIdentical(createUpdatedStages(emitters, getTime(f), getView(f)), stages);
+    }
+}
@@ -0,0 +1,823 @@
+#include "FlatOctree.h"
+
+#include "inode.h"
+#include "ivolumetest.h"
+#include "math/Frustum.h"
+#include "math/ViewProjection.h"
+
+#include "OctreeNode.h"
+
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_OCTREE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace scene
+{
+
+namespace
+{
+	const std::size_t NO_CELL = std::numeric_limits<std::size_t>::max();
+	const std::size_t NO_MEMBER = std::numeric_limits<std::size_t>::max();
+	const std::size_t ROOT_CELL = 0;
+
+	// Same values as used by the Octree
+	const double START_SIZE = 512;
+	const double MAX_WORLD_COORD = 65536;
+
+	// The float member bounds are enlarged by this amount, to make up for
+	// the rounding errors of the culling calculation
+	const float CULLING_EPSILON = 0.5f;
+
+	// Trees with fewer members are always culled by the calling thread
+	const std::size_t PARALLEL_THRESHOLD = 10000;
+
+	// Cells up to this depth are distributed over the threads
+	const std::size_t PARALLEL_SPLIT_DEPTH = 2;
+
+	// A cell or a member of a cell waiting to be visited by the front-to-back traversal
+	struct DepthSortedEntry
+	{
+		double depth;
+		std::size_t cell;
+		std::size_t member; // NO_MEMBER for the cell itself
+
+		// Inverted, the priority queue returns the largest element first
+		bool operator<(const DepthSortedEntry& other) const
+		{
+			return depth > other.depth;
+		}
+	};
+
+	// The ISPNode view of a cell, see getRoot()
+	class SnapshotNode :
+		public ISPNode
+	{
+	public:
+		ISPNodeWeakPtr parent;
+		AABB bounds;
+		NodeList children;
+		MemberList members;
+
+		ISPNodePtr getParent() const override
+		{
+			return parent.lock();
+		}
+
+		const AABB& getBounds() const override
+		{
+			return bounds;
+		}
+
+		const NodeList& getChildNodes() const override
+		{
+			return children;
+		}
+
+		bool isLeaf() const override
+		{
+			return children.empty();
+		}
+
+		const MemberList& getMembers() const override
+		{
+			return members;
+		}
+	};
+}
+
+// The six frustum planes, prepared for the member tests
+class FlatOctree::CullPlanes
+{
+private:
+	float _normalX[6];
+	float _normalY[6];
+	float _normalZ[6];
+	float _absX[6];
+	float _absY[6];
+	float _absZ[6];
+	float _dist[6];
+
+public:
+	CullPlanes(const Frustum& frustum)
+	{
+		const Plane3* planes[6] = {
+			&frustum.right, &frustum.left, &frustum.bottom,
+			&frustum.top, &frustum.back, &frustum.front
+		};
+
+		for (std::size_t i = 0; i < 6; ++i)
+		{
+			_normalX[i] = static_cast<float>(planes[i]->normal().x());
+			_normalY[i] = static_cast<float>(planes[i]->normal().y());
+			_normalZ[i] = static_cast<float>(planes[i]->normal().z());
+			_absX[i] = std::fabs(_normalX[i]);
+			_absY[i] = std::fabs(_normalY[i]);
+			_absZ[i] = std::fabs(_normalZ[i]);
+			_dist[i] = static_cast<float>(planes[i]->dist());
+		}
+	}
+
+	// Returns true if the member is entirely behind one of the planes,
+	// this is the same test as AABB::classifyPlane() does
+	bool isOutside(const MemberBlock& block, std::size_t i) const
+	{
+		for (std::size_t p = 0; p < 6; ++p)
+		{
+			float distance = _normalX[p] * block.originX[i] + _normalY[p] * block.originY[i] +
+				_normalZ[p] * block.originZ[i] + _absX[p] * block.extentsX[i] +
+				_absY[p] * block.extentsY[i] + _absZ[p] * block.extentsZ[i] - _dist[p];
+
+			if (distance < 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+#ifdef FLAT_OCTREE_SSE
+	// Tests the four members starting at the given index, returns a bit mask
+	// with the bits of the members which are outside set
+	int getOutsideMask(const MemberBlock& block, std::size_t i) const
+	{
+		__m128 originX = _mm_loadu_ps(&block.originX[i]);
+		__m128 originY = _mm_loadu_ps(&block.originY[i]);
+		__m128 originZ = _mm_loadu_ps(&block.originZ[i]);
+		__m128 extentsX = _mm_loadu_ps(&block.extentsX[i]);
+		__m128 extentsY = _mm_loadu_ps(&block.extentsY[i]);
+		__m128 extentsZ = _mm_loadu_ps(&block.extentsZ[i]);
+
+		__m128 zero = _mm_setzero_ps();
+		__m128 outside = zero;
+
+		for (std::size_t p = 0; p < 6; ++p)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(_normalX[p]), originX),
+						   _mm_mul_ps(_mm_set1_ps(_normalY[p]), originY)),
+				_mm_mul_ps(_mm_set1_ps(_normalZ[p]), originZ));
+
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(_absX[p]), extentsX));
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(_absY[p]), extentsY));
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(_absZ[p]), extentsZ));
+			distance = _mm_sub_ps(distance, _mm_set1_ps(_dist[p]));
+
+			// NaN distances (infinite extents) compare false and are never culled
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, zero));
+		}
+
+		return _mm_movemask_ps(outside);
+	}
+#endif
+};
+
+// A part of the tree culled by one thread, the members of a single cell
+// or the members of an entire subtree
+struct FlatOctree::WorkItem
+{
+	std::size_t cell;
+	bool subtree;
+	std::vector<const INodePtr*> visible;
+};
+
+void FlatOctree::MemberBlock::push_back(const INodePtr& node, const AABB& aabb)
+{
+	nodes.push_back(node);
+	bounds.push_back(aabb);
+
+	originX.push_back(0);
+	originY.push_back(0);
+	originZ.push_back(0);
+	extentsX.push_back(0);
+	extentsY.push_back(0);
+	extentsZ.push_back(0);
+
+	setBounds(nodes.size() - 1, aabb);
+}
+
+void FlatOctree::MemberBlock::setBounds(std::size_t index, const AABB& aabb)
+{
+	bounds[index] = aabb;
+
+	if (aabb.isValid())
+	{
+		originX[index] = static_cast<float>(aabb.origin.x());
+		originY[index] = static_cast<float>(aabb.origin.y());
+		originZ[index] = static_cast<float>(aabb.origin.z());
+		extentsX[index] = static_cast<float>(aabb.extents.x()) + CULLING_EPSILON;
+		extentsY[index] = static_cast<float>(aabb.extents.y()) + CULLING_EPSILON;
+		extentsZ[index] = static_cast<float>(aabb.extents.z()) + CULLING_EPSILON;
+	}
+	else
+	{
+		const float infinity = std::numeric_limits<float>::infinity();
+
+		originX[index] = 0;
+		originY[index] = 0;
+		originZ[index] = 0;
+		extentsX[index] = infinity;
+		extentsY[index] = infinity;
+		extentsZ[index] = infinity;
+	}
+}
+
+void FlatOctree::MemberBlock::removeAt(std::size_t index)
+{
+	std::size_t last = nodes.size() - 1;
+
+	if (index != last)
+	{
+		nodes[index].swap(nodes[last]);
+		bounds[index] = bounds[last];
+		originX[index] = originX[last];
+		originY[index] = originY[last];
+		originZ[index] = originZ[last];
+		extentsX[index] = extentsX[last];
+		extentsY[index] = extentsY[last];
+		extentsZ[index] = extentsZ[last];
+	}
+
+	nodes.pop_back();
+	bounds.pop_back();
+	originX.pop_back();
+	originY.pop_back();
+	originZ.pop_back();
+	extentsX.pop_back();
+	extentsY.pop_back();
+	extentsZ.pop_back();
+}
+
+void FlatOctree::MemberBlock::clear()
+{
+	nodes.clear();
+	bounds.clear();
+	originX.clear();
+	originY.clear();
+	originZ.clear();
+	extentsX.clear();
+	extentsY.clear();
+	extentsZ.clear();
+}
+
+FlatOctree::FlatOctree() :
+	_numThreads(0)
+{
+	Cell root;
+	root.bounds = AABB(Vector3(0, 0, 0), Vector3(START_SIZE, START_SIZE, START_SIZE));
+	root.parent = NO_CELL;
+	root.firstChild = NO_CELL;
+
+	_cells.push_back(root);
+	_members.resize(1);
+}
+
+void FlatOctree::link(const scene::INodePtr& sceneNode)
+{
+	// Make sure we don't do double-links
+	assert(_locations.find(sceneNode.get()) == _locations.end());
+
+	// Evaluating the bounds might end up in a call to unlink(), take a copy
+	AABB bounds = sceneNode->worldAABB();
+
+	ensureRootSize(bounds);
+
+	linkRecursively(ROOT_CELL, sceneNode, bounds);
+
+	_snapshot.reset();
+}
+
+bool FlatOctree::unlink(const scene::INodePtr& sceneNode)
+{
+	NodeLocations::iterator found = _locations.find(sceneNode.get());
+
+	if (found == _locations.end())
+	{
+		return false;
+	}
+
+	Location location = found->second;
+	_locations.erase(found);
+
+	removeMember(location.cell, location.index);
+
+	_snapshot.reset();
+
+	return true;
+}
+
+void FlatOctree::relink(const std::vector<scene::INodePtr>& sceneNodes)
+{
+	std::vector<std::pair<INodePtr, AABB>> movedNodes;
+	AABB movedBounds;
+
+	for (const INodePtr& sceneNode : sceneNodes)
+	{
+		NodeLocations::iterator found = _locations.find(sceneNode.get());
+
+		if (found == _locations.end()) continue;
+
+		// Take a copy, evaluating the bounds might end up in the scenegraph
+		AABB bounds = sceneNode->worldAABB();
+		Location location = found->second;
+
+		// Most of the transformed nodes are staying in their cell
+		if (isBestFit(location.cell, bounds))
+		{
+			_members[location.cell].setBounds(location.index, bounds);
+			continue;
+		}
+
+		_locations.erase(found);
+		removeMember(location.cell, location.index);
+
+		movedNodes.push_back(std::make_pair(sceneNode, bounds));
+		movedBounds.includeAABB(bounds);
+	}
+
+	// Grow the root for all moved nodes at once, this re-builds the tree
+	ensureRootSize(movedBounds);
+
+	for (const auto& pair : movedNodes)
+	{
+		linkRecursively(ROOT_CELL, pair.first, pair.second);
+	}
+
+	_snapshot.reset();
+}
+
+ISPNodePtr FlatOctree::getRoot() const
+{
+	if (!_snapshot)
+	{
+		_snapshot = createSnapshot(ROOT_CELL, ISPNodePtr());
+	}
+
+	return _snapshot;
+}
+
+std::size_t FlatOctree::size() const
+{
+	return _locations.size();
+}
+
+std::size_t FlatOctree::getNumCells() const
+{
+	return _cells.size();
+}
+
+void FlatOctree::setNumThreads(std::size_t numThreads)
+{
+	_numThreads = numThreads;
+}
+
+bool FlatOctree::foreachMemberInVolume(const VolumeTest& volume, const MemberVisitor& visitor)
+{
+	const Frustum* frustum = volume.getCullingFrustum();
+
+	// Without frustum only the cells are culled, using the VolumeTest
+	std::unique_ptr<CullPlanes> planes(frustum != nullptr ? new CullPlanes(*frustum) : nullptr);
+
+	std::size_t numThreads = _numThreads > 0 ? _numThreads : std::thread::hardware_concurrency();
+
+	if (numThreads <= 1 || _locations.size() < PARALLEL_THRESHOLD)
+	{
+		return visitSubtree(ROOT_CELL, volume, planes.get(), visitor);
+	}
+
+	std::vector<WorkItem> items;
+	collectWorkItems(ROOT_CELL, 0, volume, items);
+
+	std::atomic<std::size_t> nextItem(0);
+
+	auto cullItems = [&]()
+	{
+		for (std::size_t i = nextItem++; i < items.size(); i = nextItem++)
+		{
+			WorkItem& item = items[i];
+
+			auto collect = [&](const INodePtr& node)
+			{
+				item.visible.push_back(&node);
+				return true;
+			};
+
+			if (item.subtree)
+			{
+				visitSubtree(item.cell, volume, planes.get(), collect);
+			}
+			else
+			{
+				visitMembers(item.cell, planes.get(), collect);
+			}
+		}
+	};
+
+	std::vector<std::future<void>> threads;
+
+	for (std::size_t i = 1; i < numThreads; ++i)
+	{
+		threads.push_back(std::async(std::launch::async, cullItems));
+	}
+
+	cullItems();
+
+	for (std::future<void>& thread : threads)
+	{
+		thread.get();
+	}
+
+	// The items are in traversal order, visit them on this thread
+	for (const WorkItem& item : items)
+	{
+		for (const INodePtr* node : item.visible)
+		{
+			if (!visitor(*node))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool FlatOctree::foreachMemberInVolumeFrontToBack(const VolumeTest& volume, const DepthSortedMemberVisitor& visitor)
+{
+	const Frustum* frustum = volume.getCullingFrustum();
+	std::unique_ptr<CullPlanes> planes(frustum != nullptr ? new CullPlanes(*frustum) : nullptr);
+
+	// Any scissor of the volume doesn't affect the depth
+	ViewProjection viewproj(volume.GetProjection().getMultipliedBy(volume.GetModelview()));
+
+	// Members are contained in the bounds of their cell, so a cell is never farther away
+	// than its members and the cells below. The root might hold members exceeding its bounds.
+	std::priority_queue<DepthSortedEntry> queue;
+	queue.push(DepthSortedEntry{ -1, ROOT_CELL, NO_MEMBER });
+
+	while (!queue.empty())
+	{
+		DepthSortedEntry entry = queue.top();
+		queue.pop();
+
+		if (entry.member != NO_MEMBER)
+		{
+			if (!visitor(_members[entry.cell].nodes[entry.member], entry.depth))
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		const MemberBlock& block = _members[entry.cell];
+
+		// Queue the members which are not culled
+		auto queueMember = [&](const INodePtr& node)
+		{
+			std::size_t index = &node - block.nodes.data();
+			queue.push(DepthSortedEntry{ viewproj.getNearestDepth(block.bounds[index]), entry.cell, index });
+			return true;
+		};
+
+		visitMembers(entry.cell, planes.get(), queueMember);
+
+		std::size_t firstChild = _cells[entry.cell].firstChild;
+
+		if (firstChild == NO_CELL)
+		{
+			continue;
+		}
+
+		for (std::size_t child = firstChild; child < firstChild + 8; ++child)
+		{
+			if (volume.TestAABB(_cells[child].bounds) != VOLUME_OUTSIDE)
+			{
+				queue.push(DepthSortedEntry{ viewproj.getNearestDepth(_cells[child].bounds), child, NO_MEMBER });
+			}
+		}
+	}
+
+	return true;
+}
+
+template<typename Visitor>
+bool FlatOctree::visitMembers(std::size_t cell, const CullPlanes* planes, Visitor& visitor) const
+{
+	const MemberBlock& block = _members[cell];
+	std::size_t count = block.size();
+
+	if (planes == nullptr)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (!visitor(block.nodes[i]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	std::size_t i = 0;
+
+#ifdef FLAT_OCTREE_SSE
+	for (; i + 4 <= count; i += 4)
+	{
+		int outside = planes->getOutsideMask(block, i);
+
+		if (outside == 0xf) continue;
+
+		for (std::size_t j = 0; j < 4; ++j)
+		{
+			if ((outside & (1 << j)) == 0 && !visitor(block.nodes[i + j]))
+			{
+				return false;
+			}
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		if (!planes->isOutside(block, i) && !visitor(block.nodes[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template<typename Visitor>
+bool FlatOctree::visitSubtree(std::size_t cell, const VolumeTest& volume, const CullPlanes* planes,
+							  Visitor& visitor) const
+{
+	if (!visitMembers(cell, planes, visitor))
+	{
+		return false;
+	}
+
+	std::size_t firstChild = _cells[cell].firstChild;
+
+	if (firstChild == NO_CELL)
+	{
+		return true;
+	}
+
+	for (std::size_t child = firstChild; child < firstChild + 8; ++child)
+	{
+		if (volume.TestAABB(_cells[child].bounds) == VOLUME_OUTSIDE)
+		{
+			continue;
+		}
+
+		if (!visitSubtree(child, volume, planes, visitor))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FlatOctree::collectWorkItems(std::size_t cell, std::size_t depth, const VolumeTest& volume,
+								  std::vector<WorkItem>& items) const
+{
+	std::size_t firstChild = _cells[cell].firstChild;
+
+	WorkItem item;
+	item.cell = cell;
+	item.subtree = firstChild == NO_CELL || depth >= PARALLEL_SPLIT_DEPTH;
+
+	items.push_back(item);
+
+	if (item.subtree)
+	{
+		return;
+	}
+
+	for (std::size_t child = firstChild; child < firstChild + 8; ++child)
+	{
+		if (volume.TestAABB(_cells[child].bounds) != VOLUME_OUTSIDE)
+		{
+			collectWorkItems(child, depth + 1, volume, items);
+		}
+	}
+}
+
+void FlatOctree::linkRecursively(std::size_t cell, const INodePtr& sceneNode, const AABB& bounds)
+{
+	// Nodes with invalid bounds stay in the given cell
+	if (bounds.isValid())
+	{
+		// Descend as long as one of the children fits
+		while (_cells[cell].firstChild != NO_CELL)
+		{
+			std::size_t firstChild = _cells[cell].firstChild;
+			std::size_t fittingChild = NO_CELL;
+
+			for (std::size_t child = firstChild; child < firstChild + 8; ++child)
+			{
+				if (_cells[child].bounds.contains(bounds))
+				{
+					fittingChild = child;
+					break;
+				}
+			}
+
+			if (fittingChild == NO_CELL) break;
+
+			cell = fittingChild;
+		}
+	}
+
+	addMember(cell, sceneNode, bounds);
+
+	// Subdivide leaves exceeding the threshold, as long as they're large enough
+	if (_cells[cell].firstChild == NO_CELL &&
+		_members[cell].size() >= SUBDIVISION_THRESHOLD &&
+		_cells[cell].bounds.extents.x() > MIN_NODE_EXTENTS)
+	{
+		subdivide(cell);
+
+		// Re-distribute the members using the bounds they have been linked with
+		MemberBlock oldMembers;
+		std::swap(oldMembers, _members[cell]);
+
+		for (std::size_t i = 0; i < oldMembers.size(); ++i)
+		{
+			_locations.erase(oldMembers.nodes[i].get());
+			linkRecursively(cell, oldMembers.nodes[i], oldMembers.bounds[i]);
+		}
+	}
+}
+
+void FlatOctree::addMember(std::size_t cell, const INodePtr& sceneNode, const AABB& bounds)
+{
+	MemberBlock& block = _members[cell];
+
+	Location location = { cell, block.size() };
+	_locations[sceneNode.get()] = location;
+
+	block.push_back(sceneNode, bounds);
+}
+
+void FlatOctree::removeMember(std::size_t cell, std::size_t index)
+{
+	MemberBlock& block = _members[cell];
+
+	block.removeAt(index);
+
+	// The former last member took the free slot
+	if (index < block.size())
+	{
+		_locations[block.nodes[index].get()].index = index;
+	}
+}
+
+bool FlatOctree::isBestFit(std::size_t cell, const AABB& bounds) const
+{
+	// Invalid bounds are always linked to the root
+	if (!bounds.isValid())
+	{
+		return cell == ROOT_CELL;
+	}
+
+	// Bounds exceeding the root might require the tree to grow
+	if (!_cells[cell].bounds.contains(bounds))
+	{
+		return false;
+	}
+
+	std::size_t firstChild = _cells[cell].firstChild;
+
+	if (firstChild != NO_CELL)
+	{
+		for (std::size_t child = firstChild; child < firstChild + 8; ++child)
+		{
+			if (_cells[child].bounds.contains(bounds))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void FlatOctree::subdivide(std::size_t cell)
+{
+	std::size_t firstChild = _cells.size();
+
+	// Take copies, the vector is growing below
+	AABB bounds = _cells[cell].bounds;
+	_cells[cell].firstChild = firstChild;
+
+	// Each child has half the extents, same order as the OctreeNode children
+	Vector3 childExtents = bounds.extents * 0.5;
+
+	Vector3 x(childExtents.x(), 0, 0);
+	Vector3 y(0, childExtents.y(), 0);
+	Vector3 z(0, 0, childExtents.z());
+
+	Vector3 baseUpper = bounds.origin + z;
+	Vector3 baseLower = bounds.origin - z;
+
+	Vector3 origins[8] = {
+		baseUpper + x + y, baseUpper + x - y, baseUpper - x - y, baseUpper - x + y,
+		baseLower + x + y, baseLower + x - y, baseLower - x - y, baseLower - x + y
+	};
+
+	for (const Vector3& origin : origins)
+	{
+		Cell child;
+		child.bounds = AABB(origin, childExtents);
+		child.parent = cell;
+		child.firstChild = NO_CELL;
+
+		_cells.push_back(child);
+	}
+
+	_members.resize(_cells.size());
+}
+
+void FlatOctree::ensureRootSize(const AABB& bounds)
+{
+	if (!bounds.isValid()) return; // skip this for invalid bounds
+
+	AABB rootBounds = _cells[ROOT_CELL].bounds;
+
+	if (rootBounds.contains(bounds)) return;
+
+	while (!rootBounds.contains(bounds))
+	{
+		// Don't go beyond the map limits
+		if (rootBounds.extents.x() * 2 > MAX_WORLD_COORD)
+		{
+			break;
+		}
+
+		rootBounds.extents *= 2;
+	}
+
+	if (rootBounds.extents == _cells[ROOT_CELL].bounds.extents) return;
+
+	// Collect all members and build the tree from scratch, this happens
+	// only a few times until the tree covers the whole map
+	MemberBlock allMembers;
+
+	for (MemberBlock& block : _members)
+	{
+		for (std::size_t i = 0; i < block.size(); ++i)
+		{
+			allMembers.push_back(block.nodes[i], block.bounds[i]);
+		}
+	}
+
+	_cells.resize(1);
+	_cells[ROOT_CELL].bounds = rootBounds;
+	_cells[ROOT_CELL].firstChild = NO_CELL;
+
+	_members.clear();
+	_members.resize(1);
+	_locations.clear();
+
+	for (std::size_t i = 0; i < allMembers.size(); ++i)
+	{
+		linkRecursively(ROOT_CELL, allMembers.nodes[i], allMembers.bounds[i]);
+	}
+}
+
+ISPNodePtr FlatOctree::createSnapshot(std::size_t cell, const ISPNodePtr& parent) const
+{
+	std::shared_ptr<SnapshotNode> node = std::make_shared<SnapshotNode>();
+
+	node->parent = parent;
+	node->bounds = _cells[cell].bounds;
+	node->members.assign(_members[cell].nodes.begin(), _members[cell].nodes.end());
+
+	std::size_t firstChild = _cells[cell].firstChild;
+
+	if (firstChild != NO_CELL)
+	{
+		for (std::size_t child = firstChild; child < firstChild + 8; ++child)
+		{
+			node->children.push_back(createSnapshot(child, node));
+		}
+	}
+
+	return node;
+}
+
+} // namespace scene
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "ispacepartition.h"
+#include "math/AABB.h"
+
+#include <unordered_map>
+#include <vector>
+
+class Frustum;
+
+namespace scene
+{
+
+/**
+ * A FlatOctree subdivides space the same way as the Octree does,
+ * but keeps its nodes ("cells") in one contiguous array, the 8 children of
+ * a cell are stored next to each other. The members of each cell are stored
+ * along with their bounds as structure of arrays, which allows the traversal
+ * to cull the members against the planes of a view frustum four at a time
+ * (using SSE2 where available), without calling into the scene nodes.
+ *
+ * The member bounds are taken when a node is linked, the scenegraph takes
+ * care of re-linking nodes whenever their bounds change, preferably in
+ * batches through relink(). Members are removed
+ * by moving the last member of the cell into their slot, a lookup table holds
+ * the position of each node.
+ *
+ * Large trees can be culled by several threads at once (see setNumThreads()),
+ * the visitor is always invoked on the calling thread, in the same order as
+ * a single-threaded traversal would do.
+ *
+ * The ISPNode hierarchy returned by getRoot() is a snapshot, which is rebuilt
+ * on demand after the tree has changed. It is meant for debug visualisation.
+ */
+class FlatOctree :
+	public ISpacePartitionSystem
+{
+private:
+	struct Cell
+	{
+		AABB bounds;
+		std::size_t parent;
+		std::size_t firstChild; // NO_CELL for leaves, the 8 children follow
+	};
+
+	// The members of a cell, their bounds in structure of arrays layout.
+	// Members with invalid bounds get infinite extents to never be culled.
+	struct MemberBlock
+	{
+		std::vector<INodePtr> nodes;
+		std::vector<AABB> bounds;
+
+		std::vector<float> originX;
+		std::vector<float> originY;
+		std::vector<float> originZ;
+		std::vector<float> extentsX;
+		std::vector<float> extentsY;
+		std::vector<float> extentsZ;
+
+		void push_back(const INodePtr& node, const AABB& aabb);
+
+		// Replaces the bounds of the given member
+		void setBounds(std::size_t index, const AABB& aabb);
+
+		// Replaces the given member with the last one
+		void removeAt(std::size_t index);
+
+		void clear();
+
+		std::size_t size() const
+		{
+			return nodes.size();
+		}
+	};
+
+	std::vector<Cell> _cells;
+	std::vector<MemberBlock> _members;
+
+	struct Location
+	{
+		std::size_t cell;
+		std::size_t index;
+	};
+
+	// Maps scene nodes against their position in the member blocks
+	typedef std::unordered_map<INode*, Location> NodeLocations;
+	NodeLocations _locations;
+
+	std::size_t _numThreads;
+
+	// The snapshot returned by getRoot()
+	mutable ISPNodePtr _snapshot;
+
+public:
+	FlatOctree();
+
+	void link(const scene::INodePtr& sceneNode) override;
+	bool unlink(const scene::INodePtr& sceneNode) override;
+
+	// Nodes still fitting their cell get their bounds updated in place, the
+	// others are removed first and linked again after growing the root once
+	void relink(const std::vector<scene::INodePtr>& sceneNodes) override;
+
+	ISPNodePtr getRoot() const override;
+
+	bool foreachMemberInVolume(const VolumeTest& volume, const MemberVisitor& visitor) override;
+
+	// Always single-threaded, the cells and members are visited through a priority queue
+	bool foreachMemberInVolumeFrontToBack(const VolumeTest& volume, const DepthSortedMemberVisitor& visitor) override;
+
+	// Number of linked nodes
+	std::size_t size() const;
+
+	// Number of cells, including empty ones
+	std::size_t getNumCells() const;
+
+	// The number of threads used to cull large trees, including the calling
+	// one. Defaults to 0, which uses the hardware concurrency. The VolumeTest
+	// passed to foreachMemberInVolume() is then used by several threads at once.
+	void setNumThreads(std::size_t numThreads);
+
+private:
+	class CullPlanes;
+	struct WorkItem;
+
+	// Adds the node to the smallest cell below the given one fitting its bounds
+	void linkRecursively(std::size_t cell, const INodePtr& sceneNode, const AABB& bounds);
+	void addMember(std::size_t cell, const INodePtr& sceneNode, const AABB& bounds);
+	void removeMember(std::size_t cell, std::size_t index);
+
+	// True if the given cell is the one linkRecursively() would choose for the bounds
+	bool isBestFit(std::size_t cell, const AABB& bounds) const;
+
+	void subdivide(std::size_t cell);
+
+	// Doubles the root size until the bounds fit, re-linking all members
+	void ensureRootSize(const AABB& bounds);
+
+	// Visits the members of the given cell which are not culled, returns false if the visitor did
+	template<typename Visitor>
+	bool visitMembers(std::size_t cell, const CullPlanes* planes, Visitor& visitor) const;
+
+	// Visits the members of the given cell and the non-culled cells below it
+	template<typename Visitor>
+	bool visitSubtree(std::size_t cell, const VolumeTest& volume, const CullPlanes* planes,
+					  Visitor& visitor) const;
+
+	// Splits the tree into work items in traversal order, for parallel culling
+	void collectWorkItems(std::size_t cell, std::size_t depth, const VolumeTest& volume,
+						  std::vector<WorkItem>& items) const;
+
+	ISPNodePtr createSnapshot(std::size_t cell, const ISPNodePtr& parent) const;
+};
+
+} // namespace scene
@@ -1,9 +1,13 @@
 #include "Octree.h"
 
 #include "inode.h"
+#include "ivolumetest.h"
+#include "math/ViewProjection.h"
 
 #include "OctreeNode.h"
 
+#include <queue>
+
 namespace scene
 {
 
@@ -13,6 +17,20 @@ namespace
 	const float MAX_WORLD_COORD = 65536;
 
 	const AABB START_AABB(Vector3(0,0,0), Vector3(START_SIZE, START_SIZE, START_SIZE));
+
+	// An octree node or one of its members waiting to be visited front to back
+	struct DepthSortedEntry
+	{
+		double depth;
+		const ISPNode* node;
+		const INodePtr* member; // NULL for the octree node itself
+
+		// Inverted, the priority queue returns the largest element first
+		bool operator<(const DepthSortedEntry& other) const
+		{
+			return depth > other.depth;
+		}
+	};
 }
 
 Octree::Octree()
@@ -120,12 +138,111 @@ bool Octree::unlink(const scene::INodePtr& sceneNode)
 	return false;
 }
 
+void Octree::relink(const std::vector<scene::INodePtr>& sceneNodes)
+{
+	for (const scene::INodePtr& node : sceneNodes)
+	{
+		if (unlink(node))
+		{
+			link(node);
+		}
+	}
+}
+
 // Returns the root node of this SP tree
 ISPNodePtr Octree::getRoot() const
 {
 	return _root;
 }
 
+bool Octree::foreachMemberInVolume(const VolumeTest& volume, const MemberVisitor& visitor)
+{
+	return foreachMemberInVolume_r(*_root, volume, visitor);
+}
+
+bool Octree::foreachMemberInVolume_r(const ISPNode& node, const VolumeTest& volume,
+									 const MemberVisitor& visitor)
+{
+	// Visit all members
+	const ISPNode::MemberList& members = node.getMembers();
+
+	for (ISPNode::MemberList::const_iterator m = members.begin();
+		 m != members.end(); /* in-loop increment */)
+	{
+		// We're done, as soon as the visitor returns FALSE
+		if (!visitor(*m++))
+		{
+			return false;
+		}
+	}
+
+	// Now consider the children
+	const ISPNode::NodeList& children = node.getChildNodes();
+
+	for (ISPNode::NodeList::const_iterator i = children.begin(); i != children.end(); ++i)
+	{
+		if (volume.TestAABB((*i)->getBounds()) == VOLUME_OUTSIDE)
+		{
+			// Skip this node, not visible
+			continue;
+		}
+
+		// Traverse all the children too, enter recursion
+		if (!foreachMemberInVolume_r(**i, volume, visitor))
+		{
+			// The visitor returned false somewhere in the recursion depths, propagate this message
+			return false;
+		}
+	}
+
+	return true; // continue traversal
+}
+
+bool Octree::foreachMemberInVolumeFrontToBack(const VolumeTest& volume, const DepthSortedMemberVisitor& visitor)
+{
+	ViewProjection viewproj(volume.GetProjection().getMultipliedBy(volume.GetModelview()));
+
+	std::priority_queue<DepthSortedEntry> queue;
+	queue.push(DepthSortedEntry{ -1, _root.get(), nullptr });
+
+	while (!queue.empty())
+	{
+		DepthSortedEntry entry = queue.top();
+		queue.pop();
+
+		if (entry.member != nullptr)
+		{
+			if (!visitor(*entry.member, entry.depth))
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		// Members are culled before they're queued, to keep the queue small
+		for (const INodePtr& member : entry.node->getMembers())
+		{
+			const AABB& bounds = member->worldAABB();
+
+			if (volume.TestAABB(bounds) != VOLUME_OUTSIDE)
+			{
+				queue.push(DepthSortedEntry{ viewproj.getNearestDepth(bounds), entry.node, &member });
+			}
+		}
+
+		for (const ISPNodePtr& child : entry.node->getChildNodes())
+		{
+			if (volume.TestAABB(child->getBounds()) != VOLUME_OUTSIDE)
+			{
+				queue.push(DepthSortedEntry{ viewproj.getNearestDepth(child->getBounds()), child.get(), nullptr });
+			}
+		}
+	}
+
+	return true;
+}
+
 void Octree::notifyLink(const scene::INodePtr& sceneNode, OctreeNode* node)
 {
 	std::pair<NodeMapping::iterator, bool> result =
@@ -60,9 +60,18 @@ public:
 	// Unlink this node from the SP tree, returns true if found
 	bool unlink(const scene::INodePtr& sceneNode);
 
+	// Unlinks and re-links each of the given nodes
+	void relink(const std::vector<scene::INodePtr>& sceneNodes);
+
 	// Returns the root node of this SP tree
 	ISPNodePtr getRoot() const;
 
+	// Visits the members of all octree nodes intersecting the volume
+	bool foreachMemberInVolume(const VolumeTest& volume, const MemberVisitor& visitor);
+
+	// Visits the members ordered by depth, descending into the nearest octree nodes first
+	bool foreachMemberInVolumeFrontToBack(const VolumeTest& volume, const DepthSortedMemberVisitor& visitor);
+
 	// Callback used by the OctreeNodes to let the tree update its caching structures
 	void notifyLink(const scene::INodePtr& sceneNode, OctreeNode* node);
 	void notifyUnlink(const scene::INodePtr& sceneNode, OctreeNode* node);
@@ -74,6 +83,10 @@ public:
 #endif
 
 private:
+	// Recursive method used to descend the tree, returns FALSE if the visitor signaled stop
+	bool foreachMemberInVolume_r(const ISPNode& node, const VolumeTest& volume,
+								 const MemberVisitor& visitor);
+
 	/**
 	 * This is called whenever a node is linked into the octree
 	 * and ensures that the topmost octree node (the root node) is
@@ -7,7 +7,7 @@
 #include "debugging/debugging.h"
 
 #include "math/AABB.h"
-#include "Octree.h"
+#include "FlatOctree.h"
 #include "SceneGraphFactory.h"
 #include "util/ScopedBoolLock.h"
 
@@ -15,9 +15,7 @@ namespace scene
 {
 
 SceneGraph::SceneGraph() :
-	_spacePartition(new Octree),
-	_visitedSPNodes(0),
-	_skippedSPNodes(0),
+	_spacePartition(new FlatOctree),
     _traversalOngoing(false)
 {}
 
@@ -85,7 +83,10 @@ void SceneGraph::setRoot(const IMapRootNodePtr& newRoot)
 	_root = newRoot;
 
 	// Refresh the space partition class
-	_spacePartition = ISpacePartitionSystemPtr(new Octree);
+	_spacePartition = ISpacePartitionSystemPtr(new FlatOctree);
+
+	_boundsChangedNodes.clear();
+	_boundsChangedSet.clear();
 
 	if (_root)
 	{
@@ -138,6 +139,12 @@ void SceneGraph::erase(const INodePtr& node)
         return;
     }
 
+    // Don't keep removed nodes in the pending list
+    if (_boundsChangedSet.find(node.get()) != _boundsChangedSet.end())
+    {
+        flushBoundsChanges();
+    }
+
 	_spacePartition->unlink(node);
 
 	// Fire the onRemove event on the Node
@@ -155,17 +162,12 @@ void SceneGraph::erase(const INodePtr& node)
 
 void SceneGraph::nodeBoundsChanged(const INodePtr& node)
 {
-    if (_traversalOngoing)
+    // Transforming a selection reports lots of nodes at once, defer the
+    // re-linking until the space partition is needed the next time
+    if (_boundsChangedSet.insert(node.get()).second)
     {
-        _actionBuffer.push_back(NodeAction(BoundsChange, node));
-        return;
+        _boundsChangedNodes.push_back(node);
     }
-
-	if (_spacePartition->unlink(node))
-	{
-		// unlink returned true, so the given node was linked before => re-link it
-		_spacePartition->link(node);
-	}
 }
 
 void SceneGraph::foreachNode(const INode::VisitorFunc& functor)
@@ -215,21 +217,47 @@ void SceneGraph::foreachNodeInVolume(const VolumeTest& volume, const INode::Visi
     // changes during traversal so let's call this now. If nothing got changed, this call is very cheap.
     if (_root != nullptr) _root->worldAABB();
 
+    // Re-link all nodes which got new bounds since the last traversal, like
+    // the ones moved by a manipulator drag
+    flushBoundsChanges();
+
     {
         // Buffer any calls that might happen in between
         util::ScopedBoolLock traversal(_traversalOngoing);
 
         // Descend the SpacePartition tree and call the walker for each (partially) visible member
-        ISPNodePtr root = _spacePartition->getRoot();
+        _spacePartition->foreachMemberInVolume(volume, [&](const INodePtr& node)
+        {
+            // Skip hidden nodes, if specified
+            if (!visitHidden && !node->visible())
+            {
+                return true;
+            }
+
+            return functor(node);
+        });
+    }
 
-        _visitedSPNodes = _skippedSPNodes = 0;
+    // Traversal finished, flush the action buffer
+    flushActionBuffer();
+}
+
+void SceneGraph::foreachVisibleNodeInVolumeFrontToBack(const VolumeTest& volume, const DepthSortedVisitorFunc& functor)
+{
+    // Same preparations as in foreachNodeInVolume() above
+    if (_root != nullptr) _root->worldAABB();
 
-        foreachNodeInVolume_r(*root, volume, functor, visitHidden);
+    flushBoundsChanges();
+
+    {
+        util::ScopedBoolLock traversal(_traversalOngoing);
 
-        _visitedSPNodes = _skippedSPNodes = 0;
+        _spacePartition->foreachMemberInVolumeFrontToBack(volume, [&](const INodePtr& node, double nearestDepth)
+        {
+            return !node->visible() || functor(node, nearestDepth);
+        });
     }
 
-    // Traversal finished, flush the action buffer
     flushActionBuffer();
 }
 
@@ -249,56 +277,13 @@ void SceneGraph::foreachVisibleNodeInVolume(const VolumeTest& volume, Walker& wa
 		false); // don't visit hidden
 }
 
-bool SceneGraph::foreachNodeInVolume_r(const ISPNode& node, const VolumeTest& volume, 
-									   const INode::VisitorFunc& functor, bool visitHidden)
-{
-	_visitedSPNodes++;
-
-	// Visit all members
-	const ISPNode::MemberList& members = node.getMembers();
-
-	for (ISPNode::MemberList::const_iterator m = members.begin();
-		 m != members.end(); /* in-loop increment */)
-	{
-		// Skip hidden nodes, if specified
-		if (!visitHidden && !(*m)->visible())
-		{
-			++m;
-			continue;
-		}
-
-		// We're done, as soon as the walker returns FALSE
-		if (!functor(*m++))
-		{
-			return false;
-		}
-	}
-
-	// Now consider the children
-	const ISPNode::NodeList& children = node.getChildNodes();
-
-	for (ISPNode::NodeList::const_iterator i = children.begin(); i != children.end(); ++i)
-	{
-		if (volume.TestAABB((*i)->getBounds()) == VOLUME_OUTSIDE)
-		{
-			// Skip this node, not visible
-			_skippedSPNodes++;
-			continue;
-		}
-
-		// Traverse all the children too, enter recursion
-		if (!foreachNodeInVolume_r(**i, volume, functor, visitHidden))
-		{
-			// The walker returned false somewhere in the recursion depths, propagate this message
-			return false;
-		}
-	}
-
-	return true; // continue traversal
-}
-
 ISpacePartitionSystemPtr SceneGraph::getSpacePartition()
 {
+    if (!_traversalOngoing)
+    {
+        flushBoundsChanges();
+    }
+
 	return _spacePartition;
 }
 
@@ -315,15 +300,24 @@ void SceneGraph::flushActionBuffer()
         case Erase:
             erase(action.second);
             break;
-        case BoundsChange:
-            nodeBoundsChanged(action.second);
-            break;
         };
     }
 
     _actionBuffer.clear();
 }
 
+void SceneGraph::flushBoundsChanges()
+{
+    if (_boundsChangedNodes.empty()) return;
+
+    // Evaluating the bounds during relink() might report further changes
+    std::vector<INodePtr> nodes;
+    nodes.swap(_boundsChangedNodes);
+    _boundsChangedSet.clear();
+
+    _spacePartition->relink(nodes);
+}
+
 // RegisterableModule implementation
 const std::string& SceneGraphModule::getName() const
 {
@@ -2,6 +2,8 @@
 
 #include <map>
 #include <list>
+#include <unordered_set>
+#include <vector>
 #include <sigc++/signal.h>
 
 #include "iscenegraph.h"
@@ -34,16 +36,12 @@ private:
 	// The space partitioning system
 	ISpacePartitionSystemPtr _spacePartition;
 
-	std::size_t _visitedSPNodes;
-	std::size_t _skippedSPNodes;
-
     // During partition traversal all link/unlink calls are buffered and
     // performed later on.
     enum ActionType
     {
         Insert,
         Erase,
-        BoundsChange,
     };
     typedef std::pair<ActionType, scene::INodePtr> NodeAction;
     typedef std::list<NodeAction> BufferedActions;
@@ -51,6 +49,11 @@ private:
 
     bool _traversalOngoing;
 
+    // Nodes which changed their bounds since the last traversal, these are
+    // re-linked in one go before the space partition is used again.
+    std::vector<INodePtr> _boundsChangedNodes;
+    std::unordered_set<INode*> _boundsChangedSet;
+
 public:
 	SceneGraph();
 
@@ -90,16 +93,16 @@ public:
     void foreachVisibleNode(const INode::VisitorFunc& functor) override;
     void foreachNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor) override;
     void foreachVisibleNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor) override;
+    void foreachVisibleNodeInVolumeFrontToBack(const VolumeTest& volume, const DepthSortedVisitorFunc& functor) override;
 
     ISpacePartitionSystemPtr getSpacePartition() override;
 private:
 	void foreachNodeInVolume(const VolumeTest& volume, const INode::VisitorFunc& functor, bool visitHidden);
 
-	// Recursive method used to descend the SpacePartition tree, returns FALSE if the walker signaled stop
-	bool foreachNodeInVolume_r(const ISPNode& node, const VolumeTest& volume, 
-							   const INode::VisitorFunc& functor, bool visitHidden);
-
     void flushActionBuffer();
+
+    // Hands the pending bounds changes to the space partition
+    void flushBoundsChanges();
 };
 typedef std::shared_ptr<SceneGraph> SceneGraphPtr;
 
@@ -0,0 +1,565 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE spacePartitionTest
+#include <boost/test/unit_test.hpp>
+
+#include "Octree.h"
+#include "FlatOctree.h"
+#include "ivolumetest.h"
+#include "scene/Node.h"
+#include "math/Frustum.h"
+#include "math/ViewProjection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <vector>
+
+namespace
+{
+    const double MAP_SIZE = 16384;
+    const double MAP_HEIGHT = 1024;
+
+    // Same margin as used by the selection system
+    const double NEAREST_HIT_DEPTH_EPSILON = 1e-6;
+
+    // Boxes which are not solid are never hit, like a brush whose faces
+    // don't cover the picked point
+    class BoxNode :
+        public scene::Node
+    {
+        AABB _bounds;
+        bool _solid;
+
+    public:
+        BoxNode(const AABB& bounds, bool solid = true) :
+            _bounds(bounds),
+            _solid(solid)
+        {}
+
+        bool isSolid() const
+        {
+            return _solid;
+        }
+
+        void setBounds(const AABB& bounds)
+        {
+            _bounds = bounds;
+            boundsChanged();
+        }
+
+        Type getNodeType() const override { return Type::Brush; }
+        const AABB& localAABB() const override { return _bounds; }
+
+        void renderSolid(RenderableCollector&, const VolumeTest&) const override {}
+        void renderWireframe(RenderableCollector&, const VolumeTest&) const override {}
+        std::size_t getHighlightFlags() override { return 0; }
+    };
+    typedef std::shared_ptr<BoxNode> BoxNodePtr;
+
+    // Perspective view with a 90 degree field of view
+    class FrustumVolume :
+        public VolumeTest
+    {
+        Frustum _frustum;
+        Matrix4 _identity;
+
+    public:
+        FrustumVolume(const Vector3& eye, const Vector3& forward, double farDistance) :
+            _identity(Matrix4::getIdentity())
+        {
+            Vector3 up(0, 0, 1);
+            Vector3 right = forward.crossProduct(up).getNormalised();
+            up = right.crossProduct(forward).getNormalised();
+
+            // The plane normals are pointing into the frustum
+            _frustum.left = createPlane((forward + right).getNormalised(), eye);
+            _frustum.right = createPlane((forward - right).getNormalised(), eye);
+            _frustum.bottom = createPlane((forward + up).getNormalised(), eye);
+            _frustum.top = createPlane((forward - up).getNormalised(), eye);
+            _frustum.front = createPlane(forward, eye + forward * 4);
+            _frustum.back = createPlane(-forward, eye + forward * farDistance);
+        }
+
+        bool TestPoint(const Vector3& point) const override { return _frustum.testPoint(point); }
+        bool TestLine(const Segment& segment) const override { return _frustum.testLine(segment); }
+        bool TestPlane(const Plane3& plane) const override { return true; }
+        bool TestPlane(const Plane3& plane, const Matrix4& localToWorld) const override { return true; }
+
+        VolumeIntersectionValue TestAABB(const AABB& aabb) const override
+        {
+            return _frustum.testIntersection(aabb);
+        }
+
+        VolumeIntersectionValue TestAABB(const AABB& aabb, const Matrix4& localToWorld) const override
+        {
+            return _frustum.testIntersection(aabb, localToWorld);
+        }
+
+        const Frustum* getCullingFrustum() const override { return &_frustum; }
+
+        bool fill() const override { return true; }
+        const Matrix4& GetViewport() const override { return _identity; }
+        const Matrix4& GetProjection() const override { return _identity; }
+        const Matrix4& GetModelview() const override { return _identity; }
+
+    private:
+        static Plane3 createPlane(const Vector3& normal, const Vector3& point)
+        {
+            return Plane3(normal, normal.dot(point));
+        }
+    };
+
+    // Narrow perspective view around the picked point
+    class PickVolume :
+        public VolumeTest
+    {
+        Matrix4 _projection;
+        Matrix4 _modelview;
+        ViewProjection _viewproj;
+        Frustum _frustum;
+        Matrix4 _identity;
+
+    public:
+        PickVolume(const Vector3& eye, const Vector3& forward) :
+            _identity(Matrix4::getIdentity())
+        {
+            Vector3 up(0, 0, 1);
+            Vector3 right = forward.crossProduct(up).getNormalised();
+            up = right.crossProduct(forward).getNormalised();
+
+            // The camera is looking down the negative z axis
+            _modelview = Matrix4::byRows(
+                right.x(), right.y(), right.z(), -right.dot(eye),
+                up.x(), up.y(), up.z(), -up.dot(eye),
+                -forward.x(), -forward.y(), -forward.z(), forward.dot(eye),
+                0, 0, 0, 1);
+
+            _projection = Matrix4::getProjectionForFrustum(-0.01, 0.01, -0.01, 0.01, 4, MAP_SIZE);
+
+            _viewproj = _projection.getMultipliedBy(_modelview);
+            _frustum = Frustum::createFromViewproj(_viewproj);
+        }
+
+        // Returns true if the (solid) box is hit, the hit depth is the one of its centre
+        bool testHit(const BoxNode& node, double& depth) const
+        {
+            if (!node.isSolid() || TestAABB(node.worldAABB()) == VOLUME_OUTSIDE)
+            {
+                return false;
+            }
+
+            Vector4 centre = _viewproj.transform(Vector4(node.worldAABB().origin, 1));
+
+            if (centre[3] <= 0)
+            {
+                return false;
+            }
+
+            depth = std::max(centre[2] / centre[3], _viewproj.getNearestDepth(node.worldAABB()));
+            return true;
+        }
+
+        bool TestPoint(const Vector3& point) const override { return _frustum.testPoint(point); }
+        bool TestLine(const Segment& segment) const override { return _frustum.testLine(segment); }
+        bool TestPlane(const Plane3& plane) const override { return true; }
+        bool TestPlane(const Plane3& plane, const Matrix4& localToWorld) const override { return true; }
+
+        VolumeIntersectionValue TestAABB(const AABB& aabb) const override
+        {
+            return _frustum.testIntersection(aabb);
+        }
+
+        VolumeIntersectionValue TestAABB(const AABB& aabb, const Matrix4& localToWorld) const override
+        {
+            return _frustum.testIntersection(aabb, localToWorld);
+        }
+
+        const Frustum* getCullingFrustum() const override { return &_frustum; }
+
+        bool fill() const override { return true; }
+        const Matrix4& GetViewport() const override { return _identity; }
+        const Matrix4& GetProjection() const override { return _projection; }
+        const Matrix4& GetModelview() const override { return _modelview; }
+    };
+
+    // Deterministic pseudo-random numbers in [0..1)
+    double random(std::size_t& seed)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>((seed >> 11) & 0xfffff) / 0x100000;
+    }
+
+    AABB createRandomBounds(std::size_t& seed)
+    {
+        Vector3 origin(random(seed) * MAP_SIZE - MAP_SIZE / 2,
+                       random(seed) * MAP_SIZE - MAP_SIZE / 2,
+                       random(seed) * MAP_HEIGHT - MAP_HEIGHT / 2);
+
+        Vector3 extents(8 + random(seed) * 64, 8 + random(seed) * 64, 8 + random(seed) * 64);
+
+        return AABB(origin, extents);
+    }
+
+    std::vector<FrustumVolume> createViews(std::size_t numViews)
+    {
+        std::vector<FrustumVolume> views;
+
+        for (std::size_t i = 0; i < numViews; ++i)
+        {
+            // Walk around the map centre, looking into different directions
+            double angle = i * 2 * M_PI / numViews;
+            double yaw = angle * 3;
+
+            Vector3 eye(std::cos(angle) * MAP_SIZE / 4, std::sin(angle) * MAP_SIZE / 4, 64);
+            Vector3 forward(std::cos(yaw), std::sin(yaw), -0.1);
+
+            views.push_back(FrustumVolume(eye, forward.getNormalised(), 4096));
+        }
+
+        return views;
+    }
+
+    typedef std::vector<const scene::INode*> VisitedNodes;
+
+    VisitedNodes traverse(scene::ISpacePartitionSystem& partition, const VolumeTest& volume)
+    {
+        VisitedNodes visited;
+
+        partition.foreachMemberInVolume(volume, [&](const scene::INodePtr& node)
+        {
+            visited.push_back(node.get());
+            return true;
+        });
+
+        return visited;
+    }
+
+    // Creates the given number of nodes with random bounds
+    std::vector<BoxNodePtr> createNodes(std::size_t numNodes, std::size_t& seed)
+    {
+        std::vector<BoxNodePtr> nodes;
+
+        for (std::size_t i = 0; i < numNodes; ++i)
+        {
+            nodes.push_back(std::make_shared<BoxNode>(createRandomBounds(seed)));
+        }
+
+        return nodes;
+    }
+
+    // Picks at random points of the central map area, looking roughly horizontally
+    std::vector<PickVolume> createPicks(std::size_t numPicks, std::size_t& seed)
+    {
+        std::vector<PickVolume> picks;
+
+        for (std::size_t i = 0; i < numPicks; ++i)
+        {
+            Vector3 eye(random(seed) * MAP_SIZE / 2 - MAP_SIZE / 4,
+                        random(seed) * MAP_SIZE / 2 - MAP_SIZE / 4, 0);
+
+            double yaw = random(seed) * 2 * M_PI;
+            Vector3 forward(std::cos(yaw), std::sin(yaw), random(seed) * 0.2 - 0.1);
+
+            picks.push_back(PickVolume(eye, forward.getNormalised()));
+        }
+
+        return picks;
+    }
+
+    struct PickResult
+    {
+        const scene::INode* node = nullptr;
+        double depth = 1;
+        std::size_t numTested = 0;
+
+        void test(const scene::INodePtr& node, const PickVolume& pick)
+        {
+            ++numTested;
+
+            double hitDepth;
+
+            if (pick.testHit(dynamic_cast<const BoxNode&>(*node), hitDepth) && hitDepth < depth)
+            {
+                this->node = node.get();
+                depth = hitDepth;
+            }
+        }
+    };
+
+    // Tests all nodes in the pick volume
+    PickResult pickAll(scene::ISpacePartitionSystem& partition, const PickVolume& pick)
+    {
+        PickResult result;
+
+        partition.foreachMemberInVolume(pick, [&](const scene::INodePtr& node)
+        {
+            result.test(node, pick);
+            return true;
+        });
+
+        return result;
+    }
+
+    // Visits the nodes front to back, stopping once no remaining node can be
+    // any closer than the nearest hit, like the selection system does
+    PickResult pickNearest(scene::ISpacePartitionSystem& partition, const PickVolume& pick)
+    {
+        PickResult result;
+
+        partition.foreachMemberInVolumeFrontToBack(pick, [&](const scene::INodePtr& node, double nearestDepth)
+        {
+            if (result.node != nullptr && nearestDepth > result.depth + NEAREST_HIT_DEPTH_EPSILON)
+            {
+                return false;
+            }
+
+            result.test(node, pick);
+            return true;
+        });
+
+        return result;
+    }
+
+    // Above the threshold of the parallel traversal
+    const std::size_t NUM_NODES = 20000;
+    const std::size_t NUM_VIEWS = 16;
+    const std::size_t NUM_PICKS = 200;
+
+    // Every node intersecting the view has to be visited exactly once
+    void checkVisited(const std::vector<BoxNodePtr>& nodes, const FrustumVolume& view,
+                      const VisitedNodes& visited)
+    {
+        std::set<const scene::INode*> unique(visited.begin(), visited.end());
+
+        BOOST_CHECK_EQUAL(unique.size(), visited.size());
+
+        for (const BoxNodePtr& node : nodes)
+        {
+            if (view.TestAABB(node->worldAABB()) != VOLUME_OUTSIDE &&
+                unique.find(node.get()) == unique.end())
+            {
+                BOOST_ERROR("Visible node has been culled");
+                return;
+            }
+        }
+    }
+
+    void checkTraversals(scene::FlatOctree& octree, const std::vector<BoxNodePtr>& nodes,
+                         const std::vector<FrustumVolume>& views)
+    {
+        for (const FrustumVolume& view : views)
+        {
+            octree.setNumThreads(1);
+            VisitedNodes single = traverse(octree, view);
+
+            checkVisited(nodes, view, single);
+
+            // The visitor sees the same nodes in the same order
+            octree.setNumThreads(4);
+            BOOST_CHECK(traverse(octree, view) == single);
+        }
+    }
+
+    // The nearest hit among all nodes
+    const scene::INode* findNearestHit(const std::vector<BoxNodePtr>& nodes, const PickVolume& pick)
+    {
+        const scene::INode* nearest = nullptr;
+        double nearestDepth = 1;
+
+        for (const BoxNodePtr& node : nodes)
+        {
+            double depth;
+
+            if (pick.testHit(*node, depth) && depth < nearestDepth)
+            {
+                nearest = node.get();
+                nearestDepth = depth;
+            }
+        }
+
+        return nearest;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(cullVolume)
+{
+    std::size_t seed = 1;
+    std::vector<BoxNodePtr> nodes = createNodes(NUM_NODES, seed);
+
+    scene::FlatOctree octree;
+
+    for (const BoxNodePtr& node : nodes)
+    {
+        octree.link(node);
+    }
+
+    BOOST_CHECK_EQUAL(octree.size(), NUM_NODES);
+
+    checkTraversals(octree, nodes, createViews(NUM_VIEWS));
+}
+
+BOOST_AUTO_TEST_CASE(unlinkNodes)
+{
+    std::size_t seed = 2;
+    std::vector<BoxNodePtr> nodes = createNodes(NUM_NODES, seed);
+
+    scene::FlatOctree octree;
+
+    for (const BoxNodePtr& node : nodes)
+    {
+        octree.link(node);
+    }
+
+    std::vector<BoxNodePtr> remaining;
+
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+    {
+        if (i % 3 == 0)
+        {
+            BOOST_CHECK(octree.unlink(nodes[i]));
+        }
+        else
+        {
+            remaining.push_back(nodes[i]);
+        }
+    }
+
+    BOOST_CHECK(!octree.unlink(nodes.front()));
+    BOOST_CHECK_EQUAL(octree.size(), remaining.size());
+
+    std::vector<FrustumVolume> views = createViews(NUM_VIEWS);
+    checkTraversals(octree, remaining, views);
+
+    // Unlinked nodes are no longer visited
+    std::set<const scene::INode*> unlinked;
+
+    for (std::size_t i = 0; i < nodes.size(); i += 3)
+    {
+        unlinked.insert(nodes[i].get());
+    }
+
+    for (const FrustumVolume& view : views)
+    {
+        for (const scene::INode* node : traverse(octree, view))
+        {
+            BOOST_CHECK(unlinked.find(node) == unlinked.end());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(invalidBoundsAreNeverCulled)
+{
+    std::size_t seed = 3;
+    std::vector<BoxNodePtr> nodes = createNodes(100, seed);
+
+    BoxNodePtr invalid = std::make_shared<BoxNode>(AABB());
+    nodes.push_back(invalid);
+
+    scene::FlatOctree octree;
+
+    for (const BoxNodePtr& node : nodes)
+    {
+        octree.link(node);
+    }
+
+    for (const FrustumVolume& view : createViews(NUM_VIEWS))
+    {
+        VisitedNodes visited = traverse(octree, view);
+        BOOST_CHECK(std::find(visited.begin(), visited.end(), invalid.get()) != visited.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(relinkMovedNodes)
+{
+    std::size_t seed = 4;
+    std::vector<BoxNodePtr> nodes = createNodes(NUM_NODES, seed);
+
+    scene::FlatOctree octree;
+
+    for (const BoxNodePtr& node : nodes)
+    {
+        octree.link(node);
+    }
+
+    // Drag every tenth node by a small offset, a few of them far away,
+    // one beyond the current root
+    std::vector<scene::INodePtr> moved;
+
+    for (std::size_t i = 0; i < nodes.size(); i += 10)
+    {
+        AABB bounds = i % 100 == 0 ? createRandomBounds(seed) : nodes[i]->worldAABB();
+        bounds.origin += Vector3(24, -16, 8);
+
+        if (i == 0)
+        {
+            bounds.origin = Vector3(MAP_SIZE * 4, 0, 0);
+        }
+
+        nodes[i]->setBounds(bounds);
+        moved.push_back(nodes[i]);
+    }
+
+    // A node listed twice must not end up linked twice
+    moved.push_back(nodes[10]);
+
+    octree.relink(moved);
+
+    BOOST_CHECK_EQUAL(octree.size(), NUM_NODES);
+
+    std::vector<FrustumVolume> views = createViews(NUM_VIEWS);
+
+    // Looking at the far away node
+    views.push_back(FrustumVolume(Vector3(MAP_SIZE * 4 - 512, 0, 0), Vector3(1, 0, 0), 4096));
+
+    checkTraversals(octree, nodes, views);
+
+    VisitedNodes visited = traverse(octree, views.back());
+    BOOST_CHECK(std::find(visited.begin(), visited.end(), nodes.front().get()) != visited.end());
+}
+
+BOOST_AUTO_TEST_CASE(pickNearestNode)
+{
+    std::size_t seed = 5;
+    std::vector<BoxNodePtr> nodes;
+
+    for (std::size_t i = 0; i < NUM_NODES; ++i)
+    {
+        nodes.push_back(std::make_shared<BoxNode>(createRandomBounds(seed), i % 2 == 0));
+    }
+
+    scene::Octree octree;
+    scene::FlatOctree flatOctree;
+
+    for (const BoxNodePtr& node : nodes)
+    {
+        octree.link(node);
+        flatOctree.link(node);
+    }
+
+    std::size_t numHits = 0;
+    std::size_t numTestedAll = 0;
+    std::size_t numTestedNearest = 0;
+
+    for (const PickVolume& pick : createPicks(NUM_PICKS, seed))
+    {
+        const scene::INode* expected = findNearestHit(nodes, pick);
+        numHits += expected != nullptr ? 1 : 0;
+
+        BOOST_CHECK_EQUAL(pickAll(octree, pick).node, expected);
+        BOOST_CHECK_EQUAL(pickNearest(octree, pick).node, expected);
+
+        PickResult all = pickAll(flatOctree, pick);
+        PickResult nearest = pickNearest(flatOctree, pick);
+
+        BOOST_CHECK_EQUAL(all.node, expected);
+        BOOST_CHECK_EQUAL(nearest.node, expected);
+
+        numTestedAll += all.numTested;
+        numTestedNearest += nearest.numTested;
+    }
+
+    // Some picks have to hit, the front to back traversal stops early
+    BOOST_CHECK_GT(numHits, 0);
+    BOOST_CHECK_LT(numHits, NUM_PICKS);
+    BOOST_CHECK_LT(numTestedNearest, numTestedAll);
+}
@@ -54,11 +54,32 @@ TexturePtr CShader::getEditorImage()
         _editorTexture = GetTextureManager().getBinding(
             _template->getEditorTexture()
         );
+
+        // The full image is serving as preview from now on
+        _editorThumbnail.reset();
     }
 
     return _editorTexture;
 }
 
+TexturePtr CShader::getEditorImageThumbnail()
+{
+    // No need for a thumbnail if the full image is realised anyway
+    if (_editorTexture)
+    {
+        return _editorTexture;
+    }
+
+    if (!_editorThumbnail)
+    {
+        _editorThumbnail = GetTextureManager().getThumbnailBinding(
+            _template->getEditorTexture()
+        );
+    }
+
+    return _editorThumbnail;
+}
+
 bool CShader::isEditorImageNoTex()
 {
 	return (getEditorImage() == GetTextureManager().getShaderNotFound());
@@ -194,6 +215,9 @@ void CShader::realise() {
 
 void CShader::unrealise() {
 	unrealiseLighting();
+
+	// Release the preview, it is requested again after a refresh
+	_editorThumbnail.reset();
 }
 
 // Parse and load image maps for this shader
@@ -156,6 +156,7 @@ void Doom3ShaderSystem::freeShaders() {
 	_library->clear();
     _defLoader.reset();
 	_textureManager->checkBindings();
+	_textureManager->saveThumbnailCache();
 	activeShadersChangedNotify();
 }
 
@@ -285,6 +286,11 @@ void Doom3ShaderSystem::foreachMaterial(const std::function<void(const MaterialP
     _library->foreachShader(func);
 }
 
+void Doom3ShaderSystem::saveThumbnailCache()
+{
+    _textureManager->saveThumbnailCache();
+}
+
 TexturePtr Doom3ShaderSystem::loadTextureFromFile(const std::string& filename)
 {
 	// Remove any unused Textures before allocating new ones.
@@ -99,6 +99,8 @@ public:
 	 */
     void foreachMaterial(const std::function<void(const MaterialPtr&)>& func) override;
 
+    void saveThumbnailCache() override;
+
 	/* greebo: Loads an image from disk and creates a basic shader
 	 * object out of it (i.e. only diffuse and editor image are non-empty).
 	 */
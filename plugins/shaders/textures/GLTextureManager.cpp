@@ -32,6 +32,18 @@ void GLTextureManager::checkBindings() {
             ++i;
         }
     }
+
+    for (TextureMap::iterator i = _thumbnails.begin(); i != _thumbnails.end(); )
+    {
+        if (i->second.unique())
+        {
+            _thumbnails.erase(i++);
+        }
+        else
+        {
+            ++i;
+        }
+    }
 }
 
 TexturePtr GLTextureManager::getBinding(NamedBindablePtr bindable)
@@ -98,6 +110,61 @@ TexturePtr GLTextureManager::getBinding(const std::string& fullPath)
     return _textures[fullPath];
 }
 
+TexturePtr GLTextureManager::getThumbnailBinding(NamedBindablePtr bindable)
+{
+    if (!bindable)
+    {
+        return getShaderNotFound();
+    }
+
+    std::string identifier = bindable->getIdentifier();
+
+    // A full-sized texture which is loaded anyway can serve as preview
+    TextureMap::iterator i = _textures.find(identifier);
+
+    if (i != _textures.end())
+    {
+        return i->second;
+    }
+
+    i = _thumbnails.find(identifier);
+
+    if (i != _thumbnails.end())
+    {
+        return i->second;
+    }
+
+    ImagePtr fullImage;
+    TexturePtr thumbnail = _thumbnailCache.getThumbnail(
+        std::dynamic_pointer_cast<MapExpression>(bindable), fullImage
+    );
+
+    if (thumbnail)
+    {
+        _thumbnails.insert(TextureMap::value_type(identifier, thumbnail));
+        return thumbnail;
+    }
+
+    // Not cacheable, use the full image (which might have been loaded already)
+    if (fullImage)
+    {
+        TexturePtr texture = fullImage->bindTexture(identifier);
+
+        if (texture)
+        {
+            _textures.insert(TextureMap::value_type(identifier, texture));
+            return texture;
+        }
+    }
+
+    return getBinding(bindable);
+}
+
+void GLTextureManager::saveThumbnailCache()
+{
+    _thumbnailCache.save();
+}
+
 // Return the shader-not-found texture, loading if necessary
 TexturePtr GLTextureManager::getShaderNotFound()
 {
@@ -5,6 +5,7 @@
 #include <map>
 #include "../MapExpression.h"
 #include "texturelib.h"
+#include "ThumbnailCache.h"
 
 namespace shaders
 {
@@ -18,6 +19,10 @@ class GLTextureManager
 	// The fallback textures in case a texture is empty or broken
 	TexturePtr _shaderNotFound;
 
+	// Downscaled previews for the texture browsers
+	TextureMap _thumbnails;
+	ThumbnailCache _thumbnailCache;
+
 private:
 
 	// Constructs the fallback textures like "Shader Image Missing"
@@ -39,6 +44,17 @@ public:
 	 */
 	TexturePtr getBinding(const std::string& fullPath);
 
+	/**
+	 * \brief
+	 * Construct a downscaled preview texture from the given bindable, which is
+	 * served from the disk-backed thumbnail cache if possible. The returned
+	 * texture reports the dimensions of the full image.
+	 */
+	TexturePtr getThumbnailBinding(NamedBindablePtr bindable);
+
+	// Writes the thumbnail cache index to disk
+	void saveThumbnailCache();
+
 	/**
      * \brief
      * Get the "shader not found" texture.
@@ -0,0 +1,355 @@
+#include "ThumbnailCache.h"
+
+#include "iregistry.h"
+#include "itextstream.h"
+#include "ifilesystem.h"
+#include "imodule.h"
+
+#include "RGBAImage.h"
+#include "os/dir.h"
+#include "os/file.h"
+#include "stream/utils.h"
+#include "string/convert.h"
+#include "string/split.h"
+#include "string/predicate.h"
+#include "TextureManipulator.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+
+namespace shaders
+{
+
+namespace
+{
+	const char* const CACHE_FOLDER = "thumbnails/";
+	const char* const INDEX_FILE = "index.txt";
+	const char* const INDEX_HEADER = "DarkRadiant thumbnail cache 2";
+
+	// A Texture reporting the dimensions of the full editor image, while
+	// its GL texture holds the downscaled thumbnail. The thumbnail pixels
+	// are not loaded and uploaded before the texture number is requested.
+	class ThumbnailTexture :
+		public Texture
+	{
+	private:
+		std::string _name;
+		std::size_t _width;
+		std::size_t _height;
+
+		// Either the thumbnail image or its file is known at construction
+		mutable ImagePtr _thumbnail;
+		std::string _thumbnailFile;
+
+		// The source, used if the thumbnail file fails to load
+		MapExpressionPtr _expression;
+
+		mutable TexturePtr _texture;
+
+	public:
+		ThumbnailTexture(const std::string& name, std::size_t width, std::size_t height,
+			const ImagePtr& thumbnail, const std::string& thumbnailFile,
+			const MapExpressionPtr& expression) :
+			_name(name),
+			_width(width),
+			_height(height),
+			_thumbnail(thumbnail),
+			_thumbnailFile(thumbnailFile),
+			_expression(expression)
+		{}
+
+		std::string getName() const override
+		{
+			return _name;
+		}
+
+		GLuint getGLTexNum() const override
+		{
+			if (!_texture)
+			{
+				if (!_thumbnail)
+				{
+					_thumbnail = GlobalImageLoader().imageFromFile(_thumbnailFile);
+				}
+
+				_texture = _thumbnail ? _thumbnail->bindTexture(_name) : _expression->bindTexture(_name);
+				_thumbnail.reset();
+
+				if (!_texture)
+				{
+					return 0;
+				}
+			}
+
+			return _texture->getGLTexNum();
+		}
+
+		std::size_t getWidth() const override
+		{
+			return _width;
+		}
+
+		std::size_t getHeight() const override
+		{
+			return _height;
+		}
+	};
+
+	// Writes the given image as uncompressed, top-down 32 bit TGA
+	bool writeTGA(const std::string& filename, const RGBAImage& image)
+	{
+		std::ofstream stream(filename, std::ios::binary);
+
+		if (!stream)
+		{
+			return false;
+		}
+
+		stream.put(0); // id length
+		stream.put(0); // no colour map
+		stream.put(2); // uncompressed true colour
+
+		stream::writeLittleEndian<uint16_t>(stream, 0); // colour map spec
+		stream::writeLittleEndian<uint16_t>(stream, 0);
+		stream.put(0);
+
+		stream::writeLittleEndian<uint16_t>(stream, 0); // origin
+		stream::writeLittleEndian<uint16_t>(stream, 0);
+		stream::writeLittleEndian<uint16_t>(stream, static_cast<uint16_t>(image.width));
+		stream::writeLittleEndian<uint16_t>(stream, static_cast<uint16_t>(image.height));
+
+		stream.put(32);			// bits per pixel
+		stream.put(0x20 | 8);	// top-down, 8 alpha bits
+
+		std::vector<char> row(image.width * 4);
+
+		for (std::size_t y = 0; y < image.height; ++y)
+		{
+			const RGBAPixel* pixel = image.pixels + y * image.width;
+
+			for (std::size_t x = 0; x < image.width; ++x, ++pixel)
+			{
+				row[x * 4] = pixel->blue;
+				row[x * 4 + 1] = pixel->green;
+				row[x * 4 + 2] = pixel->red;
+				row[x * 4 + 3] = pixel->alpha;
+			}
+
+			stream.write(row.data(), row.size());
+		}
+
+		return stream.good();
+	}
+
+	// FNV-1a, stable across platforms and sessions
+	std::uint64_t getHash(const std::string& str)
+	{
+		std::uint64_t hash = 14695981039346656037ULL;
+
+		for (unsigned char c : str)
+		{
+			hash ^= c;
+			hash *= 1099511628211ULL;
+		}
+
+		return hash;
+	}
+}
+
+ThumbnailCache::ThumbnailCache() :
+	_loaded(false),
+	_changed(false)
+{}
+
+TexturePtr ThumbnailCache::getThumbnail(const MapExpressionPtr& expression, ImagePtr& fullImage)
+{
+	ImagePtr thumbnail;
+	const Entry* entry = findOrCreateEntry(expression, thumbnail, fullImage);
+
+	if (entry == nullptr)
+	{
+		return TexturePtr();
+	}
+
+	return std::make_shared<ThumbnailTexture>(expression->getIdentifier(),
+		entry->width, entry->height, thumbnail, _path + entry->thumbnailFile, expression);
+}
+
+const ThumbnailCache::Entry* ThumbnailCache::findOrCreateEntry(const MapExpressionPtr& expression,
+	ImagePtr& thumbnail, ImagePtr& fullImage)
+{
+	// Only plain images can be traced back to a single source file
+	if (!std::dynamic_pointer_cast<ImageExpression>(expression))
+	{
+		return nullptr;
+	}
+
+	std::string identifier = expression->getIdentifier();
+	std::string sourceFile = GlobalImageLoader().findImageFileInVFS(identifier);
+
+	if (sourceFile.empty())
+	{
+		return nullptr;
+	}
+
+	// Images in PK4s are considered changed along with the archive
+	std::string archive = GlobalFileSystem().findArchive(sourceFile);
+	std::int64_t timestamp = os::getModificationTime(
+		string::ends_with(archive, "/") ? archive + sourceFile : archive);
+
+	ensureLoaded();
+
+	EntryMap::iterator found = _entries.find(identifier);
+
+	if (found != _entries.end() && found->second.sourceFile == sourceFile &&
+		found->second.timestamp == timestamp)
+	{
+		return &found->second;
+	}
+
+	// Not cached or outdated, load the full image and scale it down
+	fullImage = expression->getImage();
+
+	if (!fullImage || fullImage->isPrecompressed() ||
+		fullImage->getWidth(0) == 0 || fullImage->getHeight(0) == 0)
+	{
+		return nullptr;
+	}
+
+	Entry entry;
+	entry.sourceFile = sourceFile;
+	entry.timestamp = timestamp;
+	entry.width = fullImage->getWidth(0);
+	entry.height = fullImage->getHeight(0);
+	entry.thumbnailFile = found != _entries.end() ?
+		found->second.thumbnailFile : generateThumbnailFileName(identifier);
+
+	double scale = static_cast<double>(MAX_THUMBNAIL_SIZE) / std::max(entry.width, entry.height);
+
+	std::shared_ptr<RGBAImage> scaled;
+
+	if (scale < 1)
+	{
+		scaled = std::make_shared<RGBAImage>(
+			std::max(static_cast<std::size_t>(entry.width * scale), std::size_t(1)),
+			std::max(static_cast<std::size_t>(entry.height * scale), std::size_t(1)));
+
+		TextureManipulator::instance().resampleTexture(
+			fullImage->getMipMapPixels(0), entry.width, entry.height,
+			scaled->getMipMapPixels(0), scaled->width, scaled->height, 4);
+	}
+	else
+	{
+		scaled = std::make_shared<RGBAImage>(entry.width, entry.height);
+		std::copy(fullImage->getMipMapPixels(0),
+			fullImage->getMipMapPixels(0) + entry.width * entry.height * 4,
+			scaled->getMipMapPixels(0));
+	}
+
+	thumbnail = scaled;
+
+	if (!writeTGA(_path + entry.thumbnailFile, *scaled))
+	{
+		rWarning() << "[shaders] Could not write thumbnail " << _path + entry.thumbnailFile << std::endl;
+	}
+
+	_changed = true;
+
+	Entry& stored = _entries[identifier];
+	stored = entry;
+
+	return &stored;
+}
+
+std::string ThumbnailCache::generateThumbnailFileName(const std::string& identifier)
+{
+	std::ostringstream name;
+	name << std::hex << std::setfill('0') << std::setw(16) << getHash(identifier);
+
+	// Avoid clashes with hash collisions
+	std::string fileName = name.str() + ".tga";
+
+	for (int i = 1; _thumbnailFiles.find(fileName) != _thumbnailFiles.end(); ++i)
+	{
+		fileName = name.str() + "_" + string::to_string(i) + ".tga";
+	}
+
+	_thumbnailFiles.insert(fileName);
+
+	return fileName;
+}
+
+void ThumbnailCache::ensureLoaded()
+{
+	if (_loaded) return;
+
+	_loaded = true;
+
+	_path = os::standardPathWithSlash(GlobalRegistry().get(RKEY_SETTINGS_PATH)) + CACHE_FOLDER;
+
+	if (!os::makeDirectory(_path))
+	{
+		rWarning() << "[shaders] Could not create thumbnail cache folder " << _path << std::endl;
+	}
+
+	std::ifstream index(_path + INDEX_FILE);
+
+	std::string line;
+
+	if (!index || !std::getline(index, line) || line != INDEX_HEADER)
+	{
+		return;
+	}
+
+	while (std::getline(index, line))
+	{
+		std::vector<std::string> parts;
+		string::split(parts, line, "\t", false);
+
+		if (parts.size() != 6)
+		{
+			continue;
+		}
+
+		Entry entry;
+		entry.sourceFile = parts[1];
+		entry.timestamp = string::convert<long long>(parts[2]);
+		entry.width = string::convert<std::size_t>(parts[3]);
+		entry.height = string::convert<std::size_t>(parts[4]);
+		entry.thumbnailFile = parts[5];
+
+		_entries[parts[0]] = entry;
+		_thumbnailFiles.insert(entry.thumbnailFile);
+	}
+
+	rMessage() << "[shaders] Loaded " << _entries.size() << " thumbnail cache entries." << std::endl;
+}
+
+void ThumbnailCache::save()
+{
+	if (!_changed) return;
+
+	std::ofstream index(_path + INDEX_FILE);
+
+	if (!index)
+	{
+		rWarning() << "[shaders] Could not write thumbnail cache index to " << _path << std::endl;
+		return;
+	}
+
+	index << INDEX_HEADER << "\n";
+
+	for (const EntryMap::value_type& pair : _entries)
+	{
+		const Entry& entry = pair.second;
+
+		index << pair.first << "\t" << entry.sourceFile << "\t" << entry.timestamp << "\t"
+			<< entry.width << "\t" << entry.height << "\t" << entry.thumbnailFile << "\n";
+	}
+
+	_changed = false;
+}
+
+} // namespace
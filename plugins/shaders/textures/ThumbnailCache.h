@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ishaders.h"
+#include "../MapExpression.h"
+
+#include <map>
+#include <set>
+#include <cstdint>
+
+namespace shaders
+{
+
+/**
+ * Disk-backed cache of downscaled editor images, used by the preview tiles
+ * of the texture browser.
+ *
+ * Entries are keyed by the VFS path of the source image and its modification
+ * time. The index (source dimensions, thumbnail file name) is loaded once,
+ * the thumbnails themselves are stored as small TGA files in the user's
+ * settings folder and only read when a tile is actually drawn.
+ */
+class ThumbnailCache
+{
+public:
+	// Thumbnails are scaled down to fit into a square of this size
+	static const std::size_t MAX_THUMBNAIL_SIZE = 128;
+
+	struct Entry
+	{
+		std::string sourceFile;		// VFS path of the source image, incl. extension
+		std::int64_t timestamp;		// modification time of the source
+		std::size_t width;			// dimensions of the source image
+		std::size_t height;
+		std::string thumbnailFile;	// file name within the cache folder
+	};
+
+private:
+	std::string _path;
+
+	// Entries by image identifier
+	typedef std::map<std::string, Entry> EntryMap;
+	EntryMap _entries;
+
+	std::set<std::string> _thumbnailFiles;
+
+	bool _loaded;
+	bool _changed;
+
+public:
+	ThumbnailCache();
+
+	/**
+	 * Returns the thumbnail texture for the given map expression. The texture
+	 * reports the dimensions of the full image, its pixel data is not loaded
+	 * before the GL texture number is requested.
+	 * Returns an empty pointer if the expression cannot be cached (anything
+	 * else than a plain VFS image, or a precompressed image). The full-sized
+	 * image is then passed back through <fullImage> if it had to be loaded.
+	 */
+	TexturePtr getThumbnail(const MapExpressionPtr& expression, ImagePtr& fullImage);
+
+	// Writes the index to disk, if anything changed
+	void save();
+
+private:
+	void ensureLoaded();
+
+	// Returns the up-to-date entry for the given expression, generating the
+	// thumbnail if needed (in which case it is returned through <thumbnail>)
+	const Entry* findOrCreateEntry(const MapExpressionPtr& expression,
+		ImagePtr& thumbnail, ImagePtr& fullImage);
+
+	std::string generateThumbnailFileName(const std::string& identifier);
+};
+
+} // namespace
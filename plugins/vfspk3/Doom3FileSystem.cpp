@@ -288,6 +288,19 @@ std::string Doom3FileSystem::findFile(const std::string& name)
 	return std::string();
 }
 
+std::string Doom3FileSystem::findArchive(const std::string& name)
+{
+	for (const ArchiveDescriptor& descriptor : _archives)
+	{
+		if (descriptor.archive->containsFile(name))
+		{
+			return descriptor.name;
+		}
+	}
+
+	return std::string();
+}
+
 std::string Doom3FileSystem::findRoot(const std::string& name)
 {
 	for (const ArchiveDescriptor& descriptor : _archives)
@@ -53,6 +53,7 @@ public:
 		std::size_t depth = 1) override;
 
 	std::string findFile(const std::string& name) override;
+	std::string findArchive(const std::string& name) override;
 	std::string findRoot(const std::string& name) override;
 
 	void addObserver(Observer& observer) override;
@@ -0,0 +1,138 @@
+#include "BRepRebuildScheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
+namespace brush
+{
+
+namespace
+{
+	// Smaller batches are clipped by the calling thread, it's not worth
+	// starting threads for a few brushes being dragged around
+	const std::size_t PARALLEL_THRESHOLD = 64;
+
+	// Number of jobs a worker takes at once
+	const std::size_t JOBS_PER_CHUNK = 16;
+}
+
+BRepRebuildScheduler::BRepRebuildScheduler() :
+	_numThreads(0),
+	_flushing(false)
+{}
+
+BRepRebuildScheduler& BRepRebuildScheduler::Instance()
+{
+	static BRepRebuildScheduler _instance;
+	return _instance;
+}
+
+void BRepRebuildScheduler::schedule(Job& job)
+{
+	if (_scheduled.insert(&job).second)
+	{
+		_queue.push_back(&job);
+	}
+}
+
+void BRepRebuildScheduler::cancel(Job& job)
+{
+	// The queue is cleaned up by the next flush
+	_scheduled.erase(&job);
+
+	if (_scheduled.empty())
+	{
+		_queue.clear();
+	}
+}
+
+std::size_t BRepRebuildScheduler::size() const
+{
+	return _scheduled.size();
+}
+
+void BRepRebuildScheduler::setNumThreads(std::size_t numThreads)
+{
+	_numThreads = numThreads;
+}
+
+void BRepRebuildScheduler::flush()
+{
+	if (_flushing || _scheduled.empty()) return;
+
+	_flushing = true;
+
+	// Preparing a job might schedule further ones, which are prepared too
+	for (std::size_t i = 0; i < _queue.size(); ++i)
+	{
+		if (_scheduled.find(_queue[i]) != _scheduled.end())
+		{
+			_queue[i]->prepareRebuild();
+		}
+	}
+
+	// Collect the jobs which are still scheduled. The queue might contain a
+	// cancelled job's address twice if another job got allocated in its place.
+	std::vector<Job*> jobs;
+	jobs.reserve(_scheduled.size());
+
+	for (Job* job : _queue)
+	{
+		if (_scheduled.erase(job) > 0)
+		{
+			jobs.push_back(job);
+		}
+	}
+
+	_queue.clear();
+
+	std::size_t numThreads = _numThreads > 0 ? _numThreads : std::thread::hardware_concurrency();
+
+	if (numThreads <= 1 || jobs.size() < PARALLEL_THRESHOLD)
+	{
+		for (Job* job : jobs)
+		{
+			job->clipWindings();
+		}
+	}
+	else
+	{
+		std::atomic<std::size_t> nextJob(0);
+
+		auto clipJobs = [&]()
+		{
+			for (std::size_t i = nextJob.fetch_add(JOBS_PER_CHUNK); i < jobs.size();
+				 i = nextJob.fetch_add(JOBS_PER_CHUNK))
+			{
+				std::size_t end = std::min(i + JOBS_PER_CHUNK, jobs.size());
+
+				for (std::size_t j = i; j < end; ++j)
+				{
+					jobs[j]->clipWindings();
+				}
+			}
+		};
+
+		numThreads = std::min(numThreads, jobs.size() / JOBS_PER_CHUNK);
+
+		std::vector<std::future<void>> threads;
+
+		for (std::size_t i = 1; i < numThreads; ++i)
+		{
+			threads.push_back(std::async(std::launch::async, clipJobs));
+		}
+
+		clipJobs();
+
+		for (std::future<void>& thread : threads)
+		{
+			thread.get();
+		}
+	}
+
+	_flushing = false;
+}
+
+} // namespace brush
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+
+namespace brush
+{
+
+/**
+ * Collects the brushes which need their windings rebuilt and clips all of
+ * them at once, distributed over the available cores. Clipping the face
+ * windings is the expensive part of a B-rep rebuild and each brush can be
+ * clipped independently of all others.
+ *
+ * Brushes schedule themselves when their planes change. The first brush
+ * which actually needs its B-rep (which happens before the next render pass
+ * or selection test evaluates the scene bounds) calls flush(), which clips
+ * all scheduled brushes. The remaining B-rep work (texture coordinates,
+ * connectivity, observers) is done by each brush on the calling thread.
+ */
+class BRepRebuildScheduler
+{
+public:
+	// A brush as seen by the scheduler
+	class Job
+	{
+	public:
+		virtual ~Job() {}
+
+		// Called on the calling thread before any clipping takes place,
+		// to bring the input of clipWindings() up to date.
+		// Might schedule this or other jobs again.
+		virtual void prepareRebuild() = 0;
+
+		// Calculates the face windings. This is called from worker threads,
+		// so it must not touch anything except the job's own data.
+		virtual void clipWindings() = 0;
+	};
+
+private:
+	// The scheduled jobs in scheduling order, might contain cancelled ones
+	std::vector<Job*> _queue;
+
+	// The jobs which are actually scheduled
+	std::unordered_set<Job*> _scheduled;
+
+	std::size_t _numThreads;
+
+	bool _flushing;
+
+public:
+	BRepRebuildScheduler();
+
+	static BRepRebuildScheduler& Instance();
+
+	// Schedules the given job, does nothing if it is scheduled already
+	void schedule(Job& job);
+
+	// Removes the job from the schedule, this must be called by destructing jobs
+	void cancel(Job& job);
+
+	// Clips the windings of all scheduled jobs. Nested calls return immediately.
+	void flush();
+
+	// Number of currently scheduled jobs
+	std::size_t size() const;
+
+	// The number of threads used for flushing, including the calling one.
+	// Defaults to 0, which uses the hardware concurrency.
+	void setNumThreads(std::size_t numThreads);
+};
+
+} // namespace brush
@@ -54,6 +54,7 @@ Brush::Brush(BrushNode& owner) :
     _uniqueEdgePoints(GL_POINTS),
     m_planeChanged(false),
     m_transformChanged(false),
+    _windingsClipped(false),
 	_detailFlag(Structural)
 {
     onFacePlaneChanged();
@@ -68,6 +69,7 @@ Brush::Brush(BrushNode& owner, const Brush& other) :
     _uniqueEdgePoints(GL_POINTS),
     m_planeChanged(false),
     m_transformChanged(false),
+    _windingsClipped(false),
 	_detailFlag(Structural)
 {
     copy(other);
@@ -76,6 +78,8 @@ Brush::Brush(BrushNode& owner, const Brush& other) :
 Brush::~Brush()
 {
     ASSERT_MESSAGE(m_observers.empty(), "Brush::~Brush: observers still attached");
+
+    brush::BRepRebuildScheduler::Instance().cancel(*this);
 }
 
 BrushNode& Brush::getBrushNode()
@@ -218,6 +222,9 @@ void Brush::setDetailFlag(DetailFlag newValue)
 
 void Brush::evaluateBRep() const {
     if(m_planeChanged) {
+        // Get this brush clipped along with all other ones waiting for a rebuild
+        brush::BRepRebuildScheduler::Instance().flush();
+
         m_planeChanged = false;
         const_cast<Brush*>(this)->buildBRep();
     }
@@ -408,6 +415,7 @@ void Brush::reserve(std::size_t count) {
 
 void Brush::push_back(Faces::value_type face) {
     m_faces.push_back(face);
+    _windingsClipped = false;
 
     if (_undoStateSaver)
     {
@@ -418,10 +426,14 @@ void Brush::push_back(Faces::value_type face) {
         (*i)->push_back(*face);
         (*i)->DEBUG_verify();
     }
+
+    signal_facesChanged().emit(*this);
 }
 
 void Brush::pop_back()
 {
+    _windingsClipped = false;
+
     if (_undoStateSaver)
     {
         m_faces.back()->disconnectUndoSystem(*_mapFileChangeTracker);
@@ -432,10 +444,14 @@ void Brush::pop_back()
         (*i)->pop_back();
         (*i)->DEBUG_verify();
     }
+
+    signal_facesChanged().emit(*this);
 }
 
 void Brush::erase(std::size_t index)
 {
+    _windingsClipped = false;
+
     if (_undoStateSaver)
     {
         m_faces[index]->disconnectUndoSystem(*_mapFileChangeTracker);
@@ -446,11 +462,17 @@ void Brush::erase(std::size_t index)
         (*i)->erase(index);
         (*i)->DEBUG_verify();
     }
+
+    signal_facesChanged().emit(*this);
 }
 
 void Brush::onFacePlaneChanged()
 {
     m_planeChanged = true;
+    _windingsClipped = false;
+
+    brush::BRepRebuildScheduler::Instance().schedule(*this);
+
     aabbChanged();
     _owner.lightsChanged();
 }
@@ -461,6 +483,8 @@ void Brush::onFaceShaderChanged()
 
     // Queue an UI update of the texture tools if any of them is listening
 	signal_faceShaderChanged().emit();
+
+    signal_facesChanged().emit(*this);
 }
 
 void Brush::onFaceConnectivityChanged()
@@ -485,11 +509,14 @@ void Brush::clear()
     }
 
     m_faces.clear();
+    _windingsClipped = false;
 
     for(Observers::iterator i = m_observers.begin(); i != m_observers.end(); ++i) {
         (*i)->clear();
         (*i)->DEBUG_verify();
     }
+
+    signal_facesChanged().emit(*this);
 }
 
 std::size_t Brush::getNumFaces() const
@@ -919,6 +946,12 @@ sigc::signal<void>& Brush::signal_faceShaderChanged()
 	return _sigFaceShaderChanged;
 }
 
+sigc::signal<void, Brush&>& Brush::signal_facesChanged()
+{
+	static sigc::signal<void, Brush&> _sigFacesChanged;
+	return _sigFacesChanged;
+}
+
 void Brush::edge_push_back(FaceVertexId faceVertex) {
     m_select_edges.push_back(SelectableEdge(m_faces, faceVertex));
     for (Observers::iterator i = m_observers.begin(); i != m_observers.end(); ++i) {
@@ -1086,20 +1119,44 @@ bool Brush::isBounded() {
     return true;
 }
 
+void Brush::prepareRebuild()
+{
+    // Transforming the faces must not happen on the worker threads
+    evaluateTransform();
+}
+
+void Brush::clipWindings()
+{
+    for (std::size_t i = 0;  i < m_faces.size(); ++i) {
+        Face& f = *m_faces[i];
+
+        if (!f.plane3().isValid() || !plane_unique(i)) {
+            f.getWinding().resize(0);
+        }
+        else {
+            windingForClipPlane(f.getWinding(), f.plane3());
+        }
+    }
+
+    _windingsClipped = true;
+}
+
 /// \brief Constructs the polygon windings for each face of the brush. Also updates the brush bounding-box and face texture-coordinates.
 bool Brush::buildWindings() {
+    // The scheduler usually did this already, possibly in parallel to other brushes
+    if (!_windingsClipped) {
+        clipWindings();
+    }
+
+    _windingsClipped = false;
+
     {
         m_aabb_local = AABB();
 
         for (std::size_t i = 0;  i < m_faces.size(); ++i) {
             Face& f = *m_faces[i];
 
-            if (!f.plane3().isValid() || !plane_unique(i)) {
-                f.getWinding().resize(0);
-            }
-            else {
-                windingForClipPlane(f.getWinding(), f.plane3());
-
+            if (f.plane3().isValid() && plane_unique(i)) {
                 // update brush bounds
                 const Winding& winding = f.getWinding();
 
@@ -1128,6 +1185,12 @@ bool Brush::buildWindings() {
         verifyConnectivityGraph();
     }
 
+    // The cleanups above might have modified the windings
+    for (const FacePtr& face : m_faces)
+    {
+        face->getWinding().geometryChanged();
+    }
+
     return degenerate;
 }
 
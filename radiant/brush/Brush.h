@@ -6,6 +6,7 @@
 #include "SelectableComponents.h"
 #include "RenderableWireFrame.h"
 #include "Translatable.h"
+#include "BRepRebuildScheduler.h"
 
 #include <sigc++/signal.h>
 #include "util/Noncopyable.h"
@@ -88,6 +89,7 @@ class Brush :
 	public Snappable,
 	public IUndoable,
 	public Translatable,
+	public brush::BRepRebuildScheduler::Job,
 	public util::Noncopyable
 {
 private:
@@ -124,6 +126,7 @@ private:
 
 	mutable bool m_planeChanged; // b-rep evaluation required
 	mutable bool m_transformChanged; // transform evaluation required
+	bool _windingsClipped; // face windings are up to date, see clipWindings()
 	// ----
 
 	DetailFlag _detailFlag;
@@ -151,6 +154,12 @@ public:
 
 		virtual ~BrushUndoMemento() {}
 
+		// The faces are shared with the brush, they save their own state
+		std::size_t getMemoryUsage() const override
+		{
+			return sizeof(*this) + _faces.capacity() * sizeof(FacePtr);
+		}
+
 		Faces _faces;
 		DetailFlag _detailFlag;
 	};
@@ -304,6 +313,9 @@ public:
 	// Signal for external code to get notified each time any face of any brush changes
 	static sigc::signal<void>& signal_faceShaderChanged();
 
+	// Signal emitted with the brush whose faces have been added, removed or got a new shader
+	static sigc::signal<void, Brush&>& signal_facesChanged();
+
 private:
 	void edge_push_back(FaceVertexId faceVertex);
 
@@ -331,6 +343,13 @@ private:
 	/// \brief Returns true if the brush is a finite volume. A brush without a finite volume extends past the maximum world bounds and is not valid.
 	bool isBounded();
 
+	// BRepRebuildScheduler::Job implementation
+	void prepareRebuild() override;
+
+	/// \brief Clips the polygon windings of each face against the other face planes, without
+	/// touching anything outside this brush. Invoked by the BRepRebuildScheduler's worker threads.
+	void clipWindings() override;
+
 	/// \brief Constructs the polygon windings for each face of the brush. Also updates the brush bounding-box and face texture-coordinates.
 	bool buildWindings();
 
@@ -18,7 +18,8 @@ BrushNode::BrushNode() :
 	_faceCentroidPointsCulled(GL_POINTS),
 	m_viewChanged(false),
 	_renderableComponentsNeedUpdate(true),
-    _untransformedOriginChanged(true)
+    _untransformedOriginChanged(true),
+	_previewTransform(Matrix4::getIdentity())
 {
 	m_brush.attach(*this); // BrushObserver
 
@@ -45,7 +46,8 @@ BrushNode::BrushNode(const BrushNode& other) :
 	_faceCentroidPointsCulled(GL_POINTS),
 	m_viewChanged(false),
 	_renderableComponentsNeedUpdate(true),
-    _untransformedOriginChanged(true)
+    _untransformedOriginChanged(true),
+	_previewTransform(Matrix4::getIdentity())
 {
 	m_brush.attach(*this); // BrushObserver
 }
@@ -67,6 +69,12 @@ void BrushNode::lightsChanged()
 }
 
 const AABB& BrushNode::localAABB() const {
+	if (isPreviewingTransform())
+	{
+		_previewAABB = AABB::createFromOrientedAABBSafe(m_brush.localAABB(), _previewTransform);
+		return _previewAABB;
+	}
+
 	return m_brush.localAABB();
 }
 
@@ -82,7 +90,7 @@ void BrushNode::snapComponents(float snap) {
 }
 
 void BrushNode::testSelect(Selector& selector, SelectionTest& test) {
-	test.BeginMesh(localToWorld());
+	test.BeginMesh(getPreviewedTransform(localToWorld()));
 
 	SelectionIntersection best;
 	for (FaceInstances::iterator i = m_faceInstances.begin(); i != m_faceInstances.end(); ++i)
@@ -98,6 +106,13 @@ void BrushNode::testSelect(Selector& selector, SelectionTest& test) {
 	}
 }
 
+bool BrushNode::prepareConcurrentSelectionTest()
+{
+	// Build the windings now, testSelect() is only reading them afterwards
+	m_brush.evaluateBRep();
+	return true;
+}
+
 bool BrushNode::isSelectedComponents() const {
 	for (FaceInstances::const_iterator i = m_faceInstances.begin(); i != m_faceInstances.end(); ++i) {
 		if (i->selectedComponents()) {
@@ -309,6 +324,10 @@ bool BrushNode::intersectsLight(const RendererLight& light) const {
 	return light.intersectsAABB(worldAABB());
 }
 
+const AABB& BrushNode::getLitObjectBounds() const {
+	return worldAABB();
+}
+
 void BrushNode::insertLight(const RendererLight& light) {
 	const Matrix4& l2w = localToWorld();
 	for (FaceInstances::iterator i = m_faceInstances.begin(); i != m_faceInstances.end(); ++i) {
@@ -415,7 +434,9 @@ void BrushNode::evaluateViewDependent(const VolumeTest& volume, const Matrix4& l
 	{
 		// Check if face is filtered before adding to visibility matrix
 		// greebo: Removed localToWorld transformation here, brushes don't have a non-identity l2w
-		if (forceVisible || (i->faceIsVisible() && i->intersectVolume(volume)))
+		// The previewed transformation needs to be taken into account, though
+		if (forceVisible || (i->faceIsVisible() && (isPreviewingTransform() ?
+			i->intersectVolume(volume, _previewTransform) : i->intersectVolume(volume))))
 		{
 			*j = true;
 
@@ -455,7 +476,15 @@ void BrushNode::renderSolid(RenderableCollector& collector,
         collector.setLights(i->m_lights);
 
 		// greebo: BrushNodes have always an identity l2w, don't do any transforms
-		i->submitRenderables(collector, volume, *_renderEntity);
+		// other than the one being previewed
+		if (isPreviewingTransform())
+		{
+			i->submitRenderables(collector, volume, _previewTransform, *_renderEntity);
+		}
+		else
+		{
+			i->submitRenderables(collector, volume, *_renderEntity);
+		}
     }
 
 	renderSelectedPoints(collector, volume, localToWorld);
@@ -467,7 +496,7 @@ void BrushNode::renderWireframe(RenderableCollector& collector, const VolumeTest
 	evaluateViewDependent(volume, localToWorld);
 
 	if (m_render_wireframe.m_size != 0) {
-		collector.addRenderable(m_render_wireframe, localToWorld);
+		collector.addRenderable(m_render_wireframe, getPreviewedTransform(localToWorld));
 	}
 
 	renderSelectedPoints(collector, volume, localToWorld);
@@ -500,10 +529,15 @@ void BrushNode::renderSelectedPoints(RenderableCollector& collector,
 		collector.setHighlightFlag(RenderableCollector::Highlight::Primitives, false);
 		collector.SetState(BrushNode::m_state_selpoint, RenderableCollector::eWireframeOnly);
 		collector.SetState(BrushNode::m_state_selpoint, RenderableCollector::eFullMaterials);
-		collector.addRenderable(_selectedPoints, localToWorld);
+		collector.addRenderable(_selectedPoints, getPreviewedTransform(localToWorld));
 	}
 }
 
+Matrix4 BrushNode::getPreviewedTransform(const Matrix4& localToWorld) const
+{
+	return isPreviewingTransform() ? localToWorld.getMultipliedBy(_previewTransform) : localToWorld;
+}
+
 void BrushNode::evaluateTransform() {
 	Matrix4 matrix(calculateTransform());
 	//rMessage() << "matrix: " << matrix << "\n";
@@ -573,6 +607,20 @@ const Vector3& BrushNode::getUntransformedOrigin()
 
 void BrushNode::_onTransformationChanged()
 {
+	if (isPreviewingTransform())
+	{
+		// Only the matrix used for rendering and selection tests changes,
+		// the faces are transformed once the transformation is frozen
+		_previewTransform = calculateTransform();
+
+		m_viewChanged = true;
+		boundsChanged();
+		lightsChanged();
+		return;
+	}
+
+	_previewTransform = Matrix4::getIdentity();
+
 	m_brush.transformChanged();
 
 	_renderableComponentsNeedUpdate = true;
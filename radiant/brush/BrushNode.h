@@ -64,6 +64,11 @@ class BrushNode :
     // If true, the _untransformedOrigin member needs an update
     bool _untransformedOriginChanged;
 
+	// The transformation the brush is rendered with while it's previewed,
+	// the faces are transformed once the transformation is frozen
+	Matrix4 _previewTransform;
+	mutable AABB _previewAABB;
+
 public:
 	// Constructor
 	BrushNode();
@@ -91,6 +96,7 @@ public:
 
 	// SelectionTestable implementation
 	virtual void testSelect(Selector& selector, SelectionTest& test) override;
+	bool prepareConcurrentSelectionTest() override;
 
 	// ComponentSelectionTestable
 	bool isSelectedComponents() const override;
@@ -138,6 +144,7 @@ public:
 
 	// LitObject implementation
 	bool intersectsLight(const RendererLight& light) const override;
+	const AABB& getLitObjectBounds() const override;
 	void insertLight(const RendererLight& light) override;
 	void clearLights() override;
 
@@ -188,5 +195,8 @@ private:
 	void renderClipPlane(RenderableCollector& collector, const VolumeTest& volume) const;
 	void evaluateViewDependent(const VolumeTest& volume, const Matrix4& localToWorld) const;
 
+	// Returns the given matrix including the previewed transformation, if any
+	Matrix4 getPreviewedTransform(const Matrix4& localToWorld) const;
+
 }; // class BrushNode
 typedef std::shared_ptr<BrushNode> BrushNodePtr;
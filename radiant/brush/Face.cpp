@@ -6,6 +6,7 @@
 #include "irenderable.h"
 
 #include "shaderlib.h"
+#include "BasicUndoMemento.h"
 #include "Winding.h"
 
 #include "Brush.h"
@@ -19,12 +20,16 @@ class Face::SavedState :
 public:
     FacePlane::SavedState _planeState;
     TextureProjection _texdefState;
-    std::string _materialName;
 
-    SavedState(const Face& face) :
+    // Faces rarely change their material, the name is shared by their mementos
+    std::shared_ptr<const std::string> _materialName;
+    bool _ownsMaterialName;
+
+    SavedState(const Face& face, const std::shared_ptr<const std::string>& materialName, bool ownsMaterialName) :
         _planeState(face.getPlane()),
         _texdefState(face.getProjection()),
-        _materialName(face.getShader())
+        _materialName(materialName),
+        _ownsMaterialName(ownsMaterialName)
     {}
 
     virtual ~SavedState() {}
@@ -32,9 +37,39 @@ public:
     void exportState(Face& face) const
     {
         _planeState.exportState(face.getPlane());
-        face.setShader(_materialName);
+        face.setShader(*_materialName);
         face.getProjection().assign(_texdefState);
     }
+
+    // True if this state exactly matches the current state of the given face
+    bool matches(const Face& face) const
+    {
+        const Plane3& plane = face.getPlane().getPlane();
+
+        if (plane.normal() != _planeState.m_plane.normal() || plane.dist() != _planeState.m_plane.dist() ||
+            *_materialName != face.getShader())
+        {
+            return false;
+        }
+
+        const TextureMatrix& matrix = face.getProjection().matrix;
+
+        for (std::size_t i = 0; i < 6; ++i)
+        {
+            if (matrix.coords[i / 3][i % 3] != _texdefState.matrix.coords[i / 3][i % 3])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::size_t getMemoryUsage() const override
+    {
+        return sizeof(*this) + (_ownsMaterialName ?
+            sizeof(std::string) + undo::getAllocatedSize(*_materialName) : 0);
+    }
 };
 
 Face::Face(Brush& owner) :
@@ -161,6 +196,7 @@ void Face::disconnectUndoSystem(IMapFileChangeTracker& changeTracker)
 {
     assert(_undoStateSaver);
     _undoStateSaver = nullptr;
+    _lastState.reset();
     GlobalUndoSystem().releaseStateSaver(*this);
 
     _shader.setInUse(false);
@@ -177,14 +213,32 @@ void Face::undoSave()
 // undoable
 IUndoMementoPtr Face::exportState() const
 {
-    return IUndoMementoPtr(new SavedState(*this));
+    // Share the last memento if the face didn't change since, like when undoing and redoing
+    if (_lastState && _lastState->matches(*this))
+    {
+        return _lastState;
+    }
+
+    if (_lastState && *_lastState->_materialName == getShader())
+    {
+        _lastState = std::make_shared<SavedState>(*this, _lastState->_materialName, false);
+    }
+    else
+    {
+        _lastState = std::make_shared<SavedState>(*this, std::make_shared<std::string>(getShader()), true);
+    }
+
+    return _lastState;
 }
 
 void Face::importState(const IUndoMementoPtr& data)
 {
     undoSave();
 
-	std::static_pointer_cast<SavedState>(data)->exportState(*this);
+    std::shared_ptr<SavedState> state = std::static_pointer_cast<SavedState>(data);
+    state->exportState(*this);
+
+    _lastState = state;
 
     planeChanged();
     _owner.onFaceConnectivityChanged();
@@ -303,6 +357,7 @@ void Face::freezeTransform() {
 
 void Face::updateWinding() {
     m_winding.updateNormals(m_plane.getPlane().normal());
+    m_winding.geometryChanged();
 }
 
 void Face::update_move_planepts_vertex(std::size_t index, PlanePoints planePoints) {
@@ -514,6 +569,7 @@ void Face::alignTexture(EAlignType align)
 
 void Face::EmitTextureCoordinates() {
     m_texdefTransformed.emitTextureCoordinates(m_winding, plane3().normal(), Matrix4::getIdentity());
+    m_winding.geometryChanged();
 }
 
 void Face::applyDefaultTextureScale()
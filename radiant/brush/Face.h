@@ -58,6 +58,10 @@ private:
 
 	IUndoStateSaver* _undoStateSaver;
 
+	// The last exported or imported state, shared with the next operation
+	// if the face didn't change in between
+	mutable std::shared_ptr<SavedState> _lastState;
+
 	// Cached visibility flag, queried during front end rendering
 	bool _faceIsVisible;
 
@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "igl.h"
 #include "itextstream.h"
 #include <algorithm>
+#include <atomic>
 #include "FixedWinding.h"
 #include "math/Ray.h"
 #include "math/Plane3.h"
@@ -54,6 +55,61 @@ namespace {
 	}
 }
 
+namespace
+{
+	// Revisions are unique across all windings, see BatchableRenderable
+	std::atomic<std::size_t> _nextRevision(1);
+}
+
+Winding::Winding() :
+	_revision(_nextRevision++)
+{}
+
+Winding::Winding(const Winding& other) :
+	IWinding(other),
+	_revision(_nextRevision++)
+{}
+
+Winding& Winding::operator=(const Winding& other)
+{
+	IWinding::operator=(other);
+	geometryChanged();
+
+	return *this;
+}
+
+void Winding::geometryChanged()
+{
+	_revision = _nextRevision++;
+}
+
+std::size_t Winding::getGeometryRevision() const
+{
+	return _revision;
+}
+
+std::size_t Winding::getNumBatchVertices() const
+{
+	return size();
+}
+
+void Winding::writeBatchVertices(BatchVertex* vertices) const
+{
+	for (const_iterator i = begin(); i != end(); ++i, ++vertices)
+	{
+		for (std::size_t j = 0; j < 3; ++j)
+		{
+			vertices->vertex[j] = static_cast<float>(i->vertex[j]);
+			vertices->normal[j] = static_cast<float>(i->normal[j]);
+			vertices->tangent[j] = static_cast<float>(i->tangent[j]);
+			vertices->bitangent[j] = static_cast<float>(i->bitangent[j]);
+		}
+
+		vertices->texcoord[0] = static_cast<float>(i->texcoord[0]);
+		vertices->texcoord[1] = static_cast<float>(i->texcoord[1]);
+	}
+}
+
 void Winding::drawWireframe() const
 {
 	if (!empty())
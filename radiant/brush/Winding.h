@@ -42,9 +42,23 @@ class SelectionIntersection;
 // by a few methods for rendering and selection tests.
 class Winding :
 	public IWinding,
-    public OpenGLRenderable
+    public OpenGLRenderable,
+    public BatchableRenderable
 {
+private:
+	// Identifies the current state of the vertices (see geometryChanged())
+	std::size_t _revision;
+
 public:
+	Winding();
+	Winding(const Winding& other);
+
+	Winding& operator=(const Winding& other);
+
+	// Acquires a new geometry revision. This must be called after the vertices
+	// have been modified, such that the render system refreshes its copy.
+	void geometryChanged();
+
 	/** greebo: Calculates the AABB of this winding
 	 */
 	AABB aabb() const;
@@ -61,6 +75,16 @@ public:
 	// Submits the wireframe render commands to OpenGL
 	void drawWireframe() const;
 
+	const BatchableRenderable* getBatchable() const override
+	{
+		return this;
+	}
+
+	// BatchableRenderable implementation
+	std::size_t getGeometryRevision() const override;
+	std::size_t getNumBatchVertices() const override;
+	void writeBatchVertices(BatchVertex* vertices) const override;
+
 	// Wraps the given index around if it's larger than the size of this winding
 	inline std::size_t wrap(std::size_t i) const
 	{
@@ -1,6 +1,10 @@
 #include "CSG.h"
 
 #include <map>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <unordered_set>
 
 #include "i18n.h"
 #include "itextstream.h"
@@ -15,6 +19,8 @@
 #include "shaderlib.h"
 
 #include "registry/registry.h"
+#include "render/NopVolumeTest.h"
+#include "math/Frustum.h"
 #include "brush/Face.h"
 #include "brush/Brush.h"
 #include "brush/BrushNode.h"
@@ -31,6 +37,48 @@ namespace algorithm {
 
 const std::string RKEY_EMIT_CSG_SUBTRACT_WARNING("user/ui/brush/emitCSGSubtractWarning");
 
+namespace
+{
+	// Fewer candidate brushes are tested by the calling thread
+	const std::size_t PARALLEL_SUBTRACT_THRESHOLD = 64;
+
+	// Volume test accepting everything touching the given box. The box
+	// planes are offered as culling frustum, so the space partition can
+	// cull the node bounds without calling TestAABB for each of them.
+	class BoundsVolumeTest :
+		public render::NopVolumeTest
+	{
+	private:
+		Frustum _frustum;
+
+	public:
+		BoundsVolumeTest(const AABB& bounds) :
+			_frustum(
+				Plane3(-1, 0, 0, -bounds.origin.x() - bounds.extents.x()),
+				Plane3(1, 0, 0, bounds.origin.x() - bounds.extents.x()),
+				Plane3(0, 1, 0, bounds.origin.y() - bounds.extents.y()),
+				Plane3(0, -1, 0, -bounds.origin.y() - bounds.extents.y()),
+				Plane3(0, 0, -1, -bounds.origin.z() - bounds.extents.z()),
+				Plane3(0, 0, 1, bounds.origin.z() - bounds.extents.z()))
+		{}
+
+		VolumeIntersectionValue TestAABB(const AABB& aabb) const override
+		{
+			return _frustum.testIntersection(aabb);
+		}
+
+		VolumeIntersectionValue TestAABB(const AABB& aabb, const Matrix4& localToWorld) const override
+		{
+			return _frustum.testIntersection(aabb, localToWorld);
+		}
+
+		const Frustum* getCullingFrustum() const override
+		{
+			return &_frustum;
+		}
+	};
+}
+
 void hollowBrush(const BrushNodePtr& sourceBrush, bool makeRoom)
 {
 	// Hollow the brush using the current grid size
@@ -136,7 +184,29 @@ BrushSplitType Brush_classifyPlane(const Brush& brush, const Plane3& plane) {
 	return split;
 }
 
-// Returns true if fragments have been inserted into the given ret_fragments list
+// Returns true if the brush is entirely in front of one of the other brush's faces,
+// in which case Brush_subtract() is guaranteed to leave it alone. This doesn't
+// modify any of the brushes, their B-reps must be up to date.
+bool Brush_isSeparatedBy(const Brush& brush, const Brush& other)
+{
+	for (Brush::const_iterator i(other.begin()); i != other.end(); ++i)
+	{
+		if (!(*i)->contributes()) continue;
+
+		BrushSplitType split = Brush_classifyPlane(brush, (*i)->plane3());
+
+		// Vertices on the plane are not accepted, to stay on the safe side
+		if (split.counts[ePlaneBack] == 0 && split.counts[ePlaneOn] == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Returns true if fragments have been inserted into the given ret_fragments list.
+// The given brush itself is never modified, it is only cloned if it's getting split.
 bool Brush_subtract(const BrushNodePtr& brush, const Brush& other, BrushPtrVector& ret_fragments)
 {
 	if (brush->getBrush().localAABB().intersects(other.localAABB()))
@@ -144,7 +214,9 @@ bool Brush_subtract(const BrushNodePtr& brush, const Brush& other, BrushPtrVecto
 		BrushPtrVector fragments;
 		fragments.reserve(other.getNumFaces());
 
-		BrushNodePtr back = std::dynamic_pointer_cast<BrushNode>(brush->clone());
+		// The remaining part, this is the source brush until the first split happens
+		BrushNodePtr back;
+		const BrushNodePtr* current = &brush;
 
 		for (Brush::const_iterator i(other.begin()); i != other.end(); ++i)
 		{
@@ -152,10 +224,16 @@ bool Brush_subtract(const BrushNodePtr& brush, const Brush& other, BrushPtrVecto
 
 			if (!face.contributes()) continue;
 
-			BrushSplitType split = Brush_classifyPlane(back->getBrush(), face.plane3());
+			BrushSplitType split = Brush_classifyPlane((*current)->getBrush(), face.plane3());
 
 			if (split.counts[ePlaneFront] != 0 && split.counts[ePlaneBack] != 0)
 			{
+				if (!back)
+				{
+					back = std::dynamic_pointer_cast<BrushNode>(brush->clone());
+					current = &back;
+				}
+
 				fragments.push_back(std::dynamic_pointer_cast<BrushNode>(back->clone()));
 
 				FacePtr newFace = fragments.back()->getBrush().addFace(face);
@@ -180,6 +258,95 @@ bool Brush_subtract(const BrushNodePtr& brush, const Brush& other, BrushPtrVecto
 	return false;
 }
 
+// Returns the unselected, visible brushes which might get split by the given ones.
+// Candidates are looked up in the space partition and tested against the selected
+// brushes' face planes, distributed over several threads.
+std::unordered_set<scene::INode*> findSubtractCandidates(const BrushPtrVector& brushlist)
+{
+	AABB selectionBounds;
+
+	for (const BrushNodePtr& brush : brushlist)
+	{
+		selectionBounds.includeAABB(brush->worldAABB());
+	}
+
+	std::vector<BrushNodePtr> candidates;
+	BoundsVolumeTest volume(selectionBounds);
+
+	GlobalSceneGraph().foreachNodeInVolume(volume, [&](const scene::INodePtr& node)
+	{
+		if (node->visible() && Node_isBrush(node) && !Node_isSelected(node))
+		{
+			candidates.push_back(std::dynamic_pointer_cast<BrushNode>(node));
+		}
+
+		return true;
+	});
+
+	// Rebuild everything up front, the tests below must not modify the brushes
+	for (const BrushNodePtr& brush : brushlist)
+	{
+		brush->getBrush().evaluateBRep();
+	}
+
+	for (const BrushNodePtr& candidate : candidates)
+	{
+		candidate->getBrush().evaluateBRep();
+	}
+
+	// One flag per candidate, to not share any containers between the threads
+	std::vector<char> affected(candidates.size(), 0);
+
+	std::atomic<std::size_t> next(0);
+
+	auto testCandidates = [&]()
+	{
+		for (std::size_t i = next++; i < candidates.size(); i = next++)
+		{
+			const Brush& candidate = candidates[i]->getBrush();
+
+			for (const BrushNodePtr& brush : brushlist)
+			{
+				if (candidate.localAABB().intersects(brush->getBrush().localAABB()) &&
+					!Brush_isSeparatedBy(candidate, brush->getBrush()))
+				{
+					affected[i] = 1;
+					break;
+				}
+			}
+		}
+	};
+
+	std::size_t numThreads = candidates.size() < PARALLEL_SUBTRACT_THRESHOLD ? 1 :
+		std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+	std::vector<std::future<void>> threads;
+
+	for (std::size_t i = 1; i < numThreads; ++i)
+	{
+		threads.push_back(std::async(std::launch::async, testCandidates));
+	}
+
+	testCandidates();
+
+	for (std::future<void>& thread : threads)
+	{
+		thread.get();
+	}
+
+	std::unordered_set<scene::INode*> result;
+
+	for (std::size_t i = 0; i < candidates.size(); ++i)
+	{
+		if (affected[i])
+		{
+			result.insert(candidates[i].get());
+		}
+	}
+
+	return result;
+}
+
 class SubtractBrushesFromUnselected :
 	public scene::NodeVisitor
 {
@@ -187,12 +354,16 @@ class SubtractBrushesFromUnselected :
 	std::size_t& _before;
 	std::size_t& _after;
 
+	// The brushes which might be affected, see findSubtractCandidates()
+	std::unordered_set<scene::INode*> _candidates;
+
 	std::list<scene::INodePtr> _deleteList;
 public:
 	SubtractBrushesFromUnselected(const BrushPtrVector& brushlist, std::size_t& before, std::size_t& after) :
 		_brushlist(brushlist),
 		_before(before),
-		_after(after)
+		_after(after),
+		_candidates(findSubtractCandidates(brushlist))
 	{}
 
 	virtual ~SubtractBrushesFromUnselected() {
@@ -208,79 +379,75 @@ public:
 	}
 
 	void post(const scene::INodePtr& node) {
-		if (!node->visible()) {
+		// The scene is still walked in full to keep the order of the new brushes,
+		// but only the candidates found through the space partition are processed
+		if (_candidates.find(node.get()) == _candidates.end()) {
 			return;
 		}
 
-		Brush* brush = Node_getBrush(node);
-
-		if (brush != NULL && !Node_isSelected(node))
-		{
-			BrushNodePtr brushNode = std::dynamic_pointer_cast<BrushNode>(node);
-
-			// Get the parent of this brush
-			scene::INodePtr parent = node->getParent();
-			assert(parent != NULL); // parent should not be NULL
+		BrushNodePtr brushNode = std::dynamic_pointer_cast<BrushNode>(node);
 
-			BrushPtrVector buffer[2];
-			std::size_t swap = 0;
+		// Get the parent of this brush
+		scene::INodePtr parent = node->getParent();
+		assert(parent != NULL); // parent should not be NULL
 
-			BrushNodePtr original = std::dynamic_pointer_cast<BrushNode>(brushNode->clone());
+		BrushPtrVector buffer[2];
+		std::size_t swap = 0;
 
-			//Brush* original = new Brush(*brush);
-			buffer[swap].push_back(original);
+		// Brush_subtract() doesn't modify the brush, it's cloned on the first split
+		BrushNodePtr original = brushNode;
+		buffer[swap].push_back(original);
 
-			// Iterate over all selected brushes
-			for (BrushPtrVector::const_iterator i(_brushlist.begin()); i != _brushlist.end(); ++i)
+		// Iterate over all selected brushes
+		for (BrushPtrVector::const_iterator i(_brushlist.begin()); i != _brushlist.end(); ++i)
+		{
+			for (BrushPtrVector::iterator j(buffer[swap].begin());
+				 j != buffer[swap].end(); ++j)
 			{
-				for (BrushPtrVector::iterator j(buffer[swap].begin());
-					 j != buffer[swap].end(); ++j)
+				if (Brush_subtract(*j, (*i)->getBrush(), buffer[1 - swap]))
 				{
-					if (Brush_subtract(*j, (*i)->getBrush(), buffer[1 - swap]))
-					{
-						// greebo: Delete not necessary, nodes get deleted automatically by clear() below
-						// delete (*j);
-					}
-					else
-					{
-						buffer[1 - swap].push_back(*j);
-					}
+					// greebo: Delete not necessary, nodes get deleted automatically by clear() below
+					// delete (*j);
+				}
+				else
+				{
+					buffer[1 - swap].push_back(*j);
 				}
-
-				buffer[swap].clear();
-				swap = 1 - swap;
 			}
 
-			BrushPtrVector& out = buffer[swap];
+			buffer[swap].clear();
+			swap = 1 - swap;
+		}
 
-			if (out.size() == 1 && out.back() == original)
-			{
-				// greebo: shared_ptr is taking care of this
-				//delete original;
-			}
-			else
-			{
-				_before++;
+		BrushPtrVector& out = buffer[swap];
 
-				for (BrushPtrVector::const_iterator i = out.begin(); i != out.end(); ++i)
-				{
-					_after++;
+		if (out.size() == 1 && out.back() == original)
+		{
+			// greebo: shared_ptr is taking care of this
+			//delete original;
+		}
+		else
+		{
+			_before++;
 
-					scene::INodePtr newBrush = GlobalBrushCreator().createBrush();
+			for (BrushPtrVector::const_iterator i = out.begin(); i != out.end(); ++i)
+			{
+				_after++;
 
-					parent->addChildNode(newBrush);
+				scene::INodePtr newBrush = GlobalBrushCreator().createBrush();
 
-					// Move the new Brush to the same layers as the source node
-					newBrush->assignToLayers(node->getLayers());
+				parent->addChildNode(newBrush);
 
-					(*i)->getBrush().removeEmptyFaces();
-					ASSERT_MESSAGE(!(*i)->getBrush().empty(), "brush left with no faces after subtract");
+				// Move the new Brush to the same layers as the source node
+				newBrush->assignToLayers(node->getLayers());
 
-					Node_getBrush(newBrush)->copy((*i)->getBrush());
-				}
+				(*i)->getBrush().removeEmptyFaces();
+				ASSERT_MESSAGE(!(*i)->getBrush().empty(), "brush left with no faces after subtract");
 
-			    _deleteList.push_back(node);
+				Node_getBrush(newBrush)->copy((*i)->getBrush());
 			}
+
+		    _deleteList.push_back(node);
 		}
 	}
 };
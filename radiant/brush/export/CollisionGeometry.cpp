@@ -0,0 +1,350 @@
+#include "CollisionGeometry.h"
+
+#include "itextstream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace cmutil {
+
+	namespace
+	{
+		const float MAX_PRECISION = 0.0001f;
+
+		inline void combineHash(std::size_t& seed, std::size_t value)
+		{
+			seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		}
+
+		// The sorted absolute edge indices, two polygons with the same
+		// signature are consisting of the same edges
+		EdgeList getSignature(const EdgeList& edges)
+		{
+			EdgeList signature;
+			signature.reserve(edges.size());
+
+			for (int edge : edges)
+			{
+				signature.push_back(abs(edge));
+			}
+
+			std::sort(signature.begin(), signature.end());
+
+			return signature;
+		}
+
+		bool isRegular(const EdgeList& signature)
+		{
+			return std::adjacent_find(signature.begin(), signature.end()) == signature.end();
+		}
+
+		// The polygon comparison as it's been done by the exhaustive search:
+		// the polygons are considered equal if the number of matching edge
+		// index pairs equals the number of edges. For polygons referencing
+		// every edge only once this means the edge sets are the same.
+		bool edgesMatch(const Polygon& polygon, const EdgeList& otherEdges)
+		{
+			if (otherEdges.size() != polygon.numEdges)
+			{
+				return false;
+			}
+
+			std::size_t matches = 0;
+
+			for (std::size_t i = 0; i < polygon.edges.size(); i++)
+			{
+				for (std::size_t j = 0; j < otherEdges.size(); j++)
+				{
+					if (abs(polygon.edges[i]) == abs(otherEdges[j]))
+					{
+						matches++;
+					}
+				}
+			}
+
+			return matches == otherEdges.size();
+		}
+	}
+
+std::size_t CollisionGeometry::VertexHash::operator()(const Vector3& vertex) const
+{
+	// The snapped coordinates are whole multiples of the precision,
+	// hash these multiples (this treats -0 and +0 alike)
+	std::size_t seed = 0;
+
+	for (std::size_t i = 0; i < 3; ++i)
+	{
+		combineHash(seed, std::hash<long>()(std::lrint(vertex[i] / MAX_PRECISION)));
+	}
+
+	return seed;
+}
+
+std::size_t CollisionGeometry::EdgeKeyHash::operator()(const std::pair<std::size_t, std::size_t>& key) const
+{
+	std::size_t seed = std::hash<std::size_t>()(key.first);
+	combineHash(seed, std::hash<std::size_t>()(key.second));
+	return seed;
+}
+
+std::size_t CollisionGeometry::SignatureHash::operator()(const EdgeList& signature) const
+{
+	std::size_t seed = signature.size();
+
+	for (int edge : signature)
+	{
+		combineHash(seed, std::hash<int>()(edge));
+	}
+
+	return seed;
+}
+
+CollisionGeometry::CollisionGeometry() :
+	_nextPolygonId(0)
+{
+	// Create the "NULL" edge (numVertices = 0)
+	_edges[0] = Edge(0);
+	_edgeIndex[std::make_pair(0, 0)] = 0;
+}
+
+const VertexMap& CollisionGeometry::getVertices() const
+{
+	return _vertices;
+}
+
+const EdgeMap& CollisionGeometry::getEdges() const
+{
+	return _edges;
+}
+
+const PolygonList& CollisionGeometry::getPolygons() const
+{
+	return _polygons;
+}
+
+int CollisionGeometry::findVertex(const Vector3& vertex) const
+{
+	auto found = _vertexIndex.find(vertex);
+
+	return found != _vertexIndex.end() ? static_cast<int>(found->second) : -1;
+}
+
+std::size_t CollisionGeometry::addVertex(const Vector3& vertex)
+{
+	Vector3 snapped = vertex.getSnapped(MAX_PRECISION);
+
+	// Try to lookup the index of the given vertex
+	int foundIndex = findVertex(snapped);
+
+	if (foundIndex == -1) {
+		// Insert the vertex at the end of the VertexMap
+		// The size of the map is the highest index + 1
+		std::size_t lastIndex = _vertices.size();
+		_vertices[lastIndex] = snapped;
+		_vertexIndex.emplace(snapped, lastIndex);
+
+		return lastIndex;
+	}
+	else {
+		// Return the found index
+		return static_cast<std::size_t>(foundIndex);
+	}
+}
+
+int CollisionGeometry::findEdge(const Edge& edge) const
+{
+	auto found = _edgeIndex.find(std::minmax(edge.from, edge.to));
+
+	if (found == _edgeIndex.end())
+	{
+		return 0;
+	}
+
+	const Edge& existing = _edges.find(found->second)->second;
+
+	// Direction match? Otherwise it's connecting the vertices the other way round
+	if (existing.from == edge.from && existing.to == edge.to) {
+		return static_cast<int>(found->second);
+	}
+
+	return -static_cast<int>(found->second);
+}
+
+std::size_t CollisionGeometry::addEdge(const Edge& edge)
+{
+	// Check for existing edge!
+	int foundIndex = findEdge(edge);
+
+	if (foundIndex == 0) {
+		// NULL edge found, insert the edge with a new index
+		std::size_t edgeIndex = _edges.size();
+		_edges[edgeIndex] = edge;
+
+		// Lookups are returning the first edge connecting these vertices,
+		// don't replace an existing entry (the NULL edge is connecting 0 and 0)
+		_edgeIndex.emplace(std::minmax(edge.from, edge.to), edgeIndex);
+
+		return edgeIndex;
+	}
+	else {
+		return abs(foundIndex);
+	}
+}
+
+std::size_t CollisionGeometry::getPolygonPosition(std::size_t id) const
+{
+	return std::lower_bound(_polygonIds.begin(), _polygonIds.end(), id) - _polygonIds.begin();
+}
+
+void CollisionGeometry::removePolygon(std::size_t position)
+{
+	std::size_t id = _polygonIds[position];
+	EdgeList signature = getSignature(_polygons[position].edges);
+
+	if (isRegular(signature))
+	{
+		auto bucket = _polygonsBySignature.find(signature);
+		bucket->second.erase(std::find(bucket->second.begin(), bucket->second.end(), id));
+
+		if (bucket->second.empty())
+		{
+			_polygonsBySignature.erase(bucket);
+		}
+	}
+	else
+	{
+		_irregularPolygons.erase(std::find(_irregularPolygons.begin(), _irregularPolygons.end(), id));
+	}
+
+	_polygonIds.erase(_polygonIds.begin() + position);
+	_polygons.erase(_polygons.begin() + position);
+}
+
+int CollisionGeometry::findPolygon(const EdgeList& otherEdges)
+{
+	EdgeList signature = getSignature(otherEdges);
+
+	// The position of the first matching polygon
+	std::size_t position = _polygons.size();
+
+	if (isRegular(signature))
+	{
+		// All regular polygons with the same edges are in the same bucket
+		auto bucket = _polygonsBySignature.find(signature);
+
+		if (bucket != _polygonsBySignature.end())
+		{
+			position = getPolygonPosition(bucket->second.front());
+		}
+
+		// An irregular polygon in front of it might match as well
+		for (std::size_t id : _irregularPolygons)
+		{
+			std::size_t p = getPolygonPosition(id);
+
+			if (p >= position) break;
+
+			if (edgesMatch(_polygons[p], otherEdges))
+			{
+				position = p;
+				break;
+			}
+		}
+	}
+	else
+	{
+		// Edges referenced multiple times, go through all of them
+		for (std::size_t p = 0; p < _polygons.size(); p++)
+		{
+			if (edgesMatch(_polygons[p], otherEdges))
+			{
+				position = p;
+				break;
+			}
+		}
+	}
+
+	if (position == _polygons.size())
+	{
+		return -1;
+	}
+
+	// Remove the duplicate polygon
+	removePolygon(position);
+	rMessage() << "CollisionModel: Removed duplicate polygon.\n";
+
+	return static_cast<int>(position);
+}
+
+void CollisionGeometry::addPolygon(const VertexList& vertexList, const Plane3& plane,
+								   const AABB& bounds, const std::string& shader)
+{
+	Polygon poly;
+
+	// Cycle from the beginning to the end-1 and add the edges
+	for (std::size_t i = 0; i < vertexList.size()-1; i++) {
+		Edge edge;
+		edge.from = vertexList[i];
+		edge.to = vertexList[i+1];
+
+		// Lookup the edge (the sign is interpreted as direction)
+		// and add it to the edge list
+		poly.edges.push_back(findEdge(edge));
+	}
+
+	if (findPolygon(poly.edges) == -1) {
+		poly.numEdges = poly.edges.size();
+		poly.plane = plane;
+		poly.min = bounds.origin - bounds.extents;
+		poly.max = bounds.origin + bounds.extents;
+		poly.shader = shader;
+
+		EdgeList signature = getSignature(poly.edges);
+		std::size_t id = _nextPolygonId++;
+
+		if (isRegular(signature))
+		{
+			_polygonsBySignature[signature].push_back(id);
+		}
+		else
+		{
+			_irregularPolygons.push_back(id);
+		}
+
+		_polygonIds.push_back(id);
+		_polygons.push_back(poly);
+	}
+}
+
+VertexList CollisionGeometry::addWinding(const std::vector<Vector3>& points)
+{
+	VertexList vertexList;
+
+	for (const Vector3& point : points) {
+		// Create a vertexId and add it to the stack
+		vertexList.push_back(addVertex(point));
+	}
+	// Now add the first vertex a second time to the end of the list
+	vertexList.push_back(addVertex(points.front()));
+
+	if (vertexList.size() > 1) {
+		Edge edge;
+
+		// Now work through the stack, adding the edges (note the -1 in the for condition)
+		for (std::size_t i = 0; i < vertexList.size()-1; i++) {
+			edge.from = vertexList[i];
+			edge.to = vertexList[i+1];
+
+			addEdge(edge);
+		}
+	}
+	else {
+		rError() << "Warning: degenerate winding found.\n";
+	}
+
+	// Now that all edges are added, return the VertexList defining the winding
+	return vertexList;
+}
+
+} // namespace cmutil
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Geometry.h"
+#include "math/AABB.h"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace cmutil {
+
+/**
+ * greebo: The welded vertices, edges and polygons of a CollisionModel.
+ *
+ * Vertices are snapped to a fixed precision and welded with every vertex
+ * snapping to the same position, edges are welded with every edge connecting
+ * the same two vertices (in either direction) and polygons consisting of the
+ * same edges are removed in pairs (these are the faces of touching brushes).
+ *
+ * All lookups are going through hash tables: the vertices are hashed by the
+ * grid cell they snapped to, the edges by their sorted vertex pair and the
+ * polygons by the sorted list of their edge indices. The resulting indices
+ * and orders are the same as the ones of an exhaustive search through the
+ * lists, which the .cm files written by previous versions are based on.
+ */
+class CollisionGeometry
+{
+	// Hashes a snapped vertex by its grid cell
+	struct VertexHash
+	{
+		std::size_t operator()(const Vector3& vertex) const;
+	};
+
+	// Hashes an edge by its vertex indices
+	struct EdgeKeyHash
+	{
+		std::size_t operator()(const std::pair<std::size_t, std::size_t>& key) const;
+	};
+
+	// Hashes the sorted absolute edge indices of a polygon
+	struct SignatureHash
+	{
+		std::size_t operator()(const EdgeList& signature) const;
+	};
+
+	// The container instances with all the vertices/edges/faces
+	VertexMap _vertices;
+	EdgeMap _edges;
+	PolygonList _polygons;
+
+	// Snapped vertex => vertex index
+	std::unordered_map<Vector3, std::size_t, VertexHash> _vertexIndex;
+
+	// Sorted vertex pair => index of the first edge connecting them
+	std::unordered_map<std::pair<std::size_t, std::size_t>, std::size_t, EdgeKeyHash> _edgeIndex;
+
+	// Every polygon gets a unique, increasing ID, this is the ID of the
+	// polygon at the same position in the PolygonList (ascending)
+	std::vector<std::size_t> _polygonIds;
+	std::size_t _nextPolygonId;
+
+	// Signature => IDs of the polygons with this signature (ascending)
+	std::unordered_map<EdgeList, std::vector<std::size_t>, SignatureHash> _polygonsBySignature;
+
+	// The IDs of the polygons referencing an edge more than once. Such
+	// polygons might match polygons with a different signature.
+	std::vector<std::size_t> _irregularPolygons;
+
+public:
+	CollisionGeometry();
+
+	/** greebo: "Parses" the given winding points and adds its
+	 * 			geometry info (vertices, edges) into the maps.
+	 *
+	 * @returns: the VertexList defining the Winding points in a
+	 * 			 closed loop (last vertexId = first vertexId)
+	 */
+	VertexList addWinding(const std::vector<Vector3>& points);
+
+	/** greebo: Adds a polygon basing on the given vertexlist, which
+	 * 			needs to be a closed loop as returned by addWinding().
+	 * 			If a polygon with the same edges exists already, that
+	 * 			polygon is removed and the given one is not added.
+	 */
+	void addPolygon(const VertexList& vertexList, const Plane3& plane,
+					const AABB& bounds, const std::string& shader);
+
+	const VertexMap& getVertices() const;
+	const EdgeMap& getEdges() const;
+	const PolygonList& getPolygons() const;
+
+private:
+	/** greebo: Adds the given vertex to the internal vertex list
+	 * and returns its index. If the vertex already exists,
+	 * the index to the existing vertex is returned.
+	 *
+	 * @returns: the index of the (existing/inserted) vertex.
+	 */
+	std::size_t addVertex(const Vector3& vertex);
+
+	/** greebo: Tries to lookup the index of the given (snapped) vertex.
+	 *
+	 * @returns: the index of the vertex or -1 if not found
+	 */
+	int findVertex(const Vector3& vertex) const;
+
+	/** greebo: Adds the given edge to the internal edge map
+	 * and returns its index. If the edge already exists,
+	 * the index to the existing edge is returned.
+	 *
+	 * @returns: the index of the (existing/inserted) edge.
+	 */
+	std::size_t addEdge(const Edge& edge);
+
+	/** greebo: Tries to lookup the index of the given edge,
+	 * 			and returns the index with the factor +1/-1
+	 * 			according to the direction.
+	 *
+	 * @returns: +index / -index of the edge or 0 for the NULL edge
+	 */
+	int findEdge(const Edge& edge) const;
+
+	/** greebo: Tries to lookup the index of the matching polygon.
+	 * 			All the Edge indices are compared regardless of
+	 * 			their order. A matching polygon is removed.
+	 *
+	 * @returns: the index of the polygon or -1 if not found
+	 */
+	int findPolygon(const EdgeList& otherEdges);
+
+	// Returns the position of the polygon with the given ID
+	std::size_t getPolygonPosition(std::size_t id) const;
+
+	// Removes the polygon at the given position from the list and the index
+	void removePolygon(std::size_t position);
+};
+
+} // namespace cmutil
@@ -76,167 +76,8 @@ std::ostream& operator<< (std::ostream& st, const BrushStruc b) {
 	return st;
 }
 
-CollisionModel::CollisionModel() {
-	// Create the "NULL" edge (numVertices = 0)
-	_edges[0] = Edge(0);
-}
-
-int CollisionModel::findVertex(const Vector3& vertex) const {
-	for (VertexMap::const_iterator i = _vertices.begin();
-		i != _vertices.end();
-		++i)
-	{
-		if (i->second == vertex) {
-			return static_cast<int>(i->first);
-		}
-	}
-	return -1;
-}
-
-std::size_t CollisionModel::addVertex(const Vector3& vertex)
-{
-	Vector3 snapped = vertex.getSnapped(MAX_PRECISION);
-
-	// Try to lookup the index of the given vertex
-	int foundIndex = findVertex(snapped);
-
-	if (foundIndex == -1) {
-		// Insert the vertex at the end of the VertexMap
-		// The size of the map is the highest index + 1
-		std::size_t lastIndex = _vertices.size();
-		_vertices[lastIndex] = snapped;
-
-		return lastIndex;
-	}
-	else {
-		// Return the found index
-		return static_cast<std::size_t>(foundIndex);
-	}
-}
-
-int CollisionModel::findEdge(const Edge& edge) const {
-	for (EdgeMap::const_iterator i = _edges.begin();
-		 i != _edges.end();
-		 i++)
-	{
-		// Direction match?
-		if (i->second.from == edge.from && i->second.to == edge.to) {
-			return static_cast<int>(i->first);
-		}
-
-		// Opposite direction match?
-		if (i->second.from == edge.to && i->second.to == edge.from) {
-			return -static_cast<int>(i->first);
-		}
-	}
-	return 0;
-}
-
-std::size_t CollisionModel::addEdge(const Edge& edge) {
-	// Check for existing edge!
-	int foundIndex = findEdge(edge);
-
-	if (foundIndex == 0) {
-		// NULL edge found, insert the edge with a new index
-		std::size_t edgeIndex = _edges.size();
-		_edges[edgeIndex] = edge;
-		return edgeIndex;
-	}
-	else {
-		return abs(foundIndex);
-	}
-}
-
-int CollisionModel::findPolygon(const EdgeList& otherEdges) {
-	for (std::size_t p = 0; p < _polygons.size(); p++) {
-		// Check if the edge count matches
-		if (otherEdges.size() == _polygons[p].numEdges) {
-			// The match count
-			std::size_t matches = 0;
-
-			// See through the current polygon and count the matches
-			for (std::size_t i = 0; i < _polygons[p].edges.size(); i++) {
-				for (std::size_t j = 0; j < otherEdges.size(); j++) {
-					if (abs(_polygons[p].edges[i]) == abs(otherEdges[j])) {
-						matches++;
-					}
-				}
-			}
-
-			// If the polygons are the same, all the edge indices matched
-			if (matches == otherEdges.size()) {
-				// Remove the duplicate polygon
-				PolygonList::iterator i = _polygons.begin() + p;
-				_polygons.erase(i);
-				rMessage() << "CollisionModel: Removed duplicate polygon.\n";
-				return static_cast<int>(p);
-			}
-		}
-	}
-	return -1;
-}
-
-void CollisionModel::addPolygon(
-	const Face& face,
-	const VertexList& vertexList)
-{
-	Polygon poly;
-
-	// Cycle from the beginning to the end-1 and add the edges
-	for (std::size_t i = 0; i < vertexList.size()-1; i++) {
-		Edge edge;
-		edge.from = vertexList[i];
-		edge.to = vertexList[i+1];
-
-		// Lookup the edge (the sign is interpreted as direction)
-		// and add it to the edge list
-		poly.edges.push_back(findEdge(edge));
-	}
-
-	if (findPolygon(poly.edges) == -1) {
-		AABB faceAABB = face.getWinding().aabb();
-
-		poly.numEdges = poly.edges.size();
-		poly.plane = face.plane3();
-		poly.min = faceAABB.origin - faceAABB.extents;
-		poly.max = faceAABB.origin + faceAABB.extents;
-		//poly.shader = face.GetShader();
-		poly.shader = game::current::getValue<std::string>(GKEY_COLLISION_SHADER);
-
-		_polygons.push_back(poly);
-	}
-}
-
-VertexList CollisionModel::addWinding(
-	const Winding& winding)
-{
-	VertexList vertexList;
-
-	for (Winding::const_iterator i = winding.begin(); i != winding.end(); ++i) {
-		// Create a vertexId and add it to the stack
-		vertexList.push_back(addVertex(i->vertex));
-	}
-	// Now add the first vertex a second time to the end of the list
-	vertexList.push_back(addVertex(winding.begin()->vertex));
-
-	if (vertexList.size() > 1) {
-		Edge edge;
-
-		// Now work through the stack, adding the edges (note the -1 in the for condition)
-		for (std::size_t i = 0; i < vertexList.size()-1; i++) {
-			edge.from = vertexList[i];
-			edge.to = vertexList[i+1];
-
-			addEdge(edge);
-		}
-	}
-	else {
-		rError() << "Warning: degenerate winding found.\n";
-	}
-
-	// Now that all edges are added, return the VertexList defining the winding
-	return vertexList;
-}
+CollisionModel::CollisionModel()
+{}
 
 void CollisionModel::addBrush(Brush& brush) {
 	BrushStruc b;
@@ -250,16 +91,25 @@ void CollisionModel::addBrush(Brush& brush) {
 	b.min = brushAABB.origin - brushAABB.extents;
 	b.max = brushAABB.origin + brushAABB.extents;
 
+	std::string shader = game::current::getValue<std::string>(GKEY_COLLISION_SHADER);
+
 	// Populate the FaceList
 	for (Brush::const_iterator i = brush.begin(); i != brush.end(); i++) {
 		// Store the plane into the brush
 		b.planes.push_back((*i)->plane3());
 
+		const Winding& winding = (*i)->getWinding();
+
+		std::vector<Vector3> points;
+		for (Winding::const_iterator v = winding.begin(); v != winding.end(); ++v) {
+			points.push_back(v->vertex);
+		}
+
 		// Parse the winding of this Face for vertices/edges
-		VertexList vertexList = addWinding((*i)->getWinding());
+		VertexList vertexList = _geometry.addWinding(points);
 
-		// Pass the Face& and the VertexList to create the polygon
-		addPolygon(*(*i), vertexList);
+		// Pass the plane, bounds and the VertexList to create the polygon
+		_geometry.addPolygon(vertexList, (*i)->plane3(), winding.aabb(), shader);
 	}
 
 	// Store the BrushStruc into the list
@@ -287,9 +137,9 @@ std::ostream& operator<<(std::ostream& st, const CollisionModel& cm) {
 	st << "collisionModel \"" << cm._model.c_str() << "\" {\n";
 
 	// Export the vertices
-	st << "\tvertices { /* numVertices = */ " << cm._vertices.size() << "\n";
-	for (VertexMap::const_iterator i = cm._vertices.begin();
-		 i != cm._vertices.end();
+	st << "\tvertices { /* numVertices = */ " << cm._geometry.getVertices().size() << "\n";
+	for (VertexMap::const_iterator i = cm._geometry.getVertices().begin();
+		 i != cm._geometry.getVertices().end();
 		 i++)
 	{
 		st << "\t/* " << i->first << " */ ";
@@ -299,9 +149,9 @@ std::ostream& operator<<(std::ostream& st, const CollisionModel& cm) {
 	st << "\t}\n";
 
 	// Export the edges
-	st << "\tedges { /* numEdges = */ " << cm._edges.size() << "\n";
-	for (EdgeMap::const_iterator i = cm._edges.begin();
-		 i != cm._edges.end();
+	st << "\tedges { /* numEdges = */ " << cm._geometry.getEdges().size() << "\n";
+	for (EdgeMap::const_iterator i = cm._geometry.getEdges().begin();
+		 i != cm._geometry.getEdges().end();
 		 ++i)
 	{
 		st << "\t/* " << i->first << " */ ";
@@ -317,8 +167,8 @@ std::ostream& operator<<(std::ostream& st, const CollisionModel& cm) {
 
 	// Export the polygons
 	st << "\tpolygons {\n";
-	for (std::size_t i = 0; i < cm._polygons.size(); i++) {
-		st << "\t" << cm._polygons[i] << "\n";
+	for (std::size_t i = 0; i < cm._geometry.getPolygons().size(); i++) {
+		st << "\t" << cm._geometry.getPolygons()[i] << "\n";
 	}
 	st << "\t}\n";
 
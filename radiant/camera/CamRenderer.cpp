@@ -67,21 +67,18 @@ void CamRenderer::addRenderable(const OpenGLRenderable& renderable,
 {
     if(_stateStack.back().highlightPrimitives)
     {
-        _highlightedPrimitiveShader->addRenderable(
-          renderable, world, _stateStack.back().lights
-        );
+        _queue.add(*_highlightedPrimitiveShader, renderable, world,
+                   _stateStack.back().lights);
     }
 
     if(_stateStack.back().highlightFaces)
     {
-        _highlightedFaceShader->addRenderable(
-            renderable, world, _stateStack.back().lights
-        );
+        _queue.add(*_highlightedFaceShader, renderable, world,
+                   _stateStack.back().lights);
     }
 
-    _stateStack.back().shader->addRenderable(
-        renderable, world, _stateStack.back().lights
-    );
+    _queue.add(*_stateStack.back().shader, renderable, world,
+               _stateStack.back().lights);
 }
 
 void CamRenderer::addRenderable(const OpenGLRenderable& renderable,
@@ -90,24 +87,23 @@ void CamRenderer::addRenderable(const OpenGLRenderable& renderable,
 {
     if (_stateStack.back().highlightPrimitives)
     {
-        _highlightedPrimitiveShader->addRenderable(
-            renderable, world, entity, _stateStack.back().lights
-        );
+        _queue.add(*_highlightedPrimitiveShader, renderable, world, entity,
+                   _stateStack.back().lights);
     }
 
     if (_stateStack.back().highlightFaces)
     {
-        _highlightedFaceShader->addRenderable(
-            renderable, world, entity, _stateStack.back().lights
-        );
+        _queue.add(*_highlightedFaceShader, renderable, world, entity,
+                   _stateStack.back().lights);
     }
 
-    _stateStack.back().shader->addRenderable(
-        renderable, world, entity, _stateStack.back().lights
-    );
+    _queue.add(*_stateStack.back().shader, renderable, world, entity,
+               _stateStack.back().lights);
 }
 
 void CamRenderer::render(const Matrix4& modelview, const Matrix4& projection)
 {
+    _queue.sort();
+
     GlobalRenderSystem().render(m_globalstate, modelview, projection, m_viewer);
 }
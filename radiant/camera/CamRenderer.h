@@ -2,6 +2,7 @@
 
 #include "irenderable.h"
 #include "irender.h"
+#include "render/frontend/StateSortQueue.h"
 
 /// Implementation of RenderableCollector for the 3D camera view
 class CamRenderer : 
@@ -30,6 +31,9 @@ class CamRenderer :
     ShaderPtr _highlightedFaceShader;
     const Vector3& m_viewer;
 
+    // The renderables collected for the shaders, sorted in render()
+    render::StateSortQueue _queue;
+
 public:
 
     /**
@@ -9,6 +9,7 @@
 #include "itextstream.h"
 
 #include <time.h>
+#include <chrono>
 #include <fmt/format.h>
 
 #include "util/ScopedBoolLock.h"
@@ -19,10 +20,14 @@
 #include "CamRenderer.h"
 #include "CameraSettings.h"
 #include "GlobalCamera.h"
-#include "render/RenderStatistics.h"
+#include "render/FrameProfiler.h"
+#include "render/backend/GeometryBatch.h"
+#include "render/backend/RecordingRenderBackend.h"
+#include "render/OpenGLRenderSystem.h"
 #include "render/frontend/RenderableCollectionWalker.h"
 #include "wxutil/MouseButton.h"
 #include "registry/adaptors.h"
+#include "registry/registry.h"
 #include "selection/OccludeSelector.h"
 #include "selection/Device.h"
 #include "selection/SelectionTest.h"
@@ -44,6 +49,9 @@ namespace
     const std::string FAR_CLIP_OUT_TEXT = "Move far clip plane further away";
     const std::string FAR_CLIP_DISABLED_TEXT = " (currently disabled in preferences)";
     const char* const RKEY_SELECT_EPSILON = "user/ui/selectionEpsilon";
+
+    // The name of the camera frames in the render profile
+    const char* const PROFILE_FRAME_NAME = "Camera";
 }
 
 class ObjectFinder :
@@ -557,6 +565,8 @@ void CamWnd::Cam_Draw()
 		return; // otherwise we'll receive OpenGL errors in ortho rendering below
 	}
 
+    render::ScopedFrameProfile frameProfile(PROFILE_FRAME_NAME);
+
     glViewport(0, 0, _camera.width, _camera.height);
 
     // enable depth buffer writes
@@ -573,8 +583,6 @@ void CamWnd::Cam_Draw()
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	render::RenderStatistics::Instance().resetStats();
-
 	render::View::resetCullStats();
 
     glMatrixMode(GL_PROJECTION);
@@ -673,14 +681,19 @@ void CamWnd::Cam_Draw()
         CamRenderer renderer(allowedRenderFlags, _primitiveHighlightShader,
                              _faceHighlightShader, _view.getViewer());
 
-		render::RenderableCollectionWalker::collectRenderablesInScene(renderer, _view);
+        {
+            render::ScopedProfile profile("Collect");
+
+            render::RenderableCollectionWalker::collectRenderablesInScene(renderer, _view);
 
-		// Render any active mousetools
-		for (const ActiveMouseTools::value_type& i : _activeMouseTools)
-		{
-			i.second->render(GlobalRenderSystem(), renderer, _view);
-		}
+            // Render any active mousetools
+            for (const ActiveMouseTools::value_type& i : _activeMouseTools)
+            {
+                i.second->render(GlobalRenderSystem(), renderer, _view);
+            }
+        }
 
+        render::ScopedProfile profile("Submit");
         renderer.render(_camera.modelview, _camera.projection);
     }
 
@@ -747,12 +760,28 @@ void CamWnd::Cam_Draw()
 
     glRasterPos3f(1.0f, static_cast<float>(_camera.height) - 1.0f, 0.0f);
 
-    GlobalOpenGL().drawString(render::RenderStatistics::Instance().getStatString());
+    render::FrameProfiler& profiler = render::FrameProfiler::Instance();
+
+    // The time of this frame isn't known yet, show the one of the last frame
+    GlobalOpenGL().drawString(profiler.getCounterString() +
+        fmt::format(" | msec: {0:.2f}", profiler.getLastFrameTime(PROFILE_FRAME_NAME)));
 
     glRasterPos3f(1.0f, static_cast<float>(_camera.height) - 11.0f, 0.0f);
 
 	GlobalOpenGL().drawString(render::View::getCullStats());
 
+    if (render::FrameProfiler::overlayEnabled())
+    {
+        float y = static_cast<float>(_camera.height) - 26.0f;
+
+        for (const std::string& line : profiler.getOverlayLines(PROFILE_FRAME_NAME))
+        {
+            glRasterPos3f(1.0f, y, 0.0f);
+            GlobalOpenGL().drawString(line);
+            y -= 10.0f;
+        }
+    }
+
     drawTime();
 
     if (!_activeMouseTools.empty())
@@ -795,20 +824,86 @@ void CamWnd::draw()
 
 void CamWnd::benchmark()
 {
-    double dStart = clock() / 1000.0;
+    const int NUM_FRAMES = 100;
 
-    for (int i=0 ; i < 100 ; i++)
-	{
-        Vector3 angles;
-        angles[CAMERA_ROLL] = 0;
-        angles[CAMERA_PITCH] = 0;
-        angles[CAMERA_YAW] = static_cast<double>(i * (360.0 / 100.0));
-        setCameraAngles(angles);
+    Vector3 originalAngles = getCameraAngles();
+    bool batchingEnabled = registry::getValue<bool>(render::RKEY_BATCH_BRUSH_FACES);
+
+    // Turn around once with the regular and once with the batched brush faces
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        registry::setValue(render::RKEY_BATCH_BRUSH_FACES, pass == 1);
+
+        std::size_t drawCalls = 0;
+        std::size_t primitives = 0;
+        double seconds = 0;
+
+        // The first frame is drawn without measuring (buffers are filled)
+        for (int i = -1; i < NUM_FRAMES; ++i)
+        {
+            Vector3 angles;
+            angles[CAMERA_ROLL] = 0;
+            angles[CAMERA_PITCH] = 0;
+            angles[CAMERA_YAW] = static_cast<double>(std::max(i, 0) * (360.0 / NUM_FRAMES));
+            setCameraAngles(angles);
+
+            auto start = std::chrono::steady_clock::now();
+
+            // Paint right now and wait for the GL to finish
+            _wxGLWidget->Refresh(false);
+            _wxGLWidget->Update();
+            glFinish();
+
+            if (i < 0) continue;
+
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            drawCalls += render::FrameProfiler::Instance().getDrawCalls();
+            primitives += render::FrameProfiler::Instance().getPrimitives();
+        }
+
+        rMessage() << (pass == 0 ? "Unbatched: " : "Batched:   ")
+            << fmt::format("{0:7.2f} msec per frame, {1} draw calls, {2} primitives",
+                seconds * 1000 / NUM_FRAMES, drawCalls / NUM_FRAMES, primitives / NUM_FRAMES)
+            << std::endl;
     }
 
-    double dEnd = clock() / 1000.0;
+    // Measure the frontend alone by recording the render commands instead of
+    // submitting them, with batching enabled
+    render::OpenGLRenderSystem* renderSystem =
+        dynamic_cast<render::OpenGLRenderSystem*>(&GlobalRenderSystem());
+
+    if (renderSystem != nullptr)
+    {
+        render::RecordingRenderBackend recorder(false);
+        renderSystem->setBackend(&recorder);
+
+        double seconds = 0;
+
+        for (int i = 0; i < NUM_FRAMES; ++i)
+        {
+            Vector3 angles;
+            angles[CAMERA_ROLL] = 0;
+            angles[CAMERA_PITCH] = 0;
+            angles[CAMERA_YAW] = static_cast<double>(i * (360.0 / NUM_FRAMES));
+            setCameraAngles(angles);
+
+            auto start = std::chrono::steady_clock::now();
+
+            _wxGLWidget->Refresh(false);
+            _wxGLWidget->Update();
+
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        renderSystem->setBackend(nullptr);
+
+        rMessage() << "Frontend:  "
+            << fmt::format("{0:7.2f} msec per frame", seconds * 1000 / NUM_FRAMES) << std::endl
+            << "Recorded:  " << recorder.getSummary() << std::endl;
+    }
 
-    rMessage() << fmt::format("{0:5.2lf}", (dEnd - dStart)) << " seconds\n";
+    registry::setValue(render::RKEY_BATCH_BRUSH_FACES, batchingEnabled);
+    setCameraAngles(originalAngles);
 }
 
 void CamWnd::onSceneGraphChange()
@@ -121,6 +121,9 @@ public:
     const Frustum& getViewFrustum() const;
 
 	// greebo: This measures the rendering time during a 360° turn of the camera.
+	// The turn is done twice, without and with batched brush faces, the average
+	// frame times and draw calls are printed to the console. A third turn is
+	// rendered through a RecordingRenderBackend to measure the frontend alone.
 	void benchmark();
 
 	// This tries to find brushes above/below the current camera position and moves the view upwards/downwards
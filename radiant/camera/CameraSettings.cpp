@@ -6,6 +6,8 @@
 
 #include "registry/registry.h"
 #include "GlobalCamera.h"
+#include "render/backend/GeometryBatch.h"
+#include "render/FrameProfiler.h"
 
 namespace ui
 {
@@ -72,6 +74,12 @@ void CameraSettings::constructPreferencePage()
 
     // Whether to show the toolbar (to please the screenspace addicts)
     page.appendCheckBox(_("Show camera toolbar"), RKEY_SHOW_CAMERA_TOOLBAR);
+
+    // Draw the brush faces per material from shared vertex buffers
+    page.appendCheckBox(_("Batch brush faces (faster for large maps)"), render::RKEY_BATCH_BRUSH_FACES);
+
+    // Per-stage frame times in the camera and ortho views
+    page.appendCheckBox(_("Show render profile"), render::RKEY_SHOW_FRAME_PROFILE);
 }
 
 bool CameraSettings::showCameraToolbar() const
@@ -12,6 +12,8 @@
 
 #include "registry/registry.h"
 #include "modulesystem/StaticModule.h"
+#include "modulesystem/ModuleRegistry.h"
+#include "render/FrameProfiler.h"
 #include "wxutil/MouseButton.h"
 
 #include "tools/ShaderClipboardTools.h"
@@ -21,6 +23,7 @@
 
 #include "FloatingCamWnd.h"
 #include <functional>
+#include <fstream>
 
 namespace ui
 {
@@ -54,6 +57,10 @@ void GlobalCameraManager::registerCommands()
 	GlobalCommandSystem().addCommand("CamDecreaseMoveSpeed", std::bind(&GlobalCameraManager::decreaseCameraSpeed, this, std::placeholders::_1));
 
 	GlobalCommandSystem().addCommand("TogglePreview", std::bind(&GlobalCameraManager::toggleLightingMode, this, std::placeholders::_1));
+	GlobalCommandSystem().addCommand("BenchmarkCamera", std::bind(&GlobalCameraManager::benchmark, this, std::placeholders::_1));
+	GlobalCommandSystem().addCommand("ExportFrameProfile",
+		std::bind(&GlobalCameraManager::exportFrameProfile, this, std::placeholders::_1),
+		cmd::ARGTYPE_STRING | cmd::ARGTYPE_OPTIONAL);
 
 	// Insert movement commands
 	GlobalCommandSystem().addCommand("CameraForward", std::bind(&GlobalCameraManager::moveForwardDiscrete, this, std::placeholders::_1));
@@ -227,7 +234,7 @@ void GlobalCameraManager::decreaseCameraSpeed(const cmd::ArgumentList& args) {
 	registry::setValue(RKEY_MOVEMENT_SPEED, movementSpeed);
 }
 
-void GlobalCameraManager::benchmark() {
+void GlobalCameraManager::benchmark(const cmd::ArgumentList& args) {
 	CamWndPtr camWnd = getActiveCamWnd();
 
 	if (camWnd != NULL) {
@@ -235,6 +242,24 @@ void GlobalCameraManager::benchmark() {
 	}
 }
 
+void GlobalCameraManager::exportFrameProfile(const cmd::ArgumentList& args)
+{
+	std::string filename = !args.empty() ? args[0].getString() :
+		module::ModuleRegistry::Instance().getApplicationContext().getSettingsPath() + "frameprofile.json";
+
+	std::ofstream stream(filename.c_str());
+
+	if (!stream.good())
+	{
+		rError() << "Cannot open " << filename << " for writing." << std::endl;
+		return;
+	}
+
+	render::FrameProfiler::Instance().exportChromeTrace(stream);
+
+	rMessage() << "Render profile written to " << filename << std::endl;
+}
+
 void GlobalCameraManager::update() {
 	// Issue the update call to all cameras
 	for (CamWndMap::iterator i = _cameras.begin(); i != _cameras.end(); /* in-loop */ ) {
@@ -88,8 +88,11 @@ public:
 	void decreaseCameraSpeed(const cmd::ArgumentList& args);
 
 	// greebo: This measures the rendering time for a full 360 degrees turn of the camera
-	// Note: unused at the moment
-	void benchmark();
+	void benchmark(const cmd::ArgumentList& args);
+
+	// Writes the render profile of the recent frames to the given file (or
+	// to frameprofile.json in the settings path) in the Chrome trace format
+	void exportFrameProfile(const cmd::ArgumentList& args);
 
 	void update();
     void forceDraw();
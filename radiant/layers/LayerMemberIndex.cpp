@@ -0,0 +1,147 @@
+#include "LayerMemberIndex.h"
+
+#include "ilayer.h"
+#include "iselectable.h"
+#include "scene/Node.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace scene
+{
+
+LayerMemberIndex::LayerMemberIndex() :
+	_valid(false)
+{}
+
+void LayerMemberIndex::invalidate()
+{
+	_layerMembers.clear();
+	_valid = false;
+}
+
+bool LayerMemberIndex::isValid() const
+{
+	return _valid;
+}
+
+void LayerMemberIndex::updateLayerMemberVisibility(int layerID,
+	const UpdateNodeVisibilityFunc& updateNodeVisibility)
+{
+	ensureLayerMembers();
+
+	if (layerID < 0 || layerID >= static_cast<int>(_layerMembers.size()))
+	{
+		return; // no members
+	}
+
+	// A node is shown if one of its layers or one of its children is visible,
+	// so the parents of the members need to be updated too
+	std::vector<std::pair<std::size_t, INodePtr> > nodes;
+	std::unordered_set<INode*> collected;
+
+	for (const INodeWeakPtr& weakMember : _layerMembers[layerID])
+	{
+		INodePtr member = weakMember.lock();
+
+		if (!member || !member->inScene())
+		{
+			continue;
+		}
+
+		for (INodePtr node = member; node && !node->isRoot(); node = node->getParent())
+		{
+			if (!collected.insert(node.get()).second)
+			{
+				break; // this node and its parents are already known
+			}
+
+			nodes.push_back(std::make_pair(0, node));
+		}
+	}
+
+	for (auto& pair : nodes)
+	{
+		for (INodePtr parent = pair.second->getParent(); parent && !parent->isRoot(); parent = parent->getParent())
+		{
+			++pair.first;
+		}
+	}
+
+	// Process children before their parents, like the UpdateNodeVisibilityWalker does
+	std::stable_sort(nodes.begin(), nodes.end(), [](const std::pair<std::size_t, INodePtr>& a,
+		const std::pair<std::size_t, INodePtr>& b)
+	{
+		return a.first > b.first;
+	});
+
+	for (const auto& pair : nodes)
+	{
+		const INodePtr& node = pair.second;
+
+		bool visible = updateNodeVisibility(node);
+
+		if (!visible)
+		{
+			// Show the node if any of its children is visible
+			node->foreachNode([&](const INodePtr& child)
+			{
+				visible = !child->checkStateFlag(Node::eLayered);
+				return !visible;
+			});
+
+			if (visible)
+			{
+				node->disable(Node::eLayered);
+			}
+		}
+
+		if (!visible)
+		{
+			// Node is hidden by layers after update, de-select
+			Node_setSelected(node, false);
+		}
+	}
+}
+
+void LayerMemberIndex::ensureLayerMembers()
+{
+	if (_valid)
+	{
+		return;
+	}
+
+	_layerMembers.clear();
+
+	if (GlobalSceneGraph().root())
+	{
+		GlobalSceneGraph().root()->foreachNode([this](const INodePtr& node)
+		{
+			node->getLayerMask().foreachLayer([&](int layerID)
+			{
+				if (layerID >= static_cast<int>(_layerMembers.size()))
+				{
+					_layerMembers.resize(layerID + 1);
+				}
+
+				_layerMembers[layerID].push_back(node);
+			});
+
+			return true;
+		});
+	}
+
+	_valid = true;
+}
+
+void LayerMemberIndex::onSceneNodeInsert(const INodePtr& node)
+{
+	invalidate();
+}
+
+void LayerMemberIndex::onSceneNodeErase(const INodePtr& node)
+{
+	invalidate();
+}
+
+} // namespace scene
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include "inode.h"
+#include "iscenegraph.h"
+
+namespace scene
+{
+
+/**
+ * The nodes of the scene, indexed by the ID of the layers they are members
+ * of. This allows the LayerSystem to toggle the visibility of a layer
+ * without visiting all nodes.
+ *
+ * The index is built on demand and discarded whenever nodes are inserted
+ * into or removed from the scene. Changes to the layer memberships need to
+ * be reported through invalidate().
+ */
+class LayerMemberIndex :
+	public Graph::Observer
+{
+private:
+	typedef std::vector<std::vector<INodeWeakPtr> > LayerMembers;
+	LayerMembers _layerMembers;
+	bool _valid;
+
+public:
+	// Updates the layered flag of a single node, returns true if it's visible
+	typedef std::function<bool(const INodePtr&)> UpdateNodeVisibilityFunc;
+
+	LayerMemberIndex();
+
+	// Discards the index, it is rebuilt the next time it's needed
+	void invalidate();
+
+	// Returns true if the index is built and up to date
+	bool isValid() const;
+
+	// Updates the visibility of the given layer's members and their parents
+	void updateLayerMemberVisibility(int layerID, const UpdateNodeVisibilityFunc& updateNodeVisibility);
+
+	// Graph::Observer implementation
+	void onSceneNodeInsert(const INodePtr& node) override;
+	void onSceneNodeErase(const INodePtr& node) override;
+
+private:
+	// Builds the index from the current scene, unless it's still valid
+	void ensureLayerMembers();
+};
+
+} // namespace scene
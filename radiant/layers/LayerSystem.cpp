@@ -56,14 +56,8 @@ int LayerSystem::createLayer(const std::string& name, int layerID)
 		return -1;
 	}
 
-	// Update the visibility cache, so get the highest ID
-	int highestID = getHighestLayerID();
-
-	// Make sure the vector has allocated enough memory
-	_layerVisibility.resize(highestID+1);
-
 	// Set the newly created layer to "visible"
-	_layerVisibility[result.first->first] = true;
+	_visibleLayers.set(result.first->first);
 
 	// Layers have changed
 	onLayersChanged();
@@ -110,7 +104,7 @@ void LayerSystem::deleteLayer(const std::string& name)
 	_layers.erase(layerID);
 
 	// Reset the visibility flag to TRUE
-	_layerVisibility[layerID] = true;
+	_visibleLayers.set(layerID);
 
 	if (layerID == _activeLayer)
 	{
@@ -141,8 +135,10 @@ void LayerSystem::reset()
 	_layers.clear();
 	_layers.insert(LayerMap::value_type(DEFAULT_LAYER, _(DEFAULT_LAYER_NAME)));
 
-	_layerVisibility.resize(1);
-	_layerVisibility[DEFAULT_LAYER] = true;
+	_visibleLayers.clear();
+	_visibleLayers.set(DEFAULT_LAYER);
+
+	_layerMembers.invalidate();
 
 	// Update the LayerControlDialog
 	_layersChangedSignal.emit();
@@ -176,7 +172,7 @@ int LayerSystem::getFirstVisibleLayer() const
 	// Iterate over all IDs and check the visibility status, return the first visible
 	for (LayerMap::const_iterator i = _layers.begin(); i != _layers.end(); ++i)
 	{
-		if (_layerVisibility[i->first])
+		if (_visibleLayers.test(i->first))
 		{
 			return i->first;
 		}
@@ -215,23 +211,23 @@ bool LayerSystem::layerIsVisible(const std::string& layerName)
 		return false;
 	}
 
-	return _layerVisibility[layerID];
+	return _visibleLayers.test(layerID);
 }
 
 bool LayerSystem::layerIsVisible(int layerID) {
 	// Sanity check
-	if (layerID < 0 || layerID >= static_cast<int>(_layerVisibility.size())) {
+	if (layerID < 0 || layerID > getHighestLayerID()) {
 		rMessage() << "LayerSystem: Querying invalid layer ID: " << layerID << std::endl;
 		return false;
 	}
 
-	return _layerVisibility[layerID];
+	return _visibleLayers.test(layerID);
 }
 
 void LayerSystem::setLayerVisibility(int layerID, bool visible)
 {
 	// Sanity check
-	if (layerID < 0 || layerID >= static_cast<int>(_layerVisibility.size()))
+	if (layerID < 0 || layerID > getHighestLayerID())
 	{
 		rMessage() <<
 			"LayerSystem: Setting visibility of invalid layer ID: " <<
@@ -240,7 +236,14 @@ void LayerSystem::setLayerVisibility(int layerID, bool visible)
 	}
 
 	// Set the visibility
-	_layerVisibility[layerID] = visible;
+	if (visible)
+	{
+		_visibleLayers.set(layerID);
+	}
+	else
+	{
+		_visibleLayers.reset(layerID);
+	}
 
 	if (!visible && layerID == _activeLayer)
 	{
@@ -250,14 +253,13 @@ void LayerSystem::setLayerVisibility(int layerID, bool visible)
     
     // If the active layer is hidden (which can occur after "hide all")
     // re-set the active layer to this one as it has been made visible
-    if (visible && _activeLayer < static_cast<int>(_layerVisibility.size()) && 
-        !_layerVisibility[_activeLayer])
+    if (visible && !_visibleLayers.test(_activeLayer))
     {
         _activeLayer = layerID;
     }
 
 	// Fire the visibility changed event
-	onLayerVisibilityChanged();
+	onLayerVisibilityChanged(layerID);
 }
 
 void LayerSystem::setLayerVisibility(const std::string& layerName, bool visible) {
@@ -295,10 +297,14 @@ void LayerSystem::onNodeMembershipChanged()
 	updateSceneGraphVisibility();
 }
 
-void LayerSystem::onLayerVisibilityChanged()
+void LayerSystem::onLayerVisibilityChanged(int layerID)
 {
-	// Update all nodes and views
-	updateSceneGraphVisibility();
+	// Only the members of this layer (and their parents) can change
+	_layerMembers.updateLayerMemberVisibility(layerID,
+		std::bind(&LayerSystem::updateNodeVisibility, this, std::placeholders::_1));
+
+	// Redraw
+	SceneChangeNotify();
 
 	// Update the LayerControlDialog
 	_layerVisibilityChangedSignal.emit();
@@ -387,26 +393,15 @@ void LayerSystem::removeSelectionFromLayer(int layerID) {
 
 bool LayerSystem::updateNodeVisibility(const scene::INodePtr& node)
 {
-	// Get the list of layers the node is associated with
-	// greebo: FIXME: Check if returning the LayerList by value is taxing.
-	LayerList layers = node->getLayers();
-
-	// We start with the assumption that a node is hidden
-	node->enable(Node::eLayered);
-
-	// Cycle through the Node's layers, and show the node as soon as
-	// a visible layer is found.
-	for (int layerId : layers)
+	// The node is visible if any of its layers is visible
+	if (node->getLayerMask().intersects(_visibleLayers))
 	{
-		if (_layerVisibility[layerId])
-		{
-			// The layer is visible, set the visibility to true and quit
-			node->disable(Node::eLayered);
-			return true;
-		}
+		node->disable(Node::eLayered);
+		return true;
 	}
 
 	// Node is hidden, return FALSE
+	node->enable(Node::eLayered);
 	return false;
 }
 
@@ -503,6 +498,7 @@ const StringSet& LayerSystem::getDependencies() const
 		_dependencies.insert(MODULE_EVENTMANAGER);
 		_dependencies.insert(MODULE_COMMANDSYSTEM);
 		_dependencies.insert(MODULE_MAPINFOFILEMANAGER);
+		_dependencies.insert(MODULE_SCENEGRAPH);
 	}
 
 	return _dependencies;
@@ -534,6 +530,18 @@ void LayerSystem::initialiseModule(const ApplicationContext& ctx)
 	GlobalMapInfoFileManager().registerInfoFileModule(
 		std::make_shared<LayerInfoFileModule>()
 	);
+
+	// Memberships changed by other code invalidate the layer member index
+	_nodeMembershipChangedSignal.connect([this]() { _layerMembers.invalidate(); });
+
+	GlobalSceneGraph().addSceneObserver(&_layerMembers);
+}
+
+void LayerSystem::shutdownModule()
+{
+	GlobalSceneGraph().removeSceneObserver(&_layerMembers);
+
+	_layerMembers.invalidate();
 }
 
 void LayerSystem::createLayerCmd(const cmd::ArgumentList& args)
@@ -5,6 +5,7 @@
 #include "ilayer.h"
 #include "imap.h"
 #include "LayerCommandTarget.h"
+#include "LayerMemberIndex.h"
 
 namespace scene {
 
@@ -20,11 +21,13 @@ class LayerSystem :
 	public ILayerSystem
 {
 private:
-	// greebo: An array of booleans reflects the visibility status
-	// of all layers. Indexed by the layer id, it can be used to
-	// quickly check whether a layer is visible or not.
-	typedef std::vector<bool> LayerVisibilityList;
-	LayerVisibilityList _layerVisibility;
+	// The IDs of all visible layers. A node is visible
+	// if its own layer mask intersects with this one.
+	LayerMask _visibleLayers;
+
+	// The members of each layer, used when toggling the visibility of a
+	// single layer. It's discarded on any change to the layer memberships.
+	LayerMemberIndex _layerMembers;
 
 	// The list of named layers, indexed by an integer ID
 	typedef std::map<int, std::string> LayerMap;
@@ -133,6 +136,7 @@ public:
 	const std::string& getName() const override;
 	const StringSet& getDependencies() const override;
 	void initialiseModule(const ApplicationContext& ctx) override;
+	void shutdownModule() override;
 
 	// Command target
 	void createLayerCmd(const cmd::ArgumentList& args);
@@ -143,8 +147,8 @@ private:
 	// Internal event emitter
 	void onLayersChanged();
 
-	// Internal event, updates the scenegraph
-	void onLayerVisibilityChanged();
+	// Internal event, updates the members of the given layer
+	void onLayerVisibilityChanged(int layerID);
 
 	// Internal event emitter
 	void onNodeMembershipChanged();
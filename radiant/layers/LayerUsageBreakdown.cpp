@@ -12,15 +12,11 @@ namespace
 {
 	void addNodeMapping(LayerUsageBreakdown& bd, const scene::INodePtr& node)
 	{
-		scene::LayerList layers = node->getLayers();
-
-		for (int layerId : layers)
+		node->getLayerMask().foreachLayer([&](int layerId)
 		{
-			assert(layerId >= 0); // we assume positive layer IDs here
-
 			// Increase the counter of the corresponding layer slot by one
 			bd[layerId]++;
-		}
+		});
 	}
 }
 
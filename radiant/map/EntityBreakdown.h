@@ -6,14 +6,20 @@
 #include "iscenegraph.h"
 #include "ientity.h"
 #include "ieclass.h"
+#include "util/Noncopyable.h"
 
 namespace map {
 
 /** greebo: This object traverses the scenegraph on construction
  * 			counting all occurrences of each entity class.
+ *
+ * Afterwards it observes the scenegraph, the counters are kept up
+ * to date as entities are inserted and removed.
  */
 class EntityBreakdown :
-	public scene::NodeVisitor
+	public scene::NodeVisitor,
+	public scene::Graph::Observer,
+	public util::Noncopyable
 {
 public:
 	typedef std::map<std::string, std::size_t> Map;
@@ -25,28 +31,42 @@ public:
 	EntityBreakdown() {
 		_map.clear();
 		GlobalSceneGraph().root()->traverse(*this);
+
+		GlobalSceneGraph().addSceneObserver(this);
+	}
+
+	~EntityBreakdown() {
+		GlobalSceneGraph().removeSceneObserver(this);
 	}
 
 	bool pre(const scene::INodePtr& node) {
+		onSceneNodeInsert(node);
+		return true;
+	}
+
+	void onSceneNodeInsert(const scene::INodePtr& node) override {
 		// Is this node an entity?
 		Entity* entity = Node_getEntity(node);
 
 		if (entity != NULL) {
-			IEntityClassConstPtr eclass = entity->getEntityClass();
-			std::string ecName = eclass->getName();
-
-			Map::iterator found = _map.find(ecName);
-			if (found == _map.end()) {
-				// Entity class not yet registered, create new entry
-				_map.insert(Map::value_type(ecName, 1));
-			}
-			else {
-				// Eclass is known, increase the counter
-				found->second++;
-			}
+			// Creates the entry for unknown entity classes
+			_map[entity->getEntityClass()->getName()]++;
+		}
+	}
+
+	void onSceneNodeErase(const scene::INodePtr& node) override {
+		Entity* entity = Node_getEntity(node);
+
+		if (entity == NULL) {
+			return;
 		}
 
-		return true;
+		Map::iterator found = _map.find(entity->getEntityClass()->getName());
+
+		if (found != _map.end() && --found->second == 0) {
+			// No more entities of this class
+			_map.erase(found);
+		}
 	}
 
 	// Accessor method to retrieve the entity breakdown map
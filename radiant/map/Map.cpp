@@ -918,17 +918,7 @@ void Map::importSelected(std::istream& in)
         // Prepare child primitives
         addOriginToChildPrimitives(root);
 
-        // Adjust all new names to fit into the existing map namespace,
-        // this routine will be changing a lot of names in the importNamespace
-        INamespacePtr nspace = getRoot()->getNamespace();
-        if (nspace)
-        {
-            // Prepare all names, but do not import them into the namesace. This
-            // will happen during the MergeMap call.
-            nspace->ensureNoConflicts(root);
-        }
-
-        MergeMap(root);
+        importSelected(root);
     }
     catch (IMapReader::FailureException& e)
     {
@@ -941,6 +931,21 @@ void Map::importSelected(std::istream& in)
     }
 }
 
+void Map::importSelected(const scene::INodePtr& root)
+{
+    // Adjust all new names to fit into the existing map namespace,
+    // this routine will be changing a lot of names in the importNamespace
+    INamespacePtr nspace = getRoot()->getNamespace();
+    if (nspace)
+    {
+        // Prepare all names, but do not import them into the namesace. This
+        // will happen during the MergeMap call.
+        nspace->ensureNoConflicts(root);
+    }
+
+    MergeMap(root);
+}
+
 void Map::exportSelected(std::ostream& out)
 {
     MapFormatPtr format = getFormat();
@@ -954,6 +959,16 @@ void Map::exportSelected(std::ostream& out)
     exporter.exportMap(GlobalSceneGraph().root(), traverseSelected);
 }
 
+void Map::exportNodes(const scene::INodePtr& root, std::ostream& out)
+{
+    MapFormatPtr format = getFormat();
+
+    IMapWriterPtr writer = format->getMapWriter();
+
+    MapExporter exporter(*writer, root, out);
+    exporter.exportMap(root, traverse);
+}
+
 // RegisterableModule implementation
 const std::string& Map::getName() const
 {
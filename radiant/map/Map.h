@@ -150,8 +150,15 @@ public:
     /// Import selection from given stream
 	void importSelected(std::istream& in);
 
+	/// Import the nodes below the given root (which is not part of the scene),
+	/// resolving their name conflicts and selecting them
+	void importSelected(const scene::INodePtr& root);
+
 	void exportSelected(std::ostream& out);
 
+	/// Write all nodes below the given root to the stream, in the current map format
+	void exportNodes(const scene::INodePtr& root, std::ostream& out);
+
 	// free all map elements, reinitialize the structures that depend on them
 	void freeMap();
 
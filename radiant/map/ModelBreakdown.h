@@ -2,19 +2,29 @@
 #define MODELBREAKDOWN_H_
 
 #include <map>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include "iscenegraph.h"
 #include "imodel.h"
 #include "modelskin.h"
+#include "util/Noncopyable.h"
 
 namespace map {
 
 /**
  * greebo: This object traverses the scenegraph on construction
  * counting all occurrences of each model (plus skins).
+ *
+ * Afterwards it observes the scenegraph, the model counters are kept
+ * up to date as models are inserted and removed. Skins can be changed
+ * without any notification, so the skin counts are collected from the
+ * tracked model nodes when the map is requested.
  */
 class ModelBreakdown :
-	public scene::NodeVisitor
+	public scene::NodeVisitor,
+	public scene::Graph::Observer,
+	public util::Noncopyable
 {
 public:
 	struct ModelCount
@@ -36,73 +46,89 @@ public:
 private:
 	mutable Map _map;
 
+	// The model path of each model node in the scene (plus its skin interface)
+	struct TrackedModel
+	{
+		std::string modelPath;
+		SkinnedModel* skinned;
+	};
+
+	typedef std::unordered_map<const scene::INode*, TrackedModel> TrackedModels;
+	TrackedModels _models;
+
 public:
 	ModelBreakdown() {
 		_map.clear();
 		GlobalSceneGraph().root()->traverseChildren(*this);
+
+		GlobalSceneGraph().addSceneObserver(this);
+	}
+
+	~ModelBreakdown() {
+		GlobalSceneGraph().removeSceneObserver(this);
 	}
 
 	bool pre(const scene::INodePtr& node) {
+		onSceneNodeInsert(node);
+		return true;
+	}
+
+	void onSceneNodeInsert(const scene::INodePtr& node) override {
 		// Check if this node is a model
 		model::ModelNodePtr modelNode = Node_getModel(node);
 
-		if (modelNode != NULL) {
-			// Get the actual model from the node
-			const model::IModel& model = modelNode->getIModel();
-
-			Map::iterator found = _map.find(model.getModelPath());
-
-			if (found == _map.end()) {
-				std::pair<Map::iterator, bool> result = _map.insert(
-					Map::value_type(model.getModelPath(), ModelCount())
-				);
-
-				found = result.first;
+		if (modelNode == NULL || _models.find(node.get()) != _models.end()) {
+			return;
+		}
 
-				// Store the polycount in the map
-				found->second.polyCount = model.getPolyCount();
-				found->second.skinCount.clear();
-			}
+		// Get the actual model from the node
+		const model::IModel& model = modelNode->getIModel();
 
-			// The iterator "found" is valid at this point
-			// Get a shortcut reference
-			ModelCount& modelCount = found->second;
+		std::pair<Map::iterator, bool> result = _map.insert(
+			Map::value_type(model.getModelPath(), ModelCount())
+		);
 
-			modelCount.count++;
+		if (result.second) {
+			// Store the polycount in the map
+			result.first->second.polyCount = model.getPolyCount();
+		}
 
-			// Increase the skin count, check if we have a skinnable model
-			SkinnedModelPtr skinned = std::dynamic_pointer_cast<SkinnedModel>(node);
+		result.first->second.count++;
 
-			if (skinned != NULL) {
-				std::string skinName = skinned->getSkin();
+		TrackedModel tracked = { model.getModelPath(), dynamic_cast<SkinnedModel*>(node.get()) };
+		_models.insert(TrackedModels::value_type(node.get(), tracked));
+	}
 
-				ModelCount::SkinCountMap::iterator foundSkin = modelCount.skinCount.find(skinName);
+	void onSceneNodeErase(const scene::INodePtr& node) override {
+		TrackedModels::iterator tracked = _models.find(node.get());
 
-				if (foundSkin == modelCount.skinCount.end()) {
-					std::pair<ModelCount::SkinCountMap::iterator, bool> result =
-						modelCount.skinCount.insert(ModelCount::SkinCountMap::value_type(skinName, 0));
+		if (tracked == _models.end()) {
+			return;
+		}
 
-					foundSkin = result.first;
-				}
+		Map::iterator found = _map.find(tracked->second.modelPath);
 
-				foundSkin->second++;
-			}
+		if (found != _map.end() && --found->second.count == 0) {
+			// No more instances of this model
+			_map.erase(found);
 		}
 
-		return true;
+		_models.erase(tracked);
 	}
 
 	// Accessor method to retrieve the entity breakdown map
 	const Map& getMap() const {
+		updateSkinCounts();
 		return _map;
 	}
 
 	std::size_t getNumSkins() const
 	{
 		std::set<std::string> skinMap;
+		const Map& map = getMap();
 
 		// Determine the number of distinct skins
-		for (Map::const_iterator m = _map.begin(); m != _map.end(); ++m)
+		for (Map::const_iterator m = map.begin(); m != map.end(); ++m)
 		{
 			for (ModelCount::SkinCountMap::const_iterator s = m->second.skinCount.begin();
 				 s != m->second.skinCount.end(); ++s)
@@ -117,14 +143,29 @@ public:
 		return skinMap.size();
 	}
 
+	// Call begin() first, it is collecting the skin counts
 	Map::const_iterator begin() const {
-		return _map.begin();
+		return getMap().begin();
 	}
 
 	Map::const_iterator end() const {
 		return _map.end();
 	}
 
+private:
+	// Collects the skin counts, visiting the tracked model nodes only
+	void updateSkinCounts() const {
+		for (Map::value_type& pair : _map) {
+			pair.second.skinCount.clear();
+		}
+
+		for (const TrackedModels::value_type& pair : _models) {
+			if (pair.second.skinned != NULL) {
+				_map[pair.second.modelPath].skinCount[pair.second.skinned->getSkin()]++;
+			}
+		}
+	}
+
 }; // class ModelBreakdown
 
 } // namespace map
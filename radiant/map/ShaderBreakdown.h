@@ -3,9 +3,13 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "ipatch.h"
 #include "ibrush.h"
 #include "iscenegraph.h"
+#include "util/Noncopyable.h"
 
 #include "patch/Patch.h"
 #include "brush/Brush.h"
@@ -15,9 +19,16 @@ namespace map {
 /**
  * greebo: This object traverses the scenegraph on construction
  * counting all occurrences of each shader.
+ *
+ * Afterwards it observes the scenegraph, the counters are kept up to
+ * date as brushes and patches are inserted and removed. Brushes
+ * changing their faces in place are recounted when the map is requested,
+ * the same goes for all patches after any patch texture has changed.
  */
 class ShaderBreakdown :
-	public scene::NodeVisitor
+	public scene::NodeVisitor,
+	public scene::Graph::Observer,
+	public util::Noncopyable
 {
 public:
 	struct ShaderCount
@@ -34,66 +45,165 @@ public:
 	typedef std::map<std::string, ShaderCount> Map;
 
 private:
-	mutable Map _map;
+	Map _map;
+
+	// The entries each brush face and each patch has been counted for
+	typedef std::unordered_map<Brush*, std::vector<Map::iterator> > BrushEntries;
+	typedef std::unordered_map<IPatch*, Map::iterator> PatchEntries;
+
+	BrushEntries _brushes;
+	PatchEntries _patches;
+
+	// Brushes which changed their faces since they have been counted
+	std::unordered_set<Brush*> _changedBrushes;
+	bool _patchesChanged;
+
+	sigc::connection _facesChangedConn;
+	sigc::connection _patchTextureChangedConn;
 
 public:
-	ShaderBreakdown() {
+	ShaderBreakdown() :
+		_patchesChanged(false)
+	{
 		_map.clear();
 		GlobalSceneGraph().root()->traverseChildren(*this);
+
+		GlobalSceneGraph().addSceneObserver(this);
+
+		_facesChangedConn = Brush::signal_facesChanged().connect(
+			sigc::mem_fun(*this, &ShaderBreakdown::onBrushFacesChanged));
+		_patchTextureChangedConn = Patch::signal_patchTextureChanged().connect(
+			sigc::mem_fun(*this, &ShaderBreakdown::onPatchTextureChanged));
+	}
+
+	~ShaderBreakdown() {
+		_facesChangedConn.disconnect();
+		_patchTextureChangedConn.disconnect();
+
+		GlobalSceneGraph().removeSceneObserver(this);
 	}
 
 	bool pre(const scene::INodePtr& node) {
+		onSceneNodeInsert(node);
 
+		// Don't traverse the children of primitives
+		return Node_getIPatch(node) == NULL && Node_getBrush(node) == NULL;
+	}
+
+	void onSceneNodeInsert(const scene::INodePtr& node) override {
 		// Check if this node is a patch
-		Patch* patch = Node_getPatch(node);
+		IPatch* patch = Node_getIPatch(node);
 
 		if (patch != NULL) {
-			increaseShaderCount(patch->getShader(), false);
-			return false;
+			if (_patches.find(patch) == _patches.end()) {
+				_patches.insert(PatchEntries::value_type(patch, increaseShaderCount(patch->getShader(), false)));
+			}
+			return;
 		}
 
 		Brush* brush = Node_getBrush(node);
 
-		if (brush != NULL) 
-        {
-            brush->forEachFace([this] (Face& face)
-            {
-                increaseShaderCount(face.getShader(), true);
-            });
+		if (brush != NULL && _brushes.find(brush) == _brushes.end()) {
+			countBrush(*brush, _brushes[brush]);
+		}
+	}
+
+	void onSceneNodeErase(const scene::INodePtr& node) override {
+		IPatch* patch = Node_getIPatch(node);
+
+		if (patch != NULL) {
+			PatchEntries::iterator found = _patches.find(patch);
 
-			return false;
+			if (found != _patches.end()) {
+				decreaseShaderCount(found->second, false);
+				_patches.erase(found);
+			}
+			return;
 		}
 
-		return true;
+		Brush* brush = Node_getBrush(node);
+
+		if (brush != NULL) {
+			BrushEntries::iterator found = _brushes.find(brush);
+
+			if (found != _brushes.end()) {
+				uncountBrush(found->second);
+				_brushes.erase(found);
+			}
+
+			_changedBrushes.erase(brush);
+		}
 	}
 
 	// Accessor method to retrieve the shader breakdown map
-	const Map& getMap() const {
+	const Map& getMap() {
+		update();
 		return _map;
 	}
 
-	Map::const_iterator begin() const {
-		return _map.begin();
+	// Call begin() first, it is recounting the changed primitives
+	Map::const_iterator begin() {
+		return getMap().begin();
 	}
 
-	Map::const_iterator end() const {
+	Map::const_iterator end() {
 		return _map.end();
 	}
 
 private:
-	// Local helper to increase the shader occurrence count
-	void increaseShaderCount(const std::string& shaderName, bool isFace) {
-		// Try to look up the shader in the map
-		Map::iterator found = _map.find(shaderName);
+	void onBrushFacesChanged(Brush& brush) {
+		// Brushes outside the scene are counted when they are inserted
+		if (_brushes.find(&brush) != _brushes.end()) {
+			_changedBrushes.insert(&brush);
+		}
+	}
 
-		if (found == _map.end()) {
-			// Shader not yet registered, create new entry
-			std::pair<Map::iterator, bool> result = _map.insert(
-				Map::value_type(shaderName, ShaderCount())
-			);
+	void onPatchTextureChanged() {
+		_patchesChanged = true;
+	}
+
+	// Recounts the primitives which changed since they have been counted
+	void update() {
+		for (Brush* brush : _changedBrushes) {
+			std::vector<Map::iterator>& entries = _brushes[brush];
+
+			uncountBrush(entries);
+			countBrush(*brush, entries);
+		}
+
+		_changedBrushes.clear();
+
+		if (_patchesChanged) {
+			for (PatchEntries::value_type& pair : _patches) {
+				if (pair.second->first != pair.first->getShader()) {
+					decreaseShaderCount(pair.second, false);
+					pair.second = increaseShaderCount(pair.first->getShader(), false);
+				}
+			}
 
-			found = result.first;
+			_patchesChanged = false;
 		}
+	}
+
+	void countBrush(const Brush& brush, std::vector<Map::iterator>& entries) {
+		brush.forEachFace([&] (Face& face)
+		{
+			entries.push_back(increaseShaderCount(face.getShader(), true));
+		});
+	}
+
+	void uncountBrush(std::vector<Map::iterator>& entries) {
+		for (const Map::iterator& entry : entries) {
+			decreaseShaderCount(entry, true);
+		}
+
+		entries.clear();
+	}
+
+	// Local helper to increase the shader occurrence count
+	Map::iterator increaseShaderCount(const std::string& shaderName, bool isFace) {
+		// Look up the shader, create a new entry if not yet registered
+		Map::iterator found = _map.insert(Map::value_type(shaderName, ShaderCount())).first;
 
 		// Iterator is valid at this point, increase the counter
 		if (isFace) {
@@ -102,6 +212,22 @@ private:
 		else {
 			found->second.patchCount++;
 		}
+
+		return found;
+	}
+
+	// Every count is referring to its entry, so it can be removed once both are zero
+	void decreaseShaderCount(Map::iterator entry, bool isFace) {
+		if (isFace) {
+			entry->second.faceCount--;
+		}
+		else {
+			entry->second.patchCount--;
+		}
+
+		if (entry->second.faceCount == 0 && entry->second.patchCount == 0) {
+			_map.erase(entry);
+		}
 	}
 
 }; // class ShaderBreakdown
@@ -1,6 +1,5 @@
 #include "ComplexName.h"
 
-#include <climits>
 #include "string/trim.h"
 #include "string/convert.h"
 
@@ -19,33 +18,12 @@ std::string ComplexName::getFullname() const
     return _name + (_postFix == -1 ? "" : string::to_string(_postFix));
 }
 
-namespace
-{
-    // Find the first integer not in the given set
-    int findFirstUnusedNumber(const PostfixSet& set)
-    {
-        static const int LOWEST_VAL = 1;
-
-        for (int i = LOWEST_VAL; i < INT_MAX; ++i)
-        {
-            if (set.find(i) == set.end())
-            {
-                // Found an unused value
-                return i;
-            }
-        }
-
-        // Pathological case, could not find a value
-        return INT_MAX;
-    }
-}
-
 int ComplexName::makePostfixUnique(const PostfixSet& postfixes)
 {
     // If our postfix is already in the set, change it to a unique value
-    if (postfixes.find(_postFix) != postfixes.end())
+    if (postfixes.contains(_postFix))
     {
-        _postFix = findFirstUnusedNumber(postfixes);
+        _postFix = postfixes.getFirstUnused();
     }
 
     return _postFix;
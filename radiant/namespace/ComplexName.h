@@ -1,10 +1,8 @@
 #pragma once
 
 #include <string>
-#include <set>
 
-/// Set of unique integer postfixes
-typedef std::set<int> PostfixSet;
+#include "PostfixSet.h"
 
 /// Name consisting of initial text and optional unique-making numeric postfix
 class ComplexName
@@ -100,11 +100,10 @@ public:
     }
 };
 
-// A walker importing all names into this namespace
+// A walker collecting all namespaced items in traversal order
 struct GatherNamespacedWalker : public scene::NodeVisitor
 {
-    // The set of imported names to keep track of what got imported already
-    std::set<NamespacedPtr> result;
+    std::vector<NamespacedPtr> result;
 
     virtual bool pre(const scene::INodePtr& node)
     {
@@ -112,7 +111,7 @@ struct GatherNamespacedWalker : public scene::NodeVisitor
         NamespacedPtr namespaced = Node_getNamespaced(node);
         if (namespaced)
         {
-            result.insert(namespaced);
+            result.push_back(namespaced);
         }
 
         return true;
@@ -242,6 +241,39 @@ void Namespace::nameChanged(const std::string& oldName, const std::string& newNa
     }
 }
 
+Namespace::Renames Namespace::resolveConflicts(const std::vector<NamespacedPtr>& imported,
+    const UniqueNameSet& importedNames) const
+{
+    // Build a union set containing all imported names and all existing names.
+    // We need to know all existing names to ensure that newly created names are
+    // unique in *both* namespaces
+    UniqueNameSet allNames = _uniqueNames;
+    allNames.merge(importedNames);
+
+    Renames renames;
+
+    for (const NamespacedPtr& n : imported)
+    {
+        std::string name = n->getName();
+
+        // If the imported node conflicts with a name in THIS namespace, then it
+        // needs to be given a new name which is unique in BOTH namespaces.
+        if (_uniqueNames.nameExists(name))
+        {
+            renames.push_back(Renames::value_type(n, allNames.insertUnique(name)));
+        }
+        else
+        {
+            // Name does not exist yet, insert it into the local combined
+            // namespace (but not our destination namespace, this will be
+            // populated in the subsequent call to connect()).
+            allNames.insert(name);
+        }
+    }
+
+    return renames;
+}
+
 void Namespace::ensureNoConflicts(const scene::INodePtr& root)
 {
     // Instantiate a new, temporary namespace for the nodes below root
@@ -257,38 +289,23 @@ void Namespace::ensureNoConflicts(const scene::INodePtr& root)
     rDebug() << "Namespace::ensureNoConflicts(): imported set of "
              << walker.result.size() << " namespaced nodes" << std::endl;
 
-    // Build a union set containing all imported names and all existing names.
-    // We need to know all existing names to ensure that newly created names are
-    // unique in *both* namespaces
-    UniqueNameSet allNames = _uniqueNames;
-    allNames.merge(foreignNamespace._uniqueNames);
+    // The new names don't depend on each other, resolve all conflicts
+    // before changing the first name
+    Renames renames = resolveConflicts(walker.result, foreignNamespace._uniqueNames);
 
-    // Process each object in the to-be-imported tree of nodes, ensuring that it
-    // has a unique name
-    for (const NamespacedPtr& n : walker.result)
+    // Change the names of the imported nodes, this should trigger all
+    // observers in the foreign namespace
+    for (const Renames::value_type& rename : renames)
     {
-        // If the imported node conflicts with a name in THIS namespace, then it
-        // needs to be given a new name which is unique in BOTH namespaces.
-        if (_uniqueNames.nameExists(n->getName()))
-        {
-            // Name exists in the target namespace, get a new name
-            std::string uniqueName = allNames.insertUnique(n->getName());
-
-            rMessage() << "Namespace::ensureNoConflicts(): '" << n->getName()
-                       << "' already exists in this namespace. Rename it to '"
-                       << uniqueName << "'\n";
+        rename.first->changeName(rename.second);
+    }
 
-            // Change the name of the imported node, this should trigger all
-            // observers in the foreign namespace
-            n->changeName(uniqueName);
-        }
-        else
-        {
-            // Name does not exist yet, insert it into the local combined
-            // namespace (but not our destination namespace, this will be
-            // populated in the subsequent call to connect()).
-            allNames.insert(n->getName());
-        }
+    // Report the renames once, instead of writing a line per node
+    if (!renames.empty())
+    {
+        rMessage() << "Namespace::ensureNoConflicts(): renamed " << renames.size()
+                   << " of " << walker.result.size()
+                   << " imported nodes, their names already existed in this namespace" << std::endl;
     }
 
     // at this point, all names in the foreign namespace have been converted to
@@ -16,6 +16,9 @@ class Namespace : public INamespace
 	typedef std::multimap<std::string, NameObserver*> ObserverMap;
 	ObserverMap _observers;
 
+	// Imported items and the new names they need to get
+	typedef std::vector<std::pair<NamespacedPtr, std::string> > Renames;
+
 public:
 	virtual ~Namespace();
 
@@ -30,5 +33,12 @@ public:
 	virtual void removeNameObserver(const std::string& name, NameObserver& observer);
 	virtual void nameChanged(const std::string& oldName, const std::string& newName);
 	virtual void ensureNoConflicts(const scene::INodePtr& root);
+
+private:
+	// Works out the new names of all imported items conflicting with a name
+	// in this namespace, in one go. The new names are unique in this namespace
+	// and the namespace the items are imported from.
+	Renames resolveConflicts(const std::vector<NamespacedPtr>& imported,
+		const UniqueNameSet& importedNames) const;
 };
 typedef std::shared_ptr<Namespace> NamespacePtr;
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <set>
+#include <climits>
+
+/**
+ * \brief
+ * Set of unique integer postfixes, keeping track of the lowest positive
+ * postfix which is not in use yet.
+ *
+ * Looking up the first unused postfix is a constant-time operation, which
+ * keeps the renaming of many conflicting names (e.g. when pasting a large
+ * number of func_static_N entities) from scanning the set over and over.
+ */
+class PostfixSet
+{
+    typedef std::set<int> Postfixes;
+    Postfixes _postfixes;
+
+    // All postfixes in the range [LOWEST_POSTFIX.._firstUnused) are used,
+    // _firstUnused itself is not
+    int _firstUnused;
+
+public:
+    // Numbering of unique names starts with this value
+    static const int LOWEST_POSTFIX = 1;
+
+    typedef Postfixes::const_iterator const_iterator;
+
+    PostfixSet() :
+        _firstUnused(LOWEST_POSTFIX)
+    {}
+
+    const_iterator begin() const
+    {
+        return _postfixes.begin();
+    }
+
+    const_iterator end() const
+    {
+        return _postfixes.end();
+    }
+
+    bool empty() const
+    {
+        return _postfixes.empty();
+    }
+
+    bool contains(int postfix) const
+    {
+        return _postfixes.find(postfix) != _postfixes.end();
+    }
+
+    /// Returns the lowest positive postfix not in this set
+    int getFirstUnused() const
+    {
+        return _firstUnused;
+    }
+
+    /// Returns TRUE if the postfix was not in the set before
+    bool insert(int postfix)
+    {
+        if (!_postfixes.insert(postfix).second)
+        {
+            return false;
+        }
+
+        if (postfix == _firstUnused)
+        {
+            advanceFirstUnused();
+        }
+
+        return true;
+    }
+
+    /// Inserts all postfixes of the other set into this one
+    void insert(const PostfixSet& other)
+    {
+        _postfixes.insert(other._postfixes.begin(), other._postfixes.end());
+        advanceFirstUnused();
+    }
+
+    /// Returns TRUE if the postfix was in the set
+    bool erase(int postfix)
+    {
+        if (_postfixes.erase(postfix) == 0)
+        {
+            return false;
+        }
+
+        if (postfix >= LOWEST_POSTFIX && postfix < _firstUnused)
+        {
+            _firstUnused = postfix;
+        }
+
+        return true;
+    }
+
+private:
+    void advanceFirstUnused()
+    {
+        // Walk the consecutive run of used postfixes starting at _firstUnused
+        for (Postfixes::const_iterator i = _postfixes.find(_firstUnused);
+             i != _postfixes.end() && *i == _firstUnused && _firstUnused < INT_MAX;
+             ++i)
+        {
+            ++_firstUnused;
+        }
+    }
+};
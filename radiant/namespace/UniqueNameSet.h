@@ -2,6 +2,7 @@
 
 #include <set>
 #include <map>
+#include <cassert>
 
 #include "ComplexName.h"
 
@@ -62,12 +63,8 @@ public:
         // The prefix is inserted at this point, add the postfix to the set
         PostfixSet& postfixSet = found->second;
 
-        std::pair<PostfixSet::iterator, bool> result = postfixSet.insert(
-            name.getPostfix()
-        );
-
-        // Return the boolean of the insertion result, it is true on successful insertion
-        return result.second;
+        // Returns true on successful insertion
+        return postfixSet.insert(name.getPostfix());
     }
 
     /**
@@ -88,8 +85,8 @@ public:
         // The prefix has been found, remove the postfix from the set
         PostfixSet& postfixSet = found->second;
 
-        // Return true if the std::set::erase method removed any elements
-        return (postfixSet.erase(name.getPostfix()) > 0);
+        // Returns true if the postfix was in the set
+        return postfixSet.erase(name.getPostfix());
     }
 
     /**
@@ -157,7 +154,7 @@ public:
             const PostfixSet& postfixSet = found->second;
 
             // If we know the number too, the full name exists
-            return (postfixSet.find(name.getPostfix()) != postfixSet.end());
+            return postfixSet.contains(name.getPostfix());
         }
         else {
             // Prefix is not known, hence full name is not known
@@ -180,7 +177,7 @@ public:
 
             if (local != _names.end()) {
                 // Prefix exists, merge the postfixes
-                local->second.insert(i->second.begin(), i->second.end());
+                local->second.insert(i->second);
             }
             else {
                 // Prefix doesn't exist yet, insert the whole string => PostfixSet pair
@@ -60,6 +60,7 @@ Patch::Patch(PatchNode& node) :
 	_renderableLattice(GL_LINES, _latticeIndices, _ctrl_vertices),
 	_transformChanged(false),
 	_tesselationChanged(true),
+	_meshChanged(false),
 	_shader(texdef_name_default())
 {
 	construct();
@@ -81,6 +82,7 @@ Patch::Patch(const Patch& other, PatchNode& node) :
 	_renderableLattice(GL_LINES, _latticeIndices, _ctrl_vertices),
 	_transformChanged(false),
 	_tesselationChanged(true),
+	_meshChanged(false),
 	_shader(other._shader.getMaterialName())
 {
 	// Initalise the default values
@@ -180,6 +182,7 @@ void Patch::disconnectUndoSystem(IMapFileChangeTracker& changeTracker)
     assert(_undoStateSaver);
 
 	_undoStateSaver = nullptr;
+    _lastState.reset();
     GlobalUndoSystem().releaseStateSaver(*this);
 }
 
@@ -350,7 +353,7 @@ void Patch::freezeTransform()
     // Don't call controlPointsChanged() here since that one will re-apply the 
     // current transformation matrix, possible the second time.
     transformChanged();
-    updateTesselation();
+    queueTesselation();
 
     for (Observers::iterator i = _observers.begin(); i != _observers.end();)
     {
@@ -363,7 +366,7 @@ void Patch::controlPointsChanged()
 {
 	transformChanged();
 	evaluateTransform();
-	updateTesselation();
+	queueTesselation();
 
 	for (Observers::iterator i = _observers.begin(); i != _observers.end();)
 	{
@@ -452,7 +455,24 @@ void Patch::undoSave()
 // Save the current patch state into a new UndoMemento instance (allocated on heap) and return it to the undo observer
 IUndoMementoPtr Patch::exportState() const
 {
-	return IUndoMementoPtr(new SavedState(_width, _height, _ctrl, _patchDef3, _subDivisions.x(), _subDivisions.y(), _shader.getMaterialName()));
+	bool ctrlUnchanged = _lastState && _lastState->ctrlMatches(_ctrl);
+
+	// Share the whole memento if nothing changed since the last export or import
+	if (ctrlUnchanged && _lastState->m_width == _width && _lastState->m_height == _height &&
+		_lastState->m_patchDef3 == _patchDef3 && _lastState->_materialName == _shader.getMaterialName() &&
+		_lastState->m_subdivisions_x == _subDivisions.x() && _lastState->m_subdivisions_y == _subDivisions.y())
+	{
+		return _lastState;
+	}
+
+	// Re-use the control grid of the last memento if only the other settings changed
+	std::shared_ptr<const PatchControlArray> ctrl = ctrlUnchanged ?
+		_lastState->m_ctrl : std::make_shared<PatchControlArray>(_ctrl);
+
+	_lastState = std::make_shared<SavedState>(_width, _height, ctrl, !ctrlUnchanged, _patchDef3,
+		_subDivisions.x(), _subDivisions.y(), _shader.getMaterialName());
+
+	return _lastState;
 }
 
 // Revert the state of this patch to the one that has been saved in the UndoMemento
@@ -460,7 +480,8 @@ void Patch::importState(const IUndoMementoPtr& state)
 {
 	undoSave();
 
-	const SavedState& other = *(std::static_pointer_cast<SavedState>(state));
+	std::shared_ptr<SavedState> savedState = std::static_pointer_cast<SavedState>(state);
+	const SavedState& other = *savedState;
 
 	// begin duplicate of SavedState copy constructor, needs refactoring
 
@@ -468,7 +489,7 @@ void Patch::importState(const IUndoMementoPtr& state)
 	{
 		_width = other.m_width;
 		_height = other.m_height;
-		_ctrl = other.m_ctrl;
+		_ctrl = *other.m_ctrl;
 		onAllocate(_ctrl.size());
 		_patchDef3 = other.m_patchDef3;
 		_subDivisions = Subdivisions(other.m_subdivisions_x, other.m_subdivisions_y);
@@ -477,6 +498,8 @@ void Patch::importState(const IUndoMementoPtr& state)
 
 	// end duplicate code
 
+	_lastState = savedState;
+
 	// Notify that this patch has changed
 	textureChanged();
 	controlPointsChanged();
@@ -498,6 +521,8 @@ Patch::~Patch()
 		(*i++)->onPatchDestruction();
 	}
 
+	patch::TesselationScheduler::Instance().cancel(*this);
+
 	// Release the shaders
     _pointShader.reset();
     _latticeShader.reset();
@@ -552,6 +577,25 @@ bool Patch::isDegenerate() const {
 }
 
 void Patch::updateTesselation()
+{
+	queueTesselation();
+
+	if (_meshChanged)
+	{
+		// Generate the meshes of all scheduled patches, including this one
+		patch::TesselationScheduler::Instance().flush();
+	}
+}
+
+void Patch::generateTesselation()
+{
+	// Run the tesselation code
+	_mesh.generate(_width, _height, _ctrlTransformed, subdivisionsFixed(), getSubdivisions());
+
+	_meshChanged = false;
+}
+
+void Patch::queueTesselation()
 {
 	// Only do something if the tesselation has actually changed
 	if (!_tesselationChanged) return;
@@ -563,13 +607,17 @@ void Patch::updateTesselation()
     
     if (!isValid())
     {
+        patch::TesselationScheduler::Instance().cancel(*this);
+        _meshChanged = false;
+
         _mesh.clear();
 		_localAABB = AABB();
         return;
     }
 
-	// Run the tesselation code
-	_mesh.generate(_width, _height, _ctrlTransformed, subdivisionsFixed(), getSubdivisions());
+	// The mesh is generated once it's needed, together with all other scheduled patches
+	_meshChanged = true;
+	patch::TesselationScheduler::Instance().schedule(*this);
 
     updateAABB();
 
@@ -2704,6 +2752,8 @@ bool Patch::subdivisionsFixed() const
 
 bool Patch::getIntersection(const Ray& ray, Vector3& intersection)
 {
+	updateTesselation();
+
 	std::vector<RenderIndex>::const_iterator stripStartIndex = _mesh.indices.begin();
 
 	// Go over each quad strip and intersect the ray with its triangles
@@ -12,6 +12,7 @@
 #include "PatchConstants.h"
 #include "PatchControl.h"
 #include "PatchTesselation.h"
+#include "TesselationScheduler.h"
 #include "PatchRenderables.h"
 #include "brush/TexDef.h"
 #include "brush/FacePlane.h"
@@ -23,6 +24,7 @@
 
 class PatchNode;
 class Ray;
+class SavedState;
 
 /* greebo: The patch class itself, represented by control vertices. The basic rendering of the patch
  * is handled here (unselected control points, tesselation lines, shader).
@@ -34,7 +36,8 @@ class Patch :
 	public IPatch,
 	public Bounded,
 	public Snappable,
-	public IUndoable
+	public IUndoable,
+	public patch::TesselationScheduler::Job
 {
 	PatchNode& _node;
 
@@ -49,6 +52,10 @@ class Patch :
 
 	IUndoStateSaver* _undoStateSaver;
 
+	// The last exported or imported state, shared with the next operation
+	// if the patch didn't change in between
+	mutable std::shared_ptr<SavedState> _lastState;
+
 	// dynamically allocated array of control points, size is _width*_height
 	PatchControlArray _ctrl;			// the true control array
 	PatchControlArray _ctrlTransformed;	// a temporary control array used during transformations, so that the
@@ -81,6 +88,9 @@ class Patch :
 	// TRUE if the patch tesselation needs an update
 	bool _tesselationChanged;
 
+	// TRUE if the mesh needs to be generated, see generateTesselation()
+	bool _meshChanged;
+
 	// The rendersystem we're attached to, to acquire materials
 	RenderSystemWeakPtr _renderSystem;
 
@@ -354,12 +364,21 @@ public:
 	// Static signal holder, signal is emitted after any patch texture has changed
 	static sigc::signal<void>& signal_patchTextureChanged();
 
+	/// TesselationScheduler::Job implementation, generates the mesh without
+	/// touching anything outside this patch. Invoked by the scheduler's worker threads.
+	void generateTesselation() override;
+
 private:
 	// This notifies the surfaceinspector/patchinspector about the texture change
 	void textureChanged();
 
+	// Brings the tesselation up to date, including the mesh
 	void updateTesselation();
 
+	// Updates the bounds and the control lattice, the mesh generation is
+	// left to the TesselationScheduler until the mesh is actually needed
+	void queueTesselation();
+
 	// greebo: checks, if the shader name is valid
 	void check_shader();
 
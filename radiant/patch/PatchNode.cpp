@@ -13,7 +13,8 @@ PatchNode::PatchNode(bool patchDef3) :
 	m_render_selected(GL_POINTS),
 	m_lightList(&GlobalRenderSystem().attachLitObject(*this)),
 	m_patch(*this),
-    _untransformedOriginChanged(true)
+    _untransformedOriginChanged(true),
+	_previewTransform(Matrix4::getIdentity())
 {
 	m_patch.setFixedSubdivisions(patchDef3, Subdivisions(m_patch.getSubdivisions()));
 
@@ -37,7 +38,8 @@ PatchNode::PatchNode(const PatchNode& other) :
 	m_render_selected(GL_POINTS),
 	m_lightList(&GlobalRenderSystem().attachLitObject(*this)),
 	m_patch(other.m_patch, *this), // create the patch out of the <other> one
-    _untransformedOriginChanged(true)
+    _untransformedOriginChanged(true),
+	_previewTransform(Matrix4::getIdentity())
 {
 	SelectableNode::setTransformChangedCallback(Callback(std::bind(&PatchNode::lightsChanged, this)));
 }
@@ -69,6 +71,12 @@ void PatchNode::allocate(std::size_t size) {
 }
 
 const AABB& PatchNode::localAABB() const {
+	if (isPreviewingTransform())
+	{
+		_previewAABB = AABB::createFromOrientedAABBSafe(m_patch.localAABB(), _previewTransform);
+		return _previewAABB;
+	}
+
 	return m_patch.localAABB();
 }
 
@@ -127,11 +135,18 @@ void PatchNode::testSelect(Selector& selector, SelectionTest& test) {
 	if (!isVisible())
 		return;
 
-    test.BeginMesh(localToWorld(), true);
+    test.BeginMesh(getPreviewedLocalToWorld(), true);
     // Pass the selection test call to the patch
     m_patch.testSelect(selector, test);
 }
 
+bool PatchNode::prepareConcurrentSelectionTest()
+{
+	// Tesselate the patch now, the scheduler must not be flushed by the test itself
+	m_patch.getTesselation();
+	return true;
+}
+
 void PatchNode::selectPlanes(Selector& selector, SelectionTest& test, const PlaneCallback& selectedPlaneCallback) {
 	test.BeginMesh(localToWorld());
 
@@ -277,6 +292,10 @@ bool PatchNode::intersectsLight(const RendererLight& light) const {
 	return light.intersectsAABB(worldAABB());
 }
 
+const AABB& PatchNode::getLitObjectBounds() const {
+	return worldAABB();
+}
+
 void PatchNode::renderSolid(RenderableCollector& collector, const VolumeTest& volume) const
 {
 	// Don't render invisible shaders
@@ -288,7 +307,7 @@ void PatchNode::renderSolid(RenderableCollector& collector, const VolumeTest& vo
 	assert(_renderEntity); // patches rendered without parent - no way!
 
 	// Pass the call to the patch instance, it adds the renderable
-	m_patch.render_solid(collector, volume, localToWorld(), *_renderEntity);
+	m_patch.render_solid(collector, volume, getPreviewedLocalToWorld(), *_renderEntity);
 
 	// Render the selected components
 	renderComponentsSelected(collector, volume);
@@ -302,7 +321,7 @@ void PatchNode::renderWireframe(RenderableCollector& collector, const VolumeTest
 	const_cast<Patch&>(m_patch).evaluateTransform();
 
 	// Pass the call to the patch instance, it adds the renderable
-	m_patch.render_wireframe(collector, volume, localToWorld());
+	m_patch.render_wireframe(collector, volume, getPreviewedLocalToWorld());
 
 	// Render the selected components
 	renderComponentsSelected(collector, volume);
@@ -372,10 +391,15 @@ void PatchNode::renderComponentsSelected(RenderableCollector& collector, const V
 		collector.setHighlightFlag(RenderableCollector::Highlight::Primitives, false);
 		collector.SetState(PatchNode::m_state_selpoint, RenderableCollector::eWireframeOnly);
 		collector.SetState(PatchNode::m_state_selpoint, RenderableCollector::eFullMaterials);
-		collector.addRenderable(m_render_selected, localToWorld());
+		collector.addRenderable(m_render_selected, getPreviewedLocalToWorld());
 	}
 }
 
+Matrix4 PatchNode::getPreviewedLocalToWorld() const
+{
+	return isPreviewingTransform() ? localToWorld().getMultipliedBy(_previewTransform) : localToWorld();
+}
+
 std::size_t PatchNode::getHighlightFlags()
 {
 	if (!isSelected()) return Highlight::NoHighlight;
@@ -433,6 +457,19 @@ void PatchNode::transformComponents(const Matrix4& matrix) {
 
 void PatchNode::_onTransformationChanged()
 {
+	if (isPreviewingTransform())
+	{
+		// Only the matrix used for rendering and selection tests changes,
+		// the control points are transformed once the transformation is frozen
+		_previewTransform = calculateTransform();
+
+		boundsChanged();
+		lightsChanged();
+		return;
+	}
+
+	_previewTransform = Matrix4::getIdentity();
+
 	m_patch.transformChanged();
 }
 
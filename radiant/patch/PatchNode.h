@@ -47,6 +47,11 @@ class PatchNode :
     // If true, the _untransformedOrigin member needs an update
     bool _untransformedOriginChanged;
 
+	// The transformation the patch is rendered with while it's previewed,
+	// the control points are transformed once the transformation is frozen
+	Matrix4 _previewTransform;
+	mutable AABB _previewAABB;
+
 public:
 	// Construct a PatchNode with no arguments
 	PatchNode(bool patchDef3 = false);
@@ -76,6 +81,7 @@ public:
 
 	// Test the Patch instance for selection (SelectionTestable)
 	void testSelect(Selector& selector, SelectionTest& test) override;
+	bool prepareConcurrentSelectionTest() override;
 
 	// Check if the drag planes pass the given selection test (and select them of course and call the callback)
 	void selectPlanes(Selector& selector, SelectionTest& test, const PlaneCallback& selectedPlaneCallback) override;
@@ -124,6 +130,7 @@ public:
 
 	// LitObject implementation
 	bool intersectsLight(const RendererLight& light) const override;
+	const AABB& getLitObjectBounds() const override;
 
 	// Renderable implementation
 
@@ -161,6 +168,9 @@ private:
 
 	// greebo: Renders the selected components. This is called by the above two render functions
 	void renderComponentsSelected(RenderableCollector& collector, const VolumeTest& volume) const;
+
+	// Returns the localToWorld matrix including the previewed transformation, if any
+	Matrix4 getPreviewedLocalToWorld() const;
 };
 typedef std::shared_ptr<PatchNode> PatchNodePtr;
 typedef std::weak_ptr<PatchNode> PatchNodeWeakPtr;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "PatchControl.h"
+#include "BasicUndoMemento.h"
+#include <memory>
 
 /* greebo: This is a structure that is allocated on the heap and contains all the state
  * information of a patch. This information is used by the UndoSystem to save the current
@@ -12,7 +14,12 @@ class SavedState :
 public:
 	// The members to store the state information
 	std::size_t m_width, m_height;
-	PatchControlArray m_ctrl;
+
+	// The control grid is shared between the mementos of a patch
+	// as long as it's not changed, e.g. when changing the material
+	std::shared_ptr<const PatchControlArray> m_ctrl;
+	bool _ownsCtrl;
+
 	bool m_patchDef3;
 	std::size_t m_subdivisions_x;
 	std::size_t m_subdivisions_y;
@@ -22,7 +29,8 @@ public:
 	SavedState(
 		std::size_t width,
 		std::size_t height,
-		const PatchControlArray& ctrl,
+		const std::shared_ptr<const PatchControlArray>& ctrl,
+		bool ownsCtrl,
 		bool patchDef3,
 		std::size_t subdivisions_x,
 		std::size_t subdivisions_y,
@@ -31,9 +39,35 @@ public:
 		m_width(width),
 		m_height(height),
 		m_ctrl(ctrl),
+		_ownsCtrl(ownsCtrl),
 		m_patchDef3(patchDef3),
 		m_subdivisions_x(subdivisions_x),
 		m_subdivisions_y(subdivisions_y),
         _materialName(materialName)
     {}
+
+	// True if the given control points are exactly the saved ones
+	bool ctrlMatches(const PatchControlArray& ctrl) const
+	{
+		if (ctrl.size() != m_ctrl->size())
+		{
+			return false;
+		}
+
+		for (std::size_t i = 0; i < ctrl.size(); ++i)
+		{
+			if (ctrl[i].vertex != (*m_ctrl)[i].vertex || ctrl[i].texcoord != (*m_ctrl)[i].texcoord)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	std::size_t getMemoryUsage() const override
+	{
+		return sizeof(*this) + undo::getAllocatedSize(_materialName) +
+			(_ownsCtrl ? sizeof(PatchControlArray) + m_ctrl->capacity() * sizeof(PatchControl) : 0);
+	}
 };
@@ -1,6 +1,168 @@
 #include "PatchTesselation.h"
 
-#include "Patch.h"
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+
+// The vertices of the meshes kept by the TesselationCache, at 136 bytes each
+const std::size_t MAX_CACHED_VERTICES = 1 << 17;
+
+// Patches with the same control points and subdivision settings (like the
+// many copies of the same pipe or arch in a map) are sharing the work
+// of tesselating them through this cache, the least recently used
+// meshes are dropped when the vertex limit is reached. Patches might be
+// tesselated by several threads at once, the cache is locked during access.
+class TesselationCache
+{
+	struct Entry
+	{
+		std::size_t hash;
+		std::size_t width;
+		std::size_t height;
+		bool subdivisionsFixed;
+		Subdivisions subdivisions;
+		PatchControlArray controlPoints;
+
+		PatchTesselation tesselation;
+		std::size_t numVertices;
+	};
+
+	// Most recently used entries first
+	typedef std::list<Entry> Entries;
+	Entries _entries;
+
+	std::unordered_multimap<std::size_t, Entries::iterator> _index;
+
+	std::size_t _numVertices;
+
+	std::mutex _lock;
+
+public:
+	TesselationCache() :
+		_numVertices(0)
+	{}
+
+	static TesselationCache& Instance()
+	{
+		static TesselationCache _instance;
+		return _instance;
+	}
+
+	static std::size_t getHash(std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+		bool subdivisionsFixed, const Subdivisions& subdivs)
+	{
+		std::size_t seed = 0;
+
+		auto combine = [&](double value)
+		{
+			seed ^= std::hash<double>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		};
+
+		combine(static_cast<double>(width));
+		combine(static_cast<double>(height));
+		combine(subdivisionsFixed ? subdivs.x() : -1.0);
+		combine(subdivisionsFixed ? subdivs.y() : -1.0);
+
+		for (const PatchControl& control : controlPoints)
+		{
+			combine(control.vertex.x());
+			combine(control.vertex.y());
+			combine(control.vertex.z());
+			combine(control.texcoord.x());
+			combine(control.texcoord.y());
+		}
+
+		return seed;
+	}
+
+	// Copies the cached mesh to the given tesselation, returns false if there is none
+	bool fetch(std::size_t hash, std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+		bool subdivisionsFixed, const Subdivisions& subdivs, PatchTesselation& tesselation)
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+
+		auto range = _index.equal_range(hash);
+
+		for (auto i = range.first; i != range.second; ++i)
+		{
+			const Entry& entry = *i->second;
+
+			if (entry.width != width || entry.height != height ||
+				entry.subdivisionsFixed != subdivisionsFixed ||
+				(subdivisionsFixed && entry.subdivisions != subdivs) ||
+				!controlPointsEqual(entry.controlPoints, controlPoints))
+			{
+				continue;
+			}
+
+			_entries.splice(_entries.begin(), _entries, i->second);
+
+			tesselation = entry.tesselation;
+			return true;
+		}
+
+		return false;
+	}
+
+	void insert(std::size_t hash, std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+		bool subdivisionsFixed, const Subdivisions& subdivs, const PatchTesselation& tesselation)
+	{
+		std::size_t numVertices = tesselation.vertices.size() + controlPoints.size();
+
+		if (numVertices > MAX_CACHED_VERTICES) return;
+
+		std::lock_guard<std::mutex> lock(_lock);
+
+		while (_numVertices + numVertices > MAX_CACHED_VERTICES)
+		{
+			removeLeastRecentlyUsed();
+		}
+
+		_entries.push_front(Entry { hash, width, height, subdivisionsFixed, subdivs, controlPoints, tesselation, numVertices });
+		_index.emplace(hash, _entries.begin());
+		_numVertices += numVertices;
+	}
+
+private:
+	static bool controlPointsEqual(const PatchControlArray& a, const PatchControlArray& b)
+	{
+		if (a.size() != b.size()) return false;
+
+		for (std::size_t i = 0; i < a.size(); ++i)
+		{
+			if (a[i].vertex != b[i].vertex || a[i].texcoord != b[i].texcoord)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void removeLeastRecentlyUsed()
+	{
+		Entries::iterator last = std::prev(_entries.end());
+		auto range = _index.equal_range(last->hash);
+
+		for (auto i = range.first; i != range.second; ++i)
+		{
+			if (i->second == last)
+			{
+				_index.erase(i);
+				break;
+			}
+		}
+
+		_numVertices -= last->numVertices;
+		_entries.erase(last);
+	}
+};
+
+}
 
 void PatchTesselation::clear()
 {
@@ -9,7 +171,7 @@ void PatchTesselation::clear()
 
 #define	COPLANAR_EPSILON	0.1f
 
-void PatchTesselation::generateNormals()
+void PatchTesselation::generateNormals(std::vector<ArbitraryMeshVertex>& vertices, std::size_t width, std::size_t height)
 {
 	//
 	// if all points are coplanar, set all normals to that plane
@@ -192,85 +354,106 @@ void PatchTesselation::generateNormals()
 	}
 }
 
-void PatchTesselation::sampleSinglePatchPoint(const ArbitraryMeshVertex ctrl[3][3], float u, float v, ArbitraryMeshVertex& out) const
+namespace
 {
-	float vCtrl[3][8];
 
-	// find the control points for the v coordinate
-	for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
-	{
-		for (std::size_t axis = 0; axis < 8; axis++)
-		{
-			float a, b, c;
+// Vertex, normal and texcoord of a mesh vertex, the components which are interpolated
+const std::size_t NUM_COMPONENTS = 8;
 
-			if (axis < 3)
-			{
-				a = ctrl[0][vPoint].vertex[axis];
-				b = ctrl[1][vPoint].vertex[axis];
-				c = ctrl[2][vPoint].vertex[axis];
-			}
-			else if (axis < 6)
-			{
-				a = ctrl[0][vPoint].normal[axis - 3];
-				b = ctrl[1][vPoint].normal[axis - 3];
-				c = ctrl[2][vPoint].normal[axis - 3];
-			}
-			else
-			{
-				a = ctrl[0][vPoint].texcoord[axis - 6];
-				b = ctrl[1][vPoint].texcoord[axis - 6];
-				c = ctrl[2][vPoint].texcoord[axis - 6];
-			}
+inline void loadComponents(const ArbitraryMeshVertex& vertex, float components[NUM_COMPONENTS])
+{
+	components[0] = vertex.vertex[0];
+	components[1] = vertex.vertex[1];
+	components[2] = vertex.vertex[2];
+	components[3] = vertex.normal[0];
+	components[4] = vertex.normal[1];
+	components[5] = vertex.normal[2];
+	components[6] = vertex.texcoord[0];
+	components[7] = vertex.texcoord[1];
+}
 
-			float qA = a - 2.0f * b + c;
-			float qB = 2.0f * b - 2.0f * a;
-			float qC = a;
+inline void storeComponents(const float components[NUM_COMPONENTS], ArbitraryMeshVertex& vertex)
+{
+	vertex.vertex.set(components[0], components[1], components[2]);
+	vertex.normal.set(components[3], components[4], components[5]);
+	vertex.texcoord[0] = components[6];
+	vertex.texcoord[1] = components[7];
+}
 
-			vCtrl[vPoint][axis] = qA * u * u + qB * u + qC;
-		}
-	}
+// The coefficients of the quadratic curves through three points, for all components
+struct QuadraticCurves
+{
+	float qA[NUM_COMPONENTS];
+	float qB[NUM_COMPONENTS];
+	float qC[NUM_COMPONENTS];
 
-	// interpolate the v value
-	for (std::size_t axis = 0; axis < 8; axis++)
+	void set(const float a[NUM_COMPONENTS], const float b[NUM_COMPONENTS], const float c[NUM_COMPONENTS])
 	{
-		float a = vCtrl[0][axis];
-		float b = vCtrl[1][axis];
-		float c = vCtrl[2][axis];
-		float qA = a - 2.0f * b + c;
-		float qB = 2.0f * b - 2.0f * a;
-		float qC = a;
-
-		if (axis < 3)
-		{
-			out.vertex[axis] = qA * v * v + qB * v + qC;
-		}
-		else if (axis < 6)
+		for (std::size_t axis = 0; axis < NUM_COMPONENTS; axis++)
 		{
-			out.normal[axis - 3] = qA * v * v + qB * v + qC;
+			qA[axis] = a[axis] - 2.0f * b[axis] + c[axis];
+			qB[axis] = 2.0f * b[axis] - 2.0f * a[axis];
+			qC[axis] = a[axis];
 		}
-		else
+	}
+
+	void evaluate(float t, float out[NUM_COMPONENTS]) const
+	{
+		for (std::size_t axis = 0; axis < NUM_COMPONENTS; axis++)
 		{
-			out.texcoord[axis - 6] = qA * v * v + qB * v + qC;
+			out[axis] = qA[axis] * t * t + qB[axis] * t + qC[axis];
 		}
 	}
+};
+
 }
 
-void PatchTesselation::sampleSinglePatch(const ArbitraryMeshVertex ctrl[3][3], 
-	std::size_t baseCol, std::size_t baseRow,
-	std::size_t w, std::size_t horzSub, std::size_t vertSub,
-	std::vector<ArbitraryMeshVertex>& outVerts) const
+void PatchTesselation::sampleSubPatch(const ArbitraryMeshVertex ctrl[3][3], std::size_t horzSub, std::size_t vertSub,
+	std::size_t numColumns, std::size_t numRows, ArbitraryMeshVertex* outVerts, std::size_t stride)
 {
-	horzSub++;
-	vertSub++;
+	// The curves along u through the three rows of control points
+	QuadraticCurves uCurves[3];
+
+	for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
+	{
+		float a[NUM_COMPONENTS], b[NUM_COMPONENTS], c[NUM_COMPONENTS];
+
+		loadComponents(ctrl[0][vPoint], a);
+		loadComponents(ctrl[1][vPoint], b);
+		loadComponents(ctrl[2][vPoint], c);
+
+		uCurves[vPoint].set(a, b, c);
+	}
 
-	for (std::size_t i = 0; i < horzSub; i++)
+	std::vector<float> vValues(numRows);
+
+	for (std::size_t j = 0; j < numRows; j++)
+	{
+		vValues[j] = static_cast<float>(j) / vertSub;
+	}
+
+	for (std::size_t i = 0; i < numColumns; i++)
 	{
-		for (std::size_t j = 0; j < vertSub; j++)
+		float u = static_cast<float>(i) / horzSub;
+
+		// find the control points for the v coordinate
+		float vCtrl[3][NUM_COMPONENTS];
+
+		for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
 		{
-			float u = static_cast<float>(i) / (horzSub - 1);
-			float v = static_cast<float>(j) / (vertSub - 1);
+			uCurves[vPoint].evaluate(u, vCtrl[vPoint]);
+		}
+
+		// interpolate the v values of this column
+		QuadraticCurves vCurve;
+		vCurve.set(vCtrl[0], vCtrl[1], vCtrl[2]);
 
-			sampleSinglePatchPoint(ctrl, u, v, outVerts[((baseRow + j) * w) + i + baseCol]);
+		for (std::size_t j = 0; j < numRows; j++)
+		{
+			float sample[NUM_COMPONENTS];
+			vCurve.evaluate(vValues[j], sample);
+
+			storeComponents(sample, outVerts[j * stride + i]);
 		}
 	}
 }
@@ -299,7 +482,7 @@ void PatchTesselation::subdivideMeshFixed(std::size_t subdivX, std::size_t subdi
 				}
 			}
 
-			sampleSinglePatch(sample, baseCol, baseRow, outWidth, subdivX, subdivY, dv);
+			sampleSubPatch(sample, subdivX, subdivY, subdivX + 1, subdivY + 1, &dv[(baseRow * outWidth) + baseCol], outWidth);
 
 			baseRow += subdivY;
 		}
@@ -691,6 +874,24 @@ void calculateFaceTangent(FaceTangents& ft, const ArbitraryMeshVertex& a, const
 	ft.tangents[1] = temp;
 }
 
+// Invokes the functor for each triangle of the quad strips, in the order
+// the tangent vectors are derived
+template<typename Functor>
+void foreachTriangle(const std::vector<RenderIndex>& indices, std::size_t numStrips, std::size_t lenStrips,
+	const Functor& functor)
+{
+	const RenderIndex* strip_indices = &indices.front();
+
+	for (std::size_t strip = 0; strip < numStrips; strip++, strip_indices += lenStrips)
+	{
+		for (std::size_t i = 0; i < lenStrips - 2; i += 2)
+		{
+			functor(strip_indices[i + 0], strip_indices[i + 1], strip_indices[i + 2]);
+			functor(strip_indices[i + 1], strip_indices[i + 2], strip_indices[i + 3]);
+		}
+	}
+}
+
 } // namespace
 
 void PatchTesselation::deriveFaceTangents(std::vector<FaceTangents>& faceTangents)
@@ -789,6 +990,67 @@ void PatchTesselation::deriveTangents()
 	}
 }
 
+void PatchTesselation::deriveTangents(const std::vector<bool>& changedVertices)
+{
+	if (lenStrips < 2) return;
+
+	// The tangents of all vertices sharing a face with a changed vertex are affected
+	std::vector<bool> affected(vertices.size(), false);
+
+	foreachTriangle(indices, numStrips, lenStrips, [&](RenderIndex a, RenderIndex b, RenderIndex c)
+	{
+		if (changedVertices[a] || changedVertices[b] || changedVertices[c])
+		{
+			affected[a] = affected[b] = affected[c] = true;
+		}
+	});
+
+	for (std::size_t i = 0; i < vertices.size(); i++)
+	{
+		if (affected[i])
+		{
+			vertices[i].tangent = Normal3f(0, 0, 0);
+			vertices[i].bitangent = Normal3f(0, 0, 0);
+		}
+	}
+
+	// Sum up the face tangents again, in the same order as deriveTangents() does
+	foreachTriangle(indices, numStrips, lenStrips, [&](RenderIndex a, RenderIndex b, RenderIndex c)
+	{
+		if (!affected[a] && !affected[b] && !affected[c])
+		{
+			return;
+		}
+
+		FaceTangents ft;
+		calculateFaceTangent(ft, vertices[a], vertices[b], vertices[c]);
+
+		for (RenderIndex index : { a, b, c })
+		{
+			if (affected[index])
+			{
+				vertices[index].tangent += ft.tangents[0];
+				vertices[index].bitangent += ft.tangents[1];
+			}
+		}
+	});
+
+	for (std::size_t i = 0; i < vertices.size(); i++)
+	{
+		if (!affected[i]) continue;
+
+		ArbitraryMeshVertex& vert = vertices[i];
+
+		float d = vert.tangent.dot(vert.normal);
+		vert.tangent = vert.tangent - vert.normal * d;
+		vert.tangent.normalise();
+
+		d = vert.bitangent.dot(vert.normal);
+		vert.bitangent = vert.bitangent - vert.normal * d;
+		vert.bitangent.normalise();
+	}
+}
+
 void PatchTesselation::generateIndices()
 {
 	const std::size_t numElems = width*height; // total number of elements in vertex array
@@ -830,7 +1092,27 @@ void PatchTesselation::generateIndices()
 	}
 }
 
-void PatchTesselation::generate(std::size_t patchWidth, std::size_t patchHeight, 
+std::vector<ArbitraryMeshVertex> PatchTesselation::getControlMesh(std::size_t patchWidth, std::size_t patchHeight,
+	const PatchControlArray& controlPoints)
+{
+	std::vector<ArbitraryMeshVertex> mesh(controlPoints.size());
+
+	for (std::size_t w = 0; w < patchWidth; w++)
+	{
+		for (std::size_t h = 0; h < patchHeight; h++)
+		{
+			mesh[h*patchWidth + w].vertex = controlPoints[h*patchWidth + w].vertex;
+			mesh[h*patchWidth + w].texcoord = controlPoints[h*patchWidth + w].texcoord;
+		}
+	}
+
+	// generate normals for the control mesh
+	generateNormals(mesh, patchWidth, patchHeight);
+
+	return mesh;
+}
+
+void PatchTesselation::generateMesh(std::size_t patchWidth, std::size_t patchHeight,
 	const PatchControlArray& controlPoints, bool subdivionsFixed, const Subdivisions& subdivs)
 {
 	width = patchWidth;
@@ -840,26 +1122,22 @@ void PatchTesselation::generate(std::size_t patchWidth, std::size_t patchHeight,
 	_maxHeight = height;
 
 	// We start off with the control vertex grid, copy it into our tesselation structure
-	vertices.resize(controlPoints.size());
-
-	for (std::size_t w = 0; w < width; w++)
-	{
-		for (std::size_t h = 0; h < height; h++)
-		{
-			vertices[h*width + w].vertex = controlPoints[h*width + w].vertex;
-			vertices[h*width + w].texcoord = controlPoints[h*width + w].texcoord;
-		}
-	}
-
-	// generate normals for the control mesh
-	generateNormals();
+	vertices = getControlMesh(width, height, controlPoints);
 
 	if (subdivionsFixed)
 	{
+		// Keep the control mesh around to update this mesh in place later on
+		_controlMesh = vertices;
+		_controlWidth = width;
+		_controlHeight = height;
+		_fixedSubdivisions = subdivs;
+
 		subdivideMeshFixed(subdivs.x(), subdivs.y());
 	}
 	else
 	{
+		_controlMesh.clear();
+
 		subdivideMesh();
 	}
 
@@ -875,3 +1153,125 @@ void PatchTesselation::generate(std::size_t patchWidth, std::size_t patchHeight,
 	// With indices in place we can derive the tangent/bitangent vectors
 	deriveTangents();
 }
+
+bool PatchTesselation::updateFixedMesh(std::size_t patchWidth, std::size_t patchHeight,
+	const PatchControlArray& controlPoints, const Subdivisions& subdivs)
+{
+	if (_controlMesh.empty() || _controlWidth != patchWidth || _controlHeight != patchHeight ||
+		_fixedSubdivisions != subdivs || subdivs.x() == 0 || subdivs.y() == 0 || width < 2 || height < 2)
+	{
+		return false;
+	}
+
+	// The normals of the control mesh might change in other places than the
+	// moved control points, calculate all of them and compare
+	std::vector<ArbitraryMeshVertex> controlMesh = getControlMesh(patchWidth, patchHeight, controlPoints);
+
+	std::size_t numPatchesX = (patchWidth - 1) / 2;
+	std::size_t numPatchesY = (patchHeight - 1) / 2;
+
+	std::vector<bool> changedPatches(numPatchesX * numPatchesY, false);
+	bool changed = false;
+
+	for (std::size_t h = 0; h < patchHeight; h++)
+	{
+		for (std::size_t w = 0; w < patchWidth; w++)
+		{
+			const ArbitraryMeshVertex& current = controlMesh[h*patchWidth + w];
+			const ArbitraryMeshVertex& previous = _controlMesh[h*patchWidth + w];
+
+			if (current.vertex == previous.vertex && current.texcoord == previous.texcoord &&
+				current.normal == previous.normal)
+			{
+				continue;
+			}
+
+			changed = true;
+
+			// Control points on the border of a 3x3 sub-patch are shared with its neighbours
+			for (std::size_t y = h > 0 ? (h - 1) / 2 : 0; y <= h / 2 && y < numPatchesY; y++)
+			{
+				for (std::size_t x = w > 0 ? (w - 1) / 2 : 0; x <= w / 2 && x < numPatchesX; x++)
+				{
+					changedPatches[y*numPatchesX + x] = true;
+				}
+			}
+		}
+	}
+
+	_controlMesh.swap(controlMesh);
+
+	if (!changed)
+	{
+		return true;
+	}
+
+	std::size_t subdivX = subdivs.x();
+	std::size_t subdivY = subdivs.y();
+
+	std::vector<bool> changedVertices(vertices.size(), false);
+	ArbitraryMeshVertex sample[3][3];
+
+	// The vertices on the border of two sub-patches are sampled by both of them
+	// in subdivideMeshFixed(), the latter one wins. Sample the changed sub-patches
+	// without the vertices they're sharing with the next ones.
+	for (std::size_t x = 0; x < numPatchesX; x++)
+	{
+		for (std::size_t y = 0; y < numPatchesY; y++)
+		{
+			if (!changedPatches[y*numPatchesX + x]) continue;
+
+			for (std::size_t k = 0; k < 3; k++)
+			{
+				for (std::size_t l = 0; l < 3; l++)
+				{
+					sample[k][l] = _controlMesh[((y * 2 + l) * patchWidth) + x * 2 + k];
+				}
+			}
+
+			std::size_t numColumns = x + 1 < numPatchesX ? subdivX : subdivX + 1;
+			std::size_t numRows = y + 1 < numPatchesY ? subdivY : subdivY + 1;
+
+			std::size_t baseIndex = ((y * subdivY) * width) + x * subdivX;
+
+			sampleSubPatch(sample, subdivX, subdivY, numColumns, numRows, &vertices[baseIndex], width);
+
+			for (std::size_t j = 0; j < numRows; j++)
+			{
+				for (std::size_t i = 0; i < numColumns; i++)
+				{
+					std::size_t index = baseIndex + j * width + i;
+
+					vertices[index].normal.normalise();
+					changedVertices[index] = true;
+				}
+			}
+		}
+	}
+
+	// Stitch the tangents of the sampled vertices and their neighbours
+	deriveTangents(changedVertices);
+
+	return true;
+}
+
+void PatchTesselation::generate(std::size_t patchWidth, std::size_t patchHeight, 
+	const PatchControlArray& controlPoints, bool subdivionsFixed, const Subdivisions& subdivs)
+{
+	if (subdivionsFixed && updateFixedMesh(patchWidth, patchHeight, controlPoints, subdivs))
+	{
+		return;
+	}
+
+	TesselationCache& cache = TesselationCache::Instance();
+	std::size_t hash = TesselationCache::getHash(patchWidth, patchHeight, controlPoints, subdivionsFixed, subdivs);
+
+	if (cache.fetch(hash, patchWidth, patchHeight, controlPoints, subdivionsFixed, subdivs, *this))
+	{
+		return;
+	}
+
+	generateMesh(patchWidth, patchHeight, controlPoints, subdivionsFixed, subdivs);
+
+	cache.insert(hash, patchWidth, patchHeight, controlPoints, subdivionsFixed, subdivs, *this);
+}
@@ -29,6 +29,14 @@ private:
 	std::size_t _maxWidth;
 	std::size_t _maxHeight;
 
+	// The control mesh (including its normals) the last fixed-subdivision
+	// mesh has been sampled from, empty for variable subdivisions.
+	// Used to re-sample only the sub-patches which changed since.
+	std::vector<ArbitraryMeshVertex> _controlMesh;
+	std::size_t _controlWidth;
+	std::size_t _controlHeight;
+	Subdivisions _fixedSubdivisions;
+
 public:
 
     /// Construct an uninitialised patch tesselation
@@ -38,20 +46,47 @@ public:
 		width(0),
 		height(0),
 		_maxWidth(0),
-		_maxHeight(0)
+		_maxHeight(0),
+		_controlWidth(0),
+		_controlHeight(0),
+		_fixedSubdivisions(0, 0)
 	{}
 
     /// Clear all patch data
     void clear();
 
-	// Generates the tesselated mesh based on the input parameters
+	// Generates the tesselated mesh based on the input parameters. Fixed-subdivision
+	// meshes of the same dimensions are updated in place, only the sub-patches
+	// affected by changed control points are sampled again. Otherwise the mesh
+	// is taken from the tesselation cache shared by all patches, if possible.
 	void generate(std::size_t width, std::size_t height, const PatchControlArray& controlPoints, 
 		bool subdivionsFixed, const Subdivisions& subdivs);
 
+	/**
+	 * Evaluates the biquadratic patch defined by the 3x3 control vertices at
+	 * numColumns x numRows points (u = column / horzSub, v = row / vertSub)
+	 * and writes vertex, normal and texcoord to the given row-major grid.
+	 * The curve coefficients are calculated once per patch and column, then
+	 * the samples of a column are evaluated for all 8 components side by side.
+	 */
+	static void sampleSubPatch(const ArbitraryMeshVertex ctrl[3][3], std::size_t horzSub, std::size_t vertSub,
+		std::size_t numColumns, std::size_t numRows, ArbitraryMeshVertex* outVerts, std::size_t stride);
+
 private:
+	void generateMesh(std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+		bool subdivionsFixed, const Subdivisions& subdivs);
+
+	// Re-samples the sub-patches of a fixed-subdivision mesh whose control points changed,
+	// returns false if the mesh can't be updated this way
+	bool updateFixedMesh(std::size_t width, std::size_t height, const PatchControlArray& controlPoints,
+		const Subdivisions& subdivs);
+
+	static std::vector<ArbitraryMeshVertex> getControlMesh(std::size_t width, std::size_t height,
+		const PatchControlArray& controlPoints);
+
 	// Private methods used for tesselation, modeled after the patch subdivision code found in idTech4
 	void generateIndices();
-	void generateNormals();
+	static void generateNormals(std::vector<ArbitraryMeshVertex>& vertices, std::size_t width, std::size_t height);
 	void subdivideMesh();
 	void subdivideMeshFixed(std::size_t subdivX, std::size_t subdivY);
 	void collapseMesh();
@@ -63,10 +98,9 @@ private:
 	static void lerpVert(const ArbitraryMeshVertex& a, const ArbitraryMeshVertex& b, ArbitraryMeshVertex&out);
 	static Vector3 projectPointOntoVector(const Vector3& point, const Vector3& vStart, const Vector3& vEnd);
 
-	void sampleSinglePatch(const ArbitraryMeshVertex ctrl[3][3], std::size_t baseCol, std::size_t baseRow, 
-		std::size_t width, std::size_t horzSub, std::size_t vertSub, 
-		std::vector<ArbitraryMeshVertex>& outVerts) const;
-	void sampleSinglePatchPoint(const ArbitraryMeshVertex ctrl[3][3], float u, float v, ArbitraryMeshVertex& out) const;
 	void deriveTangents();
 	void deriveFaceTangents(std::vector<FaceTangents>& faceTangents);
+
+	// Re-calculates the tangents of the vertices sharing a face with a changed vertex
+	void deriveTangents(const std::vector<bool>& changedVertices);
 };
@@ -0,0 +1,124 @@
+#include "TesselationScheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
+namespace patch
+{
+
+namespace
+{
+	// Smaller batches are tesselated by the calling thread, like
+	// the few patches being dragged around
+	const std::size_t PARALLEL_THRESHOLD = 16;
+
+	// Number of jobs a worker takes at once
+	const std::size_t JOBS_PER_CHUNK = 4;
+}
+
+TesselationScheduler::TesselationScheduler() :
+	_numThreads(0)
+{}
+
+TesselationScheduler& TesselationScheduler::Instance()
+{
+	static TesselationScheduler _instance;
+	return _instance;
+}
+
+void TesselationScheduler::schedule(Job& job)
+{
+	if (_scheduled.insert(&job).second)
+	{
+		_queue.push_back(&job);
+	}
+}
+
+void TesselationScheduler::cancel(Job& job)
+{
+	// The queue is cleaned up by the next flush
+	_scheduled.erase(&job);
+
+	if (_scheduled.empty())
+	{
+		_queue.clear();
+	}
+}
+
+std::size_t TesselationScheduler::size() const
+{
+	return _scheduled.size();
+}
+
+void TesselationScheduler::setNumThreads(std::size_t numThreads)
+{
+	_numThreads = numThreads;
+}
+
+void TesselationScheduler::flush()
+{
+	if (_scheduled.empty()) return;
+
+	// Collect the jobs which are still scheduled. The queue might contain a
+	// cancelled job's address twice if another job got allocated in its place.
+	std::vector<Job*> jobs;
+	jobs.reserve(_scheduled.size());
+
+	for (Job* job : _queue)
+	{
+		if (_scheduled.erase(job) > 0)
+		{
+			jobs.push_back(job);
+		}
+	}
+
+	_queue.clear();
+
+	std::size_t numThreads = _numThreads > 0 ? _numThreads : std::thread::hardware_concurrency();
+
+	if (numThreads <= 1 || jobs.size() < PARALLEL_THRESHOLD)
+	{
+		for (Job* job : jobs)
+		{
+			job->generateTesselation();
+		}
+
+		return;
+	}
+
+	std::atomic<std::size_t> nextJob(0);
+
+	auto generateJobs = [&]()
+	{
+		for (std::size_t i = nextJob.fetch_add(JOBS_PER_CHUNK); i < jobs.size();
+			 i = nextJob.fetch_add(JOBS_PER_CHUNK))
+		{
+			std::size_t end = std::min(i + JOBS_PER_CHUNK, jobs.size());
+
+			for (std::size_t j = i; j < end; ++j)
+			{
+				jobs[j]->generateTesselation();
+			}
+		}
+	};
+
+	numThreads = std::min(numThreads, jobs.size() / JOBS_PER_CHUNK);
+
+	std::vector<std::future<void>> threads;
+
+	for (std::size_t i = 1; i < numThreads; ++i)
+	{
+		threads.push_back(std::async(std::launch::async, generateJobs));
+	}
+
+	generateJobs();
+
+	for (std::future<void>& thread : threads)
+	{
+		thread.get();
+	}
+}
+
+} // namespace patch
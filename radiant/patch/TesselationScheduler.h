@@ -0,0 +1,64 @@
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+
+namespace patch
+{
+
+/**
+ * Collects the patches which need their mesh tesselated and generates all
+ * of them at once, distributed over the available cores. Each patch mesh
+ * can be generated independently of all others, which pays off after
+ * loading a map or transforming lots of patches at once.
+ *
+ * Patches schedule themselves when their control points change. The first
+ * patch which actually needs its mesh (for rendering or selection tests)
+ * calls flush(), which tesselates all scheduled patches.
+ */
+class TesselationScheduler
+{
+public:
+	// A patch as seen by the scheduler
+	class Job
+	{
+	public:
+		virtual ~Job() {}
+
+		// Generates the mesh. This is called from worker threads,
+		// so it must not touch anything except the job's own data.
+		virtual void generateTesselation() = 0;
+	};
+
+private:
+	// The scheduled jobs in scheduling order, might contain cancelled ones
+	std::vector<Job*> _queue;
+
+	// The jobs which are actually scheduled
+	std::unordered_set<Job*> _scheduled;
+
+	std::size_t _numThreads;
+
+public:
+	TesselationScheduler();
+
+	static TesselationScheduler& Instance();
+
+	// Schedules the given job, does nothing if it is scheduled already
+	void schedule(Job& job);
+
+	// Removes the job from the schedule, this must be called by destructing jobs
+	void cancel(Job& job);
+
+	// Generates the meshes of all scheduled jobs
+	void flush();
+
+	// Number of currently scheduled jobs
+	std::size_t size() const;
+
+	// The number of threads used for flushing, including the calling one.
+	// Defaults to 0, which uses the hardware concurrency.
+	void setNumThreads(std::size_t numThreads);
+};
+
+} // namespace patch
@@ -0,0 +1,342 @@
+#include "FrameProfiler.h"
+
+#include "string/convert.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <fmt/format.h>
+
+namespace render
+{
+
+namespace
+{
+    const std::size_t NO_PARENT = std::numeric_limits<std::size_t>::max();
+
+    // Number of frames kept for the min/avg/max calculation
+    const std::size_t HISTORY_SIZE = 120;
+
+    // Number of frames kept for the trace export
+    const std::size_t TRACE_FRAMES = 60;
+
+    // Only the first events of a frame end up in the trace. Scopes entered
+    // per object are not traced at all, see beginScope().
+    const std::size_t MAX_TRACE_EVENTS_PER_FRAME = 10000;
+
+    inline double toMsec(FrameProfiler::Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    inline double toUsec(FrameProfiler::Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    // The scope names are string literals, escape them anyway
+    std::string escapeJson(const char* str)
+    {
+        std::string result;
+
+        for (const char* c = str; *c != '\0'; ++c)
+        {
+            if (*c == '"' || *c == '\\') result += '\\';
+            result += *c;
+        }
+
+        return result;
+    }
+}
+
+FrameProfiler::FrameProfiler() :
+    _nextTraceFrame(0),
+    _epoch(Clock::now()),
+    _countPrims(0),
+    _countBatchedPrims(0),
+    _countDrawCalls(0),
+    _countStates(0),
+    _countTransforms(0)
+{}
+
+FrameProfiler& FrameProfiler::Instance()
+{
+    static FrameProfiler _instance;
+    return _instance;
+}
+
+void FrameProfiler::beginFrame(const char* name)
+{
+    // A view drawn while another one is drawing is treated as a scope of it
+    if (!_openScopes.empty())
+    {
+        beginScope(name);
+        return;
+    }
+
+    _countPrims = 0;
+    _countBatchedPrims = 0;
+    _countDrawCalls = 0;
+    _countStates = 0;
+    _countTransforms = 0;
+
+    _currentFrame.clear();
+
+    OpenScope scope = { findOrInsertNode(name, NO_PARENT), Clock::now(), true };
+    _openScopes.push_back(scope);
+}
+
+void FrameProfiler::endFrame()
+{
+    if (_openScopes.size() > 1)
+    {
+        endScope();
+        return;
+    }
+
+    if (_openScopes.empty()) return;
+
+    Clock::time_point end = Clock::now();
+    std::size_t root = _openScopes.back().node;
+
+    Node& rootNode = _nodes[root];
+    rootNode.frameTime += end - _openScopes.back().start;
+    ++rootNode.frameCalls;
+
+    TraceEvent event = { root, _openScopes.back().start, end };
+    _currentFrame.push_back(event);
+
+    _openScopes.clear();
+
+    // Every scope of this view gets a sample, zero if it hasn't been entered
+    for (Node& node : _nodes)
+    {
+        if (node.root != root) continue;
+
+        node.history[node.nextSample] = node.frameTime;
+        node.nextSample = (node.nextSample + 1) % HISTORY_SIZE;
+        node.numSamples = std::min(node.numSamples + 1, HISTORY_SIZE);
+
+        node.lastCalls = node.frameCalls;
+        node.frameTime = Clock::duration::zero();
+        node.frameCalls = 0;
+    }
+
+    // Move the events to the trace ring buffer, recycling the oldest frame
+    if (_traceFrames.size() < TRACE_FRAMES)
+    {
+        _traceFrames.push_back(TraceFrame());
+    }
+
+    _traceFrames[_nextTraceFrame].swap(_currentFrame);
+    _nextTraceFrame = (_nextTraceFrame + 1) % TRACE_FRAMES;
+}
+
+void FrameProfiler::beginScope(const char* name, bool traced)
+{
+    if (_openScopes.empty()) return;
+
+    OpenScope scope = { findOrInsertNode(name, _openScopes.back().node), Clock::now(), traced };
+    _openScopes.push_back(scope);
+}
+
+void FrameProfiler::endScope()
+{
+    // The frame itself is closed by endFrame(), anything else is a scope
+    // which has been opened outside of a frame
+    if (_openScopes.size() <= 1) return;
+
+    Clock::time_point end = Clock::now();
+    const OpenScope& scope = _openScopes.back();
+
+    Node& node = _nodes[scope.node];
+    node.frameTime += end - scope.start;
+    ++node.frameCalls;
+
+    if (scope.traced && _currentFrame.size() < MAX_TRACE_EVENTS_PER_FRAME)
+    {
+        TraceEvent event = { scope.node, scope.start, end };
+        _currentFrame.push_back(event);
+    }
+
+    _openScopes.pop_back();
+}
+
+std::size_t FrameProfiler::getDrawCalls() const
+{
+    return _countDrawCalls;
+}
+
+std::size_t FrameProfiler::getPrimitives() const
+{
+    return _countPrims + _countBatchedPrims;
+}
+
+std::string FrameProfiler::getCounterString() const
+{
+    return "prims: " + string::to_string(_countPrims + _countBatchedPrims) +
+           " (batched: " + string::to_string(_countBatchedPrims) + ")" +
+           " | draws: " + string::to_string(_countDrawCalls) +
+           " | states: " + string::to_string(_countStates) +
+           " | transforms: " + string::to_string(_countTransforms);
+}
+
+double FrameProfiler::getLastFrameTime(const char* frameName) const
+{
+    std::size_t root = findRootNode(frameName);
+
+    if (root == NO_PARENT || _nodes[root].numSamples == 0) return 0;
+
+    const Node& node = _nodes[root];
+    return toMsec(node.history[(node.nextSample + HISTORY_SIZE - 1) % HISTORY_SIZE]);
+}
+
+std::vector<FrameProfiler::ScopeStats> FrameProfiler::getScopeStats(const char* frameName) const
+{
+    std::vector<ScopeStats> stats;
+
+    std::size_t root = findRootNode(frameName);
+
+    if (root != NO_PARENT)
+    {
+        collectScopeStats(root, stats);
+    }
+
+    return stats;
+}
+
+void FrameProfiler::collectScopeStats(std::size_t index, std::vector<ScopeStats>& stats) const
+{
+    const Node& node = _nodes[index];
+
+    if (node.numSamples == 0) return;
+
+    ScopeStats scope;
+    scope.name = node.name;
+    scope.depth = node.depth;
+    scope.calls = node.lastCalls;
+
+    std::size_t lastSample = (node.nextSample + HISTORY_SIZE - 1) % HISTORY_SIZE;
+    scope.last = toMsec(node.history[lastSample]);
+
+    Clock::duration min = Clock::duration::max();
+    Clock::duration max = Clock::duration::zero();
+    Clock::duration sum = Clock::duration::zero();
+
+    for (std::size_t i = 0; i < node.numSamples; ++i)
+    {
+        min = std::min(min, node.history[i]);
+        max = std::max(max, node.history[i]);
+        sum += node.history[i];
+    }
+
+    scope.min = toMsec(min);
+    scope.max = toMsec(max);
+    scope.avg = toMsec(sum) / node.numSamples;
+
+    stats.push_back(scope);
+
+    // Children are always stored after their parent
+    for (std::size_t i = index + 1; i < _nodes.size(); ++i)
+    {
+        if (_nodes[i].parent == index)
+        {
+            collectScopeStats(i, stats);
+        }
+    }
+}
+
+std::vector<std::string> FrameProfiler::getOverlayLines(const char* frameName) const
+{
+    std::vector<std::string> lines;
+
+    for (const ScopeStats& scope : getScopeStats(frameName))
+    {
+        std::string name = std::string(scope.depth * 2, ' ') + scope.name;
+
+        if (scope.calls > 1)
+        {
+            name += fmt::format(" ({0}x)", scope.calls);
+        }
+
+        lines.push_back(fmt::format("{0:<32} {1:7.2f} | avg {2:7.2f} | min {3:7.2f} | max {4:7.2f} msec",
+                                    name, scope.last, scope.avg, scope.min, scope.max));
+    }
+
+    return lines;
+}
+
+void FrameProfiler::exportChromeTrace(std::ostream& stream) const
+{
+    stream << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+    bool first = true;
+
+    // Oldest frame first
+    std::size_t numFrames = _traceFrames.size();
+    std::size_t firstFrame = numFrames < TRACE_FRAMES ? 0 : _nextTraceFrame;
+
+    for (std::size_t f = 0; f < numFrames; ++f)
+    {
+        for (const TraceEvent& event : _traceFrames[(firstFrame + f) % numFrames])
+        {
+            const Node& node = _nodes[event.node];
+
+            stream << (first ? "\n" : ",\n");
+            first = false;
+
+            stream << fmt::format("{{\"name\": \"{0}\", \"cat\": \"{1}\", \"ph\": \"X\", "
+                                  "\"ts\": {2:.3f}, \"dur\": {3:.3f}, \"pid\": 1, \"tid\": 1}}",
+                                  escapeJson(node.name), node.parent == NO_PARENT ? "frame" : "scope",
+                                  toUsec(event.start - _epoch), toUsec(event.end - event.start));
+        }
+    }
+
+    stream << "\n]}" << std::endl;
+}
+
+std::size_t FrameProfiler::findRootNode(const char* frameName) const
+{
+    for (std::size_t i = 0; i < _nodes.size(); ++i)
+    {
+        if (_nodes[i].parent == NO_PARENT && std::strcmp(_nodes[i].name, frameName) == 0)
+        {
+            return i;
+        }
+    }
+
+    return NO_PARENT;
+}
+
+std::size_t FrameProfiler::findOrInsertNode(const char* name, std::size_t parent)
+{
+    for (std::size_t i = 0; i < _nodes.size(); ++i)
+    {
+        const Node& node = _nodes[i];
+
+        if (node.parent == parent &&
+            (node.name == name || std::strcmp(node.name, name) == 0))
+        {
+            return i;
+        }
+    }
+
+    Node node;
+    node.name = name;
+    node.parent = parent;
+    node.depth = parent == NO_PARENT ? 0 : _nodes[parent].depth + 1;
+    node.root = parent == NO_PARENT ? _nodes.size() : _nodes[parent].root;
+    node.frameTime = Clock::duration::zero();
+    node.frameCalls = 0;
+    node.lastCalls = 0;
+    node.history.resize(HISTORY_SIZE, Clock::duration::zero());
+    node.numSamples = 0;
+    node.nextSample = 0;
+
+    _nodes.push_back(node);
+
+    return _nodes.size() - 1;
+}
+
+} // namespace render
@@ -0,0 +1,219 @@
+#pragma once
+
+#include "registry/CachedKey.h"
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace render
+{
+
+// Shows the frame profile in the camera and ortho views
+const char* const RKEY_SHOW_FRAME_PROFILE = "user/ui/showFrameProfile";
+
+/**
+ * \brief
+ * Hierarchical per-frame profiler for the render views.
+ *
+ * A view opens a frame (see ScopedFrameProfile), the stages of the frame
+ * are measured using nested ScopedProfile objects. Scopes with the same name
+ * and parent are merged, their times are summed up per frame. For each scope
+ * a rolling history of the last frames is kept, from which the min/avg/max
+ * values shown in the overlay are calculated. The individual scope timings
+ * of the most recent frames can be exported in the Chrome trace event format
+ * (chrome://tracing or Perfetto) for offline analysis.
+ *
+ * The profiler also holds the primitive, state and transform counters of the
+ * OpenGL backend, which are reset at the beginning of each frame.
+ *
+ * Times are taken on the CPU, the "Submit" stages therefore measure the
+ * time to sort the renderables into the shader passes ("State sorting") and
+ * to issue the GL commands, not the time the GPU takes to execute them.
+ * Like the rendering itself, the profiler is not thread-safe. Scopes opened
+ * outside of a frame are ignored.
+ */
+class FrameProfiler
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct ScopeStats
+    {
+        std::string name;
+        std::size_t depth;  // 0 == frame
+        std::size_t calls;  // in the last frame
+
+        // Milliseconds
+        double last;
+        double min;
+        double avg;
+        double max;
+    };
+
+private:
+    struct Node
+    {
+        const char* name;
+        std::size_t parent;
+        std::size_t root;   // the frame this scope belongs to
+        std::size_t depth;
+
+        // Accumulated during the current frame
+        Clock::duration frameTime;
+        std::size_t frameCalls;
+        std::size_t lastCalls;
+
+        // Ring buffer of the frame times
+        std::vector<Clock::duration> history;
+        std::size_t numSamples;
+        std::size_t nextSample;
+    };
+
+    // All scopes ever seen, children are added after their parents
+    std::vector<Node> _nodes;
+
+    struct TraceEvent
+    {
+        std::size_t node;
+        Clock::time_point start;
+        Clock::time_point end;
+    };
+    typedef std::vector<TraceEvent> TraceFrame;
+
+    // The events of the current frame and the finished frames
+    TraceFrame _currentFrame;
+    std::vector<TraceFrame> _traceFrames;
+    std::size_t _nextTraceFrame;
+
+    struct OpenScope
+    {
+        std::size_t node;
+        Clock::time_point start;
+        bool traced;
+    };
+
+    // The frame and the scopes currently open within it
+    std::vector<OpenScope> _openScopes;
+
+    Clock::time_point _epoch;
+
+    std::size_t _countPrims;
+    std::size_t _countBatchedPrims;
+    std::size_t _countDrawCalls;
+    std::size_t _countStates;
+    std::size_t _countTransforms;
+
+public:
+    FrameProfiler();
+
+    static FrameProfiler& Instance();
+
+    // Returns true if the views should draw the profile overlay
+    static bool overlayEnabled()
+    {
+        static registry::CachedKey<bool> showFrameProfile(RKEY_SHOW_FRAME_PROFILE);
+        return showFrameProfile.get();
+    }
+
+    // Begins a new frame of the given view. The name must be a string literal.
+    void beginFrame(const char* name);
+    void endFrame();
+
+    // Opens a named scope within the current frame or scope. Scopes entered
+    // many times per frame (e.g. once per object) should not be traced,
+    // their time is summed up in the statistics only.
+    void beginScope(const char* name, bool traced = true);
+    void endScope();
+
+    // Counters of the OpenGL backend
+
+    // A single renderable has been drawn on its own
+    void addPrimitive()
+    {
+        ++_countPrims;
+        ++_countDrawCalls;
+    }
+
+    // A geometry batch containing the given number of renderables has been drawn
+    void addBatch(std::size_t numPrims)
+    {
+        _countBatchedPrims += numPrims;
+        ++_countDrawCalls;
+    }
+
+    void addState()
+    {
+        ++_countStates;
+    }
+
+    void addTransform()
+    {
+        ++_countTransforms;
+    }
+
+    std::size_t getDrawCalls() const;
+    std::size_t getPrimitives() const;
+
+    // Returns the counters as one line of text
+    std::string getCounterString() const;
+
+    // Returns the duration of the last completed frame of the given view in msec
+    double getLastFrameTime(const char* frameName) const;
+
+    // Returns the statistics of the given frame and its scopes, depth first
+    std::vector<ScopeStats> getScopeStats(const char* frameName) const;
+
+    // Returns the lines of the overlay of the given frame
+    std::vector<std::string> getOverlayLines(const char* frameName) const;
+
+    /**
+     * \brief
+     * Write the scope timings of the most recent frames to the given stream
+     * as JSON in the Chrome trace event format.
+     */
+    void exportChromeTrace(std::ostream& stream) const;
+
+private:
+    std::size_t findRootNode(const char* frameName) const;
+    std::size_t findOrInsertNode(const char* name, std::size_t parent);
+    void collectScopeStats(std::size_t node, std::vector<ScopeStats>& stats) const;
+};
+
+/**
+ * Measures the lifetime of this object as frame of the given view.
+ */
+class ScopedFrameProfile
+{
+public:
+    ScopedFrameProfile(const char* name)
+    {
+        FrameProfiler::Instance().beginFrame(name);
+    }
+
+    ~ScopedFrameProfile()
+    {
+        FrameProfiler::Instance().endFrame();
+    }
+};
+
+/**
+ * Measures the lifetime of this object as named scope within the current
+ * frame profile.
+ */
+class ScopedProfile
+{
+public:
+    ScopedProfile(const char* name, bool traced = true)
+    {
+        FrameProfiler::Instance().beginScope(name, traced);
+    }
+
+    ~ScopedProfile()
+    {
+        FrameProfiler::Instance().endScope();
+    }
+};
+
+} // namespace render
@@ -0,0 +1,141 @@
+#include "LightInteractionIndex.h"
+
+#include "FrameProfiler.h"
+
+#include <algorithm>
+
+namespace render
+{
+
+ObjectLightList::ObjectLightList(LitObject& object, LightInteractionIndex& index) :
+    _litObject(object),
+    _index(index),
+    _dirty(true)
+{}
+
+void ObjectLightList::calculateIntersectingLights() const
+{
+    // Get the index to tell us whether anything actually needs updating
+    _index.update();
+
+    if (_dirty)
+    {
+        // This runs for every dirty object, keep it out of the trace
+        ScopedProfile profile("Light intersection", false);
+
+        _dirty = false;
+
+        _activeLights.clear();
+        _litObject.clearLights();
+
+        std::vector<RendererLight*> candidates;
+        _index.findLights(*this, _litObject.getLitObjectBounds(), candidates);
+
+        // Determine which of the nearby lights intersect the object
+        for (RendererLight* light : candidates)
+        {
+            if (_litObject.intersectsLight(*light))
+            {
+                _activeLights.push_back(light);
+                _litObject.insertLight(*light);
+            }
+        }
+    }
+}
+
+void ObjectLightList::forEachLight(const RendererLightCallback& callback) const
+{
+    calculateIntersectingLights();
+
+    for (RendererLight* light : _activeLights)
+    {
+        callback(*light);
+    }
+}
+
+void ObjectLightList::setDirty()
+{
+    _dirty = true;
+}
+
+void LightInteractionIndex::attachLight(RendererLight& light)
+{
+    // The light is added to the grid by the next update()
+    _changedLights.insert(&light);
+}
+
+void LightInteractionIndex::detachLight(RendererLight& light)
+{
+    _changedLights.erase(&light);
+
+    if (_lights.contains(&light))
+    {
+        setObjectsDirty(_lights.getBounds(&light));
+        _lights.erase(&light);
+    }
+}
+
+void LightInteractionIndex::lightChanged(RendererLight& light)
+{
+    // Lights are reported changed before they are attached, ignore these
+    if (_lights.contains(&light))
+    {
+        _changedLights.insert(&light);
+    }
+}
+
+void LightInteractionIndex::detachLightList(const ObjectLightList& lightList)
+{
+    _objects.erase(&lightList);
+}
+
+void LightInteractionIndex::update()
+{
+    if (_changedLights.empty()) return;
+
+    for (RendererLight* light : _changedLights)
+    {
+        AABB bounds = light->lightAABB();
+
+        // The objects lit by the old volume and the ones lit by the new one
+        if (_lights.contains(light))
+        {
+            setObjectsDirty(_lights.getBounds(light));
+        }
+
+        setObjectsDirty(bounds);
+
+        _lights.insert(light, bounds);
+    }
+
+    _changedLights.clear();
+}
+
+std::size_t LightInteractionIndex::getNumLights() const
+{
+    return _lights.size();
+}
+
+void LightInteractionIndex::findLights(const ObjectLightList& lightList, const AABB& bounds,
+                                       std::vector<RendererLight*>& lights)
+{
+    _objects.insert(&lightList, bounds);
+
+    _lights.forEachIntersecting(bounds, [&](RendererLight* light)
+    {
+        lights.push_back(light);
+    });
+
+    // Keep the order independent of the grid layout
+    std::sort(lights.begin(), lights.end());
+}
+
+void LightInteractionIndex::setObjectsDirty(const AABB& bounds)
+{
+    _objects.forEachIntersecting(bounds, [](const ObjectLightList* lightList)
+    {
+        lightList->_dirty = true;
+    });
+}
+
+} // namespace render
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "irender.h"
+#include "SpatialGrid.h"
+
+#include <set>
+#include <vector>
+
+namespace render
+{
+
+class LightInteractionIndex;
+
+/**
+ * \brief
+ * Main renderer implementation of LightList interface.
+ *
+ * The ObjectLightList is reponsible for associating a single lit object with
+ * all of the lights which currently light it. Only the lights found near the
+ * object by the LightInteractionIndex are tested for intersection.
+ */
+class ObjectLightList :
+	public LightList
+{
+private:
+    // Target object
+	LitObject& _litObject;
+
+    // The index knowing about all lights and lit objects
+	LightInteractionIndex& _index;
+
+    // List of lights which are intersecting our lit object
+	typedef std::vector<RendererLight*> Lights;
+	mutable Lights _activeLights;
+
+    // Dirty flag indicating recalculation needed
+	mutable bool _dirty;
+
+    // The index marks the light lists near a changed light as dirty
+    friend class LightInteractionIndex;
+
+public:
+    ObjectLightList(LitObject& object, LightInteractionIndex& index);
+
+    // LightList implementation
+	void calculateIntersectingLights() const override;
+	void forEachLight(const RendererLightCallback& callback) const override;
+	void setDirty() override;
+};
+
+/**
+ * \brief
+ * Spatial index of the lights and lit objects known to the render system.
+ *
+ * Lights are stored in a grid by the volume they had when the interactions
+ * were last updated, lit objects by the bounds they had when their light list
+ * was last calculated. When a light changes, only the light lists of the
+ * objects near its old and new volume are marked dirty, and a dirty light list
+ * only tests the lights near its object.
+ *
+ * Light changes are collected and processed in one go by update(), which the
+ * light lists invoke before calculating their interactions. Moving a light
+ * several times between two frames therefore costs a single update.
+ */
+class LightInteractionIndex
+{
+private:
+    // All attached lights, by their volume at the last update
+    SpatialGrid<RendererLight> _lights;
+
+    // Light lists, by the object bounds at their last calculation
+    SpatialGrid<const ObjectLightList> _objects;
+
+    // Lights which have been attached or changed since the last update
+    std::set<RendererLight*> _changedLights;
+
+public:
+    void attachLight(RendererLight& light);
+    void detachLight(RendererLight& light);
+    void lightChanged(RendererLight& light);
+
+    // Removes the given light list from the index
+    void detachLightList(const ObjectLightList& lightList);
+
+    // Processes the pending light changes
+    void update();
+
+    std::size_t getNumLights() const;
+
+    /**
+     * \brief
+     * Store the bounds of the given light list's object and return the
+     * lights whose volume intersects them, sorted by address.
+     */
+    void findLights(const ObjectLightList& lightList, const AABB& bounds,
+                    std::vector<RendererLight*>& lights);
+
+private:
+    void setObjectsDirty(const AABB& bounds);
+};
+
+} // namespace render
@@ -6,34 +6,13 @@
 #include "math/Matrix4.h"
 #include "modulesystem/StaticModule.h"
 #include "backend/GLProgramFactory.h"
+#include "FrameProfiler.h"
 #include "debugging/debugging.h"
 
 #include <functional>
 
 namespace render {
 
-namespace {
-	// Polygon stipple pattern
-	const GLubyte POLYGON_STIPPLE_PATTERN[132] = {
-	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
-	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
- 	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
-	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
-	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
-	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
- 	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
-	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
-	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
-	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
- 	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
-	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
-	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
-	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
- 	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
-	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55
-	};
-}
-
 /**
  * Main constructor.
  */
@@ -42,7 +21,7 @@ OpenGLRenderSystem::OpenGLRenderSystem() :
     _glProgramFactory(std::make_shared<GLProgramFactory>()),
 	_currentShaderProgram(SHADER_PROGRAM_NONE),
 	_time(0),
-	m_lightsChanged(true),
+	_backend(nullptr),
 	m_traverseRenderablesMutex(false)
 {
 	// For the static default rendersystem, the MaterialManager is not existent yet,
@@ -120,104 +99,17 @@ void OpenGLRenderSystem::render(RenderStateFlags globalstate,
                                const Matrix4& projection,
                                const Vector3& viewer)
 {
-	glPushAttrib(GL_ALL_ATTRIB_BITS);
-
-	// Set the projection and modelview matrices
-	glMatrixMode(GL_PROJECTION);
-	glLoadMatrixd(projection);
-
-	glMatrixMode(GL_MODELVIEW);
-	glLoadMatrixd(modelview);
-
-	// global settings that are not set in renderstates
-    glFrontFace(GL_CW);
-    glCullFace(GL_BACK);
-    glPolygonOffset(-1, 1);
-
-	// Set polygon stipple pattern from constant
-	glPolygonStipple(POLYGON_STIPPLE_PATTERN);
-
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
-
-    if (GLEW_VERSION_1_3) {
-		glActiveTexture(GL_TEXTURE0);
-		glClientActiveTexture(GL_TEXTURE0);
-    }
-
-    if (GLEW_ARB_shader_objects) {
-		glUseProgramObjectARB(0);
-		glDisableVertexAttribArrayARB(c_attr_TexCoord0);
-		glDisableVertexAttribArrayARB(c_attr_Tangent);
-		glDisableVertexAttribArrayARB(c_attr_Binormal);
-    }
-
-    if (globalstate & RENDER_TEXTURE_2D) {
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    }
+	RenderBackend& backend = _backend != nullptr ? *_backend : _glBackend;
 
 	// Construct default OpenGL state
 	OpenGLState current;
 
-    // Set up initial GL state. This MUST MATCH the defaults in the OpenGLState
-    // object, otherwise required state changes may not occur.
-    glLineStipple(current.m_linestipple_factor,
-    			  current.m_linestipple_pattern);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    glDisable(GL_LIGHTING);
-    glDisable(GL_TEXTURE_2D);
-    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-    glDisableClientState(GL_COLOR_ARRAY);
-    glDisableClientState(GL_NORMAL_ARRAY);
-    glDisable(GL_BLEND);
-    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_CULL_FACE);
-    glShadeModel(GL_FLAT);
-    glDisable(GL_DEPTH_TEST);
-
-    // RENDER_DEPTHWRITE defaults to 0
-    glDepthMask(GL_FALSE);
-
-    // RENDER_MASKCOLOUR defaults to 0
-    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-
-    glDisable(GL_ALPHA_TEST);
-
-    glDisable(GL_LINE_STIPPLE);
-    glDisable(GL_POLYGON_STIPPLE);
-    glDisable(GL_POLYGON_OFFSET_LINE);
-	glDisable(GL_POLYGON_OFFSET_FILL); // greebo: otherwise tiny gap lines between brushes are visible
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glColor4f(1,1,1,1);
-    glDepthFunc(current.getDepthFunc());
-    glAlphaFunc(GL_ALWAYS, 0);
-    glLineWidth(1);
-    glPointSize(1);
-
-	glHint(GL_FOG_HINT, GL_NICEST);
-    glDisable(GL_FOG);
-
-#if 0
-	std::size_t count = 0 ;
-
-	for (OpenGLStates::iterator i = _state_sorted.begin();
-		i != _state_sorted.end();
-		++i)
 	{
-		// Render the OpenGLShaderPass
-		if (!i->second->empty())
-		{
-			count++;
-		}
+		ScopedProfile profile("Frame setup");
+		backend.beginFrame(current, globalstate, modelview, projection);
 	}
 
-	rMessage() << "R1 " << count << " of " << _state_sorted.size() << "\n";
-
-	std::size_t curObject = 0;
-#endif
+	ScopedProfile profile("Shader passes");
 
     // Iterate over the sorted mapping between OpenGLStates and their
     // OpenGLShaderPasses (containing the renderable geometry), and render the
@@ -230,16 +122,16 @@ void OpenGLRenderSystem::render(RenderStateFlags globalstate,
 		// Render the OpenGLShaderPass
         if (!i->second->empty())
         {
-#if 0
-			rMessage() << curObject << " " << (*i->second);
-			curObject++;
-#endif
-
-            i->second->render(current, globalstate, viewer, _time);
+            i->second->render(backend, current, globalstate, viewer, _time);
         }
 	}
 
-	glPopAttrib();
+	backend.endFrame();
+}
+
+void OpenGLRenderSystem::setBackend(RenderBackend* backend)
+{
+	_backend = backend;
 }
 
 void OpenGLRenderSystem::realise()
@@ -415,23 +307,19 @@ sigc::signal<void> OpenGLRenderSystem::signal_extensionsInitialised()
 LightList& OpenGLRenderSystem::attachLitObject(LitObject& object)
 {
 	return m_lightLists.insert(
-		LightLists::value_type(
-			&object,
-			LinearLightList(
-                object,
-                m_lights,
-                std::bind(
-                    &OpenGLRenderSystem::propagateLightChangedFlagToAllLights,
-                    this
-                )
-            )
-        )
+		LightLists::value_type(&object, ObjectLightList(object, _lightIndex))
     ).first->second;
 }
 
 void OpenGLRenderSystem::detachLitObject(LitObject& object) 
 {
-	m_lightLists.erase(&object);
+	LightLists::iterator i = m_lightLists.find(&object);
+
+	if (i != m_lightLists.end())
+	{
+		_lightIndex.detachLightList(i->second);
+		m_lightLists.erase(i);
+	}
 }
 
 void OpenGLRenderSystem::litObjectChanged(LitObject& object) 
@@ -444,35 +332,17 @@ void OpenGLRenderSystem::litObjectChanged(LitObject& object)
 
 void OpenGLRenderSystem::attachLight(RendererLight& light)
 {
-    ASSERT_MESSAGE(m_lights.find(&light) == m_lights.end(), "light could not be attached");
-    m_lights.insert(&light);
-    lightChanged(light);
+    _lightIndex.attachLight(light);
 }
 
 void OpenGLRenderSystem::detachLight(RendererLight& light)
 {
-    ASSERT_MESSAGE(m_lights.find(&light) != m_lights.end(), "light could not be detached");
-    m_lights.erase(&light);
-    lightChanged(light);
+    _lightIndex.detachLight(light);
 }
 
 void OpenGLRenderSystem::lightChanged(RendererLight& light)
 {
-    m_lightsChanged = true;
-}
-
-void OpenGLRenderSystem::propagateLightChangedFlagToAllLights()
-{
-    if (m_lightsChanged)
-    {
-    	m_lightsChanged = false;
-    	for (LightLists::iterator i = m_lightLists.begin();
-             i != m_lightLists.end();
-             ++i) 
-        {
-    		i->second.setDirty();
-    	}
-	}
+    _lightIndex.lightChanged(light);
 }
 
 void OpenGLRenderSystem::insertSortedState(const OpenGLStates::value_type& val) {
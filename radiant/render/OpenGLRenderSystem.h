@@ -6,7 +6,8 @@
 #include "imodule.h"
 #include "backend/OpenGLStateManager.h"
 #include "backend/OpenGLShader.h"
-#include "LinearLightList.h"
+#include "backend/GLRenderBackend.h"
+#include "LightInteractionIndex.h"
 #include "render/backend/OpenGLStateLess.h"
 
 namespace render
@@ -43,10 +44,15 @@ private:
 	// Render time
 	std::size_t _time;
 
+	// The backend submitting the render commands to OpenGL
+	GLRenderBackend _glBackend;
+
+	// Optional replacement for the GL backend, not owned
+	RenderBackend* _backend;
+
 	// Lights
-	RendererLights m_lights;
-	bool m_lightsChanged;
-	typedef std::map<LitObject*, LinearLightList> LightLists;
+	LightInteractionIndex _lightIndex;
+	typedef std::map<LitObject*, ObjectLightList> LightLists;
 	LightLists m_lightLists;
 
 	sigc::signal<void> _sigExtensionsInitialised;
@@ -54,9 +60,6 @@ private:
 	sigc::connection _materialDefsLoaded;
 	sigc::connection _materialDefsUnloaded;
 
-private:
-	void propagateLightChangedFlagToAllLights();
-
 public:
 
 	/**
@@ -78,6 +81,12 @@ public:
 
     GLProgramFactory& getGLProgramFactory();
 
+	/**
+	 * Let the given backend receive the render commands instead of
+	 * OpenGL, e.g. to record them. Pass nullptr to revert to OpenGL.
+	 */
+	void setBackend(RenderBackend* backend);
+
 	std::size_t getTime() const override;
 	void setTime(std::size_t milliSeconds) override;
 
@@ -0,0 +1,320 @@
+#pragma once
+
+#include "math/AABB.h"
+
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace render
+{
+
+/**
+ * \brief
+ * Sparse uniform grid mapping elements to the cells covered by their bounds.
+ *
+ * Only cells containing at least one element are allocated. Elements whose
+ * bounds cover too many cells are kept in a separate list, which every query
+ * tests against its bounds. Queries visit each element at most once and only
+ * if its bounds intersect the query bounds, elements with invalid bounds are
+ * visited by every query.
+ *
+ * Elements are identified by their address, the grid doesn't own them.
+ */
+template<typename Element>
+class SpatialGrid
+{
+private:
+    struct CellKey
+    {
+        long x;
+        long y;
+        long z;
+
+        bool operator==(const CellKey& other) const
+        {
+            return x == other.x && y == other.y && z == other.z;
+        }
+    };
+
+    struct CellKeyHash
+    {
+        std::size_t operator()(const CellKey& key) const
+        {
+            return static_cast<std::size_t>(key.x) * 73856093u ^
+                   static_cast<std::size_t>(key.y) * 19349663u ^
+                   static_cast<std::size_t>(key.z) * 83492791u;
+        }
+    };
+
+    struct Record
+    {
+        Element* element;
+        AABB bounds;
+
+        // The range of cells this element is linked to
+        CellKey min;
+        CellKey max;
+        bool oversized;
+
+        // The query which visited this element last
+        std::size_t visited;
+    };
+
+    typedef std::vector<Record*> Cell;
+
+    // Records are never moved by the unordered_map, the cells point to them
+    std::unordered_map<Element*, Record> _records;
+    std::unordered_map<CellKey, Cell, CellKeyHash> _cells;
+    std::vector<Record*> _oversized;
+
+    double _cellSize;
+    std::size_t _maxCellsPerElement;
+
+    std::size_t _queryCount;
+
+public:
+    SpatialGrid(double cellSize = 256, std::size_t maxCellsPerElement = 512) :
+        _cellSize(cellSize),
+        _maxCellsPerElement(maxCellsPerElement),
+        _queryCount(0)
+    {}
+
+    std::size_t size() const
+    {
+        return _records.size();
+    }
+
+    bool contains(Element* element) const
+    {
+        return _records.find(element) != _records.end();
+    }
+
+    // Returns the bounds the given element has been inserted with
+    const AABB& getBounds(Element* element) const
+    {
+        return _records.find(element)->second.bounds;
+    }
+
+    // Inserts the element or moves it to the given bounds
+    void insert(Element* element, const AABB& bounds)
+    {
+        auto found = _records.find(element);
+
+        if (found != _records.end())
+        {
+            unlink(found->second);
+        }
+        else
+        {
+            found = _records.emplace(element, Record()).first;
+        }
+
+        Record& record = found->second;
+
+        record.element = element;
+        record.bounds = bounds;
+        record.visited = _queryCount;
+
+        link(record);
+    }
+
+    void erase(Element* element)
+    {
+        auto found = _records.find(element);
+
+        if (found == _records.end()) return;
+
+        unlink(found->second);
+        _records.erase(found);
+    }
+
+    void clear()
+    {
+        _records.clear();
+        _cells.clear();
+        _oversized.clear();
+    }
+
+    /**
+     * \brief
+     * Invoke the functor for every element whose bounds intersect the given
+     * ones, and for every element with invalid bounds. Invalid query bounds
+     * visit all elements.
+     */
+    void forEachIntersecting(const AABB& bounds, const std::function<void(Element*)>& func)
+    {
+        ++_queryCount;
+
+        for (Record* record : _oversized)
+        {
+            if (!isBounded(bounds) || !isBounded(record->bounds) ||
+                intersects(record->bounds, bounds))
+            {
+                visit(*record, func);
+            }
+        }
+
+        CellKey min, max;
+
+        if (!getCellRange(bounds, min, max))
+        {
+            // Too large to walk the cells, visit every record instead
+            for (auto& pair : _records)
+            {
+                if (!isBounded(bounds) || !isBounded(pair.second.bounds) ||
+                    intersects(pair.second.bounds, bounds))
+                {
+                    visit(pair.second, func);
+                }
+            }
+
+            return;
+        }
+
+        for (long x = min.x; x <= max.x; ++x)
+        {
+            for (long y = min.y; y <= max.y; ++y)
+            {
+                for (long z = min.z; z <= max.z; ++z)
+                {
+                    auto cell = _cells.find(CellKey{ x, y, z });
+
+                    if (cell == _cells.end()) continue;
+
+                    for (Record* record : cell->second)
+                    {
+                        if (record->visited != _queryCount && intersects(record->bounds, bounds))
+                        {
+                            visit(*record, func);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    void visit(Record& record, const std::function<void(Element*)>& func)
+    {
+        if (record.visited == _queryCount) return;
+
+        record.visited = _queryCount;
+        func(record.element);
+    }
+
+    // AABB::isValid() lets NaN coordinates pass, these are invalid here
+    static bool isBounded(const AABB& bounds)
+    {
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            if (!(bounds.origin[i] >= -FLT_MAX && bounds.origin[i] <= FLT_MAX &&
+                  bounds.extents[i] >= 0 && bounds.extents[i] <= FLT_MAX))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Touching bounds count as intersecting, unlike AABB::intersects()
+    static bool intersects(const AABB& a, const AABB& b)
+    {
+        return std::fabs(a.origin[0] - b.origin[0]) <= (a.extents[0] + b.extents[0]) &&
+               std::fabs(a.origin[1] - b.origin[1]) <= (a.extents[1] + b.extents[1]) &&
+               std::fabs(a.origin[2] - b.origin[2]) <= (a.extents[2] + b.extents[2]);
+    }
+
+    // Returns false if the bounds are invalid or cover too many cells
+    bool getCellRange(const AABB& bounds, CellKey& min, CellKey& max) const
+    {
+        if (!isBounded(bounds)) return false;
+
+        double cellMin[3];
+        double cellMax[3];
+        double numCells = 1;
+
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            cellMin[i] = std::floor((bounds.origin[i] - bounds.extents[i]) / _cellSize);
+            cellMax[i] = std::floor((bounds.origin[i] + bounds.extents[i]) / _cellSize);
+            numCells *= cellMax[i] - cellMin[i] + 1;
+        }
+
+        // This also catches infinite and NaN coordinates
+        if (!(numCells <= _maxCellsPerElement)) return false;
+
+        min = CellKey{ static_cast<long>(cellMin[0]), static_cast<long>(cellMin[1]), static_cast<long>(cellMin[2]) };
+        max = CellKey{ static_cast<long>(cellMax[0]), static_cast<long>(cellMax[1]), static_cast<long>(cellMax[2]) };
+
+        return true;
+    }
+
+    void link(Record& record)
+    {
+        record.oversized = !getCellRange(record.bounds, record.min, record.max);
+
+        if (record.oversized)
+        {
+            _oversized.push_back(&record);
+            return;
+        }
+
+        for (long x = record.min.x; x <= record.max.x; ++x)
+        {
+            for (long y = record.min.y; y <= record.max.y; ++y)
+            {
+                for (long z = record.min.z; z <= record.max.z; ++z)
+                {
+                    _cells[CellKey{ x, y, z }].push_back(&record);
+                }
+            }
+        }
+    }
+
+    void unlink(Record& record)
+    {
+        if (record.oversized)
+        {
+            removeFrom(_oversized, &record);
+            return;
+        }
+
+        for (long x = record.min.x; x <= record.max.x; ++x)
+        {
+            for (long y = record.min.y; y <= record.max.y; ++y)
+            {
+                for (long z = record.min.z; z <= record.max.z; ++z)
+                {
+                    auto cell = _cells.find(CellKey{ x, y, z });
+
+                    removeFrom(cell->second, &record);
+
+                    if (cell->second.empty())
+                    {
+                        _cells.erase(cell);
+                    }
+                }
+            }
+        }
+    }
+
+    // Swap-and-pop, the order within a cell doesn't matter
+    static void removeFrom(std::vector<Record*>& list, Record* record)
+    {
+        for (std::size_t i = 0; i < list.size(); ++i)
+        {
+            if (list[i] == record)
+            {
+                list[i] = list.back();
+                list.pop_back();
+                return;
+            }
+        }
+    }
+};
+
+} // namespace render
@@ -126,6 +126,11 @@ VolumeIntersectionValue View::TestAABB(const AABB& aabb, const Matrix4& localToW
 	return _frustum.testIntersection(aabb, localToWorld);
 }
 
+const Frustum* View::getCullingFrustum() const
+{
+	return &_frustum;
+}
+
 const Matrix4& View::GetViewMatrix() const
 {
 	return _viewproj;
@@ -54,6 +54,7 @@ public:
 
     VolumeIntersectionValue TestAABB(const AABB& aabb) const;
 	VolumeIntersectionValue TestAABB(const AABB& aabb, const Matrix4& localToWorld) const;
+	const Frustum* getCullingFrustum() const override;
 
 	const Matrix4& GetViewMatrix() const;
 	const Matrix4& GetViewport() const;
@@ -0,0 +1,206 @@
+#include "GLRenderBackend.h"
+
+#include "igl.h"
+#include "iglrender.h"
+#include "math/Matrix4.h"
+
+#include "OpenGLShaderPass.h"
+#include "GeometryBatch.h"
+#include "../FrameProfiler.h"
+
+namespace render
+{
+
+namespace
+{
+	// Polygon stipple pattern
+	const GLubyte POLYGON_STIPPLE_PATTERN[132] = {
+	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+ 	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+ 	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+ 	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+ 	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55,
+	      0xAA, 0xAA, 0xAA, 0xAA, 0x55, 0x55, 0x55, 0x55
+	};
+}
+
+void GLRenderBackend::beginFrame(OpenGLState& current,
+                                 RenderStateFlags globalstate,
+                                 const Matrix4& modelview,
+                                 const Matrix4& projection)
+{
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+
+	// Set the projection and modelview matrices
+	glMatrixMode(GL_PROJECTION);
+	glLoadMatrixd(projection);
+
+	glMatrixMode(GL_MODELVIEW);
+	glLoadMatrixd(modelview);
+
+	// global settings that are not set in renderstates
+    glFrontFace(GL_CW);
+    glCullFace(GL_BACK);
+    glPolygonOffset(-1, 1);
+
+	// Set polygon stipple pattern from constant
+	glPolygonStipple(POLYGON_STIPPLE_PATTERN);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+
+    if (GLEW_VERSION_1_3) {
+		glActiveTexture(GL_TEXTURE0);
+		glClientActiveTexture(GL_TEXTURE0);
+    }
+
+    if (GLEW_ARB_shader_objects) {
+		glUseProgramObjectARB(0);
+		glDisableVertexAttribArrayARB(c_attr_TexCoord0);
+		glDisableVertexAttribArrayARB(c_attr_Tangent);
+		glDisableVertexAttribArrayARB(c_attr_Binormal);
+    }
+
+    if (globalstate & RENDER_TEXTURE_2D) {
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    }
+
+    // Set up initial GL state. This MUST MATCH the defaults in the OpenGLState
+    // object, otherwise required state changes may not occur.
+    glLineStipple(current.m_linestipple_factor,
+    			  current.m_linestipple_pattern);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisable(GL_BLEND);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_CULL_FACE);
+    glShadeModel(GL_FLAT);
+    glDisable(GL_DEPTH_TEST);
+
+    // RENDER_DEPTHWRITE defaults to 0
+    glDepthMask(GL_FALSE);
+
+    // RENDER_MASKCOLOUR defaults to 0
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    glDisable(GL_ALPHA_TEST);
+
+    glDisable(GL_LINE_STIPPLE);
+    glDisable(GL_POLYGON_STIPPLE);
+    glDisable(GL_POLYGON_OFFSET_LINE);
+	glDisable(GL_POLYGON_OFFSET_FILL); // greebo: otherwise tiny gap lines between brushes are visible
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glColor4f(1,1,1,1);
+    glDepthFunc(current.getDepthFunc());
+    glAlphaFunc(GL_ALWAYS, 0);
+    glLineWidth(1);
+    glPointSize(1);
+
+	glHint(GL_FOG_HINT, GL_NICEST);
+    glDisable(GL_FOG);
+}
+
+void GLRenderBackend::endFrame()
+{
+	glPopAttrib();
+}
+
+void GLRenderBackend::beginPass(OpenGLShaderPass& pass)
+{
+    // Reset the texture matrix
+    glMatrixMode(GL_TEXTURE);
+    glLoadMatrixd(Matrix4::getIdentity());
+
+    glMatrixMode(GL_MODELVIEW);
+}
+
+void GLRenderBackend::applyState(OpenGLShaderPass& pass,
+                                 OpenGLState& current,
+                                 unsigned int requiredState,
+                                 const Vector3& viewer,
+                                 const IRenderEntity* entity)
+{
+    pass.applyState(current, requiredState, viewer);
+
+    FrameProfiler::Instance().addState();
+}
+
+void GLRenderBackend::beginRenderables()
+{
+    glPushMatrix();
+}
+
+void GLRenderBackend::endRenderables()
+{
+    glPopMatrix();
+}
+
+void GLRenderBackend::setTransform(const Matrix4& transform, const OpenGLState& current)
+{
+    glPopMatrix();
+    glPushMatrix();
+    glMultMatrixd(transform);
+
+    // Determine the face direction
+    if (current.testRenderFlag(RENDER_CULLFACE)
+        && transform.getHandedness() == Matrix4::RIGHTHANDED)
+    {
+        glFrontFace(GL_CW);
+    }
+    else
+    {
+        glFrontFace(GL_CCW);
+    }
+
+    FrameProfiler::Instance().addTransform();
+}
+
+void GLRenderBackend::setUpLight(OpenGLShaderPass& pass,
+                                 OpenGLState& current,
+                                 const RendererLight& light,
+                                 const Vector3& viewer,
+                                 const Matrix4& transform,
+                                 std::size_t time)
+{
+    pass.setUpLightingCalculation(current, &light, viewer, transform, time);
+}
+
+void GLRenderBackend::draw(const OpenGLRenderable& renderable, const RenderInfo& info)
+{
+    renderable.render(info);
+
+    FrameProfiler::Instance().addPrimitive();
+}
+
+void GLRenderBackend::drawBatch(GeometryBatch& batch,
+                                const std::vector<const BatchableRenderable*>& renderables,
+                                const RenderInfo& info)
+{
+    std::size_t numPolygons = batch.prepare(renderables);
+
+    if (numPolygons > 0)
+    {
+        batch.draw(info);
+
+        FrameProfiler::Instance().addBatch(numPolygons);
+    }
+}
+
+} // namespace
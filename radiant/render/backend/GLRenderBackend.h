@@ -0,0 +1,49 @@
+#pragma once
+
+#include "RenderBackend.h"
+
+namespace render
+{
+
+/**
+ * \brief
+ * The default RenderBackend, submitting everything to OpenGL.
+ */
+class GLRenderBackend :
+    public RenderBackend
+{
+public:
+    void beginFrame(OpenGLState& current,
+                    RenderStateFlags globalFlagsMask,
+                    const Matrix4& modelview,
+                    const Matrix4& projection) override;
+    void endFrame() override;
+
+    void beginPass(OpenGLShaderPass& pass) override;
+
+    void applyState(OpenGLShaderPass& pass,
+                    OpenGLState& current,
+                    unsigned int requiredState,
+                    const Vector3& viewer,
+                    const IRenderEntity* entity) override;
+
+    void beginRenderables() override;
+    void endRenderables() override;
+
+    void setTransform(const Matrix4& transform, const OpenGLState& current) override;
+
+    void setUpLight(OpenGLShaderPass& pass,
+                    OpenGLState& current,
+                    const RendererLight& light,
+                    const Vector3& viewer,
+                    const Matrix4& transform,
+                    std::size_t time) override;
+
+    void draw(const OpenGLRenderable& renderable, const RenderInfo& info) override;
+
+    void drawBatch(GeometryBatch& batch,
+                   const std::vector<const BatchableRenderable*>& renderables,
+                   const RenderInfo& info) override;
+};
+
+} // namespace
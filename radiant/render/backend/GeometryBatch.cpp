@@ -0,0 +1,288 @@
+#include "GeometryBatch.h"
+
+#include "igl.h"
+#include "GLProgramAttributes.h"
+#include "render/VBO.h"
+
+#include <cstddef>
+
+namespace render
+{
+
+namespace
+{
+    // Polygons not drawn within this many draws are evicted
+    const std::size_t EVICTION_INTERVAL = 512;
+
+    // Don't bother compacting small buffers
+    const std::size_t MIN_COMPACTION_SIZE = 4096;
+
+    const GLsizei STRIDE = sizeof(BatchVertex);
+
+    inline const GLvoid* attributeOffset(std::size_t offset)
+    {
+        return reinterpret_cast<const GLvoid*>(offset);
+    }
+}
+
+GeometryBatch::GeometryBatch() :
+    _unusedVertices(0),
+    _dirtyBegin(0),
+    _dirtyEnd(0),
+    _vbo(0),
+    _vboCapacity(0),
+    _drawCount(0),
+    _numPreparedVertices(0)
+{}
+
+GeometryBatch::~GeometryBatch()
+{
+    deleteVBO(_vbo);
+}
+
+bool GeometryBatch::isSupported()
+{
+    // VBOs and glMultiDrawArrays
+    return GLEW_VERSION_1_5 ? true : false;
+}
+
+std::size_t GeometryBatch::size() const
+{
+    return _slots.size();
+}
+
+std::size_t GeometryBatch::prepare(const std::vector<const BatchableRenderable*>& renderables)
+{
+    _firsts.clear();
+    _counts.clear();
+    _numPreparedVertices = 0;
+
+    if (renderables.empty()) return 0;
+
+    if (++_drawCount % EVICTION_INTERVAL == 0)
+    {
+        evictUnused();
+    }
+
+    for (const BatchableRenderable* renderable : renderables)
+    {
+        const Slot& slot = update(*renderable);
+
+        if (slot.numVertices > 0)
+        {
+            _firsts.push_back(static_cast<GLint>(slot.firstVertex));
+            _counts.push_back(static_cast<GLsizei>(slot.numVertices));
+            _numPreparedVertices += slot.numVertices;
+        }
+    }
+
+    return _firsts.size();
+}
+
+std::size_t GeometryBatch::getNumPreparedVertices() const
+{
+    return _numPreparedVertices;
+}
+
+void GeometryBatch::draw(const RenderInfo& info)
+{
+    if (_firsts.empty()) return;
+
+    upload();
+
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+
+    // Our vertex colours are always white, if requested
+    glDisableClientState(GL_COLOR_ARRAY);
+    if (info.checkFlag(RENDER_VERTEX_COLOUR))
+    {
+        glColor3f(1, 1, 1);
+    }
+
+    glVertexPointer(3, GL_FLOAT, STRIDE, attributeOffset(offsetof(BatchVertex, vertex)));
+
+    // Same attribute selection as in Winding::render()
+    if (info.checkFlag(RENDER_TEXTURE_CUBEMAP))
+    {
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glTexCoordPointer(3, GL_FLOAT, STRIDE, attributeOffset(offsetof(BatchVertex, vertex)));
+    }
+    else if (info.checkFlag(RENDER_BUMP))
+    {
+        glVertexAttribPointer(ATTR_NORMAL, 3, GL_FLOAT, 0, STRIDE,
+                              attributeOffset(offsetof(BatchVertex, normal)));
+        glVertexAttribPointer(ATTR_TEXCOORD, 2, GL_FLOAT, 0, STRIDE,
+                              attributeOffset(offsetof(BatchVertex, texcoord)));
+        glVertexAttribPointer(ATTR_TANGENT, 3, GL_FLOAT, 0, STRIDE,
+                              attributeOffset(offsetof(BatchVertex, tangent)));
+        glVertexAttribPointer(ATTR_BITANGENT, 3, GL_FLOAT, 0, STRIDE,
+                              attributeOffset(offsetof(BatchVertex, bitangent)));
+    }
+    else
+    {
+        if (info.checkFlag(RENDER_LIGHTING))
+        {
+            glNormalPointer(GL_FLOAT, STRIDE, attributeOffset(offsetof(BatchVertex, normal)));
+        }
+
+        if (info.checkFlag(RENDER_TEXTURE_2D))
+        {
+            glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+            glTexCoordPointer(2, GL_FLOAT, STRIDE, attributeOffset(offsetof(BatchVertex, texcoord)));
+        }
+    }
+
+    glMultiDrawArrays(GL_POLYGON, _firsts.data(), _counts.data(), static_cast<GLsizei>(_firsts.size()));
+
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+    // The other renderables submit client-side arrays
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+const GeometryBatch::Slot& GeometryBatch::update(const BatchableRenderable& renderable)
+{
+    std::size_t revision = renderable.getGeometryRevision();
+
+    Slots::iterator found = _slots.find(&renderable);
+
+    if (found == _slots.end())
+    {
+        Slot& slot = _slots[&renderable];
+
+        slot.revision = revision;
+        slot.lastUsed = _drawCount;
+        allocate(slot, renderable, renderable.getNumBatchVertices());
+
+        return slot;
+    }
+
+    Slot& slot = found->second;
+    slot.lastUsed = _drawCount;
+
+    if (slot.revision != revision)
+    {
+        slot.revision = revision;
+
+        std::size_t numVertices = renderable.getNumBatchVertices();
+
+        if (numVertices == slot.numVertices)
+        {
+            // Overwrite in place, this is the common case for moved brushes
+            renderable.writeBatchVertices(_vertices.data() + slot.firstVertex);
+            markDirty(slot.firstVertex, slot.firstVertex + numVertices);
+        }
+        else
+        {
+            _unusedVertices += slot.numVertices;
+            allocate(slot, renderable, numVertices);
+        }
+    }
+
+    return slot;
+}
+
+void GeometryBatch::allocate(Slot& slot, const BatchableRenderable& renderable, std::size_t numVertices)
+{
+    slot.firstVertex = _vertices.size();
+    slot.numVertices = numVertices;
+
+    if (numVertices == 0) return;
+
+    _vertices.resize(_vertices.size() + numVertices);
+    renderable.writeBatchVertices(_vertices.data() + slot.firstVertex);
+
+    markDirty(slot.firstVertex, slot.firstVertex + numVertices);
+}
+
+void GeometryBatch::markDirty(std::size_t begin, std::size_t end)
+{
+    if (_dirtyBegin == _dirtyEnd)
+    {
+        _dirtyBegin = begin;
+        _dirtyEnd = end;
+    }
+    else
+    {
+        _dirtyBegin = std::min(_dirtyBegin, begin);
+        _dirtyEnd = std::max(_dirtyEnd, end);
+    }
+}
+
+void GeometryBatch::evictUnused()
+{
+    for (Slots::iterator i = _slots.begin(); i != _slots.end(); )
+    {
+        if (_drawCount - i->second.lastUsed > EVICTION_INTERVAL)
+        {
+            _unusedVertices += i->second.numVertices;
+            i = _slots.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    if (_unusedVertices > MIN_COMPACTION_SIZE && _unusedVertices * 2 > _vertices.size())
+    {
+        compact();
+    }
+}
+
+void GeometryBatch::compact()
+{
+    std::vector<BatchVertex> vertices;
+    vertices.reserve(_vertices.size() - _unusedVertices);
+
+    for (Slots::value_type& pair : _slots)
+    {
+        Slot& slot = pair.second;
+
+        std::size_t firstVertex = vertices.size();
+
+        vertices.insert(vertices.end(),
+            _vertices.begin() + slot.firstVertex,
+            _vertices.begin() + slot.firstVertex + slot.numVertices);
+
+        slot.firstVertex = firstVertex;
+    }
+
+    _vertices.swap(vertices);
+    _unusedVertices = 0;
+
+    markDirty(0, _vertices.size());
+}
+
+void GeometryBatch::upload()
+{
+    if (_vbo == 0)
+    {
+        glGenBuffers(1, &_vbo);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+
+    if (_vertices.size() > _vboCapacity)
+    {
+        // Grow along with the vector to keep the number of reallocations low
+        _vboCapacity = _vertices.capacity();
+
+        glBufferData(GL_ARRAY_BUFFER, _vboCapacity * sizeof(BatchVertex), nullptr, GL_DYNAMIC_DRAW);
+
+        _dirtyBegin = 0;
+        _dirtyEnd = _vertices.size();
+    }
+
+    if (_dirtyBegin < _dirtyEnd)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER,
+            _dirtyBegin * sizeof(BatchVertex),
+            (_dirtyEnd - _dirtyBegin) * sizeof(BatchVertex),
+            _vertices.data() + _dirtyBegin);
+    }
+
+    _dirtyBegin = _dirtyEnd = 0;
+}
+
+} // namespace
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "irender.h"
+#include <GL/glew.h>
+
+#include <vector>
+#include <unordered_map>
+
+namespace render
+{
+
+// Enables the batched rendering path for brush faces
+const char* const RKEY_BATCH_BRUSH_FACES = "user/ui/camera/batchBrushFaces";
+
+/**
+ * \brief
+ * Vertex storage for the BatchableRenderables (i.e. brush faces) of a single
+ * OpenGLShader.
+ *
+ * The polygons of all batchable renderables drawn with the shader are packed
+ * into one single-precision vertex buffer object, which is updated
+ * incrementally whenever a polygon's geometry revision changes. Each shader
+ * pass can then draw the polygons it collected with one glMultiDrawArrays()
+ * call instead of one draw call per polygon.
+ *
+ * Polygons which haven't been drawn for a while are evicted from the buffer,
+ * the storage is compacted as soon as the unused space exceeds the used one.
+ */
+class GeometryBatch
+{
+private:
+    struct Slot
+    {
+        std::size_t revision;
+        std::size_t firstVertex;
+        std::size_t numVertices;
+        std::size_t lastUsed;    // value of the draw counter
+    };
+
+    // The renderables are used as keys only, they're never dereferenced
+    // unless they have been submitted in the current frame
+    typedef std::unordered_map<const BatchableRenderable*, Slot> Slots;
+    Slots _slots;
+
+    std::vector<BatchVertex> _vertices;
+    std::size_t _unusedVertices;
+
+    // The range of _vertices which needs to be uploaded to the VBO
+    std::size_t _dirtyBegin;
+    std::size_t _dirtyEnd;
+
+    GLuint _vbo;
+    std::size_t _vboCapacity;
+
+    std::size_t _drawCount;
+
+    // Arguments for glMultiDrawArrays, kept to avoid reallocations
+    std::vector<GLint> _firsts;
+    std::vector<GLsizei> _counts;
+    std::size_t _numPreparedVertices;
+
+public:
+    GeometryBatch();
+    ~GeometryBatch();
+
+    GeometryBatch(const GeometryBatch& other) = delete;
+    GeometryBatch& operator=(const GeometryBatch& other) = delete;
+
+    // Returns true if the GL implementation supports the batched path
+    static bool isSupported();
+
+    /**
+     * \brief
+     * Prepare the polygons of the given renderables for the next draw() call.
+     * Missing or outdated polygons are (re-)packed into the vertex storage,
+     * no GL calls are made. Returns the number of polygons to draw.
+     */
+    std::size_t prepare(const std::vector<const BatchableRenderable*>& renderables);
+
+    // The total number of vertices of the polygons collected by prepare()
+    std::size_t getNumPreparedVertices() const;
+
+    /**
+     * \brief
+     * Draw the polygons collected by prepare() in the current GL state.
+     * The render flags of the given info determine the vertex attributes
+     * to submit, like in Winding::render().
+     */
+    void draw(const RenderInfo& info);
+
+    // The number of polygons currently held in the buffer
+    std::size_t size() const;
+
+private:
+    const Slot& update(const BatchableRenderable& renderable);
+    void allocate(Slot& slot, const BatchableRenderable& renderable, std::size_t numVertices);
+    void markDirty(std::size_t begin, std::size_t end);
+    void evictUnused();
+    void compact();
+    void upload();
+};
+
+} // namespace
@@ -51,6 +51,11 @@ OpenGLRenderSystem& OpenGLShader::getRenderSystem()
     return _renderSystem;
 }
 
+GeometryBatch& OpenGLShader::getGeometryBatch()
+{
+    return _geometryBatch;
+}
+
 void OpenGLShader::destroy()
 {
     _material.reset();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "OpenGLShaderPass.h"
+#include "GeometryBatch.h"
 
 #include "irender.h"
 #include "ishaders.h"
@@ -38,6 +39,9 @@ class OpenGLShader :
 	typedef std::set<Observer*> Observers;
 	Observers _observers;
 
+	// Packed brush faces, shared by all passes
+	GeometryBatch _geometryBatch;
+
 private:
 
     // Start point for constructing shader passes from the shader name
@@ -78,6 +82,9 @@ public:
     // Returns the owning render system
     OpenGLRenderSystem& getRenderSystem();
 
+    // Returns the vertex storage for batchable renderables using this shader
+    GeometryBatch& getGeometryBatch();
+
     // Shader implementation
 	void addRenderable(const OpenGLRenderable& renderable,
 					   const Matrix4& modelview,
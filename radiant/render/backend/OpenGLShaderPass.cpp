@@ -8,7 +8,9 @@
 #include "texturelib.h"
 #include "iglprogram.h"
 
+#include "registry/CachedKey.h"
 #include "debugging/render.h"
+#include "RenderBackend.h"
 
 namespace render
 {
@@ -79,6 +81,21 @@ inline void evaluateStage(const ShaderLayerPtr& stage, std::size_t time, const I
     }
 }
 
+inline bool batchingEnabled()
+{
+    // This is queried for every pass, don't look up the registry each time
+    static registry::CachedKey<bool> batchBrushFaces(RKEY_BATCH_BRUSH_FACES);
+
+    return batchBrushFaces.get() && GeometryBatch::isSupported();
+}
+
+// Batches are drawn without object transform
+inline bool isIdentity(const Matrix4* transform)
+{
+    return transform == &Matrix4::getIdentity() ||
+           transform->isAffineEqual(Matrix4::getIdentity());
+}
+
 } // namespace
 
 // GL state enabling/disabling helpers
@@ -294,12 +311,10 @@ void OpenGLShaderPass::setUpCubeMapAndTexGen(OpenGLState& current,
     }
 }
 
-// Apply own state to current state object
-void OpenGLShaderPass::applyState(OpenGLState& current,
-                                  unsigned int globalStateMask,
-                                  const Vector3& viewer,
-                                  std::size_t time,
-                                  const IRenderEntity* entity)
+// Evaluate the stages and determine the render flags to apply
+unsigned int OpenGLShaderPass::evaluateState(unsigned int globalStateMask,
+                                             std::size_t time,
+                                             const IRenderEntity* entity)
 {
     // Evaluate any shader expressions
     if (_glState.stage0)
@@ -329,7 +344,14 @@ void OpenGLShaderPass::applyState(OpenGLState& current,
 
     // Apply the global state mask to our own desired render flags to determine
     // the final set of flags that must bet set
-    const unsigned requiredState = _glState.getRenderFlags() & globalStateMask;
+    return _glState.getRenderFlags() & globalStateMask;
+}
+
+// Apply own state to current state object
+void OpenGLShaderPass::applyState(OpenGLState& current,
+                                  unsigned int requiredState,
+                                  const Vector3& viewer)
+{
 
     // Construct a mask containing all the flags that will be changing between
     // the current state and the required state. This avoids performing
@@ -590,23 +612,20 @@ void OpenGLShaderPass::addRenderable(const OpenGLRenderable& renderable,
 }
 
 // Render the bucket contents
-void OpenGLShaderPass::render(OpenGLState& current,
+void OpenGLShaderPass::render(RenderBackend& backend,
+                              OpenGLState& current,
                               unsigned int flagsMask,
                               const Vector3& viewer,
                               std::size_t time)
 {
-    // Reset the texture matrix
-    glMatrixMode(GL_TEXTURE);
-    glLoadMatrixd(Matrix4::getIdentity());
-
-    glMatrixMode(GL_MODELVIEW);
+    backend.beginPass(*this);
 
     // Apply our state to the current state object
-    applyState(current, flagsMask, viewer, time, NULL);
+    backend.applyState(*this, current, evaluateState(flagsMask, time, NULL), viewer, NULL);
 
     if (!_renderablesWithoutEntity.empty())
     {
-        renderAllContained(_renderablesWithoutEntity, current, viewer, time);
+        renderAllContained(backend, _renderablesWithoutEntity, current, viewer, time);
     }
 
     for (RenderablesByEntity::const_iterator i = _renderables.begin();
@@ -614,14 +633,14 @@ void OpenGLShaderPass::render(OpenGLState& current,
          ++i)
     {
         // Apply our state to the current state object
-        applyState(current, flagsMask, viewer, time, i->first);
+        backend.applyState(*this, current, evaluateState(flagsMask, time, i->first), viewer, i->first);
 
         if (!stateIsActive())
         {
             continue;
         }
 
-        renderAllContained(i->second, current, viewer, time);
+        renderAllContained(backend, i->second, current, viewer, time);
     }
 
     _renderablesWithoutEntity.clear();
@@ -691,7 +710,8 @@ void OpenGLShaderPass::setUpLightingCalculation(OpenGLState& current,
 }
 
 // Flush renderables
-void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
+void OpenGLShaderPass::renderAllContained(RenderBackend& backend,
+                                          const Renderables& renderables,
                                           OpenGLState& current,
                                           const Vector3& viewer,
                                           std::size_t time)
@@ -699,31 +719,32 @@ void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
     // Keep a pointer to the last transform matrix and render entity used
     const Matrix4* transform = 0;
 
-    glPushMatrix();
+    bool useBatch = batchingEnabled();
+
+    backend.beginRenderables();
 
     // Iterate over each transformed renderable in the vector
     for (const TransformedRenderable& r : renderables)
     {
+        // Static polygons are drawn through the shader's geometry batch below
+        if (useBatch)
+        {
+            const BatchableRenderable* batchable = r.renderable->getBatchable();
+
+            if (batchable != nullptr && isIdentity(r.transform))
+            {
+                getBatchedRenderables(r.light).push_back(batchable);
+                continue;
+            }
+        }
+
         // If the current iteration's transform matrix was different from the
         // last, apply it and store for the next iteration
         if (transform == NULL ||
             (transform != r.transform && !transform->isAffineEqual(*r.transform)))
         {
             transform = r.transform;
-            glPopMatrix();
-            glPushMatrix();
-            glMultMatrixd(*transform);
-
-            // Determine the face direction
-            if (current.testRenderFlag(RENDER_CULLFACE)
-                && transform->getHandedness() == Matrix4::RIGHTHANDED)
-            {
-                glFrontFace(GL_CW);
-            }
-            else
-            {
-                glFrontFace(GL_CCW);
-            }
+            backend.setTransform(*transform, current);
         }
 
         // If we are using a lighting program and this renderable is lit, set
@@ -731,16 +752,75 @@ void OpenGLShaderPass::renderAllContained(const Renderables& renderables,
         const RendererLight* light = r.light;
         if (current.glProgram && light)
         {
-            setUpLightingCalculation(current, light, viewer, *transform, time);
+            backend.setUpLight(*this, current, *light, viewer, *transform, time);
         }
 
         // Render the renderable
         RenderInfo info(current.getRenderFlags(), viewer, current.cubeMapMode);
-        r.renderable->render(info);
+        backend.draw(*r.renderable, info);
     }
 
     // Cleanup
-    glPopMatrix();
+    backend.endRenderables();
+
+    if (useBatch)
+    {
+        renderBatchedRenderables(backend, current, viewer, time);
+    }
+}
+
+std::vector<const BatchableRenderable*>& OpenGLShaderPass::getBatchedRenderables(const RendererLight* light)
+{
+    // There are only a few lights per pass, a linear search will do
+    for (LitBatch& batch : _batchedRenderables)
+    {
+        if (batch.light == light)
+        {
+            return batch.renderables;
+        }
+    }
+
+    _batchedRenderables.push_back(LitBatch());
+    _batchedRenderables.back().light = light;
+
+    return _batchedRenderables.back().renderables;
+}
+
+void OpenGLShaderPass::renderBatchedRenderables(RenderBackend& backend,
+                                                OpenGLState& current,
+                                                const Vector3& viewer,
+                                                std::size_t time)
+{
+    const Matrix4& identity = Matrix4::getIdentity();
+
+    RenderInfo info(current.getRenderFlags(), viewer, current.cubeMapMode);
+
+    backend.beginRenderables();
+
+    // This also determines the face direction, like for any other identity transform
+    backend.setTransform(identity, current);
+
+    for (LitBatch& batch : _batchedRenderables)
+    {
+        if (batch.renderables.empty()) continue;
+
+        if (current.glProgram && batch.light)
+        {
+            backend.setUpLight(*this, current, *batch.light, viewer, identity, time);
+        }
+
+        backend.drawBatch(_owner.getGeometryBatch(), batch.renderables, info);
+
+        batch.renderables.clear();
+    }
+
+    backend.endRenderables();
+
+    // Don't keep the lists of lights which are no longer around
+    if (_batchedRenderables.size() > 32)
+    {
+        _batchedRenderables.clear();
+    }
 }
 
 // Stream insertion operator
@@ -10,11 +10,13 @@
 class Matrix4;
 class OpenGLRenderable;
 class RendererLight;
+class BatchableRenderable;
 
 namespace render
 { 
     
 class OpenGLShader;
+class RenderBackend;
 
 /**
  * @brief A single component pass of an OpenGL shader.
@@ -69,16 +71,21 @@ class OpenGLShaderPass
 
 	RenderablesByEntity _renderables;
 
+	// Batchable renderables collected while rendering, grouped by light
+	struct LitBatch
+	{
+		const RendererLight* light;
+		std::vector<const BatchableRenderable*> renderables;
+	};
+	std::vector<LitBatch> _batchedRenderables;
+
 private:
 
-	// Apply own state to the "current" state object passed in as a reference,
-	// in combination with the global state mask, as well as setting
-    // relevant GL parameters directly.
-	void applyState(OpenGLState& current,
-                    unsigned int globalStateMask,
-                    const Vector3& viewer,
-					std::size_t time,
-					const IRenderEntity* entity);
+	// Evaluate the shader expressions of all stages and return the render
+	// flags of this pass in combination with the global state mask
+	unsigned int evaluateState(unsigned int globalStateMask,
+							   std::size_t time,
+							   const IRenderEntity* entity);
 
 	// Returns true if the stage associated to this pass is active and should be rendered
 	bool stateIsActive();
@@ -86,11 +93,21 @@ private:
 	void setupTextureMatrix(GLenum textureUnit, const ShaderLayerPtr& stage);
 
 	// Render all of the given TransformedRenderables
-	void renderAllContained(const Renderables& renderables,
+	void renderAllContained(RenderBackend& backend,
+							const Renderables& renderables,
 							OpenGLState& current,
 						    const Vector3& viewer,
 							std::size_t time);
 
+	// Returns the list of batchable renderables lit by the given light
+	std::vector<const BatchableRenderable*>& getBatchedRenderables(const RendererLight* light);
+
+	// Draw the collected batchable renderables through the shader's GeometryBatch
+	void renderBatchedRenderables(RenderBackend& backend,
+								  OpenGLState& current,
+								  const Vector3& viewer,
+								  std::size_t time);
+
     /* Helper functions to enable/disable particular GL states */
 
     void setTexture0();
@@ -112,13 +129,6 @@ private:
                                unsigned requiredState,
                                const Vector3& viewer);
 
-    // Set up lighting calculation
-    void setUpLightingCalculation(OpenGLState& current,
-                                  const RendererLight* light,
-                                  const Vector3& viewer,
-                                  const Matrix4& objTransform,
-								  std::size_t time);
-
 public:
 
 	OpenGLShaderPass(OpenGLShader& owner) :
@@ -160,10 +170,29 @@ public:
 		return &_glState;
 	}
 
+	/**
+	 * Apply own state to the "current" state object passed in as a reference,
+	 * setting the relevant GL parameters directly. requiredState holds the
+	 * flags returned by evaluateState().
+	 */
+	void applyState(OpenGLState& current,
+					unsigned int requiredState,
+					const Vector3& viewer);
+
+    // Set up lighting calculation
+    void setUpLightingCalculation(OpenGLState& current,
+                                  const RendererLight* light,
+                                  const Vector3& viewer,
+                                  const Matrix4& objTransform,
+								  std::size_t time);
+
 	/**
 	 * \brief
      * Render the renderables attached to this shader pass.
      *
+     * \param backend
+     * The backend receiving the render commands.
+     *
      * \param current
      * The current OpenGL state variables.
      *
@@ -174,7 +203,8 @@ public:
      * Viewer location in world space.
      *
      */
-	void render(OpenGLState& current,
+	void render(RenderBackend& backend,
+				OpenGLState& current,
 				unsigned int flagsMask,
 				const Vector3& viewer,
 				std::size_t time);
@@ -0,0 +1,165 @@
+#include "RecordingRenderBackend.h"
+
+#include "iglrender.h"
+#include "OpenGLShaderPass.h"
+#include "GeometryBatch.h"
+
+#include <ostream>
+#include <fmt/format.h>
+
+namespace render
+{
+
+namespace
+{
+    const char* const COMMAND_NAMES[] =
+    {
+        "Frame", "Pass", "State", "Transform", "Light", "Draw", "Batch",
+    };
+}
+
+RecordingRenderBackend::RecordingRenderBackend(bool recordCommands) :
+    _recordCommands(recordCommands),
+    _sortPosition(0)
+{
+    clear();
+}
+
+void RecordingRenderBackend::clear()
+{
+    _commands.clear();
+    _totals = Totals();
+    _sortPosition = 0;
+}
+
+const RenderCommandList& RecordingRenderBackend::getCommands() const
+{
+    return _commands;
+}
+
+const RecordingRenderBackend::Totals& RecordingRenderBackend::getTotals() const
+{
+    return _totals;
+}
+
+std::string RecordingRenderBackend::getSummary() const
+{
+    return fmt::format("frames: {0} | passes: {1} | states: {2} | transforms: {3} | "
+                       "lights: {4} | draws: {5} | batches: {6} ({7} polygons, {8} vertices)",
+                       _totals.frames, _totals.passes, _totals.stateChanges, _totals.transforms,
+                       _totals.lights, _totals.draws, _totals.batches,
+                       _totals.batchedPolygons, _totals.batchedVertices);
+}
+
+void RecordingRenderBackend::dump(std::ostream& stream) const
+{
+    for (const RenderCommand& command : _commands)
+    {
+        stream << fmt::format("{0:<10} flags: {1:#010x} sort: {2:>4} count: {3}",
+                              COMMAND_NAMES[command.type], command.renderFlags,
+                              command.sortPosition, command.count) << std::endl;
+    }
+}
+
+void RecordingRenderBackend::record(RenderCommand::Type type, unsigned int renderFlags,
+                                    std::size_t count, const void* object)
+{
+    if (!_recordCommands) return;
+
+    RenderCommand command;
+
+    command.type = type;
+    command.renderFlags = renderFlags;
+    command.sortPosition = _sortPosition;
+    command.count = count;
+    command.object = object;
+
+    _commands.push_back(command);
+}
+
+void RecordingRenderBackend::beginFrame(OpenGLState& current,
+                                        RenderStateFlags globalFlagsMask,
+                                        const Matrix4& modelview,
+                                        const Matrix4& projection)
+{
+    ++_totals.frames;
+    _sortPosition = 0;
+
+    record(RenderCommand::Frame, globalFlagsMask, 1, nullptr);
+}
+
+void RecordingRenderBackend::endFrame()
+{}
+
+void RecordingRenderBackend::beginPass(OpenGLShaderPass& pass)
+{
+    ++_totals.passes;
+    _sortPosition = pass.state().getSortPosition();
+
+    record(RenderCommand::Pass, pass.state().getRenderFlags(), 1, &pass);
+}
+
+void RecordingRenderBackend::applyState(OpenGLShaderPass& pass,
+                                        OpenGLState& current,
+                                        unsigned int requiredState,
+                                        const Vector3& viewer,
+                                        const IRenderEntity* entity)
+{
+    ++_totals.stateChanges;
+
+    // Track the flags and the program only, the rendering code depends on
+    // them. The program is never enabled, lights are set up if there is one.
+    current.setRenderFlags(requiredState);
+    current.glProgram = (requiredState & RENDER_PROGRAM) != 0 ? pass.state().glProgram : nullptr;
+
+    record(RenderCommand::State, requiredState, 1, &pass);
+}
+
+void RecordingRenderBackend::beginRenderables()
+{}
+
+void RecordingRenderBackend::endRenderables()
+{}
+
+void RecordingRenderBackend::setTransform(const Matrix4& transform, const OpenGLState& current)
+{
+    ++_totals.transforms;
+
+    record(RenderCommand::Transform, current.getRenderFlags(), 1, &transform);
+}
+
+void RecordingRenderBackend::setUpLight(OpenGLShaderPass& pass,
+                                        OpenGLState& current,
+                                        const RendererLight& light,
+                                        const Vector3& viewer,
+                                        const Matrix4& transform,
+                                        std::size_t time)
+{
+    ++_totals.lights;
+
+    record(RenderCommand::Light, current.getRenderFlags(), 1, &light);
+}
+
+void RecordingRenderBackend::draw(const OpenGLRenderable& renderable, const RenderInfo& info)
+{
+    ++_totals.draws;
+
+    record(RenderCommand::Draw, info.getFlags(), 1, &renderable);
+}
+
+void RecordingRenderBackend::drawBatch(GeometryBatch& batch,
+                                       const std::vector<const BatchableRenderable*>& renderables,
+                                       const RenderInfo& info)
+{
+    std::size_t numPolygons = batch.prepare(renderables);
+
+    if (numPolygons == 0) return;
+
+    ++_totals.batches;
+    _totals.batchedPolygons += numPolygons;
+    _totals.batchedVertices += batch.getNumPreparedVertices();
+
+    record(RenderCommand::Batch, info.getFlags(), numPolygons, &batch);
+}
+
+} // namespace
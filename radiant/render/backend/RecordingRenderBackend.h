@@ -0,0 +1,136 @@
+#pragma once
+
+#include "RenderBackend.h"
+
+#include <iosfwd>
+#include <string>
+
+namespace render
+{
+
+/**
+ * \brief
+ * A single command as received by the RecordingRenderBackend.
+ */
+struct RenderCommand
+{
+    enum Type
+    {
+        Frame,      // beginFrame()
+        Pass,       // beginPass()
+        State,      // applyState()
+        Transform,  // setTransform()
+        Light,      // setUpLight()
+        Draw,       // draw()
+        Batch,      // drawBatch()
+    };
+
+    Type type;
+
+    // The render flags active for this command
+    unsigned int renderFlags;
+
+    // The sort position of the pass, for Pass and State commands
+    int sortPosition;
+
+    // Number of polygons for Batch commands, 1 otherwise
+    std::size_t count;
+
+    // The object passed along with the command (pass, renderable, light),
+    // for identification only. This is not to be dereferenced after the frame.
+    const void* object;
+};
+
+typedef std::vector<RenderCommand> RenderCommandList;
+
+/**
+ * \brief
+ * A RenderBackend which doesn't talk to OpenGL at all. It records the
+ * commands it receives to a list and keeps a few totals, to allow the
+ * frontend part of the render system to be tested and benchmarked without
+ * a window or GL context.
+ *
+ * Batches are still prepared through the GeometryBatch, such that the
+ * vertex packing is included in the measured time. Vertex counts are only
+ * known for batched polygons, the renderables drawn one by one are opaque.
+ */
+class RecordingRenderBackend :
+    public RenderBackend
+{
+public:
+    struct Totals
+    {
+        std::size_t frames;
+        std::size_t passes;
+        std::size_t stateChanges;
+        std::size_t transforms;
+        std::size_t lights;
+        std::size_t draws;
+        std::size_t batches;
+        std::size_t batchedPolygons;
+        std::size_t batchedVertices;
+    };
+
+private:
+    RenderCommandList _commands;
+    Totals _totals;
+
+    // Set to false to keep the totals only
+    bool _recordCommands;
+
+    // The sort position of the pass currently rendered
+    int _sortPosition;
+
+public:
+    RecordingRenderBackend(bool recordCommands = true);
+
+    // Removes all recorded commands and resets the totals
+    void clear();
+
+    const RenderCommandList& getCommands() const;
+    const Totals& getTotals() const;
+
+    // Returns a one-line summary of the totals
+    std::string getSummary() const;
+
+    // Writes the recorded command list to the given stream, one per line
+    void dump(std::ostream& stream) const;
+
+    void beginFrame(OpenGLState& current,
+                    RenderStateFlags globalFlagsMask,
+                    const Matrix4& modelview,
+                    const Matrix4& projection) override;
+    void endFrame() override;
+
+    void beginPass(OpenGLShaderPass& pass) override;
+
+    void applyState(OpenGLShaderPass& pass,
+                    OpenGLState& current,
+                    unsigned int requiredState,
+                    const Vector3& viewer,
+                    const IRenderEntity* entity) override;
+
+    void beginRenderables() override;
+    void endRenderables() override;
+
+    void setTransform(const Matrix4& transform, const OpenGLState& current) override;
+
+    void setUpLight(OpenGLShaderPass& pass,
+                    OpenGLState& current,
+                    const RendererLight& light,
+                    const Vector3& viewer,
+                    const Matrix4& transform,
+                    std::size_t time) override;
+
+    void draw(const OpenGLRenderable& renderable, const RenderInfo& info) override;
+
+    void drawBatch(GeometryBatch& batch,
+                   const std::vector<const BatchableRenderable*>& renderables,
+                   const RenderInfo& info) override;
+
+private:
+    void record(RenderCommand::Type type, unsigned int renderFlags,
+                std::size_t count, const void* object);
+};
+
+} // namespace
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "irender.h"
+#include <vector>
+
+class Matrix4;
+class OpenGLState;
+
+namespace render
+{
+
+class OpenGLShaderPass;
+class GeometryBatch;
+
+/**
+ * \brief
+ * The part of the OpenGLRenderSystem issuing the actual render commands.
+ *
+ * The render system and its shader passes do all the frontend work (sorting,
+ * shader expression evaluation, state change detection, batching) and pass
+ * the resulting commands to a RenderBackend. The default backend submits them
+ * to OpenGL, other implementations can record them for analysis instead,
+ * which doesn't need a GL context.
+ */
+class RenderBackend
+{
+public:
+    virtual ~RenderBackend() {}
+
+    /**
+     * Called at the beginning of OpenGLRenderSystem::render(), before any
+     * pass is rendered. The given state object holds the defaults, the backend
+     * needs to bring the target into the matching state.
+     */
+    virtual void beginFrame(OpenGLState& current,
+                            RenderStateFlags globalFlagsMask,
+                            const Matrix4& modelview,
+                            const Matrix4& projection) = 0;
+
+    virtual void endFrame() = 0;
+
+    // A shader pass is about to render its renderables
+    virtual void beginPass(OpenGLShaderPass& pass) = 0;
+
+    /**
+     * Switch from the current state to the state of the given pass.
+     * requiredState contains the render flags of the pass with the global
+     * mask applied. Implementations must update the current state object.
+     */
+    virtual void applyState(OpenGLShaderPass& pass,
+                            OpenGLState& current,
+                            unsigned int requiredState,
+                            const Vector3& viewer,
+                            const IRenderEntity* entity) = 0;
+
+    // Brackets a sequence of setTransform()/draw() calls
+    virtual void beginRenderables() = 0;
+    virtual void endRenderables() = 0;
+
+    // Sets the object transform for the following draw calls
+    virtual void setTransform(const Matrix4& transform, const OpenGLState& current) = 0;
+
+    // Sets up the interaction with the given light for the following draw calls
+    virtual void setUpLight(OpenGLShaderPass& pass,
+                            OpenGLState& current,
+                            const RendererLight& light,
+                            const Vector3& viewer,
+                            const Matrix4& transform,
+                            std::size_t time) = 0;
+
+    // Draws a single renderable in the current state
+    virtual void draw(const OpenGLRenderable& renderable, const RenderInfo& info) = 0;
+
+    // Draws the given renderables from the geometry batch in the current state
+    virtual void drawBatch(GeometryBatch& batch,
+                           const std::vector<const BatchableRenderable*>& renderables,
+                           const RenderInfo& info) = 0;
+};
+
+} // namespace
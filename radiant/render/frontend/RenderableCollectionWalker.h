@@ -4,6 +4,7 @@
 #include "ientity.h"
 #include "ieclass.h"
 #include "iscenegraph.h"
+#include "../FrameProfiler.h"
 #include <functional>
 
 namespace render
@@ -123,10 +124,16 @@ public:
         RenderableCollectionWalker renderHighlightWalker(collector, volume);
 
         // Submit renderables from scene graph
-        GlobalSceneGraph().foreachVisibleNodeInVolume(volume,
-                                                      renderHighlightWalker);
+        {
+            ScopedProfile profile("Scene walk");
+
+            GlobalSceneGraph().foreachVisibleNodeInVolume(volume,
+                                                          renderHighlightWalker);
+        }
 
         // Submit renderables directly attached to the ShaderCache
+        ScopedProfile profile("Attached renderables");
+
         RenderableCollectionWalker walker(collector, volume);
         GlobalRenderSystem().forEachRenderable(walker.getRenderableCallback());
     }
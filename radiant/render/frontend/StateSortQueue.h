@@ -0,0 +1,73 @@
+#pragma once
+
+#include "irender.h"
+#include "../FrameProfiler.h"
+
+#include <vector>
+
+namespace render
+{
+
+/**
+ * \brief
+ * Queue of the renderables a RenderableCollector received during the scene
+ * walk. The renderables are handed to their shaders in one go right before
+ * rendering, which sorts them into the shader passes. The sorting is thereby
+ * measured as profile stage of its own instead of being spread across the
+ * scene walk.
+ *
+ * The transforms and light lists are referenced, like the shader passes do.
+ */
+class StateSortQueue
+{
+    struct Entry
+    {
+        Shader* shader;
+        const OpenGLRenderable* renderable;
+        const Matrix4* transform;
+        const IRenderEntity* entity;
+        const LightList* lights;
+    };
+
+    std::vector<Entry> _entries;
+
+public:
+    void add(Shader& shader, const OpenGLRenderable& renderable,
+             const Matrix4& transform, const LightList* lights = nullptr)
+    {
+        Entry entry = { &shader, &renderable, &transform, nullptr, lights };
+        _entries.push_back(entry);
+    }
+
+    void add(Shader& shader, const OpenGLRenderable& renderable,
+             const Matrix4& transform, const IRenderEntity& entity,
+             const LightList* lights = nullptr)
+    {
+        Entry entry = { &shader, &renderable, &transform, &entity, lights };
+        _entries.push_back(entry);
+    }
+
+    // Passes the queued renderables to their shaders in submission order
+    void sort()
+    {
+        ScopedProfile profile("State sorting");
+
+        for (const Entry& entry : _entries)
+        {
+            if (entry.entity != nullptr)
+            {
+                entry.shader->addRenderable(*entry.renderable, *entry.transform,
+                                            *entry.entity, entry.lights);
+            }
+            else
+            {
+                entry.shader->addRenderable(*entry.renderable, *entry.transform,
+                                            entry.lights);
+            }
+        }
+
+        _entries.clear();
+    }
+};
+
+} // namespace
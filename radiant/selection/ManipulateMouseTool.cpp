@@ -10,6 +10,7 @@
 #include "Pivot2World.h"
 #include "SelectionTest.h"
 #include "SceneWalkers.h"
+#include "transformlib.h"
 #include <fmt/format.h>
 #include "string/split.h"
 
@@ -154,6 +155,8 @@ void ManipulateMouseTool::handleMouseMove(const render::View& view, const Vector
 	{
 		_undoBegun = true;
 		GlobalUndoSystem().start();
+
+		beginTransformPreview();
 	}
 
 #ifdef _DEBUG
@@ -192,16 +195,34 @@ void ManipulateMouseTool::handleMouseMove(const render::View& view, const Vector
 	_selectionSystem.onManipulationChanged();
 }
 
-void ManipulateMouseTool::freezeTransforms()
+void ManipulateMouseTool::beginTransformPreview()
 {
-	GlobalSceneGraph().foreachNode(scene::freezeTransformableNode);
+	// Let the selected nodes render their transformation during the move,
+	// their geometry is transformed once the manipulation ends
+	_selectionSystem.foreachSelected([](const scene::INodePtr& node)
+	{
+		ITransformablePtr transform = Node_getTransformable(node);
 
-	_selectionSystem.onManipulationEnd();
+		if (transform)
+		{
+			transform->beginTransformPreview();
+		}
+
+		// The child primitives of entities are transformed along with them
+		if (Node_getEntity(node))
+		{
+			scene::foreachTransformable(node, [](ITransformable& child)
+			{
+				child.beginTransformPreview();
+			});
+		}
+	});
 }
 
 void ManipulateMouseTool::endMove()
 {
-	freezeTransforms();
+	// Applies the transformations
+	_selectionSystem.onManipulationEnd();
 
 	const selection::ManipulatorPtr& activeManipulator = _selectionSystem.getActiveManipulator();
 	assert(activeManipulator);
@@ -59,7 +59,7 @@ public:
 private:
 	bool selectManipulator(const render::View& view, const Vector2& devicePoint, const Vector2& deviceEpsilon);
 	void handleMouseMove(const render::View& view, const Vector2& devicePoint);
-	void freezeTransforms();
+	void beginTransformPreview();
 	void endMove();
 	void cancelMove();
 	bool nothingSelected() const;
@@ -0,0 +1,138 @@
+#include "ParallelSelectionTester.h"
+
+#include "SelectionPool.h"
+#include "SelectionTest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
+namespace
+{
+	// Fewer tests are run by the calling thread, small areas
+	// are not worth the overhead of starting any threads
+	const std::size_t PARALLEL_THRESHOLD = 512;
+
+	// Number of consecutive tests making up a job
+	const std::size_t JOB_SIZE = 128;
+}
+
+ParallelSelectionTester::ParallelSelectionTester(std::size_t numThreads) :
+	_numThreads(numThreads)
+{}
+
+void ParallelSelectionTester::addTest(ISelectable& selectable, const SelectionTestablePtr& testable)
+{
+	bool concurrent = testable->prepareConcurrentSelectionTest();
+
+	_tests.push_back(Test{ &selectable, testable, concurrent });
+}
+
+std::size_t ParallelSelectionTester::size() const
+{
+	return _tests.size();
+}
+
+void ParallelSelectionTester::runTests(std::size_t first, std::size_t last,
+	SelectionVolume& volume, SelectionPool& pool)
+{
+	for (std::size_t i = first; i < last; ++i)
+	{
+		pool.pushSelectable(*_tests[i].selectable);
+		_tests[i].testable->testSelect(pool, volume);
+		pool.popSelectable();
+	}
+}
+
+void ParallelSelectionTester::run(const SelectionVolume& volume, SelectionPool& pool)
+{
+	std::size_t numThreads = _numThreads > 0 ? _numThreads : std::thread::hardware_concurrency();
+
+	if (numThreads <= 1 || _tests.size() < PARALLEL_THRESHOLD)
+	{
+		SelectionVolume test(volume);
+		runTests(0, _tests.size(), test, pool);
+
+		_tests.clear();
+		return;
+	}
+
+	// The first and one past the last test of each job. A job ends where the
+	// tests switch between concurrent and non-concurrent ones, those are left
+	// to the calling thread without holding up the concurrent tests around them.
+	std::vector<std::pair<std::size_t, std::size_t>> jobs;
+	std::vector<std::size_t> concurrentJobs;
+	std::vector<std::size_t> mainThreadJobs;
+
+	for (std::size_t first = 0; first < _tests.size(); first = jobs.back().second)
+	{
+		bool concurrent = _tests[first].concurrent;
+		std::size_t last = first + 1;
+
+		while (last < _tests.size() && last - first < JOB_SIZE && _tests[last].concurrent == concurrent)
+		{
+			++last;
+		}
+
+		(concurrent ? concurrentJobs : mainThreadJobs).push_back(jobs.size());
+		jobs.push_back(std::make_pair(first, last));
+	}
+
+	numThreads = std::min(numThreads, concurrentJobs.size());
+
+	std::vector<SelectionPool> jobPools(jobs.size());
+
+	auto runJob = [&](std::size_t job, SelectionVolume& test)
+	{
+		runTests(jobs[job].first, jobs[job].second, test, jobPools[job]);
+	};
+
+	std::atomic<std::size_t> nextJob(0);
+
+	auto runConcurrentJobs = [&]()
+	{
+		// The volume is modified by BeginMesh(), every thread needs its own
+		SelectionVolume test(volume);
+
+		for (std::size_t i = nextJob++; i < concurrentJobs.size(); i = nextJob++)
+		{
+			runJob(concurrentJobs[i], test);
+		}
+	};
+
+	std::vector<std::future<void>> threads;
+
+	for (std::size_t i = 1; i < numThreads; ++i)
+	{
+		threads.push_back(std::async(std::launch::async, runConcurrentJobs));
+	}
+
+	{
+		SelectionVolume test(volume);
+
+		for (std::size_t job : mainThreadJobs)
+		{
+			runJob(job, test);
+		}
+	}
+
+	runConcurrentJobs();
+
+	for (std::future<void>& thread : threads)
+	{
+		thread.get();
+	}
+
+	// Merging in job order keeps the first of equally good intersections,
+	// the same way the serial tests would have added them
+	for (const SelectionPool& jobPool : jobPools)
+	{
+		for (SelectionPool::const_iterator i = jobPool.begin(); i != jobPool.end(); ++i)
+		{
+			pool.addSelectable(i->first, i->second);
+		}
+	}
+
+	_tests.clear();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "iselectiontest.h"
+#include "iselectable.h"
+
+#include <vector>
+
+class SelectionPool;
+class SelectionVolume;
+
+/**
+ * Runs the selection tests of an area selection as data-parallel jobs.
+ *
+ * The walkers queue their tests in traversal order (see
+ * SelectionTestWalker::deferTestsTo), which is following the cells of the
+ * space partition. The queue is split into jobs of consecutive tests, each
+ * job is filling its own SelectionPool using a thread-local copy of the
+ * SelectionVolume. The pools are merged in job order afterwards, which yields
+ * the same result as running all tests one after the other.
+ *
+ * Nodes which can't be tested concurrently are tested on the calling thread.
+ */
+class ParallelSelectionTester
+{
+	struct Test
+	{
+		ISelectable* selectable;
+		SelectionTestablePtr testable;
+		bool concurrent;
+	};
+
+	std::vector<Test> _tests;
+	std::size_t _numThreads;
+
+public:
+	// Passing 0 threads is using as many as the hardware supports
+	ParallelSelectionTester(std::size_t numThreads = 0);
+
+	// Queues the test of the given testable, the selectable is the one
+	// receiving the intersections. Must be called on the main thread.
+	void addTest(ISelectable& selectable, const SelectionTestablePtr& testable);
+
+	std::size_t size() const;
+
+	// Runs all queued tests against the given volume, adding the results
+	// to the pool. The queue is empty afterwards.
+	void run(const SelectionVolume& volume, SelectionPool& pool);
+
+private:
+	void runTests(std::size_t first, std::size_t last, SelectionVolume& volume, SelectionPool& pool);
+};
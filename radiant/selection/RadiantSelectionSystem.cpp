@@ -10,6 +10,7 @@
 #include "imousetoolmanager.h"
 #include "SelectionPool.h"
 #include "SelectionTest.h"
+#include "ParallelSelectionTester.h"
 #include "modulesystem/StaticModule.h"
 #include "SelectionMouseTools.h"
 #include "ManipulateMouseTool.h"
@@ -26,6 +27,8 @@
 #include "manipulators/ModelScaleManipulator.h"
 
 #include <functional>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace selection
 {
@@ -72,9 +75,69 @@ void RadiantSelectionSystem::notifyObservers(const scene::INodePtr& node, bool i
     }
 }
 
-void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, SelectionTest& test,
+namespace
+{
+
+// Hits closer than this to the nearest possible depth of a node's bounds
+// don't stop the front-to-back traversal, to make up for rounding errors
+const double NEAREST_HIT_DEPTH_EPSILON = 1e-6;
+
+// Visits the visible nodes in the view with the given walker, which is filling the pool.
+// If only the nearest hit is requested, the nodes are visited front to back until none
+// of the remaining ones can provide a hit closer than the best one in the pool.
+void foreachVisibleNodeInView(const render::View& view, scene::Graph::Walker& walker,
+                              const SelectionPool& pool, bool nearestOnly)
+{
+    if (!nearestOnly)
+    {
+        GlobalSceneGraph().foreachVisibleNodeInVolume(view, walker);
+        return;
+    }
+
+    GlobalSceneGraph().foreachVisibleNodeInVolumeFrontToBack(view,
+        [&](const scene::INodePtr& node, double nearestDepth)
+    {
+        if (!pool.empty())
+        {
+            const SelectionIntersection& best = pool.begin()->first;
+
+            // Intersections are sorted by distance first, a hit covering the selection point
+            // can only be beaten by a closer depth, which the remaining nodes can't provide
+            if (best.distance() == 0 && nearestDepth > best.depth() + NEAREST_HIT_DEPTH_EPSILON)
+            {
+                return false;
+            }
+        }
+
+        return walker.visit(node);
+    });
+}
+
+// Runs the walker's selection tests on the visible nodes in the view, filling the pool.
+// Unless only the nearest hit is requested, the tests are run in parallel.
+void testVisibleNodesInView(const render::View& view, SelectionTestWalker& walker,
+                            const SelectionVolume& test, SelectionPool& pool, bool nearestOnly)
+{
+    if (nearestOnly)
+    {
+        foreachVisibleNodeInView(view, walker, pool, nearestOnly);
+        return;
+    }
+
+    ParallelSelectionTester tester;
+
+    walker.deferTestsTo(&tester);
+    GlobalSceneGraph().foreachVisibleNodeInVolume(view, walker);
+    walker.deferTestsTo(nullptr);
+
+    tester.run(test, pool);
+}
+
+}
+
+void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, SelectionVolume& test,
                                              const render::View& view, SelectionSystem::EMode mode,
-                                             SelectionSystem::EComponentMode componentMode)
+                                             SelectionSystem::EComponentMode componentMode, bool nearestOnly)
 {
     // The (temporary) storage pool
     SelectionPool selector;
@@ -86,7 +149,7 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
         {
             // Instantiate a walker class which is specialised for selecting entities
             EntitySelector entityTester(selector, test);
-            GlobalSceneGraph().foreachVisibleNodeInVolume(view, entityTester);
+            testVisibleNodesInView(view, entityTester, test, selector, nearestOnly);
 
             for (SelectionPool::const_iterator i = selector.begin(); i != selector.end(); ++i)
             {
@@ -102,7 +165,7 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
             {
                 // Test for any visible elements (primitives, entities), but don't select child primitives
                 AnySelector anyTester(selector, test);
-                GlobalSceneGraph().foreachVisibleNodeInVolume(view, anyTester);
+                testVisibleNodesInView(view, anyTester, test, selector, nearestOnly);
             }
             else
             {
@@ -110,11 +173,14 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
 
                 // First, obtain all the selectable entities
                 EntitySelector entityTester(selector, test);
-                GlobalSceneGraph().foreachVisibleNodeInVolume(view, entityTester);
+                testVisibleNodesInView(view, entityTester, test, selector, nearestOnly);
 
-                // Now retrieve all the selectable primitives
-                PrimitiveSelector primitiveTester(sel2, test);
-                GlobalSceneGraph().foreachVisibleNodeInVolume(view, primitiveTester);
+                // Now retrieve all the selectable primitives, unless an entity is taking precedence
+                if (!nearestOnly || selector.empty())
+                {
+                    PrimitiveSelector primitiveTester(sel2, test);
+                    testVisibleNodesInView(view, primitiveTester, test, sel2, nearestOnly);
+                }
             }
 
             // Add the first selection crop to the target vector
@@ -122,15 +188,13 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
                 targetList.push_back(i->second);
             }
 
-            // Add the secondary crop to the vector (if it has any entries)
-            for (SelectionPool::const_iterator i = sel2.begin(); i != sel2.end(); ++i) {
-                // Check for duplicates
-                SelectablesList::iterator j;
-                for (j = targetList.begin(); j != targetList.end(); ++j) {
-                    if (*j == i->second) break;
-                }
-                // Insert if not yet in the list
-                if (j == targetList.end()) {
+            // Add the secondary crop to the vector (if it has any entries), skipping duplicates
+            std::unordered_set<ISelectable*> added(targetList.begin(), targetList.end());
+
+            for (SelectionPool::const_iterator i = sel2.begin(); i != sel2.end(); ++i)
+            {
+                if (added.insert(i->second).second)
+                {
                     targetList.push_back(i->second);
                 }
             }
@@ -141,7 +205,7 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
         {
             // Retrieve all the selectable primitives of group nodes
             GroupChildPrimitiveSelector primitiveTester(selector, test);
-            GlobalSceneGraph().foreachVisibleNodeInVolume(view, primitiveTester);
+            testVisibleNodesInView(view, primitiveTester, test, selector, nearestOnly);
 
             // Add the selection crop to the target vector
             for (SelectionPool::const_iterator i = selector.begin(); i != selector.end(); ++i)
@@ -574,12 +638,15 @@ void RadiantSelectionSystem::SelectPoint(const render::View& view,
         // The possible candidates are stored in the SelectablesSet
         SelectablesList candidates;
 
+        // Cycling through the candidates needs all of them, otherwise only the nearest one counts
+        bool nearestOnly = modifier != SelectionSystem::eCycle;
+
         if (face)
         {
             SelectionPool selector;
 
             ComponentSelector selectionTester(selector, volume, eFace);
-            GlobalSceneGraph().foreachVisibleNodeInVolume(scissored, selectionTester);
+            foreachVisibleNodeInView(scissored, selectionTester, selector, nearestOnly);
 
             // Load them all into the vector
             for (SelectionPool::const_iterator i = selector.begin(); i != selector.end(); ++i)
@@ -588,7 +655,7 @@ void RadiantSelectionSystem::SelectPoint(const render::View& view,
             }
         }
         else {
-            testSelectScene(candidates, volume, scissored, Mode(), ComponentMode());
+            testSelectScene(candidates, volume, scissored, Mode(), ComponentMode(), nearestOnly);
         }
 
         // Was the selection test successful (have we found anything to select)?
@@ -733,8 +800,8 @@ void RadiantSelectionSystem::SelectArea(const render::View& view,
 
 		// Since toggling a selectable might trigger a group-selection
 		// we need to keep track of the desired state of each selectable 
-		typedef std::map<ISelectable*, bool> SelectablesMap;
-		SelectablesMap selectableStates;
+		typedef std::unordered_map<ISelectable*, bool> SelectablesMap;
+		SelectablesMap selectableStates(candidates.size());
 
 		for (ISelectable* selectable : candidates)
 		{
@@ -767,6 +834,11 @@ void RadiantSelectionSystem::onManipulationChanged()
 
 void RadiantSelectionSystem::onManipulationEnd()
 {
+	// Transform the geometry, nodes previewing their transformation have been left
+	// untouched during the manipulation. The brush windings get rebuilt in one go
+	// (and in parallel) by the scheduler the next time any of them is needed.
+	GlobalSceneGraph().foreachNode(scene::freezeTransformableNode);
+
 	_pivot.endOperation();
 
 	// The selection bounds have possibly changed, request an idle callback
@@ -15,6 +15,8 @@
 
 #include "ManipulationPivot.h"
 
+class SelectionVolume;
+
 namespace selection
 {
 
@@ -172,9 +174,12 @@ protected:
 	virtual void onIdle() override;
 
 	// Traverses the scene and adds any selectable nodes matching the given SelectionTest to the "targetList".
-	void testSelectScene(SelectablesList& targetList, SelectionTest& test,
+	// If nearestOnly is true, only the first element of the list is guaranteed to be correct,
+	// the scene is traversed front to back and the traversal stops as soon as it is known.
+	// Otherwise the nodes are tested in parallel, see ParallelSelectionTester.
+	void testSelectScene(SelectablesList& targetList, SelectionVolume& test,
 						 const render::View& view, SelectionSystem::EMode mode,
-						 SelectionSystem::EComponentMode componentMode);
+						 SelectionSystem::EComponentMode componentMode, bool nearestOnly = false);
 
 private:
 	void notifyObservers(const scene::INodePtr& node, bool isComponent);
@@ -118,7 +118,7 @@ public:
 		return _pool.end();
 	}
 
-	bool empty()
+	bool empty() const
 	{
 		return _pool.empty();
 	}
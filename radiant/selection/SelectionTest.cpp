@@ -1,4 +1,5 @@
 #include "SelectionTest.h"
+#include "ParallelSelectionTester.h"
 
 #include "igroupnode.h"
 #include "itextstream.h"
@@ -216,6 +217,11 @@ bool SelectionTestWalker::entityIsWorldspawn(const scene::INodePtr& node)
 	return Node_isWorldspawn(node);
 }
 
+void SelectionTestWalker::deferTestsTo(ParallelSelectionTester* tester)
+{
+	_deferredTests = tester;
+}
+
 void SelectionTestWalker::performSelectionTest(const scene::INodePtr& selectableNode, 
 	const scene::INodePtr& nodeToBeTested)
 {
@@ -223,11 +229,24 @@ void SelectionTestWalker::performSelectionTest(const scene::INodePtr& selectable
 
 	if (selectable == NULL) return; // skip non-selectables
 
-	_selector.pushSelectable(*selectable);
-
 	// Test the entity for selection, this will add an intersection to the selector
 	SelectionTestablePtr selectionTestable = Node_getSelectionTestable(nodeToBeTested);
 
+	if (_deferredTests != nullptr)
+	{
+		if (selectionTestable)
+		{
+			// Evaluate the transform here, it's touching the parent nodes
+			nodeToBeTested->localToWorld();
+
+			_deferredTests->addTest(*selectable, selectionTestable);
+		}
+
+		return;
+	}
+
+	_selector.pushSelectable(*selectable);
+
 	if (selectionTestable)
 	{
 		selectionTestable->testSelect(_selector, _test);
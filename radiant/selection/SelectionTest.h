@@ -43,6 +43,8 @@ public:
 
 // --------------------------------------------------------------------------------
 
+class ParallelSelectionTester;
+
 // Base class for SelectionTesters, provides some convenience methods
 class SelectionTestWalker :
 	public scene::Graph::Walker
@@ -51,12 +53,23 @@ protected:
 	Selector& _selector;
 	SelectionTest& _test;
 
+	// If non-NULL, the tests are queued here instead of being run right away
+	ParallelSelectionTester* _deferredTests;
+
 protected:
 	SelectionTestWalker(Selector& selector, SelectionTest& test) :
 		_selector(selector),
-		_test(test)
+		_test(test),
+		_deferredTests(nullptr)
 	{}
 
+public:
+	// Queues the selection tests in the given tester, which is running them
+	// later on (see ParallelSelectionTester). Pass NULL to test right away again.
+	void deferTestsTo(ParallelSelectionTester* tester);
+
+protected:
+
 	void printNodeName(const scene::INodePtr& node);
 
 	// Returns non-NULL if the given node is an Entity
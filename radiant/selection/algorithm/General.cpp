@@ -32,7 +32,12 @@
 #include "patch/Patch.h"
 #include "patch/PatchNode.h"
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <limits>
 #include <stack>
+#include <thread>
 
 namespace selection
 {
@@ -507,10 +512,23 @@ void deleteSelectionCmd(const cmd::ArgumentList& args)
 	deleteSelection();
 }
 
+namespace
+{
+	// Fewer AABB tests than this are done by the calling thread
+	const std::size_t BOUNDS_TEST_PARALLEL_THRESHOLD = 16384;
+
+	// Number of consecutive candidates making up a job
+	const std::size_t BOUNDS_TEST_JOB_SIZE = 1024;
+}
+
 /**
  * Selects all objects that intersect one of the bounding AABBs.
  * The exact intersection-method is specified through TSelectionPolicy,
- * which must implement an evalute() method taking an AABB and the scene::INodePtr.
+ * see SelectionPolicies.h for the methods it must implement.
+ *
+ * The candidates are collected during the traversal, their bounds are tested
+ * in parallel afterwards. The selection is applied on the main thread in
+ * traversal order, the children of selected nodes are not selected themselves.
  */
 template<class TSelectionPolicy>
 class SelectByBounds :
@@ -520,6 +538,19 @@ class SelectByBounds :
 	std::size_t _count;			// number of aabbs in _aabbs
 	TSelectionPolicy policy;	// type that contains a custom intersection method aabb<->aabb
 
+	static const std::size_t NO_CANDIDATE = std::numeric_limits<std::size_t>::max();
+
+	struct Candidate
+	{
+		ISelectablePtr selectable;
+		AABB bounds;
+		std::size_t parent;		// nearest candidate among the ancestors
+	};
+	std::vector<Candidate> _candidates;
+
+	// The nearest candidate of each node on the current traversal path
+	std::vector<std::size_t> _path;
+
 public:
 	SelectByBounds(AABB* aabbs, std::size_t count) :
 		_aabbs(aabbs),
@@ -527,6 +558,9 @@ public:
 	{}
 
 	bool pre(const scene::INodePtr& node) {
+		std::size_t parent = _path.empty() ? NO_CANDIDATE : _path.back();
+		_path.push_back(parent);
+
 		// Don't traverse hidden nodes
 		if (!node->visible()) {
 			return false;
@@ -542,23 +576,100 @@ public:
 			}
 		}
 
-    	bool selected = false;
-
 		if (selectable != NULL && node->getParent() != NULL && !node->isRoot()) {
-			for (std::size_t i = 0; i < _count; ++i) {
-				// Check if the selectable passes the AABB test
-				if (policy.evaluate(_aabbs[i], node)) {
-					selectable->setSelected(true);
-					selected = true;
-					break;
-				}
+			_path.back() = _candidates.size();
+			_candidates.push_back(Candidate{ selectable, policy.getBounds(node), parent });
+		}
+
+		return true;
+	}
+
+	void post(const scene::INodePtr& node) {
+		_path.pop_back();
+	}
+
+	// Tests the collected candidates and selects the ones passing
+	void selectCandidates()
+	{
+		std::vector<char> passed(_candidates.size(), 0);
+		testCandidates(passed);
+
+		// Candidates below a selected node are not visited by the serial traversal
+		std::vector<char> covered(_candidates.size(), 0);
+
+		for (std::size_t i = 0; i < _candidates.size(); ++i)
+		{
+			const Candidate& candidate = _candidates[i];
+			bool parentCovered = candidate.parent != NO_CANDIDATE && covered[candidate.parent];
+
+			if (!parentCovered && passed[i])
+			{
+				candidate.selectable->setSelected(true);
 			}
+
+			covered[i] = parentCovered || passed[i];
 		}
+	}
 
-		// Only traverse the children of this node, if the node itself couldn't be selected
-		return !selected;
+private:
+	bool testBounds(const AABB& bounds) const
+	{
+		for (std::size_t i = 0; i < _count; ++i) {
+			// Check if the selectable passes the AABB test
+			if (policy.evaluate(_aabbs[i], bounds)) {
+				return true;
+			}
+		}
+
+		return false;
 	}
 
+	void testCandidates(std::vector<char>& passed) const
+	{
+		auto testRange = [&](std::size_t first, std::size_t last)
+		{
+			for (std::size_t i = first; i < last; ++i)
+			{
+				passed[i] = testBounds(_candidates[i].bounds) ? 1 : 0;
+			}
+		};
+
+		std::size_t numJobs = (_candidates.size() + BOUNDS_TEST_JOB_SIZE - 1) / BOUNDS_TEST_JOB_SIZE;
+		std::size_t numThreads = std::min<std::size_t>(std::thread::hardware_concurrency(), numJobs);
+
+		if (numThreads <= 1 || _candidates.size() * _count < BOUNDS_TEST_PARALLEL_THRESHOLD)
+		{
+			testRange(0, _candidates.size());
+			return;
+		}
+
+		std::atomic<std::size_t> nextJob(0);
+
+		auto testJobs = [&]()
+		{
+			for (std::size_t job = nextJob++; job < numJobs; job = nextJob++)
+			{
+				testRange(job * BOUNDS_TEST_JOB_SIZE,
+					std::min((job + 1) * BOUNDS_TEST_JOB_SIZE, _candidates.size()));
+			}
+		};
+
+		std::vector<std::future<void>> threads;
+
+		for (std::size_t i = 1; i < numThreads; ++i)
+		{
+			threads.push_back(std::async(std::launch::async, testJobs));
+		}
+
+		testJobs();
+
+		for (std::future<void>& thread : threads)
+		{
+			thread.get();
+		}
+	}
+
+public:
 	/**
 	 * Performs selection operation on the global scenegraph.
 	 * If delete_bounds_src is true, then the objects which were
@@ -610,6 +721,8 @@ public:
 		SelectByBounds<TSelectionPolicy> walker(aabbs.get(), aabbCount);
 		GlobalSceneGraph().root()->traverse(walker);
 
+		walker.selectCandidates();
+
 		SceneChangeNotify();
 	}
 };
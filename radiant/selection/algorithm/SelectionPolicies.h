@@ -4,54 +4,65 @@
 #include "ilightnode.h"
 #include "xyview/GlobalXYWnd.h"
 
+/**
+ * The selection policies for SelectByBounds provide two methods:
+ *
+ * getBounds() returns the AABB of the given node to be tested, it is called
+ * on the main thread. evaluate() compares these bounds to a selection AABB,
+ * it must be safe to call it from several threads at once.
+ */
+
 /**
   SelectionPolicy for SelectByBounds
   Returns true if
 */
 class SelectionPolicy_Complete_Tall
 {
+	unsigned int _axis1;
+	unsigned int _axis2;
+
 public:
-	bool evaluate(const AABB& box, const scene::INodePtr& node) const
+	SelectionPolicy_Complete_Tall() :
+		_axis1(0),
+		_axis2(1)
 	{
-		// Get the AABB of the visited instance
-		AABB other = node->worldAABB();
-
-		// greebo: Perform a special selection test for lights
-		// as the small diamond should be tested against selection only
-		ILightNodePtr light = Node_getLightNode(node);
-		
-		if (light )
-		{
-			other = light->getSelectAABB();
-		}
-
 		// Determine the viewtype
 		EViewType viewType = GlobalXYWndManager().getActiveViewType();
 
-		unsigned int axis1 = 0;
-		unsigned int axis2 = 1;
-
 		// Determine which axes have to be compared
 		switch (viewType) {
 			case XY:
-				axis1 = 0;
-				axis2 = 1;
+				_axis1 = 0;
+				_axis2 = 1;
 			break;
 			case YZ:
-				axis1 = 1;
-				axis2 = 2;
+				_axis1 = 1;
+				_axis2 = 2;
 			break;
 			case XZ:
-				axis1 = 0;
-				axis2 = 2;
+				_axis1 = 0;
+				_axis2 = 2;
 			break;
 		};
+	}
+
+	AABB getBounds(const scene::INodePtr& node) const
+	{
+		// greebo: Perform a special selection test for lights
+		// as the small diamond should be tested against selection only
+		ILightNodePtr light = Node_getLightNode(node);
 
+		// Get the AABB of the visited instance
+		return light ? light->getSelectAABB() : node->worldAABB();
+	}
+
+	bool evaluate(const AABB& box, const AABB& other) const
+	{
 		// Check if the AABB is contained
-		float dist1 = fabs(other.origin[axis1] - box.origin[axis1]) + fabs(other.extents[axis1]);
-		float dist2 = fabs(other.origin[axis2] - box.origin[axis2]) + fabs(other.extents[axis2]);
+		float dist1 = fabs(other.origin[_axis1] - box.origin[_axis1]) + fabs(other.extents[_axis1]);
+		float dist2 = fabs(other.origin[_axis2] - box.origin[_axis2]) + fabs(other.extents[_axis2]);
 
-		return (dist1 < fabs(box.extents[axis1]) && dist2 < fabs(box.extents[axis2]));
+		return (dist1 < fabs(box.extents[_axis1]) && dist2 < fabs(box.extents[_axis2]));
 	}
 };
 
@@ -62,9 +73,12 @@ public:
 class SelectionPolicy_Touching
 {
 public:
-	bool evaluate(const AABB& box, const scene::INodePtr& node) const {
-		const AABB& other(node->worldAABB());
+	AABB getBounds(const scene::INodePtr& node) const
+	{
+		return node->worldAABB();
+	}
 
+	bool evaluate(const AABB& box, const AABB& other) const {
 		for (unsigned int i = 0; i < 3; ++i) {
             if (std::abs(box.origin[i] - other.origin[i]) > (box.extents[i] + other.extents[i])) {
 				return false;
@@ -82,19 +96,17 @@ public:
 class SelectionPolicy_Inside
 {
 public:
-	bool evaluate(const AABB& box, const scene::INodePtr& node) const
+	AABB getBounds(const scene::INodePtr& node) const
 	{
-		AABB other = node->worldAABB();
-
 		// greebo: Perform a special selection test for lights
 		// as the small diamond should be tested against selection only
 		ILightNodePtr light = Node_getLightNode(node);
-		
-		if (light )
-		{
-			other = light->getSelectAABB();
-		}
 
+		return light ? light->getSelectAABB() : node->worldAABB();
+	}
+
+	bool evaluate(const AABB& box, const AABB& other) const
+	{
 		for (unsigned int i = 0; i < 3; ++i) {
 			if (std::abs(box.origin[i] - other.origin[i]) > (box.extents[i] - other.extents[i])) {
 				return false;
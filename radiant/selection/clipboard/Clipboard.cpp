@@ -2,9 +2,15 @@
 
 #include "iselection.h"
 #include "igrid.h"
+#include "iradiant.h"
 
+#include <wx/utils.h>
 #include "wxutil/clipboard.h"
+#include "scenelib.h"
+#include "scene/BasicRootNode.h"
 #include "map/Map.h"
+#include "map/algorithm/Clone.h"
+#include "map/algorithm/Traverse.h"
 #include "camera/GlobalCamera.h"
 #include "brush/FaceInstance.h"
 #include "selection/algorithm/General.h"
@@ -16,9 +22,75 @@ namespace selection
 namespace clipboard
 {
 
+namespace
+{
+    // Clones of the nodes copied last, together with the ID identifying them
+    // on the system clipboard. As long as the clipboard is holding that ID,
+    // pasting clones these nodes instead of parsing the map text.
+    scene::INodePtr _copiedNodes;
+    std::string _copiedNodesId;
+
+    std::string generateContentId()
+    {
+        static std::size_t copyCount = 0;
+
+        // The process ID tells apart the contents copied by other DarkRadiant instances
+        return std::to_string(wxGetProcessId()) + ":" + std::to_string(++copyCount);
+    }
+
+    void setCopiedNodes(const scene::INodePtr& copiedNodes, const std::string& id)
+    {
+        static bool shutdownHandlerConnected = false;
+
+        if (!shutdownHandlerConnected)
+        {
+            // Release the copied nodes before the modules they depend on are gone
+            GlobalRadiant().signal_radiantShutdown().connect([]()
+            {
+                if (_copiedNodes && wxutil::getClipboardContentId() == _copiedNodesId)
+                {
+                    // The map text is still to be generated from the nodes, publish
+                    // it now so that it can be pasted after we're gone
+                    std::stringstream out;
+                    GlobalMap().exportNodes(_copiedNodes, out);
+
+                    wxutil::copyToClipboard(out.str());
+                    wxutil::flushClipboard();
+                }
+
+                _copiedNodes.reset();
+                _copiedNodesId.clear();
+            });
+
+            shutdownHandlerConnected = true;
+        }
+
+        _copiedNodes = copiedNodes;
+        _copiedNodesId = id;
+    }
+
+    scene::INodePtr cloneChildNodes(const scene::INodePtr& root)
+    {
+        scene::INodePtr clonedRoot = std::make_shared<scene::BasicRootNode>();
+
+        map::CloneAll cloner(clonedRoot, map::PostCloneCallback());
+        root->traverseChildren(cloner);
+
+        return clonedRoot;
+    }
+}
+
 void pasteToMap()
 {
     GlobalSelectionSystem().setSelectedAll(false);
+
+    if (_copiedNodes && !_copiedNodesId.empty() && wxutil::getClipboardContentId() == _copiedNodesId)
+    {
+        // The clipboard contents have been copied by us, the copied nodes can be pasted right away
+        GlobalMap().importSelected(cloneChildNodes(_copiedNodes));
+        return;
+    }
+
     std::stringstream str(wxutil::pasteFromClipboard());
     GlobalMap().importSelected(str);
 }
@@ -27,12 +99,33 @@ void copy(const cmd::ArgumentList& args)
 {
 	if (FaceInstance::Selection().empty())
     {
-        // Stream selected objects into a stringstream
-        std::stringstream out;
-        GlobalMap().exportSelected(out);
+        // Clone the selected nodes, including the entities holding selected
+        // child primitives (the same set of nodes the map text would contain)
+        scene::INodePtr copiedNodes = std::make_shared<scene::BasicRootNode>();
+
+        map::CloneAll cloner(copiedNodes, map::PostCloneCallback());
+        map::traverseSelected(GlobalSceneGraph().root(), cloner);
+
+        setCopiedNodes(copiedNodes, generateContentId());
+
+        // Publish the map text to the clipboard, it's only generated
+        // when some other application asks for it
+        std::weak_ptr<scene::INode> weakCopiedNodes(copiedNodes);
+
+        wxutil::copyToClipboard([weakCopiedNodes]()
+        {
+            scene::INodePtr copiedNodes = weakCopiedNodes.lock();
+
+            if (!copiedNodes)
+            {
+                return std::string();
+            }
+
+            std::stringstream out;
+            GlobalMap().exportNodes(copiedNodes, out);
 
-        // Copy the resulting string to the clipboard
-        wxutil::copyToClipboard(out.str());
+            return out.str();
+        }, _copiedNodesId);
 	}
 	else
 	{
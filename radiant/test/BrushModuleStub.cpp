@@ -0,0 +1,17 @@
+#include "brush/BrushModule.h"
+
+#include <stdexcept>
+
+// The brush module registers commands and preferences of the main binary,
+// it isn't linked into the tests. Only Face::transform() asks it for the
+// texture lock setting, which the tests don't use.
+
+BrushModuleImpl& GlobalBrush()
+{
+	throw std::logic_error("No brush module in tests");
+}
+
+bool BrushModuleImpl::textureLockEnabled() const
+{
+	return false;
+}
@@ -0,0 +1,83 @@
+#include "render/backend/OpenGLShader.h"
+
+#include <stdexcept>
+
+// The shaders are constructed by the render system from the materials, which
+// aren't available in the tests. The shader passes only ask their shader for
+// its geometry batch and its material, the tests set up the passes themselves.
+
+namespace render
+{
+
+OpenGLShader::OpenGLShader(OpenGLRenderSystem& renderSystem) :
+	_renderSystem(renderSystem),
+	_isVisible(true),
+	_useCount(0)
+{}
+
+GeometryBatch& OpenGLShader::getGeometryBatch()
+{
+	return _geometryBatch;
+}
+
+const MaterialPtr& OpenGLShader::getMaterial() const
+{
+	return _material;
+}
+
+void OpenGLShader::addRenderable(const OpenGLRenderable& renderable,
+								 const Matrix4& modelview,
+								 const LightList* lights)
+{
+	throw std::logic_error("Add renderables to the passes in tests");
+}
+
+void OpenGLShader::addRenderable(const OpenGLRenderable& renderable,
+								 const Matrix4& modelview,
+								 const IRenderEntity& entity,
+								 const LightList* lights)
+{
+	throw std::logic_error("Add renderables to the passes in tests");
+}
+
+void OpenGLShader::setVisible(bool visible)
+{
+	_isVisible = visible;
+}
+
+bool OpenGLShader::isVisible() const
+{
+	return _isVisible;
+}
+
+void OpenGLShader::incrementUsed()
+{
+	++_useCount;
+}
+
+void OpenGLShader::decrementUsed()
+{
+	--_useCount;
+}
+
+void OpenGLShader::attachObserver(Observer& observer)
+{
+	_observers.insert(&observer);
+}
+
+void OpenGLShader::detachObserver(Observer& observer)
+{
+	_observers.erase(&observer);
+}
+
+bool OpenGLShader::isRealised()
+{
+	return false;
+}
+
+unsigned int OpenGLShader::getFlags() const
+{
+	return 0;
+}
+
+} // namespace
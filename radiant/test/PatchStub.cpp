@@ -0,0 +1,11 @@
+#include "patch/Patch.h"
+
+// The patches depend on the UI and the selection system, they aren't linked
+// into the tests. The test patches emit the texture change signal themselves,
+// like Patch::textureChanged() does.
+
+sigc::signal<void>& Patch::signal_patchTextureChanged()
+{
+	static sigc::signal<void> _sigPatchTextureChanged;
+	return _sigPatchTextureChanged;
+}
@@ -0,0 +1,605 @@
+#pragma once
+
+#include "imodule.h"
+#include "icounter.h"
+#include "ilayer.h"
+#include "imap.h"
+#include "iregistry.h"
+#include "irender.h"
+#include "iscenegraph.h"
+#include "iundo.h"
+#include "iuimanager.h"
+#include "mapfile.h"
+#include "scene/Node.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Minimal module registry and modules for the tests linking parts of the
+ * main binary. Only the calls made by the tested code are implemented, the
+ * others throw std::logic_error.
+ */
+namespace test
+{
+
+class TestModuleRegistry :
+	public IModuleRegistry
+{
+	std::map<std::string, RegisterableModulePtr> _modules;
+
+public:
+	TestModuleRegistry()
+	{
+		module::RegistryReference::Instance().setRegistry(*this);
+	}
+
+	// The registry stays alive until exit, the Global*() accessors keep
+	// references to the modules
+	static TestModuleRegistry& Instance()
+	{
+		static TestModuleRegistry _instance;
+		return _instance;
+	}
+
+	void registerModule(const RegisterableModulePtr& module) override
+	{
+		_modules[module->getName()] = module;
+	}
+
+	RegisterableModulePtr getModule(const std::string& name) const override
+	{
+		auto found = _modules.find(name);
+
+		if (found == _modules.end())
+		{
+			throw std::logic_error("Module not available in tests: " + name);
+		}
+
+		return found->second;
+	}
+
+	bool moduleExists(const std::string& name) const override
+	{
+		return _modules.find(name) != _modules.end();
+	}
+
+	void loadAndInitialiseModules() override {}
+	void shutdownModules() override {}
+
+	const ApplicationContext& getApplicationContext() const override
+	{
+		throw std::logic_error("No application context in tests");
+	}
+
+	sigc::signal<void> signal_allModulesInitialised() const override { return sigc::signal<void>(); }
+	ProgressSignal signal_moduleInitialisationProgress() const override { return ProgressSignal(); }
+	sigc::signal<void> signal_allModulesUninitialised() const override { return sigc::signal<void>(); }
+
+	std::size_t getCompatibilityLevel() const override
+	{
+		return MODULE_COMPATIBILITY_LEVEL;
+	}
+};
+
+// Base of the test modules, none of them has dependencies
+template<typename ModuleInterface>
+class TestModule :
+	public ModuleInterface
+{
+	std::string _name;
+
+public:
+	TestModule(const std::string& name) :
+		_name(name)
+	{}
+
+	const std::string& getName() const override
+	{
+		return _name;
+	}
+
+	const StringSet& getDependencies() const override
+	{
+		static StringSet _dependencies;
+		return _dependencies;
+	}
+
+	void initialiseModule(const ApplicationContext& ctx) override {}
+};
+
+// Plain key/value store, unknown keys are empty
+class TestRegistry :
+	public TestModule<Registry>
+{
+	std::map<std::string, std::string> _values;
+
+public:
+	TestRegistry() :
+		TestModule<Registry>(MODULE_XMLREGISTRY)
+	{}
+
+	void set(const std::string& key, const std::string& value) override
+	{
+		_values[key] = value;
+	}
+
+	std::string get(const std::string& key) override
+	{
+		auto found = _values.find(key);
+		return found != _values.end() ? found->second : std::string();
+	}
+
+	bool keyExists(const std::string& key) override
+	{
+		return _values.find(key) != _values.end();
+	}
+
+	// Nobody is notified of changes
+	sigc::signal<void> signalForKey(const std::string& key) const override
+	{
+		return sigc::signal<void>();
+	}
+
+	void import(const std::string& importFilePath, const std::string& parentKey, Tree tree) override
+	{
+		throw std::logic_error("No registry files in tests");
+	}
+
+	void dump() const override {}
+	void saveToDisk() override {}
+
+	void exportToFile(const std::string& key, const std::string& filename) override
+	{
+		throw std::logic_error("No registry files in tests");
+	}
+
+	xml::NodeList findXPath(const std::string& path) override
+	{
+		throw std::logic_error("No XML in the test registry");
+	}
+
+	xml::Node createKey(const std::string& key) override
+	{
+		throw std::logic_error("No XML in the test registry");
+	}
+
+	xml::Node createKeyWithName(const std::string& path, const std::string& key,
+								const std::string& name) override
+	{
+		throw std::logic_error("No XML in the test registry");
+	}
+
+	void setAttribute(const std::string& path, const std::string& attrName,
+					  const std::string& attrValue) override
+	{
+		throw std::logic_error("No XML in the test registry");
+	}
+
+	std::string getAttribute(const std::string& path, const std::string& attrName) override
+	{
+		throw std::logic_error("No XML in the test registry");
+	}
+
+	void deleteXPath(const std::string& path) override
+	{
+		throw std::logic_error("No XML in the test registry");
+	}
+};
+
+// Scene graph without a space partition, change notifications are dropped.
+// Inserted nodes are instantiated if a root has been set.
+class TestSceneGraph :
+	public TestModule<RegisterableModule>,
+	public scene::Graph
+{
+	scene::IMapRootNodePtr _root;
+	std::vector<Observer*> _observers;
+
+public:
+	TestSceneGraph() :
+		TestModule<RegisterableModule>(MODULE_SCENEGRAPH)
+	{}
+
+	const scene::IMapRootNodePtr& root() const override { return _root; }
+	void setRoot(const scene::IMapRootNodePtr& newRoot) override { _root = newRoot; }
+
+	void insert(const scene::INodePtr& node) override
+	{
+		if (_root)
+		{
+			node->onInsertIntoScene(*_root);
+		}
+
+		for (Observer* observer : _observers)
+		{
+			observer->onSceneNodeInsert(node);
+		}
+	}
+
+	void erase(const scene::INodePtr& node) override
+	{
+		if (_root)
+		{
+			node->onRemoveFromScene(*_root);
+		}
+
+		for (Observer* observer : _observers)
+		{
+			observer->onSceneNodeErase(node);
+		}
+	}
+
+	void addSceneObserver(Observer* observer) override
+	{
+		_observers.push_back(observer);
+	}
+
+	void removeSceneObserver(Observer* observer) override
+	{
+		_observers.erase(std::remove(_observers.begin(), _observers.end(), observer), _observers.end());
+	}
+
+	void sceneChanged() override {}
+	sigc::signal<void> signal_boundsChanged() const override { return sigc::signal<void>(); }
+	void boundsChanged() override {}
+	void nodeBoundsChanged(const scene::INodePtr& node) override {}
+
+	void foreachNode(const scene::INode::VisitorFunc& functor) override
+	{
+		if (_root)
+		{
+			_root->foreachNode(functor);
+		}
+	}
+
+	void foreachVisibleNode(const scene::INode::VisitorFunc& functor) override
+	{
+		throw std::logic_error("No visibility tests in the test scene graph");
+	}
+
+	void foreachNodeInVolume(const VolumeTest& volume, Walker& walker) override
+	{
+		throw std::logic_error("No space partition in the test scene graph");
+	}
+
+	void foreachVisibleNodeInVolume(const VolumeTest& volume, Walker& walker) override
+	{
+		throw std::logic_error("No space partition in the test scene graph");
+	}
+
+	void foreachNodeInVolume(const VolumeTest& volume, const scene::INode::VisitorFunc& functor) override
+	{
+		throw std::logic_error("No space partition in the test scene graph");
+	}
+
+	void foreachVisibleNodeInVolume(const VolumeTest& volume, const scene::INode::VisitorFunc& functor) override
+	{
+		throw std::logic_error("No space partition in the test scene graph");
+	}
+
+	void foreachVisibleNodeInVolumeFrontToBack(const VolumeTest& volume,
+											   const DepthSortedVisitorFunc& functor) override
+	{
+		throw std::logic_error("No space partition in the test scene graph");
+	}
+
+	scene::ISpacePartitionSystemPtr getSpacePartition() override
+	{
+		throw std::logic_error("No space partition in the test scene graph");
+	}
+};
+
+// The map root, without namespace or targets. Changes are not tracked, the
+// nodes inserted below it can connect to the (test) undo system though.
+class TestRootNode :
+	public scene::IMapRootNode,
+	public scene::Node
+{
+	class NullChangeTracker :
+		public IMapFileChangeTracker
+	{
+	public:
+		void save() override {}
+		bool saved() const override { return true; }
+		void changed() override {}
+		void setChangedCallback(const std::function<void()>& changed) override {}
+		std::size_t changes() const override { return 0; }
+	};
+
+	INamespacePtr _namespace;
+	NullChangeTracker _changeTracker;
+	AABB _bounds;
+
+public:
+	const INamespacePtr& getNamespace() override { return _namespace; }
+
+	ITargetManager& getTargetManager() override
+	{
+		throw std::logic_error("No target manager in tests");
+	}
+
+	IMapFileChangeTracker& getUndoChangeTracker() override
+	{
+		return _changeTracker;
+	}
+
+	Type getNodeType() const override { return Type::MapRoot; }
+	const AABB& localAABB() const override { return _bounds; }
+
+	void renderSolid(RenderableCollector&, const VolumeTest&) const override {}
+	void renderWireframe(RenderableCollector&, const VolumeTest&) const override {}
+	std::size_t getHighlightFlags() override { return 0; }
+};
+
+// Sets a new, instantiated root of the registered test scene graph. Nodes
+// added below it are inserted into the scene, notifying the scene observers.
+inline std::shared_ptr<TestRootNode> createSceneRoot()
+{
+	auto sceneGraph = std::dynamic_pointer_cast<scene::Graph>(
+		TestModuleRegistry::Instance().getModule(MODULE_SCENEGRAPH));
+
+	auto root = std::make_shared<TestRootNode>();
+	root->setIsRoot(true);
+	root->setSceneGraph(sceneGraph);
+
+	sceneGraph->setRoot(root);
+	root->onInsertIntoScene(*root);
+
+	return root;
+}
+
+// Only the layer visibility, the layers are never named
+class TestLayerSystem :
+	public TestModule<scene::ILayerSystem>
+{
+	scene::LayerMask _visibleLayers;
+
+public:
+	TestLayerSystem() :
+		TestModule<scene::ILayerSystem>(MODULE_LAYERSYSTEM)
+	{}
+
+	int createLayer(const std::string& name) override { throw std::logic_error("No named layers in tests"); }
+	int createLayer(const std::string& name, int layerID) override { throw std::logic_error("No named layers in tests"); }
+	void deleteLayer(const std::string& name) override { throw std::logic_error("No named layers in tests"); }
+
+	void reset() override
+	{
+		_visibleLayers.clear();
+	}
+
+	void foreachLayer(const LayerVisitFunc& visitor) override {}
+
+	int getLayerID(const std::string& name) const override { return -1; }
+	std::string getLayerName(int layerID) const override { return std::string(); }
+	bool layerExists(int layerID) const override { return false; }
+	bool renameLayer(int layerID, const std::string& newLayerName) override { return false; }
+
+	int getFirstVisibleLayer() const override { throw std::logic_error("No active layer in tests"); }
+	int getActiveLayer() const override { throw std::logic_error("No active layer in tests"); }
+	void setActiveLayer(int layerID) override { throw std::logic_error("No active layer in tests"); }
+
+	bool layerIsVisible(const std::string& layerName) override { return false; }
+
+	bool layerIsVisible(int layerID) override
+	{
+		return _visibleLayers.test(layerID);
+	}
+
+	void setLayerVisibility(const std::string& layerName, bool visible) override
+	{
+		throw std::logic_error("No named layers in tests");
+	}
+
+	// Only changes the visibility, the nodes are not updated
+	void setLayerVisibility(int layerID, bool visible) override
+	{
+		if (visible)
+		{
+			_visibleLayers.set(layerID);
+		}
+		else
+		{
+			_visibleLayers.reset(layerID);
+		}
+	}
+
+	void addSelectionToLayer(const std::string& layerName) override { throw std::logic_error("No selection in tests"); }
+	void addSelectionToLayer(int layerID) override { throw std::logic_error("No selection in tests"); }
+	void moveSelectionToLayer(const std::string& layerName) override { throw std::logic_error("No selection in tests"); }
+	void moveSelectionToLayer(int layerID) override { throw std::logic_error("No selection in tests"); }
+	void removeSelectionFromLayer(const std::string& layerName) override { throw std::logic_error("No selection in tests"); }
+	void removeSelectionFromLayer(int layerID) override { throw std::logic_error("No selection in tests"); }
+
+	// Same check as the LayerSystem's
+	bool updateNodeVisibility(const scene::INodePtr& node) override
+	{
+		if (node->getLayerMask().intersects(_visibleLayers))
+		{
+			node->disable(scene::Node::eLayered);
+			return true;
+		}
+
+		node->enable(scene::Node::eLayered);
+		return false;
+	}
+
+	void setSelected(int layerID, bool selected) override { throw std::logic_error("No selection in tests"); }
+
+	sigc::signal<void> signal_layersChanged() override { return sigc::signal<void>(); }
+	sigc::signal<void> signal_layerVisibilityChanged() override { return sigc::signal<void>(); }
+	sigc::signal<void> signal_nodeMembershipChanged() override { return sigc::signal<void>(); }
+};
+
+// Lit objects are never lit, nothing can be rendered
+class TestRenderSystem :
+	public TestModule<RenderSystem>
+{
+	class EmptyLightList :
+		public LightList
+	{
+	public:
+		void calculateIntersectingLights() const override {}
+		void setDirty() override {}
+		void forEachLight(const RendererLightCallback& callback) const override {}
+	};
+
+	EmptyLightList _lightList;
+
+public:
+	TestRenderSystem() :
+		TestModule<RenderSystem>(MODULE_RENDERSYSTEM)
+	{}
+
+	ShaderPtr capture(const std::string& name) override
+	{
+		throw std::logic_error("No shaders in tests");
+	}
+
+	void render(RenderStateFlags globalFlagsMask, const Matrix4& modelview,
+				const Matrix4& projection, const Vector3& viewer) override
+	{
+		throw std::logic_error("No rendering in tests");
+	}
+
+	void realise() override {}
+	void unrealise() override {}
+
+	std::size_t getTime() const override { return 0; }
+	void setTime(std::size_t milliSeconds) override {}
+
+	ShaderProgram getCurrentShaderProgram() const override { return SHADER_PROGRAM_NONE; }
+	void setShaderProgram(ShaderProgram prog) override {}
+
+	LightList& attachLitObject(LitObject& object) override { return _lightList; }
+	void detachLitObject(LitObject& cullable) override {}
+	void litObjectChanged(LitObject& cullable) override {}
+
+	void attachLight(RendererLight& light) override {}
+	void detachLight(RendererLight& light) override {}
+	void lightChanged(RendererLight& light) override {}
+
+	void attachRenderable(const Renderable& renderable) override {}
+	void detachRenderable(const Renderable& renderable) override {}
+	void forEachRenderable(const RenderableCallback& callback) const override {}
+
+	void extensionsInitialised() override {}
+	sigc::signal<void> signal_extensionsInitialised() override { return sigc::signal<void>(); }
+};
+
+// Provides the colour scheme only, every colour is black
+class TestUIManager :
+	public TestModule<IUIManager>
+{
+	class BlackColourScheme :
+		public IColourSchemeManager
+	{
+	public:
+		Vector3 getColour(const std::string& colourName) override
+		{
+			return Vector3(0, 0, 0);
+		}
+	};
+
+	BlackColourScheme _colourScheme;
+
+public:
+	TestUIManager() :
+		TestModule<IUIManager>(MODULE_UIMANAGER)
+	{}
+
+	IColourSchemeManager& getColourSchemeManager() override { return _colourScheme; }
+
+	IMenuManager& getMenuManager() override { throw std::logic_error("No menus in tests"); }
+	IToolbarManager& getToolbarManager() override { throw std::logic_error("No toolbars in tests"); }
+	IGroupDialog& getGroupDialog() override { throw std::logic_error("No dialogs in tests"); }
+	IStatusBarManager& getStatusBarManager() override { throw std::logic_error("No status bar in tests"); }
+	ui::IDialogManager& getDialogManager() override { throw std::logic_error("No dialogs in tests"); }
+
+	const std::string& ArtIdPrefix() const override
+	{
+		static std::string _prefix;
+		return _prefix;
+	}
+
+	ui::IFilterMenuPtr createFilterMenu() override { throw std::logic_error("No menus in tests"); }
+};
+
+// Hands out a state saver which doesn't save anything, there are no operations
+class TestUndoSystem :
+	public TestModule<IUndoSystem>
+{
+	class NullStateSaver :
+		public IUndoStateSaver
+	{
+	public:
+		void save(IUndoable& undoable) override {}
+	};
+
+	NullStateSaver _stateSaver;
+
+public:
+	TestUndoSystem() :
+		TestModule<IUndoSystem>(MODULE_UNDOSYSTEM)
+	{}
+
+	IUndoStateSaver* getStateSaver(IUndoable& undoable, IMapFileChangeTracker& tracker) override
+	{
+		return &_stateSaver;
+	}
+
+	void releaseStateSaver(IUndoable& undoable) override {}
+
+	std::size_t size() const override { return 0; }
+	void start() override {}
+	void finish(const std::string& command) override {}
+	void undo() override { throw std::logic_error("No undo in tests"); }
+	void redo() override { throw std::logic_error("No redo in tests"); }
+	void clear() override {}
+	void cancel() override {}
+
+	sigc::signal<void>& signal_postUndo() override { throw std::logic_error("No undo in tests"); }
+	sigc::signal<void>& signal_postRedo() override { throw std::logic_error("No redo in tests"); }
+
+	void attachTracker(Tracker& tracker) override {}
+	void detachTracker(Tracker& tracker) override {}
+};
+
+// Plain counters, nobody is observing them
+class TestCounters :
+	public TestModule<ICounterManager>
+{
+	class Counter :
+		public ICounter
+	{
+		std::size_t _count;
+
+	public:
+		Counter() :
+			_count(0)
+		{}
+
+		void increment() override { ++_count; }
+		void decrement() override { --_count; }
+		std::size_t get() const override { return _count; }
+	};
+
+	std::map<CounterType, Counter> _counters;
+
+public:
+	TestCounters() :
+		TestModule<ICounterManager>(MODULE_COUNTER)
+	{}
+
+	ICounter& getCounter(CounterType counter) override
+	{
+		return _counters[counter];
+	}
+};
+
+} // namespace
@@ -0,0 +1,292 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE areaSelectTest
+#include <boost/test/unit_test.hpp>
+
+#include "selection/ParallelSelectionTester.h"
+#include "selection/SelectionPool.h"
+#include "selection/SelectionTest.h"
+#include "render/View.h"
+#include "math/AABB.h"
+#include "math/Matrix4.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // A map of box-shaped primitives, the boxes are tested face by face like
+    // brushes, some of them don't support concurrent tests like entities
+    const double MAP_SIZE = 16384;
+    const double MAP_HEIGHT = 1024;
+
+    // Every n-th primitive is tested on the main thread only
+    const std::size_t NON_CONCURRENT_INTERVAL = 64;
+
+    class BoxPrimitive :
+        public SelectionTestable,
+        public ISelectable
+    {
+        Vector3 _vertices[24];
+        bool _concurrent;
+        bool _selected;
+
+        // The thread which ran the most recent test
+        std::thread::id _testThread;
+
+    public:
+        BoxPrimitive(const AABB& bounds, bool concurrent) :
+            _concurrent(concurrent),
+            _selected(false)
+        {
+            Vector3 min = bounds.origin - bounds.extents;
+            Vector3 max = bounds.origin + bounds.extents;
+
+            // The corners of the six faces, wound counter-clockwise seen from outside
+            const Vector3 faces[24] =
+            {
+                Vector3(min.x(), min.y(), max.z()), Vector3(max.x(), min.y(), max.z()), Vector3(max.x(), max.y(), max.z()), Vector3(min.x(), max.y(), max.z()),
+                Vector3(min.x(), min.y(), min.z()), Vector3(min.x(), max.y(), min.z()), Vector3(max.x(), max.y(), min.z()), Vector3(max.x(), min.y(), min.z()),
+                Vector3(min.x(), min.y(), min.z()), Vector3(max.x(), min.y(), min.z()), Vector3(max.x(), min.y(), max.z()), Vector3(min.x(), min.y(), max.z()),
+                Vector3(min.x(), max.y(), min.z()), Vector3(min.x(), max.y(), max.z()), Vector3(max.x(), max.y(), max.z()), Vector3(max.x(), max.y(), min.z()),
+                Vector3(min.x(), min.y(), min.z()), Vector3(min.x(), min.y(), max.z()), Vector3(min.x(), max.y(), max.z()), Vector3(min.x(), max.y(), min.z()),
+                Vector3(max.x(), min.y(), min.z()), Vector3(max.x(), max.y(), min.z()), Vector3(max.x(), max.y(), max.z()), Vector3(max.x(), min.y(), max.z()),
+            };
+
+            std::copy(faces, faces + 24, _vertices);
+        }
+
+        bool isConcurrent() const
+        {
+            return _concurrent;
+        }
+
+        const std::thread::id& getTestThread() const
+        {
+            return _testThread;
+        }
+
+        void testSelect(Selector& selector, SelectionTest& test) override
+        {
+            _testThread = std::this_thread::get_id();
+
+            test.BeginMesh(Matrix4::getIdentity());
+
+            SelectionIntersection best;
+
+            for (std::size_t face = 0; face < 6; ++face)
+            {
+                test.TestPolygon(VertexPointer(&_vertices[face * 4], sizeof(Vector3)), 4, best);
+            }
+
+            if (best.isValid())
+            {
+                selector.addIntersection(best);
+            }
+        }
+
+        bool prepareConcurrentSelectionTest() override
+        {
+            return _concurrent;
+        }
+
+        void setSelected(bool select) override { _selected = select; }
+        bool isSelected() const override { return _selected; }
+    };
+    typedef std::shared_ptr<BoxPrimitive> BoxPrimitivePtr;
+
+    // Deterministic pseudo-random numbers in [0..1)
+    double random(std::size_t& seed)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>((seed >> 11) & 0xfffff) / 0x100000;
+    }
+
+    AABB createRandomBounds(std::size_t& seed)
+    {
+        Vector3 origin(random(seed) * MAP_SIZE - MAP_SIZE / 2,
+                       random(seed) * MAP_SIZE - MAP_SIZE / 2,
+                       random(seed) * MAP_HEIGHT - MAP_HEIGHT / 2);
+
+        Vector3 extents(8 + random(seed) * 64, 8 + random(seed) * 64, 8 + random(seed) * 64);
+
+        return AABB(origin, extents);
+    }
+
+    // Top-down orthographic view of the whole map, the selection box covering its left half
+    render::View createSelectionView()
+    {
+        Matrix4 projection = Matrix4::byRows(
+            2 / MAP_SIZE, 0, 0, 0,
+            0, 2 / MAP_SIZE, 0, 0,
+            0, 0, -1 / MAP_SIZE, 0,
+            0, 0, 0, 1);
+
+        render::View view;
+        view.Construct(projection, Matrix4::getIdentity(), 1024, 1024);
+        view.EnableScissor(-1, 0, -1, 1);
+
+        return view;
+    }
+
+    typedef std::vector<std::pair<SelectionIntersection, ISelectable*>> PoolContents;
+
+    PoolContents getContents(const SelectionPool& pool)
+    {
+        return PoolContents(pool.begin(), pool.end());
+    }
+
+    // Places the given number of boxes, every n-th of them can't be tested concurrently
+    std::vector<BoxPrimitivePtr> createPrimitives(std::size_t numPrimitives)
+    {
+        std::size_t seed = 1;
+        std::vector<BoxPrimitivePtr> primitives;
+
+        for (std::size_t i = 0; i < numPrimitives; ++i)
+        {
+            primitives.push_back(std::make_shared<BoxPrimitive>(createRandomBounds(seed),
+                i % NON_CONCURRENT_INTERVAL != 0));
+        }
+
+        return primitives;
+    }
+
+    // Runs the tests one after the other, like the walkers used to do
+    void testSerially(const std::vector<BoxPrimitivePtr>& primitives,
+        const SelectionVolume& volume, SelectionPool& pool)
+    {
+        SelectionVolume serialVolume(volume);
+
+        for (const BoxPrimitivePtr& primitive : primitives)
+        {
+            pool.pushSelectable(*primitive);
+            primitive->testSelect(pool, serialVolume);
+            pool.popSelectable();
+        }
+    }
+
+    // Queues the tests the way the walkers are doing it and runs them
+    void testInParallel(const std::vector<BoxPrimitivePtr>& primitives, std::size_t numThreads,
+        const SelectionVolume& volume, SelectionPool& pool)
+    {
+        ParallelSelectionTester tester(numThreads);
+
+        for (const BoxPrimitivePtr& primitive : primitives)
+        {
+            tester.addTest(*primitive, primitive);
+        }
+
+        tester.run(volume, pool);
+    }
+
+    // Well above the threshold of the parallel tests
+    const std::size_t NUM_PRIMITIVES = 5000;
+
+    // The pools have to contain the same selectables in the same order
+    void checkIdentical(const PoolContents& expected, const PoolContents& contents)
+    {
+        BOOST_REQUIRE_EQUAL(expected.size(), contents.size());
+
+        for (std::size_t i = 0; i < expected.size(); ++i)
+        {
+            BOOST_CHECK_EQUAL(expected[i].second, contents[i].second);
+            BOOST_CHECK(!(expected[i].first < contents[i].first));
+            BOOST_CHECK(!(contents[i].first < expected[i].first));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parallelTestsMatchSerialOnes)
+{
+    std::vector<BoxPrimitivePtr> primitives = createPrimitives(NUM_PRIMITIVES);
+
+    render::View view = createSelectionView();
+    SelectionVolume volume(view);
+
+    SelectionPool serialPool;
+    testSerially(primitives, volume, serialPool);
+
+    PoolContents expected = getContents(serialPool);
+
+    // The selection box covers about half of the map
+    BOOST_CHECK_GT(expected.size(), NUM_PRIMITIVES / 4);
+    BOOST_CHECK_LT(expected.size(), NUM_PRIMITIVES * 3 / 4);
+
+    for (std::size_t threads : { 1, 2, 4 })
+    {
+        SelectionPool pool;
+        testInParallel(primitives, threads, volume, pool);
+
+        checkIdentical(expected, getContents(pool));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(smallAreasMatchSerialOnes)
+{
+    // Below the threshold, the tests are run by the calling thread
+    std::vector<BoxPrimitivePtr> primitives = createPrimitives(100);
+
+    render::View view = createSelectionView();
+    SelectionVolume volume(view);
+
+    SelectionPool serialPool;
+    testSerially(primitives, volume, serialPool);
+
+    SelectionPool pool;
+    testInParallel(primitives, 4, volume, pool);
+
+    checkIdentical(getContents(serialPool), getContents(pool));
+
+    for (const BoxPrimitivePtr& primitive : primitives)
+    {
+        BOOST_CHECK(primitive->getTestThread() == std::this_thread::get_id());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(nonConcurrentTestsOnCallingThread)
+{
+    std::vector<BoxPrimitivePtr> primitives = createPrimitives(NUM_PRIMITIVES);
+
+    render::View view = createSelectionView();
+    SelectionVolume volume(view);
+
+    SelectionPool pool;
+    testInParallel(primitives, 4, volume, pool);
+
+    std::size_t numOtherThreads = 0;
+
+    for (const BoxPrimitivePtr& primitive : primitives)
+    {
+        if (!primitive->isConcurrent())
+        {
+            BOOST_CHECK(primitive->getTestThread() == std::this_thread::get_id());
+        }
+        else if (primitive->getTestThread() != std::this_thread::get_id())
+        {
+            ++numOtherThreads;
+        }
+    }
+
+    BOOST_CHECK_GT(numOtherThreads, 0);
+}
+
+BOOST_AUTO_TEST_CASE(emptyQueue)
+{
+    render::View view = createSelectionView();
+    SelectionVolume volume(view);
+
+    ParallelSelectionTester tester(4);
+    SelectionPool pool;
+
+    tester.run(volume, pool);
+    BOOST_CHECK(pool.empty());
+
+    // The queue is empty after running it
+    std::vector<BoxPrimitivePtr> primitives = createPrimitives(10);
+    tester.addTest(*primitives.front(), primitives.front());
+
+    BOOST_CHECK_EQUAL(tester.size(), 1);
+    tester.run(volume, pool);
+    BOOST_CHECK_EQUAL(tester.size(), 0);
+}
@@ -0,0 +1,204 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE brushRebuildTest
+#include <boost/test/unit_test.hpp>
+
+#include "brush/BRepRebuildScheduler.h"
+#include "brush/BrushNode.h"
+#include "TestModules.h"
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+    typedef std::vector<std::shared_ptr<BrushNode>> BrushNodes;
+
+    // Registers the modules needed to construct brushes and build their B-reps
+    void initialiseBrushModules()
+    {
+        test::TestModuleRegistry& registry = test::TestModuleRegistry::Instance();
+
+        if (registry.moduleExists(MODULE_RENDERSYSTEM)) return;
+
+        auto xmlRegistry = std::make_shared<test::TestRegistry>();
+        xmlRegistry->set("user/ui/textures/defaultTextureScale", "0.5");
+
+        registry.registerModule(xmlRegistry);
+        registry.registerModule(std::make_shared<test::TestRenderSystem>());
+        registry.registerModule(std::make_shared<test::TestSceneGraph>());
+        registry.registerModule(std::make_shared<test::TestUIManager>());
+
+        // Usually set by the brush module from the game file
+        Brush::m_maxWorldCoord = 65536;
+    }
+
+    // Deterministic pseudo-random numbers in [0..1)
+    double random(std::size_t& seed)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>((seed >> 11) & 0xfffff) / 0x100000;
+    }
+
+    // Creates a brush with random planes, its B-rep is not built yet
+    std::shared_ptr<BrushNode> createBrush(std::size_t& seed)
+    {
+        auto node = std::make_shared<BrushNode>();
+        Brush& brush = node->getBrush();
+
+        Vector3 origin(random(seed) * 16384, random(seed) * 16384, random(seed) * 1024);
+        Vector3 extents(16 + random(seed) * 256, 16 + random(seed) * 256, 16 + random(seed) * 256);
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            Vector3 normal(0, 0, 0);
+            normal[axis] = 1;
+
+            brush.addFace(Plane3(normal, normal.dot(origin) + extents[axis]));
+            brush.addFace(Plane3(-normal, -normal.dot(origin) + extents[axis]));
+        }
+
+        std::size_t numBevels = static_cast<std::size_t>(random(seed) * 16);
+
+        for (std::size_t i = 0; i < numBevels; ++i)
+        {
+            Vector3 direction(random(seed) - 0.5, random(seed) - 0.5, random(seed) - 0.5);
+            Vector3 normal = direction.getNormalised();
+
+            Vector3 scaled(normal.x() * extents.x(), normal.y() * extents.y(), normal.z() * extents.z());
+            brush.addFace(Plane3(normal, normal.dot(origin) + scaled.getLength() * 0.9));
+        }
+
+        return node;
+    }
+
+    BrushNodes createBrushes(std::size_t numBrushes, std::size_t seed)
+    {
+        BrushNodes nodes;
+
+        for (std::size_t i = 0; i < numBrushes; ++i)
+        {
+            nodes.push_back(createBrush(seed));
+        }
+
+        return nodes;
+    }
+
+    // Above the threshold of the parallel flush
+    const std::size_t NUM_BRUSHES = 500;
+
+    brush::BRepRebuildScheduler& scheduler()
+    {
+        return brush::BRepRebuildScheduler::Instance();
+    }
+
+    // Builds the B-rep of each brush on its own, without the scheduler
+    BrushNodes createSerialBrushes(std::size_t numBrushes, std::size_t seed)
+    {
+        BrushNodes nodes;
+
+        for (std::size_t i = 0; i < numBrushes; ++i)
+        {
+            nodes.push_back(createBrush(seed));
+
+            Brush& brush = nodes.back()->getBrush();
+
+            scheduler().cancel(brush);
+            brush.evaluateBRep();
+        }
+
+        return nodes;
+    }
+
+    void checkSameBRep(const Brush& brush, const Brush& expected)
+    {
+        brush.evaluateBRep();
+
+        BOOST_REQUIRE_EQUAL(brush.getNumFaces(), expected.getNumFaces());
+
+        for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
+        {
+            const IWinding& winding = const_cast<Brush&>(brush).getFace(i).getWinding();
+            const IWinding& expectedWinding = const_cast<Brush&>(expected).getFace(i).getWinding();
+
+            BOOST_REQUIRE(winding == expectedWinding);
+        }
+
+        BOOST_CHECK_EQUAL(brush.localAABB().origin, expected.localAABB().origin);
+        BOOST_CHECK_EQUAL(brush.localAABB().extents, expected.localAABB().extents);
+    }
+
+    struct BrushModulesFixture
+    {
+        BrushModulesFixture()
+        {
+            initialiseBrushModules();
+        }
+
+        ~BrushModulesFixture()
+        {
+            scheduler().setNumThreads(0);
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE(parallelFlush, BrushModulesFixture)
+{
+    BrushNodes serial = createSerialBrushes(NUM_BRUSHES, 1);
+
+    BOOST_CHECK_EQUAL(scheduler().size(), 0);
+
+    // New brushes schedule themselves
+    BrushNodes parallel = createBrushes(NUM_BRUSHES, 1);
+
+    BOOST_CHECK_EQUAL(scheduler().size(), NUM_BRUSHES);
+
+    scheduler().setNumThreads(4);
+    scheduler().flush();
+
+    BOOST_CHECK_EQUAL(scheduler().size(), 0);
+
+    for (std::size_t i = 0; i < NUM_BRUSHES; ++i)
+    {
+        checkSameBRep(parallel[i]->getBrush(), serial[i]->getBrush());
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(singleThreadedFlush, BrushModulesFixture)
+{
+    BrushNodes serial = createSerialBrushes(NUM_BRUSHES, 2);
+    BrushNodes flushed = createBrushes(NUM_BRUSHES, 2);
+
+    scheduler().setNumThreads(1);
+    scheduler().flush();
+
+    for (std::size_t i = 0; i < NUM_BRUSHES; ++i)
+    {
+        checkSameBRep(flushed[i]->getBrush(), serial[i]->getBrush());
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(flushOnDemand, BrushModulesFixture)
+{
+    BrushNodes serial = createSerialBrushes(NUM_BRUSHES, 3);
+    BrushNodes parallel = createBrushes(NUM_BRUSHES, 3);
+
+    // Destroyed brushes are removed from the schedule
+    for (std::size_t i = 0; i < NUM_BRUSHES; i += 2)
+    {
+        parallel[i].reset();
+    }
+
+    BOOST_CHECK_EQUAL(scheduler().size(), NUM_BRUSHES / 2);
+
+    scheduler().setNumThreads(4);
+
+    // The first brush asked for its bounds clips all others
+    parallel[1]->getBrush().localAABB();
+
+    BOOST_CHECK_EQUAL(scheduler().size(), 0);
+
+    for (std::size_t i = 1; i < NUM_BRUSHES; i += 2)
+    {
+        checkSameBRep(parallel[i]->getBrush(), serial[i]->getBrush());
+    }
+}
@@ -0,0 +1,386 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE collisionModelTest
+#include <boost/test/unit_test.hpp>
+
+#include "radiant/brush/export/CollisionGeometry.h"
+
+#include <cmath>
+
+using namespace cmutil;
+
+namespace
+{
+    const float MAX_PRECISION = 0.0001f;
+
+    // The exhaustive search the collision model export used to perform,
+    // the hashed lookups must produce the very same geometry
+    class ReferenceGeometry
+    {
+    public:
+        VertexMap vertices;
+        EdgeMap edges;
+        PolygonList polygons;
+
+        ReferenceGeometry()
+        {
+            edges[0] = Edge(0);
+        }
+
+        int findVertex(const Vector3& vertex) const
+        {
+            for (VertexMap::const_iterator i = vertices.begin(); i != vertices.end(); ++i)
+            {
+                if (i->second == vertex) return static_cast<int>(i->first);
+            }
+            return -1;
+        }
+
+        std::size_t addVertex(const Vector3& vertex)
+        {
+            Vector3 snapped = vertex.getSnapped(MAX_PRECISION);
+            int foundIndex = findVertex(snapped);
+
+            if (foundIndex == -1)
+            {
+                std::size_t lastIndex = vertices.size();
+                vertices[lastIndex] = snapped;
+                return lastIndex;
+            }
+
+            return static_cast<std::size_t>(foundIndex);
+        }
+
+        int findEdge(const Edge& edge) const
+        {
+            for (EdgeMap::const_iterator i = edges.begin(); i != edges.end(); i++)
+            {
+                if (i->second.from == edge.from && i->second.to == edge.to)
+                {
+                    return static_cast<int>(i->first);
+                }
+
+                if (i->second.from == edge.to && i->second.to == edge.from)
+                {
+                    return -static_cast<int>(i->first);
+                }
+            }
+            return 0;
+        }
+
+        std::size_t addEdge(const Edge& edge)
+        {
+            int foundIndex = findEdge(edge);
+
+            if (foundIndex == 0)
+            {
+                std::size_t edgeIndex = edges.size();
+                edges[edgeIndex] = edge;
+                return edgeIndex;
+            }
+
+            return abs(foundIndex);
+        }
+
+        int findPolygon(const EdgeList& otherEdges)
+        {
+            for (std::size_t p = 0; p < polygons.size(); p++)
+            {
+                if (otherEdges.size() != polygons[p].numEdges) continue;
+
+                std::size_t matches = 0;
+
+                for (std::size_t i = 0; i < polygons[p].edges.size(); i++)
+                {
+                    for (std::size_t j = 0; j < otherEdges.size(); j++)
+                    {
+                        if (abs(polygons[p].edges[i]) == abs(otherEdges[j])) matches++;
+                    }
+                }
+
+                if (matches == otherEdges.size())
+                {
+                    polygons.erase(polygons.begin() + p);
+                    return static_cast<int>(p);
+                }
+            }
+            return -1;
+        }
+
+        VertexList addWinding(const std::vector<Vector3>& points)
+        {
+            VertexList vertexList;
+
+            for (const Vector3& point : points)
+            {
+                vertexList.push_back(addVertex(point));
+            }
+            vertexList.push_back(addVertex(points.front()));
+
+            for (std::size_t i = 0; i < vertexList.size() - 1; i++)
+            {
+                Edge edge;
+                edge.from = vertexList[i];
+                edge.to = vertexList[i + 1];
+                addEdge(edge);
+            }
+
+            return vertexList;
+        }
+
+        void addPolygon(const VertexList& vertexList, const Plane3& plane,
+                        const AABB& bounds, const std::string& shader)
+        {
+            Polygon poly;
+
+            for (std::size_t i = 0; i < vertexList.size() - 1; i++)
+            {
+                Edge edge;
+                edge.from = vertexList[i];
+                edge.to = vertexList[i + 1];
+                poly.edges.push_back(findEdge(edge));
+            }
+
+            if (findPolygon(poly.edges) == -1)
+            {
+                poly.numEdges = poly.edges.size();
+                poly.plane = plane;
+                poly.min = bounds.origin - bounds.extents;
+                poly.max = bounds.origin + bounds.extents;
+                poly.shader = shader;
+
+                polygons.push_back(poly);
+            }
+        }
+    };
+
+    struct Face
+    {
+        Plane3 plane;
+        std::vector<Vector3> points;
+    };
+
+    typedef std::vector<Face> BrushFaces;
+
+    AABB getBounds(const std::vector<Vector3>& points)
+    {
+        AABB bounds;
+
+        for (const Vector3& point : points)
+        {
+            bounds.includePoint(point);
+        }
+
+        return bounds;
+    }
+
+    // The faces of an axis-aligned box, windings are clockwise seen from outside
+    BrushFaces createBox(const Vector3& min, const Vector3& max)
+    {
+        Vector3 c[8];
+
+        for (int i = 0; i < 8; ++i)
+        {
+            c[i] = Vector3(i & 1 ? max.x() : min.x(), i & 2 ? max.y() : min.y(), i & 4 ? max.z() : min.z());
+        }
+
+        return BrushFaces {
+            { Plane3(-1, 0, 0, -min.x()), { c[0], c[4], c[6], c[2] } },
+            { Plane3(1, 0, 0, max.x()), { c[1], c[3], c[7], c[5] } },
+            { Plane3(0, -1, 0, -min.y()), { c[0], c[1], c[5], c[4] } },
+            { Plane3(0, 1, 0, max.y()), { c[2], c[6], c[7], c[3] } },
+            { Plane3(0, 0, -1, -min.z()), { c[0], c[2], c[3], c[1] } },
+            { Plane3(0, 0, 1, max.z()), { c[4], c[5], c[7], c[6] } },
+        };
+    }
+
+    // A vertical prism with a regular polygon as base, rotated by the given angle
+    BrushFaces createPrism(const Vector3& centre, double radius, double height,
+                           std::size_t numSides, double angle)
+    {
+        std::vector<Vector3> bottom;
+        std::vector<Vector3> top;
+
+        for (std::size_t i = 0; i < numSides; ++i)
+        {
+            double a = angle + 2 * M_PI * i / numSides;
+            Vector3 offset(std::cos(a) * radius, std::sin(a) * radius, 0);
+
+            bottom.push_back(centre + offset);
+            top.push_back(centre + offset + Vector3(0, 0, height));
+        }
+
+        BrushFaces faces;
+
+        faces.push_back({ Plane3(0, 0, -1, -centre.z()), std::vector<Vector3>(bottom.begin(), bottom.end()) });
+        faces.push_back({ Plane3(0, 0, 1, centre.z() + height), std::vector<Vector3>(top.rbegin(), top.rend()) });
+
+        for (std::size_t i = 0; i < numSides; ++i)
+        {
+            std::size_t j = (i + 1) % numSides;
+            Vector3 normal = (bottom[j] - bottom[i]).crossProduct(Vector3(0, 0, 1)).getNormalised();
+
+            faces.push_back({ Plane3(normal, normal.dot(bottom[i])), { bottom[i], bottom[j], top[j], top[i] } });
+        }
+
+        return faces;
+    }
+
+    void addBrushes(const std::vector<BrushFaces>& brushes, ReferenceGeometry& reference, CollisionGeometry& geometry)
+    {
+        for (const BrushFaces& brush : brushes)
+        {
+            for (const Face& face : brush)
+            {
+                AABB bounds = getBounds(face.points);
+
+                reference.addPolygon(reference.addWinding(face.points), face.plane, bounds, "textures/common/collision");
+                geometry.addPolygon(geometry.addWinding(face.points), face.plane, bounds, "textures/common/collision");
+            }
+        }
+    }
+
+    void checkIdentical(const ReferenceGeometry& reference, const CollisionGeometry& geometry)
+    {
+        BOOST_REQUIRE_EQUAL(reference.vertices.size(), geometry.getVertices().size());
+
+        for (const auto& pair : reference.vertices)
+        {
+            BOOST_CHECK(pair.second == geometry.getVertices().at(pair.first));
+        }
+
+        BOOST_REQUIRE_EQUAL(reference.edges.size(), geometry.getEdges().size());
+
+        for (const auto& pair : reference.edges)
+        {
+            const Edge& edge = geometry.getEdges().at(pair.first);
+
+            BOOST_CHECK_EQUAL(pair.second.from, edge.from);
+            BOOST_CHECK_EQUAL(pair.second.to, edge.to);
+            BOOST_CHECK_EQUAL(pair.second.numVertices, edge.numVertices);
+        }
+
+        BOOST_REQUIRE_EQUAL(reference.polygons.size(), geometry.getPolygons().size());
+
+        for (std::size_t i = 0; i < reference.polygons.size(); ++i)
+        {
+            const Polygon& expected = reference.polygons[i];
+            const Polygon& poly = geometry.getPolygons()[i];
+
+            BOOST_CHECK_EQUAL(expected.numEdges, poly.numEdges);
+            BOOST_CHECK(expected.edges == poly.edges);
+            BOOST_CHECK_EQUAL(expected.plane, poly.plane);
+            BOOST_CHECK(expected.min == poly.min);
+            BOOST_CHECK(expected.max == poly.max);
+        }
+    }
+
+    std::size_t countFaces(const std::vector<BrushFaces>& brushes)
+    {
+        std::size_t count = 0;
+
+        for (const BrushFaces& brush : brushes)
+        {
+            count += brush.size();
+        }
+
+        return count;
+    }
+}
+
+// A block of touching boxes, the faces between them are removed
+BOOST_AUTO_TEST_CASE(touchingBoxes)
+{
+    std::vector<BrushFaces> brushes;
+
+    for (int x = 0; x < 6; ++x)
+    {
+        for (int y = 0; y < 5; ++y)
+        {
+            for (int z = 0; z < 3; ++z)
+            {
+                Vector3 min(x * 64 - 128, y * 32 - 64, z * 16);
+                brushes.push_back(createBox(min, min + Vector3(64, 32, 16)));
+            }
+        }
+    }
+
+    ReferenceGeometry reference;
+    CollisionGeometry geometry;
+
+    addBrushes(brushes, reference, geometry);
+
+    BOOST_CHECK_LT(reference.polygons.size(), countFaces(brushes));
+    checkIdentical(reference, geometry);
+}
+
+// Off-grid boxes and prisms, part of their vertices welded within the precision
+BOOST_AUTO_TEST_CASE(offGridBrushes)
+{
+    std::vector<BrushFaces> brushes;
+
+    for (int i = 0; i < 40; ++i)
+    {
+        double offset = i * 17.3333;
+        Vector3 min(offset, std::fmod(offset * 3.1, 100), -0.00004 * (i % 3));
+
+        brushes.push_back(createBox(min, min + Vector3(17.33333, 9.5 + i % 4, 8.00002)));
+        brushes.push_back(createPrism(min + Vector3(0, 0, 8.00002), 4 + i % 5, 12.7, 3 + i % 6, i * 0.3));
+    }
+
+    // A stack of identical prisms touching each other
+    for (int i = 0; i < 5; ++i)
+    {
+        brushes.push_back(createPrism(Vector3(-200, -200, i * 24.5), 32, 24.5, 8, M_PI / 8));
+    }
+
+    // Coordinates around zero, some of them snapping to -0
+    brushes.push_back(createBox(Vector3(-0.00003, -8, -8), Vector3(8, 8, 8)));
+    brushes.push_back(createBox(Vector3(-8, -8, -8), Vector3(0.00002, 8, 8)));
+
+    ReferenceGeometry reference;
+    CollisionGeometry geometry;
+
+    addBrushes(brushes, reference, geometry);
+
+    checkIdentical(reference, geometry);
+}
+
+// Windings with vertices collapsing to the same one, these are producing
+// polygons which reference the same edge more than once
+BOOST_AUTO_TEST_CASE(degenerateWindings)
+{
+    std::vector<BrushFaces> brushes;
+
+    brushes.push_back(createBox(Vector3(0, 0, 0), Vector3(16, 16, 16)));
+
+    Plane3 plane(0, 0, 1, 16);
+
+    brushes.push_back(BrushFaces {
+        // Sliver with two vertices snapping together
+        { plane, { Vector3(0, 0, 16), Vector3(16, 0, 16), Vector3(16, 0.00001, 16), Vector3(0, 16, 16) } },
+        { plane, { Vector3(0, 0, 16), Vector3(16, 0, 16), Vector3(0, 16, 16) } },
+        // Collapsed to a single vertex, this is using the NULL edge
+        { plane, { Vector3(0, 0, 0), Vector3(0.00001, 0, 0), Vector3(0, 0.00001, 0) } },
+        { plane, { Vector3(0, 0, 0) } },
+        { plane, { Vector3(0, 0, 0), Vector3(0, 0, 0.00001) } },
+        // Back and forth between two vertices
+        { plane, { Vector3(0, 0, 16), Vector3(16, 0, 16), Vector3(0, 0, 16), Vector3(16, 0, 16) } },
+        { plane, { Vector3(16, 0, 16), Vector3(0, 0, 16) } },
+        { plane, { Vector3(0, 0, 16), Vector3(16, 0, 16), Vector3(16, 16, 16), Vector3(16, 16, 16) } },
+        { plane, { Vector3(16, 0, 16), Vector3(16, 16, 16), Vector3(0, 0, 16) } },
+        // Using two edges twice each, this matches the regular quad after it
+        { plane, { Vector3(32, 0, 0), Vector3(48, 0, 0), Vector3(32, 0, 0), Vector3(32, 16, 0) } },
+        { plane, { Vector3(48, 0, 0), Vector3(32, 0, 0), Vector3(32, 16, 0), Vector3(48, 16, 0) } },
+    });
+
+    // The regular faces again, after the irregular ones
+    brushes.push_back(createBox(Vector3(0, 0, 0), Vector3(16, 16, 16)));
+    brushes.push_back(createBox(Vector3(0, 0, 16), Vector3(16, 16, 32)));
+
+    ReferenceGeometry reference;
+    CollisionGeometry geometry;
+
+    addBrushes(brushes, reference, geometry);
+
+    checkIdentical(reference, geometry);
+}
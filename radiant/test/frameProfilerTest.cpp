@@ -0,0 +1,273 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE frameProfilerTest
+#include <boost/test/unit_test.hpp>
+
+#include "radiant/render/FrameProfiler.h"
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+using render::FrameProfiler;
+
+namespace
+{
+    typedef std::vector<FrameProfiler::ScopeStats> ScopeStatsList;
+
+    void wait()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const FrameProfiler::ScopeStats& findScope(const ScopeStatsList& stats, const std::string& name)
+    {
+        for (const FrameProfiler::ScopeStats& scope : stats)
+        {
+            if (scope.name == name) return scope;
+        }
+
+        BOOST_FAIL("Scope " << name << " not found");
+        return stats.front();
+    }
+
+    // A camera frame with the stages of CamWnd, lights are tested three times
+    void renderFrame(FrameProfiler& profiler)
+    {
+        profiler.beginFrame("Camera");
+
+        profiler.beginScope("Collect");
+        profiler.beginScope("Scene walk");
+
+        for (int i = 0; i < 3; ++i)
+        {
+            profiler.beginScope("Light intersection");
+            wait();
+            profiler.endScope();
+        }
+
+        profiler.endScope();
+        profiler.endScope();
+
+        profiler.beginScope("Submit");
+        profiler.beginScope("State sorting");
+        wait();
+        profiler.endScope();
+        profiler.beginScope("Shader passes");
+        wait();
+        profiler.endScope();
+        profiler.endScope();
+
+        profiler.endFrame();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(nestedScopes)
+{
+    FrameProfiler profiler;
+    renderFrame(profiler);
+
+    ScopeStatsList stats = profiler.getScopeStats("Camera");
+
+    // Depth first, in the order the scopes have been entered
+    const char* const names[] =
+    {
+        "Camera", "Collect", "Scene walk", "Light intersection",
+        "Submit", "State sorting", "Shader passes",
+    };
+    const std::size_t depths[] = { 0, 1, 2, 3, 1, 2, 2 };
+
+    BOOST_REQUIRE_EQUAL(stats.size(), 7);
+
+    for (std::size_t i = 0; i < stats.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(stats[i].name, names[i]);
+        BOOST_CHECK_EQUAL(stats[i].depth, depths[i]);
+    }
+
+    // A parent contains the time of its children
+    const FrameProfiler::ScopeStats& frame = findScope(stats, "Camera");
+    const FrameProfiler::ScopeStats& submit = findScope(stats, "Submit");
+    const FrameProfiler::ScopeStats& sorting = findScope(stats, "State sorting");
+    const FrameProfiler::ScopeStats& passes = findScope(stats, "Shader passes");
+
+    BOOST_CHECK_GE(submit.last, sorting.last + passes.last);
+    BOOST_CHECK_GE(frame.last, findScope(stats, "Collect").last + submit.last);
+    BOOST_CHECK_GE(sorting.last, 1.0);
+
+    BOOST_CHECK_EQUAL(profiler.getLastFrameTime("Camera"), frame.last);
+}
+
+BOOST_AUTO_TEST_CASE(aggregateCallsAndFrames)
+{
+    FrameProfiler profiler;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        renderFrame(profiler);
+    }
+
+    ScopeStatsList stats = profiler.getScopeStats("Camera");
+
+    // Repeated calls within a frame are merged into one scope
+    BOOST_CHECK_EQUAL(stats.size(), 7);
+
+    const FrameProfiler::ScopeStats& lights = findScope(stats, "Light intersection");
+
+    BOOST_CHECK_EQUAL(lights.calls, 3);
+    BOOST_CHECK_GE(lights.last, 3.0);
+
+    for (const FrameProfiler::ScopeStats& scope : stats)
+    {
+        BOOST_CHECK_LE(scope.min, scope.avg);
+        BOOST_CHECK_LE(scope.avg, scope.max);
+        BOOST_CHECK_LE(scope.min, scope.last);
+        BOOST_CHECK_LE(scope.last, scope.max);
+    }
+
+    // A scope which has not been entered gets a zero sample
+    profiler.beginFrame("Camera");
+    profiler.beginScope("Collect");
+    profiler.endScope();
+    profiler.endFrame();
+
+    stats = profiler.getScopeStats("Camera");
+
+    BOOST_CHECK_EQUAL(findScope(stats, "Submit").calls, 0);
+    BOOST_CHECK_EQUAL(findScope(stats, "Submit").last, 0);
+    BOOST_CHECK_EQUAL(findScope(stats, "Submit").min, 0);
+    BOOST_CHECK_GT(findScope(stats, "Submit").max, 0);
+    BOOST_CHECK_EQUAL(findScope(stats, "Collect").calls, 1);
+}
+
+BOOST_AUTO_TEST_CASE(separateViewsAndParents)
+{
+    FrameProfiler profiler;
+
+    profiler.beginFrame("Camera");
+    profiler.beginScope("Collect");
+    profiler.endScope();
+    profiler.endFrame();
+
+    profiler.beginFrame("XY");
+    profiler.beginScope("Collect");
+    profiler.beginScope("Grid");
+    profiler.endScope();
+    profiler.endScope();
+    profiler.beginScope("Grid");
+    profiler.endScope();
+    profiler.endFrame();
+
+    BOOST_CHECK_EQUAL(profiler.getScopeStats("Camera").size(), 2);
+
+    // Scopes of the same name below different parents are kept apart
+    ScopeStatsList xy = profiler.getScopeStats("XY");
+
+    BOOST_REQUIRE_EQUAL(xy.size(), 4);
+    BOOST_CHECK_EQUAL(xy[2].name, "Grid");
+    BOOST_CHECK_EQUAL(xy[2].depth, 2);
+    BOOST_CHECK_EQUAL(xy[3].name, "Grid");
+    BOOST_CHECK_EQUAL(xy[3].depth, 1);
+
+    BOOST_CHECK(profiler.getScopeStats("Unknown").empty());
+}
+
+BOOST_AUTO_TEST_CASE(nestedFramesAndStrayScopes)
+{
+    FrameProfiler profiler;
+
+    // Scopes outside of a frame are ignored
+    profiler.beginScope("Stray");
+    profiler.endScope();
+
+    // A view drawn while another one is drawing counts as a scope of it
+    profiler.beginFrame("Camera");
+    profiler.beginFrame("Preview");
+    profiler.endFrame();
+    profiler.endFrame();
+
+    ScopeStatsList stats = profiler.getScopeStats("Camera");
+
+    BOOST_REQUIRE_EQUAL(stats.size(), 2);
+    BOOST_CHECK_EQUAL(stats[1].name, "Preview");
+    BOOST_CHECK_EQUAL(stats[1].depth, 1);
+
+    BOOST_CHECK(profiler.getScopeStats("Stray").empty());
+    BOOST_CHECK(profiler.getScopeStats("Preview").empty());
+}
+
+BOOST_AUTO_TEST_CASE(scopedProfiles)
+{
+    {
+        render::ScopedFrameProfile frame("Scoped test");
+        render::ScopedProfile outer("Outer");
+        render::ScopedProfile inner("Inner");
+    }
+
+    ScopeStatsList stats = FrameProfiler::Instance().getScopeStats("Scoped test");
+
+    BOOST_REQUIRE_EQUAL(stats.size(), 3);
+    BOOST_CHECK_EQUAL(stats[2].name, "Inner");
+    BOOST_CHECK_EQUAL(stats[2].depth, 2);
+}
+
+BOOST_AUTO_TEST_CASE(exportTrace)
+{
+    FrameProfiler profiler;
+    renderFrame(profiler);
+    renderFrame(profiler);
+
+    std::ostringstream stream;
+    profiler.exportChromeTrace(stream);
+
+    std::string trace = stream.str();
+
+    // One event per frame and scope call
+    std::size_t numEvents = 0;
+
+    for (std::size_t pos = trace.find("\"ph\": \"X\""); pos != std::string::npos;
+         pos = trace.find("\"ph\": \"X\"", pos + 1))
+    {
+        ++numEvents;
+    }
+
+    BOOST_CHECK_EQUAL(numEvents, 2 * 9);
+    BOOST_CHECK_NE(trace.find("\"name\": \"State sorting\", \"cat\": \"scope\""), std::string::npos);
+    BOOST_CHECK_NE(trace.find("\"name\": \"Camera\", \"cat\": \"frame\""), std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(untracedScopes)
+{
+    FrameProfiler profiler;
+
+    // More per-object scopes than trace events are kept per frame
+    profiler.beginFrame("Camera");
+    profiler.beginScope("Scene walk");
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        profiler.beginScope("Light intersection", false);
+        profiler.endScope();
+    }
+
+    profiler.endScope();
+    profiler.beginScope("Submit");
+    profiler.endScope();
+    profiler.endFrame();
+
+    // The calls are summed up in the statistics
+    ScopeStatsList stats = profiler.getScopeStats("Camera");
+
+    BOOST_REQUIRE_EQUAL(stats.size(), 4);
+    BOOST_CHECK_EQUAL(findScope(stats, "Light intersection").calls, 20000);
+
+    std::ostringstream stream;
+    profiler.exportChromeTrace(stream);
+
+    std::string trace = stream.str();
+
+    // The parents are traced, the untraced scope isn't
+    BOOST_CHECK_NE(trace.find("\"name\": \"Scene walk\""), std::string::npos);
+    BOOST_CHECK_NE(trace.find("\"name\": \"Submit\""), std::string::npos);
+    BOOST_CHECK_NE(trace.find("\"name\": \"Camera\""), std::string::npos);
+    BOOST_CHECK_EQUAL(trace.find("\"name\": \"Light intersection\""), std::string::npos);
+}
@@ -0,0 +1,358 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE layerVisibilityTest
+#include <boost/test/unit_test.hpp>
+
+#include "TestModules.h"
+#include "layers/LayerMemberIndex.h"
+#include "iselectable.h"
+#include "scene/Node.h"
+#include "scenelib.h"
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Entities and their child primitives spread across many layers. The
+    // scene is built below the root of the test scene graph, where the
+    // LayerMemberIndex picks it up, or below a container node outside the scene.
+    class LayeredNode :
+        public scene::Node,
+        public ISelectable
+    {
+        Type _type;
+        AABB _bounds;
+        bool _selected;
+
+    public:
+        LayeredNode(Type type) :
+            _type(type),
+            _selected(false)
+        {}
+
+        Type getNodeType() const override { return _type; }
+        const AABB& localAABB() const override { return _bounds; }
+
+        void renderSolid(RenderableCollector&, const VolumeTest&) const override {}
+        void renderWireframe(RenderableCollector&, const VolumeTest&) const override {}
+        std::size_t getHighlightFlags() override { return 0; }
+
+        void setSelected(bool select) override { _selected = select; }
+        bool isSelected() const override { return _selected; }
+
+        bool isLayered() const
+        {
+            return checkStateFlag(eLayered);
+        }
+    };
+    typedef std::shared_ptr<LayeredNode> LayeredNodePtr;
+    typedef std::vector<LayeredNodePtr> LayeredNodes;
+
+    // Registers the scene graph and the layer system used by the scenelib walkers
+    void initialiseLayerModules()
+    {
+        test::TestModuleRegistry& registry = test::TestModuleRegistry::Instance();
+
+        if (registry.moduleExists(MODULE_LAYERSYSTEM)) return;
+
+        registry.registerModule(std::make_shared<test::TestSceneGraph>());
+        registry.registerModule(std::make_shared<test::TestLayerSystem>());
+    }
+
+    // Deterministic pseudo-random numbers in [0..1)
+    double random(std::size_t& seed)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>((seed >> 11) & 0xfffff) / 0x100000;
+    }
+
+    // Assigns the node to one or two random layers
+    void assignRandomLayers(scene::INode& node, int numLayers, std::size_t& seed)
+    {
+        int first = static_cast<int>(random(seed) * numLayers);
+        int second = random(seed) < 0.25 ? static_cast<int>(random(seed) * numLayers) : first;
+
+        node.moveToLayer(first);
+        node.addToLayer(second);
+    }
+
+    // Adds entities to the given parent, most of them holding a few primitives
+    // which may be in other layers than their entity. The same seed yields the
+    // same scene.
+    void createScene(const scene::INodePtr& parent, std::size_t numEntities, int numLayers, std::size_t seed)
+    {
+        for (std::size_t i = 0; i < numEntities; ++i)
+        {
+            auto entity = std::make_shared<LayeredNode>(scene::INode::Type::Entity);
+            assignRandomLayers(*entity, numLayers, seed);
+
+            parent->addChildNode(entity);
+
+            std::size_t numPrimitives = static_cast<std::size_t>(random(seed) * 5);
+
+            for (std::size_t p = 0; p < numPrimitives; ++p)
+            {
+                auto primitive = std::make_shared<LayeredNode>(scene::INode::Type::Brush);
+
+                // Primitives are usually in the layer of their entity
+                if (random(seed) < 0.5)
+                {
+                    primitive->assignToLayers(entity->getLayers());
+                }
+                else
+                {
+                    assignRandomLayers(*primitive, numLayers, seed);
+                }
+
+                entity->addChildNode(primitive);
+            }
+        }
+    }
+
+    // All nodes below the given one, depth first
+    LayeredNodes getLayeredNodes(const scene::INodePtr& parent)
+    {
+        LayeredNodes nodes;
+
+        parent->foreachNode([&](const scene::INodePtr& node)
+        {
+            nodes.push_back(std::dynamic_pointer_cast<LayeredNode>(node));
+            return true;
+        });
+
+        return nodes;
+    }
+
+    const std::size_t NUM_ENTITIES = 500;
+
+    // More than fit into the inline word of the LayerMask
+    const int NUM_LAYERS = 80;
+
+    // The same scene twice: below the scene graph root, updated through the
+    // LayerMemberIndex, and outside the scene, updated by full walks
+    struct LayerScenes
+    {
+        std::shared_ptr<test::TestRootNode> root;
+        LayeredNodePtr container;
+
+        scene::LayerMemberIndex index;
+
+        LayerScenes() :
+            container(std::make_shared<LayeredNode>(scene::INode::Type::Entity))
+        {
+            initialiseLayerModules();
+
+            GlobalLayerSystem().reset();
+
+            for (int layerId = 0; layerId < NUM_LAYERS; ++layerId)
+            {
+                GlobalLayerSystem().setLayerVisibility(layerId, true);
+            }
+
+            root = test::createSceneRoot();
+            GlobalSceneGraph().addSceneObserver(&index);
+
+            createScene(root, NUM_ENTITIES, NUM_LAYERS, 1);
+            createScene(container, NUM_ENTITIES, NUM_LAYERS, 1);
+
+            updateAll();
+        }
+
+        ~LayerScenes()
+        {
+            GlobalSceneGraph().removeSceneObserver(&index);
+            GlobalSceneGraph().setRoot(scene::IMapRootNodePtr());
+        }
+
+        void updateAll()
+        {
+            scene::UpdateNodeVisibilityWalker walker;
+            root->traverseChildren(walker);
+            container->traverseChildren(walker);
+        }
+
+        // Adds the same entity with a primitive to both scenes
+        void addEntity(int layerId)
+        {
+            for (const scene::INodePtr& parent : { scene::INodePtr(root), scene::INodePtr(container) })
+            {
+                auto entity = std::make_shared<LayeredNode>(scene::INode::Type::Entity);
+                entity->moveToLayer(layerId);
+
+                auto primitive = std::make_shared<LayeredNode>(scene::INode::Type::Brush);
+                primitive->moveToLayer(layerId);
+
+                entity->addChildNode(primitive);
+                scene::addNodeToContainer(entity, parent);
+            }
+        }
+
+        // Selects all visible nodes (hidden ones can't be selected), then
+        // hides or shows the layer and updates the scenes, the nodes hidden
+        // by it are de-selected
+        void setLayerVisibility(int layerId, bool visible)
+        {
+            for (const LayeredNodes& nodes : { getLayeredNodes(root), getLayeredNodes(container) })
+            {
+                for (const LayeredNodePtr& node : nodes)
+                {
+                    node->setSelected(!node->isLayered());
+                }
+            }
+
+            GlobalLayerSystem().setLayerVisibility(layerId, visible);
+
+            index.updateLayerMemberVisibility(layerId, [](const scene::INodePtr& node)
+            {
+                return GlobalLayerSystem().updateNodeVisibility(node);
+            });
+
+            scene::UpdateNodeVisibilityWalker walker;
+            container->traverseChildren(walker);
+        }
+
+        void checkIdentical()
+        {
+            LayeredNodes nodes = getLayeredNodes(root);
+            LayeredNodes expected = getLayeredNodes(container);
+
+            BOOST_REQUIRE_EQUAL(nodes.size(), expected.size());
+
+            std::size_t numDifferent = 0;
+
+            for (std::size_t i = 0; i < nodes.size(); ++i)
+            {
+                if (nodes[i]->isLayered() != expected[i]->isLayered() ||
+                    nodes[i]->isSelected() != expected[i]->isSelected())
+                {
+                    ++numDifferent;
+                }
+            }
+
+            BOOST_CHECK_EQUAL(numDifferent, 0);
+        }
+
+        // The direct children of the given parent
+        static LayeredNodes getEntities(const scene::INodePtr& parent)
+        {
+            LayeredNodes entities;
+
+            for (const LayeredNodePtr& node : getLayeredNodes(parent))
+            {
+                if (node->getParent() == parent)
+                {
+                    entities.push_back(node);
+                }
+            }
+
+            return entities;
+        }
+
+        std::size_t countLayered()
+        {
+            std::size_t numLayered = 0;
+
+            for (const LayeredNodePtr& node : getLayeredNodes(root))
+            {
+                numLayered += node->isLayered() ? 1 : 0;
+            }
+
+            return numLayered;
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE(toggleLayersMatchesFullUpdate, LayerScenes)
+{
+    BOOST_CHECK_EQUAL(countLayered(), 0);
+
+    for (bool visible : { false, true })
+    {
+        for (int layerId = 0; layerId < NUM_LAYERS; ++layerId)
+        {
+            setLayerVisibility(layerId, visible);
+            checkIdentical();
+        }
+
+        BOOST_CHECK_EQUAL(countLayered(), visible ? 0 : getLayeredNodes(root).size());
+    }
+
+    // Hiding a layer twice doesn't change anything
+    setLayerVisibility(NUM_LAYERS / 2, false);
+    setLayerVisibility(NUM_LAYERS / 2, false);
+    checkIdentical();
+}
+
+BOOST_FIXTURE_TEST_CASE(insertedNodesAreIndexed, LayerScenes)
+{
+    setLayerVisibility(0, false);
+    BOOST_CHECK(index.isValid());
+
+    addEntity(NUM_LAYERS - 1);
+    BOOST_CHECK(!index.isValid());
+
+    std::size_t numLayered = countLayered();
+
+    setLayerVisibility(NUM_LAYERS - 1, false);
+    checkIdentical();
+
+    // The entity and its primitive are hidden, along with the other members
+    BOOST_CHECK_GE(countLayered(), numLayered + 2);
+    BOOST_CHECK(getEntities(root).back()->isLayered());
+}
+
+BOOST_FIXTURE_TEST_CASE(erasedNodesAreDropped, LayerScenes)
+{
+    setLayerVisibility(0, false);
+    BOOST_CHECK(index.isValid());
+
+    LayeredNodePtr erased = getEntities(root).front();
+    int layerId = *erased->getLayers().begin();
+
+    root->removeChildNode(erased);
+    container->removeChildNode(getEntities(container).front());
+
+    BOOST_CHECK(!index.isValid());
+    BOOST_CHECK(!erased->inScene());
+
+    setLayerVisibility(layerId, !GlobalLayerSystem().layerIsVisible(layerId));
+    checkIdentical();
+}
+
+BOOST_FIXTURE_TEST_CASE(membershipChangesAreIndexed, LayerScenes)
+{
+    setLayerVisibility(NUM_LAYERS - 1, false);
+    BOOST_CHECK(index.isValid());
+
+    // Move every other primitive into the hidden layer, the
+    // LayerSystem reports this through its membership changed signal
+    for (const scene::INodePtr& parent : { scene::INodePtr(root), scene::INodePtr(container) })
+    {
+        std::size_t i = 0;
+
+        parent->foreachNode([&](const scene::INodePtr& node)
+        {
+            if (node->getParent() != parent && i++ % 2 == 0)
+            {
+                node->moveToLayer(NUM_LAYERS - 1);
+            }
+
+            return true;
+        });
+    }
+
+    index.invalidate();
+    updateAll();
+    checkIdentical();
+
+    // Showing the layer has to reach the moved primitives, hiding their
+    // former layers must not
+    setLayerVisibility(NUM_LAYERS - 1, true);
+    checkIdentical();
+
+    for (int layerId = 0; layerId < NUM_LAYERS / 2; ++layerId)
+    {
+        setLayerVisibility(layerId, false);
+        checkIdentical();
+    }
+}
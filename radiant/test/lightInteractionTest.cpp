@@ -0,0 +1,312 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE lightInteractionTest
+#include <boost/test/unit_test.hpp>
+
+#include "radiant/render/LightInteractionIndex.h"
+#include "math/AABB.h"
+#include "math/Matrix4.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace
+{
+    const double MAP_SIZE = 16384;
+    const double OBJECT_HEIGHT = 256;
+    const double LIGHT_RADIUS = 320;
+
+    // Omni light with an axis-aligned volume
+    class BoxLight :
+        public RendererLight
+    {
+        AABB _bounds;
+        ShaderPtr _shader;
+
+    public:
+        BoxLight(const Vector3& origin, double radius) :
+            _bounds(origin, Vector3(radius, radius, radius))
+        {}
+
+        void setOrigin(const Vector3& origin)
+        {
+            _bounds.origin = origin;
+        }
+
+        void setBounds(const AABB& bounds)
+        {
+            _bounds = bounds;
+        }
+
+        float getShaderParm(int parmNum) const override { return 1.0f; }
+        const Vector3& getDirection() const override { return _bounds.extents; }
+        const ShaderPtr& getWireShader() const override { return _shader; }
+        const ShaderPtr& getShader() const override { return _shader; }
+        const Vector3& worldOrigin() const override { return _bounds.origin; }
+        Matrix4 getLightTextureTransformation() const override { return Matrix4::getIdentity(); }
+        Vector3 getLightOrigin() const override { return _bounds.origin; }
+
+        bool intersectsAABB(const AABB& other) const override
+        {
+            return other.intersects(_bounds);
+        }
+
+        AABB lightAABB() const override
+        {
+            return _bounds;
+        }
+    };
+
+    // Records the lights inserted by the light list
+    class BoxObject :
+        public LitObject
+    {
+        AABB _bounds;
+
+    public:
+        std::vector<const RendererLight*> lights;
+
+        BoxObject(const AABB& bounds) :
+            _bounds(bounds)
+        {}
+
+        bool intersectsLight(const RendererLight& light) const override
+        {
+            return light.intersectsAABB(_bounds);
+        }
+
+        const AABB& getLitObjectBounds() const override
+        {
+            return _bounds;
+        }
+
+        void insertLight(const RendererLight& light) override
+        {
+            lights.push_back(&light);
+        }
+
+        void clearLights() override
+        {
+            lights.clear();
+        }
+    };
+
+    typedef std::vector<std::unique_ptr<BoxLight>> Lights;
+    typedef std::vector<std::unique_ptr<BoxObject>> Objects;
+
+    void createMap(Lights& lights, Objects& objects, std::size_t objectsPerAxis, std::size_t lightsPerAxis)
+    {
+        double objectSpacing = MAP_SIZE / objectsPerAxis;
+        double objectSize = objectSpacing * 0.4;
+
+        for (std::size_t x = 0; x < objectsPerAxis; ++x)
+        {
+            for (std::size_t y = 0; y < objectsPerAxis; ++y)
+            {
+                Vector3 origin((x + 0.5) * objectSpacing, (y + 0.5) * objectSpacing, 0);
+                objects.emplace_back(new BoxObject(AABB(origin, Vector3(objectSize, objectSize, OBJECT_HEIGHT))));
+            }
+        }
+
+        double lightSpacing = MAP_SIZE / lightsPerAxis;
+
+        for (std::size_t x = 0; x < lightsPerAxis; ++x)
+        {
+            for (std::size_t y = 0; y < lightsPerAxis; ++y)
+            {
+                Vector3 origin((x + 0.5) * lightSpacing, (y + 0.5) * lightSpacing, 64);
+                lights.emplace_back(new BoxLight(origin, LIGHT_RADIUS));
+            }
+        }
+    }
+
+    // Position of the dragged light in the given step, diagonally across the map
+    Vector3 getDragPosition(std::size_t step, std::size_t steps)
+    {
+        double t = static_cast<double>(step) / steps;
+        return Vector3(t * MAP_SIZE, t * MAP_SIZE, 64);
+    }
+
+    // Tests every object against every light, like the former LinearLightList did
+    void updateLinear(const Lights& lights, const Objects& objects)
+    {
+        for (const auto& object : objects)
+        {
+            object->clearLights();
+
+            for (const auto& light : lights)
+            {
+                if (object->intersectsLight(*light))
+                {
+                    object->insertLight(*light);
+                }
+            }
+        }
+    }
+
+    // The lights of each object, sorted by address
+    std::vector<std::vector<const RendererLight*>> collectResults(const Objects& objects)
+    {
+        std::vector<std::vector<const RendererLight*>> results;
+
+        for (const auto& object : objects)
+        {
+            results.push_back(object->lights);
+            std::sort(results.back().begin(), results.back().end());
+        }
+
+        return results;
+    }
+
+    typedef std::vector<std::unique_ptr<render::ObjectLightList>> LightLists;
+
+    // Attaches the lights and creates a light list for each object
+    void createLightLists(render::LightInteractionIndex& index, const Lights& lights,
+                          const Objects& objects, LightLists& lightLists)
+    {
+        for (const auto& light : lights)
+        {
+            index.attachLight(*light);
+        }
+
+        for (const auto& object : objects)
+        {
+            lightLists.emplace_back(new render::ObjectLightList(*object, index));
+        }
+    }
+
+    // The interactions found by the index, compared with the linear reference
+    void checkInteractions(const LightLists& lightLists, const Lights& lights,
+                           const Objects& objects)
+    {
+        for (const auto& lightList : lightLists)
+        {
+            lightList->calculateIntersectingLights();
+        }
+
+        auto indexResults = collectResults(objects);
+
+        updateLinear(lights, objects);
+
+        BOOST_CHECK(collectResults(objects) == indexResults);
+    }
+
+    typedef render::SpatialGrid<int> Grid;
+
+    typedef std::multiset<int*> Elements;
+
+    Elements query(Grid& grid, const AABB& bounds)
+    {
+        Elements elements;
+
+        grid.forEachIntersecting(bounds, [&](int* element)
+        {
+            elements.insert(element);
+        });
+
+        return elements;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(dragLight)
+{
+    Lights lights;
+    Objects objects;
+    createMap(lights, objects, 32, 8);
+
+    render::LightInteractionIndex index;
+    LightLists lightLists;
+    createLightLists(index, lights, objects, lightLists);
+
+    checkInteractions(lightLists, lights, objects);
+
+    BoxLight& dragged = *lights.front();
+    const std::size_t steps = 40;
+
+    for (std::size_t step = 0; step <= steps; ++step)
+    {
+        dragged.setOrigin(getDragPosition(step, steps));
+        index.lightChanged(dragged);
+
+        checkInteractions(lightLists, lights, objects);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(growAndDetachLight)
+{
+    Lights lights;
+    Objects objects;
+    createMap(lights, objects, 16, 4);
+
+    render::LightInteractionIndex index;
+    LightLists lightLists;
+    createLightLists(index, lights, objects, lightLists);
+
+    checkInteractions(lightLists, lights, objects);
+
+    // Covering the whole map, the grid keeps such lights apart
+    BoxLight& light = *lights.back();
+    light.setBounds(AABB(Vector3(MAP_SIZE / 2, MAP_SIZE / 2, 0), Vector3(MAP_SIZE, MAP_SIZE, MAP_SIZE)));
+    index.lightChanged(light);
+
+    checkInteractions(lightLists, lights, objects);
+
+    for (const auto& object : objects)
+    {
+        BOOST_CHECK(std::find(object->lights.begin(), object->lights.end(), &light) != object->lights.end());
+    }
+
+    // And back to a small one
+    light.setBounds(AABB(Vector3(100, 100, 0), Vector3(LIGHT_RADIUS, LIGHT_RADIUS, LIGHT_RADIUS)));
+    index.lightChanged(light);
+
+    checkInteractions(lightLists, lights, objects);
+
+    index.detachLight(light);
+    lights.pop_back();
+
+    checkInteractions(lightLists, lights, objects);
+    BOOST_CHECK_EQUAL(index.getNumLights(), lights.size());
+}
+
+BOOST_AUTO_TEST_CASE(oversizedElements)
+{
+    Grid grid(64, 8);
+
+    int small = 0;
+    int large = 1;
+    int infinite = 2;
+    int invalid = 3;
+
+    grid.insert(&small, AABB(Vector3(0, 0, 0), Vector3(16, 16, 16)));
+    grid.insert(&large, AABB(Vector3(1024, 0, 0), Vector3(512, 512, 512)));
+    grid.insert(&infinite, AABB::createInfinite());
+    grid.insert(&invalid, AABB(Vector3(NAN, 0, 0), Vector3(16, 16, 16)));
+
+    // Oversized elements are only visited if their bounds intersect
+    Elements expected = { &small, &infinite, &invalid };
+    BOOST_CHECK(query(grid, AABB(Vector3(0, 0, 0), Vector3(32, 32, 32))) == expected);
+
+    expected = { &large, &infinite, &invalid };
+    BOOST_CHECK(query(grid, AABB(Vector3(1024, 0, 0), Vector3(32, 32, 32))) == expected);
+
+    // Query bounds covering many cells
+    expected = { &small, &large, &infinite, &invalid };
+    BOOST_CHECK(query(grid, AABB(Vector3(0, 0, 0), Vector3(2048, 2048, 2048))) == expected);
+    BOOST_CHECK(query(grid, AABB()) == expected);
+
+    // Moving an element out of the oversized list and back
+    grid.insert(&large, AABB(Vector3(0, 0, 0), Vector3(8, 8, 8)));
+
+    expected = { &small, &large, &infinite, &invalid };
+    BOOST_CHECK(query(grid, AABB(Vector3(0, 0, 0), Vector3(32, 32, 32))) == expected);
+
+    grid.insert(&large, AABB(Vector3(1024, 0, 0), Vector3(512, 512, 512)));
+    grid.erase(&infinite);
+
+    expected = { &small, &invalid };
+    BOOST_CHECK(query(grid, AABB(Vector3(0, 0, 0), Vector3(32, 32, 32))) == expected);
+    BOOST_CHECK_EQUAL(grid.size(), 3);
+}
@@ -0,0 +1,178 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE namespaceTest
+#include <boost/test/unit_test.hpp>
+
+#include "namespace/UniqueNameSet.h"
+
+#include <climits>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Numbered entity names, along with the postfix search the UniqueNameSet
+    // used before the PostfixSet
+    const char* const PREFIXES[] =
+    {
+        "func_static_", "light_", "speaker_", "atdm_ai_guard_", "info_player_start_"
+    };
+
+    // Postfix lookup as it was done before the PostfixSet
+    class LinearNameSet
+    {
+        typedef std::map<std::string, std::set<int> > Names;
+        Names _names;
+
+    public:
+        void insert(const ComplexName& name)
+        {
+            _names[name.getNameWithoutPostfix()].insert(name.getPostfix());
+        }
+
+        std::string insertUnique(const ComplexName& name)
+        {
+            std::set<int>& postfixes = _names[name.getNameWithoutPostfix()];
+            int postfix = name.getPostfix();
+
+            if (postfixes.find(postfix) != postfixes.end())
+            {
+                for (postfix = 1; postfix < INT_MAX && postfixes.find(postfix) != postfixes.end(); ++postfix);
+            }
+
+            postfixes.insert(postfix);
+
+            return name.getNameWithoutPostfix() + std::to_string(postfix);
+        }
+    };
+
+    // func_static_1, light_1, ..., func_static_2, light_2, ...
+    std::vector<std::string> createNames(std::size_t numEntities)
+    {
+        std::vector<std::string> names;
+
+        for (std::size_t i = 0; i < numEntities; ++i)
+        {
+            names.push_back(PREFIXES[i % 5] + std::to_string(i / 5 + 1));
+        }
+
+        return names;
+    }
+
+    // Pastes a copy of the given names into a set already containing them,
+    // returns the names handed out to the pasted copies
+    template<typename NameSet>
+    std::vector<std::string> paste(NameSet& nameSet, const std::vector<std::string>& names)
+    {
+        std::vector<std::string> pastedNames;
+
+        for (const std::string& name : names)
+        {
+            pastedNames.push_back(nameSet.insertUnique(name));
+        }
+
+        return pastedNames;
+    }
+
+    template<typename NameSet>
+    void fill(NameSet& nameSet, const std::vector<std::string>& names)
+    {
+        for (const std::string& name : names)
+        {
+            nameSet.insert(name);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(firstUnusedPostfix)
+{
+    PostfixSet postfixes;
+    BOOST_CHECK_EQUAL(postfixes.getFirstUnused(), 1);
+
+    // Postfixes out of the consecutive run don't move the first unused one
+    postfixes.insert(3);
+    postfixes.insert(-1);
+    BOOST_CHECK_EQUAL(postfixes.getFirstUnused(), 1);
+
+    // Filling the gap skips the postfixes used after it
+    postfixes.insert(1);
+    postfixes.insert(2);
+    BOOST_CHECK_EQUAL(postfixes.getFirstUnused(), 4);
+
+    BOOST_CHECK(!postfixes.insert(2));
+    BOOST_CHECK_EQUAL(postfixes.getFirstUnused(), 4);
+
+    // Erasing opens a gap below, erasing above doesn't
+    postfixes.erase(3);
+    BOOST_CHECK_EQUAL(postfixes.getFirstUnused(), 3);
+
+    postfixes.erase(2);
+    BOOST_CHECK_EQUAL(postfixes.getFirstUnused(), 2);
+
+    postfixes.erase(-1);
+    BOOST_CHECK(!postfixes.erase(5));
+    BOOST_CHECK_EQUAL(postfixes.getFirstUnused(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(mergedPostfixes)
+{
+    PostfixSet postfixes;
+    postfixes.insert(1);
+    postfixes.insert(4);
+
+    PostfixSet other;
+    other.insert(2);
+    other.insert(3);
+    other.insert(6);
+
+    postfixes.insert(other);
+    BOOST_CHECK_EQUAL(postfixes.getFirstUnused(), 5);
+
+    // The merge is a union, both sets contain the postfix 1 now
+    other.insert(1);
+    postfixes.insert(other);
+    BOOST_CHECK_EQUAL(postfixes.getFirstUnused(), 5);
+}
+
+BOOST_AUTO_TEST_CASE(pastedNamesMatchLinearSearch)
+{
+    std::vector<std::string> names = createNames(2000);
+
+    LinearNameSet linear;
+    UniqueNameSet unique;
+
+    fill(linear, names);
+    fill(unique, names);
+
+    // Paste twice, the second time the names handed out to the first copies
+    // are taken as well
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+        std::vector<std::string> expected = paste(linear, names);
+        std::vector<std::string> pastedNames = paste(unique, names);
+
+        BOOST_CHECK(expected == pastedNames);
+    }
+
+    BOOST_CHECK_EQUAL(paste(unique, { "func_static_1" }).front(), "func_static_1201");
+}
+
+BOOST_AUTO_TEST_CASE(pastedNamesFillGaps)
+{
+    UniqueNameSet unique;
+    fill(unique, { "light_1", "light_2", "light_4" });
+
+    BOOST_CHECK(unique.erase(ComplexName("light_2")));
+
+    std::vector<std::string> expected = { "light_2", "light_3", "light_5", "light_6" };
+    BOOST_CHECK(paste(unique, { "light_1", "light_1", "light_4", "light_2" }) == expected);
+
+    // The names of another namespace are taken into account after a merge
+    UniqueNameSet other;
+    fill(other, { "light_7", "light_8" });
+
+    unique.merge(other);
+    BOOST_CHECK_EQUAL(paste(unique, { "light_1" }).front(), "light_9");
+    BOOST_CHECK(unique.nameExists("light_8"));
+}
@@ -0,0 +1,314 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE patchTesselationTest
+#include <boost/test/unit_test.hpp>
+
+#include "radiant/patch/PatchTesselation.h"
+#include "radiant/patch/TesselationScheduler.h"
+
+#include <cmath>
+
+namespace
+{
+    // Deterministic pseudo-random numbers in [0..1)
+    double random(std::size_t& seed)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>((seed >> 11) & 0xfffff) / 0x100000;
+    }
+
+    // A bent pipe section, curved in both directions
+    PatchControlArray createControlPoints(std::size_t width, std::size_t height)
+    {
+        PatchControlArray controlPoints(width * height);
+
+        for (std::size_t h = 0; h < height; ++h)
+        {
+            for (std::size_t w = 0; w < width; ++w)
+            {
+                double angle = M_PI * w / (width - 1);
+                double radius = 64 + 16 * std::sin(M_PI * h / (height - 1));
+
+                PatchControl& control = controlPoints[h * width + w];
+                control.vertex = Vector3(std::cos(angle) * radius, std::sin(angle) * radius, h * 32.0);
+                control.texcoord = Vector2(w * 0.25, h * 0.5);
+            }
+        }
+
+        return controlPoints;
+    }
+
+    // The scalar evaluation of a single sample point PatchTesselation used to perform
+    void sampleSinglePatchPoint(const ArbitraryMeshVertex ctrl[3][3], float u, float v, ArbitraryMeshVertex& out)
+    {
+        float vCtrl[3][8];
+
+        for (std::size_t vPoint = 0; vPoint < 3; vPoint++)
+        {
+            for (std::size_t axis = 0; axis < 8; axis++)
+            {
+                float a, b, c;
+
+                if (axis < 3)
+                {
+                    a = ctrl[0][vPoint].vertex[axis];
+                    b = ctrl[1][vPoint].vertex[axis];
+                    c = ctrl[2][vPoint].vertex[axis];
+                }
+                else if (axis < 6)
+                {
+                    a = ctrl[0][vPoint].normal[axis - 3];
+                    b = ctrl[1][vPoint].normal[axis - 3];
+                    c = ctrl[2][vPoint].normal[axis - 3];
+                }
+                else
+                {
+                    a = ctrl[0][vPoint].texcoord[axis - 6];
+                    b = ctrl[1][vPoint].texcoord[axis - 6];
+                    c = ctrl[2][vPoint].texcoord[axis - 6];
+                }
+
+                float qA = a - 2.0f * b + c;
+                float qB = 2.0f * b - 2.0f * a;
+                float qC = a;
+
+                vCtrl[vPoint][axis] = qA * u * u + qB * u + qC;
+            }
+        }
+
+        for (std::size_t axis = 0; axis < 8; axis++)
+        {
+            float a = vCtrl[0][axis];
+            float b = vCtrl[1][axis];
+            float c = vCtrl[2][axis];
+            float qA = a - 2.0f * b + c;
+            float qB = 2.0f * b - 2.0f * a;
+            float qC = a;
+
+            if (axis < 3)
+            {
+                out.vertex[axis] = qA * v * v + qB * v + qC;
+            }
+            else if (axis < 6)
+            {
+                out.normal[axis - 3] = qA * v * v + qB * v + qC;
+            }
+            else
+            {
+                out.texcoord[axis - 6] = qA * v * v + qB * v + qC;
+            }
+        }
+    }
+
+    // Tesselates its control points when the scheduler asks for it
+    class TesselationJob :
+        public patch::TesselationScheduler::Job
+    {
+    public:
+        PatchControlArray controlPoints;
+        PatchTesselation tess;
+
+        void generateTesselation() override
+        {
+            tess.generate(9, 7, controlPoints, false, Subdivisions(0, 0));
+        }
+    };
+
+    void checkIdentical(const PatchTesselation& expected, const PatchTesselation& tess)
+    {
+        BOOST_REQUIRE_EQUAL(expected.width, tess.width);
+        BOOST_REQUIRE_EQUAL(expected.height, tess.height);
+        BOOST_REQUIRE_EQUAL(expected.numStrips, tess.numStrips);
+        BOOST_REQUIRE_EQUAL(expected.lenStrips, tess.lenStrips);
+        BOOST_REQUIRE(expected.indices == tess.indices);
+        BOOST_REQUIRE_EQUAL(expected.vertices.size(), tess.vertices.size());
+
+        for (std::size_t i = 0; i < expected.vertices.size(); ++i)
+        {
+            const ArbitraryMeshVertex& a = expected.vertices[i];
+            const ArbitraryMeshVertex& b = tess.vertices[i];
+
+            BOOST_REQUIRE_MESSAGE(a.vertex == b.vertex && a.normal == b.normal &&
+                a.texcoord == b.texcoord && a.tangent == b.tangent && a.bitangent == b.bitangent,
+                "Vertex " << i << " differs");
+        }
+    }
+}
+
+// Moving single control points updates the affected sub-patches only,
+// the result must be the same as tesselating the whole patch again
+BOOST_AUTO_TEST_CASE(fixedSubdivisionUpdate)
+{
+    const std::size_t width = 15;
+    const std::size_t height = 9;
+    const Subdivisions subdivs(4, 6);
+
+    PatchControlArray controlPoints = createControlPoints(width, height);
+
+    PatchTesselation tess;
+    tess.generate(width, height, controlPoints, true, subdivs);
+
+    std::size_t seed = 1;
+
+    for (std::size_t step = 0; step < 40; ++step)
+    {
+        // Corners, borders between sub-patches and interior points
+        std::size_t index = static_cast<std::size_t>(random(seed) * controlPoints.size());
+
+        controlPoints[index].vertex += Vector3(random(seed) - 0.5, random(seed) - 0.5, random(seed) - 0.5) * 24;
+
+        if (step % 5 == 0)
+        {
+            controlPoints[index].texcoord += Vector2(0.125, -0.25);
+        }
+
+        tess.generate(width, height, controlPoints, true, subdivs);
+
+        PatchTesselation expected;
+        expected.generate(width, height, controlPoints, true, subdivs);
+
+        checkIdentical(expected, tess);
+    }
+
+    // Flatten the patch completely, which changes all normals at once
+    for (PatchControl& control : controlPoints)
+    {
+        control.vertex.z() = 0;
+    }
+
+    tess.generate(width, height, controlPoints, true, subdivs);
+
+    PatchTesselation expected;
+    expected.generate(width, height, controlPoints, true, subdivs);
+
+    checkIdentical(expected, tess);
+}
+
+// Changing the subdivisions or the dimensions tesselates the whole patch
+BOOST_AUTO_TEST_CASE(fixedSubdivisionChange)
+{
+    PatchControlArray controlPoints = createControlPoints(5, 7);
+
+    PatchTesselation tess;
+    tess.generate(5, 7, controlPoints, true, Subdivisions(3, 3));
+    tess.generate(5, 7, controlPoints, true, Subdivisions(2, 5));
+
+    PatchTesselation expected;
+    expected.generate(5, 7, controlPoints, true, Subdivisions(2, 5));
+    checkIdentical(expected, tess);
+
+    BOOST_CHECK_EQUAL(tess.width, 5u);
+    BOOST_CHECK_EQUAL(tess.height, 16u);
+
+    controlPoints = createControlPoints(7, 5);
+    tess.generate(7, 5, controlPoints, true, Subdivisions(2, 5));
+
+    PatchTesselation expectedResized;
+    expectedResized.generate(7, 5, controlPoints, true, Subdivisions(2, 5));
+    checkIdentical(expectedResized, tess);
+}
+
+// Identical patches are taken from the cache
+BOOST_AUTO_TEST_CASE(sharedTesselation)
+{
+    PatchControlArray controlPoints = createControlPoints(9, 9);
+
+    PatchTesselation first;
+    first.generate(9, 9, controlPoints, false, Subdivisions(0, 0));
+
+    PatchTesselation second;
+    second.generate(9, 9, controlPoints, false, Subdivisions(0, 0));
+
+    checkIdentical(first, second);
+
+    // A slightly different patch must not use the cached mesh
+    controlPoints[40].vertex += Vector3(0, 0, 48);
+
+    PatchTesselation moved;
+    moved.generate(9, 9, controlPoints, false, Subdivisions(0, 0));
+
+    BOOST_CHECK(!(moved.vertices[moved.vertices.size() / 2].vertex == first.vertices[first.vertices.size() / 2].vertex));
+}
+
+// The sub-patch evaluation must produce exactly the values of the per-point evaluation
+BOOST_AUTO_TEST_CASE(sampleSubPatch)
+{
+    std::size_t seed = 7;
+
+    for (std::size_t pass = 0; pass < 50; ++pass)
+    {
+        ArbitraryMeshVertex ctrl[3][3];
+
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            for (std::size_t l = 0; l < 3; ++l)
+            {
+                ctrl[k][l].vertex = Vector3(random(seed) - 0.5, random(seed) - 0.5, random(seed) - 0.5) * 8192;
+                ctrl[k][l].normal = Vector3(random(seed) - 0.5, random(seed) - 0.5, random(seed) - 0.5).getNormalised();
+                ctrl[k][l].texcoord = Vector2(random(seed) * 16 - 8, random(seed) * 16 - 8);
+            }
+        }
+
+        std::size_t horzSub = 1 + pass % 16;
+        std::size_t vertSub = 1 + (pass * 7) % 32;
+
+        std::vector<ArbitraryMeshVertex> samples((horzSub + 1) * (vertSub + 1));
+        PatchTesselation::sampleSubPatch(ctrl, horzSub, vertSub, horzSub + 1, vertSub + 1, &samples.front(), horzSub + 1);
+
+        for (std::size_t i = 0; i <= horzSub; ++i)
+        {
+            for (std::size_t j = 0; j <= vertSub; ++j)
+            {
+                ArbitraryMeshVertex expected;
+                sampleSinglePatchPoint(ctrl, static_cast<float>(i) / horzSub, static_cast<float>(j) / vertSub, expected);
+
+                const ArbitraryMeshVertex& sample = samples[j * (horzSub + 1) + i];
+
+                BOOST_REQUIRE(expected.vertex == sample.vertex);
+                BOOST_REQUIRE(expected.normal == sample.normal);
+                BOOST_REQUIRE(expected.texcoord == sample.texcoord);
+            }
+        }
+    }
+}
+
+// Meshes generated by the scheduler's worker threads are the same as generated one by one
+BOOST_AUTO_TEST_CASE(parallelTesselation)
+{
+    std::vector<TesselationJob> jobs(100);
+    std::size_t seed = 3;
+
+    for (TesselationJob& job : jobs)
+    {
+        job.controlPoints = createControlPoints(9, 7);
+
+        for (PatchControl& control : job.controlPoints)
+        {
+            control.vertex += Vector3(random(seed), random(seed), random(seed)) * 32;
+        }
+    }
+
+    patch::TesselationScheduler scheduler;
+    scheduler.setNumThreads(4);
+
+    for (TesselationJob& job : jobs)
+    {
+        scheduler.schedule(job);
+    }
+
+    scheduler.cancel(jobs[10]);
+    BOOST_CHECK_EQUAL(scheduler.size(), jobs.size() - 1);
+
+    scheduler.flush();
+    BOOST_CHECK_EQUAL(scheduler.size(), 0u);
+    BOOST_CHECK(jobs[10].tess.vertices.empty());
+
+    for (std::size_t i = 0; i < jobs.size(); ++i)
+    {
+        if (i == 10) continue;
+
+        PatchTesselation expected;
+        expected.generate(9, 7, jobs[i].controlPoints, false, Subdivisions(0, 0));
+
+        checkIdentical(expected, jobs[i].tess);
+    }
+}
@@ -0,0 +1,480 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE renderBackendTest
+#include <boost/test/unit_test.hpp>
+
+#include "render/OpenGLRenderSystem.h"
+#include "render/backend/RecordingRenderBackend.h"
+#include "render/backend/OpenGLShader.h"
+#include "render/backend/GeometryBatch.h"
+#include "iglprogram.h"
+#include "math/AABB.h"
+#include "math/Matrix4.h"
+#include "TestModules.h"
+
+#include <type_traits>
+
+using namespace render;
+
+namespace
+{
+    // The flags allowed by a lit camera view
+    const unsigned int GLOBAL_STATE = RENDER_FILL | RENDER_TEXTURE_2D | RENDER_BUMP | RENDER_PROGRAM;
+
+    // Renderable drawn one by one
+    class TestRenderable :
+        public OpenGLRenderable
+    {
+    public:
+        void render(const RenderInfo& info) const override
+        {}
+    };
+
+    // Polygon with the given number of vertices, drawn through the geometry
+    // batch of its shader if it's not transformed
+    class TestPolygon :
+        public OpenGLRenderable,
+        public BatchableRenderable
+    {
+        std::size_t _numVertices;
+        std::size_t _revision;
+
+    public:
+        TestPolygon(std::size_t numVertices, std::size_t revision) :
+            _numVertices(numVertices),
+            _revision(revision)
+        {}
+
+        void render(const RenderInfo& info) const override
+        {}
+
+        const BatchableRenderable* getBatchable() const override
+        {
+            return this;
+        }
+
+        std::size_t getGeometryRevision() const override
+        {
+            return _revision;
+        }
+
+        std::size_t getNumBatchVertices() const override
+        {
+            return _numVertices;
+        }
+
+        void writeBatchVertices(BatchVertex* vertices) const override
+        {
+            for (std::size_t i = 0; i < _numVertices; ++i)
+            {
+                vertices[i] = BatchVertex();
+                vertices[i].vertex[0] = static_cast<float>(i);
+            }
+        }
+    };
+
+    // Counts the calls, the recording backend must not enable the program
+    class TestProgram :
+        public GLProgram
+    {
+    public:
+        std::size_t numEnabled = 0;
+        std::size_t numParams = 0;
+
+        void create() override {}
+        void destroy() override {}
+        void enable() override { ++numEnabled; }
+        void disable() override {}
+
+        void applyRenderParams(const Vector3& viewer, const Matrix4& localToWorld,
+                               const Params& lightParms) override
+        {
+            ++numParams;
+        }
+    };
+
+    class TestEntity :
+        public virtual IRenderEntity
+    {
+        Vector3 _direction;
+        ShaderPtr _wireShader;
+
+    public:
+        float getShaderParm(int parmNum) const override { return 1.0f; }
+        const Vector3& getDirection() const override { return _direction; }
+        const ShaderPtr& getWireShader() const override { return _wireShader; }
+    };
+
+    class TestLight :
+        public RendererLight,
+        public TestEntity
+    {
+        AABB _bounds;
+        ShaderPtr _shader;
+
+    public:
+        const ShaderPtr& getShader() const override { return _shader; }
+        const Vector3& worldOrigin() const override { return _bounds.origin; }
+        Matrix4 getLightTextureTransformation() const override { return Matrix4::getIdentity(); }
+        bool intersectsAABB(const AABB& aabb) const override { return true; }
+        AABB lightAABB() const override { return _bounds; }
+        Vector3 getLightOrigin() const override { return _bounds.origin; }
+    };
+
+    // Batching depends on a registry key, the CachedKey of the shader
+    // passes reads it on first use
+    void enableBatching()
+    {
+        test::TestModuleRegistry& registry = test::TestModuleRegistry::Instance();
+
+        if (registry.moduleExists(MODULE_XMLREGISTRY)) return;
+
+        auto xmlRegistry = std::make_shared<test::TestRegistry>();
+        xmlRegistry->set(RKEY_BATCH_BRUSH_FACES, "1");
+
+        registry.registerModule(xmlRegistry);
+    }
+
+    // A shader with a single pass, rendered like OpenGLRenderSystem::render()
+    // renders its sorted passes
+    struct ShaderPass
+    {
+        // The passes never reach the render system through their shader,
+        // it is not constructed
+        std::aligned_storage<sizeof(OpenGLRenderSystem), alignof(OpenGLRenderSystem)>::type renderSystem;
+
+        OpenGLShader shader;
+        OpenGLShaderPass pass;
+
+        Matrix4 translation;
+        Matrix4 otherTranslation;
+
+        ShaderPass() :
+            shader(reinterpret_cast<OpenGLRenderSystem&>(renderSystem)),
+            pass(shader),
+            translation(Matrix4::getTranslation(Vector3(64, 0, 0))),
+            otherTranslation(Matrix4::getTranslation(Vector3(0, 64, 0)))
+        {
+            enableBatching();
+
+            pass.state().setRenderFlags(RENDER_FILL | RENDER_TEXTURE_2D);
+            pass.state().setSortPosition(OpenGLState::SORT_FULLBRIGHT);
+        }
+
+        // Turns this into an interaction pass using the given program
+        void setProgram(GLProgram& program)
+        {
+            pass.state().setRenderFlags(RENDER_PROGRAM | RENDER_BUMP | RENDER_FILL | RENDER_TEXTURE_2D);
+            pass.state().setSortPosition(OpenGLState::SORT_INTERACTION);
+            pass.state().glProgram = &program;
+        }
+    };
+
+    void renderFrame(RenderBackend& backend,
+                     const std::vector<OpenGLShaderPass*>& passes,
+                     unsigned int flagsMask = GLOBAL_STATE)
+    {
+        OpenGLState current;
+        const Matrix4& identity = Matrix4::getIdentity();
+
+        backend.beginFrame(current, flagsMask, identity, identity);
+
+        for (OpenGLShaderPass* pass : passes)
+        {
+            if (!pass->empty())
+            {
+                pass->render(backend, current, flagsMask, Vector3(0, 0, 0), 0);
+            }
+        }
+
+        backend.endFrame();
+    }
+
+    void checkCommandTypes(const RenderCommandList& commands,
+                           const std::vector<RenderCommand::Type>& expected)
+    {
+        BOOST_REQUIRE_EQUAL(commands.size(), expected.size());
+
+        for (std::size_t i = 0; i < commands.size(); ++i)
+        {
+            BOOST_CHECK_EQUAL(commands[i].type, expected[i]);
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(recordUnlitPass, ShaderPass)
+{
+    TestRenderable first;
+    TestRenderable second;
+    TestRenderable third;
+
+    TestPolygon triangle(3, 1);
+    TestPolygon quad(4, 2);
+    TestPolygon empty(0, 3);
+
+    // The first two share their transform, the polygons are batched
+    pass.addRenderable(first, translation);
+    pass.addRenderable(triangle, Matrix4::getIdentity());
+    pass.addRenderable(second, translation);
+    pass.addRenderable(empty, Matrix4::getIdentity());
+    pass.addRenderable(third, otherTranslation);
+    pass.addRenderable(quad, Matrix4::getIdentity());
+
+    RecordingRenderBackend backend;
+    renderFrame(backend, { &pass });
+
+    const RenderCommandList& commands = backend.getCommands();
+
+    checkCommandTypes(commands,
+    {
+        RenderCommand::Frame, RenderCommand::Pass, RenderCommand::State,
+        RenderCommand::Transform, RenderCommand::Draw, RenderCommand::Draw,
+        RenderCommand::Transform, RenderCommand::Draw,
+        RenderCommand::Transform, RenderCommand::Batch,
+    });
+
+    const unsigned int flags = RENDER_FILL | RENDER_TEXTURE_2D;
+
+    BOOST_CHECK_EQUAL(commands[0].renderFlags, GLOBAL_STATE);
+
+    BOOST_CHECK_EQUAL(commands[1].object, &pass);
+    BOOST_CHECK_EQUAL(commands[1].sortPosition, OpenGLState::SORT_FULLBRIGHT);
+    BOOST_CHECK_EQUAL(commands[2].renderFlags, flags);
+
+    // The renderables are recorded in submission order, in the state of the pass
+    BOOST_CHECK_EQUAL(commands[3].object, &translation);
+    BOOST_CHECK_EQUAL(commands[4].object, &first);
+    BOOST_CHECK_EQUAL(commands[5].object, &second);
+    BOOST_CHECK_EQUAL(commands[6].object, &otherTranslation);
+    BOOST_CHECK_EQUAL(commands[7].object, &third);
+    BOOST_CHECK_EQUAL(commands[7].renderFlags, flags);
+
+    // Polygons without vertices are not drawn
+    BOOST_CHECK_EQUAL(commands[8].object, &Matrix4::getIdentity());
+    BOOST_CHECK_EQUAL(commands[9].object, &shader.getGeometryBatch());
+    BOOST_CHECK_EQUAL(commands[9].renderFlags, flags);
+    BOOST_CHECK_EQUAL(commands[9].count, 2);
+
+    const RecordingRenderBackend::Totals& totals = backend.getTotals();
+
+    BOOST_CHECK_EQUAL(totals.frames, 1);
+    BOOST_CHECK_EQUAL(totals.passes, 1);
+    BOOST_CHECK_EQUAL(totals.stateChanges, 1);
+    BOOST_CHECK_EQUAL(totals.transforms, 3);
+    BOOST_CHECK_EQUAL(totals.lights, 0);
+    BOOST_CHECK_EQUAL(totals.draws, 3);
+    BOOST_CHECK_EQUAL(totals.batches, 1);
+    BOOST_CHECK_EQUAL(totals.batchedPolygons, 2);
+    BOOST_CHECK_EQUAL(totals.batchedVertices, 7);
+
+    // The pass is empty after rendering
+    BOOST_CHECK(pass.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(recordLitPass, ShaderPass)
+{
+    TestProgram program;
+    setProgram(program);
+
+    TestLight red;
+    TestLight blue;
+
+    TestRenderable first;
+    TestRenderable second;
+    TestPolygon triangle(3, 1);
+    TestPolygon quad(4, 2);
+
+    pass.addRenderable(first, translation, &red);
+    pass.addRenderable(second, translation, &blue);
+    pass.addRenderable(triangle, Matrix4::getIdentity(), &red);
+    pass.addRenderable(quad, Matrix4::getIdentity(), &blue);
+
+    RecordingRenderBackend backend;
+    renderFrame(backend, { &pass });
+
+    const RenderCommandList& commands = backend.getCommands();
+
+    // Each renderable and each batch is drawn after setting up its light
+    checkCommandTypes(commands,
+    {
+        RenderCommand::Frame, RenderCommand::Pass, RenderCommand::State,
+        RenderCommand::Transform,
+        RenderCommand::Light, RenderCommand::Draw,
+        RenderCommand::Light, RenderCommand::Draw,
+        RenderCommand::Transform,
+        RenderCommand::Light, RenderCommand::Batch,
+        RenderCommand::Light, RenderCommand::Batch,
+    });
+
+    BOOST_CHECK_EQUAL(commands[1].sortPosition, OpenGLState::SORT_INTERACTION);
+    BOOST_CHECK_EQUAL(commands[2].renderFlags, RENDER_PROGRAM | RENDER_BUMP | RENDER_FILL | RENDER_TEXTURE_2D);
+
+    BOOST_CHECK_EQUAL(commands[4].object, static_cast<const RendererLight*>(&red));
+    BOOST_CHECK_EQUAL(commands[5].object, &first);
+    BOOST_CHECK_EQUAL(commands[6].object, static_cast<const RendererLight*>(&blue));
+    BOOST_CHECK_EQUAL(commands[7].object, &second);
+    BOOST_CHECK_EQUAL(commands[9].object, static_cast<const RendererLight*>(&red));
+    BOOST_CHECK_EQUAL(commands[10].count, 1);
+    BOOST_CHECK_EQUAL(commands[11].object, static_cast<const RendererLight*>(&blue));
+    BOOST_CHECK_EQUAL(commands[12].count, 1);
+
+    const RecordingRenderBackend::Totals& totals = backend.getTotals();
+
+    BOOST_CHECK_EQUAL(totals.lights, 4);
+    BOOST_CHECK_EQUAL(totals.draws, 2);
+    BOOST_CHECK_EQUAL(totals.batches, 2);
+    BOOST_CHECK_EQUAL(totals.batchedVertices, 7);
+
+    // Nothing is submitted to the program
+    BOOST_CHECK_EQUAL(program.numEnabled, 0);
+    BOOST_CHECK_EQUAL(program.numParams, 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(skipLightsWithoutProgram, ShaderPass)
+{
+    TestProgram program;
+    setProgram(program);
+
+    ShaderPass fullbright;
+
+    TestLight light;
+    TestRenderable lit;
+    TestRenderable unlit;
+
+    // Without the program flag in the mask, the interaction pass is not lit
+    pass.addRenderable(lit, translation, &light);
+
+    RecordingRenderBackend backend;
+    renderFrame(backend, { &pass }, GLOBAL_STATE & ~RENDER_PROGRAM);
+
+    BOOST_CHECK_EQUAL(backend.getTotals().draws, 1);
+    BOOST_CHECK_EQUAL(backend.getTotals().lights, 0);
+
+    // A pass without program following a lit one doesn't set up lights
+    backend.clear();
+
+    pass.addRenderable(lit, translation, &light);
+    fullbright.pass.addRenderable(unlit, translation, &light);
+
+    renderFrame(backend, { &pass, &fullbright.pass });
+
+    checkCommandTypes(backend.getCommands(),
+    {
+        RenderCommand::Frame,
+        RenderCommand::Pass, RenderCommand::State,
+        RenderCommand::Transform, RenderCommand::Light, RenderCommand::Draw,
+        RenderCommand::Transform,
+        RenderCommand::Pass, RenderCommand::State,
+        RenderCommand::Transform, RenderCommand::Draw,
+        RenderCommand::Transform,
+    });
+
+    BOOST_CHECK_EQUAL(backend.getTotals().lights, 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(applyStatePerEntity, ShaderPass)
+{
+    TestEntity entity;
+    TestRenderable withEntity;
+    TestRenderable withoutEntity;
+
+    pass.addRenderable(withEntity, translation, entity);
+    pass.addRenderable(withoutEntity, otherTranslation);
+
+    RecordingRenderBackend backend;
+    renderFrame(backend, { &pass });
+
+    const RenderCommandList& commands = backend.getCommands();
+
+    // The renderables without entity go first, the state is evaluated again
+    // for each entity
+    checkCommandTypes(commands,
+    {
+        RenderCommand::Frame, RenderCommand::Pass, RenderCommand::State,
+        RenderCommand::Transform, RenderCommand::Draw, RenderCommand::Transform,
+        RenderCommand::State,
+        RenderCommand::Transform, RenderCommand::Draw, RenderCommand::Transform,
+    });
+
+    BOOST_CHECK_EQUAL(commands[4].object, &withoutEntity);
+    BOOST_CHECK_EQUAL(commands[8].object, &withEntity);
+    BOOST_CHECK_EQUAL(backend.getTotals().stateChanges, 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(accumulateFrames, ShaderPass)
+{
+    TestRenderable renderable;
+    TestPolygon triangle(3, 1);
+    TestPolygon quad(4, 2);
+
+    RecordingRenderBackend backend;
+
+    pass.addRenderable(renderable, translation);
+    pass.addRenderable(triangle, Matrix4::getIdentity());
+    pass.addRenderable(quad, Matrix4::getIdentity());
+    renderFrame(backend, { &pass });
+
+    // The triangle is reused from the first frame, the pentagon is added
+    TestPolygon pentagon(5, 4);
+
+    pass.addRenderable(renderable, translation);
+    pass.addRenderable(triangle, Matrix4::getIdentity());
+    pass.addRenderable(pentagon, Matrix4::getIdentity());
+    renderFrame(backend, { &pass });
+
+    // Nothing is left to render in the third frame
+    renderFrame(backend, { &pass });
+
+    const RecordingRenderBackend::Totals& totals = backend.getTotals();
+
+    BOOST_CHECK_EQUAL(backend.getCommands().size(), 15);
+    BOOST_CHECK_EQUAL(totals.frames, 3);
+    BOOST_CHECK_EQUAL(totals.passes, 2);
+    BOOST_CHECK_EQUAL(totals.draws, 2);
+    BOOST_CHECK_EQUAL(totals.batches, 2);
+    BOOST_CHECK_EQUAL(totals.batchedPolygons, 4);
+    BOOST_CHECK_EQUAL(totals.batchedVertices, 15);
+    BOOST_CHECK_EQUAL(shader.getGeometryBatch().size(), 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(skipEmptyBatches, ShaderPass)
+{
+    TestPolygon empty(0, 1);
+
+    RecordingRenderBackend backend;
+
+    pass.addRenderable(empty, Matrix4::getIdentity());
+    renderFrame(backend, { &pass });
+
+    const RecordingRenderBackend::Totals& totals = backend.getTotals();
+
+    BOOST_CHECK_EQUAL(totals.passes, 1);
+    BOOST_CHECK_EQUAL(totals.batches, 0);
+    BOOST_CHECK_EQUAL(totals.batchedPolygons, 0);
+
+    for (const RenderCommand& command : backend.getCommands())
+    {
+        BOOST_CHECK_NE(command.type, RenderCommand::Batch);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(totalsOnlyAndClear, ShaderPass)
+{
+    TestRenderable renderable;
+    TestPolygon quad(4, 1);
+
+    RecordingRenderBackend backend(false);
+
+    pass.addRenderable(renderable, translation);
+    pass.addRenderable(quad, Matrix4::getIdentity());
+    renderFrame(backend, { &pass });
+
+    BOOST_CHECK(backend.getCommands().empty());
+    BOOST_CHECK_EQUAL(backend.getTotals().draws, 1);
+    BOOST_CHECK_EQUAL(backend.getTotals().batchedVertices, 4);
+
+    backend.clear();
+
+    BOOST_CHECK_EQUAL(backend.getTotals().frames, 0);
+    BOOST_CHECK_EQUAL(backend.getTotals().draws, 0);
+    BOOST_CHECK_EQUAL(backend.getTotals().batchedVertices, 0);
+}
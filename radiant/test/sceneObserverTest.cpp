@@ -0,0 +1,679 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE sceneObserverTest
+#include <boost/test/unit_test.hpp>
+
+#include "TestModules.h"
+#include "brush/BrushNode.h"
+#include "map/EntityBreakdown.h"
+#include "map/ModelBreakdown.h"
+#include "map/ShaderBreakdown.h"
+#include "ui/entitylist/GraphTreeModel.h"
+#include "ieclass.h"
+#include "ientity.h"
+#include "imodel.h"
+#include "ipatch.h"
+#include "modelskin.h"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Only the name is known
+    class TestEntityClass :
+        public IEntityClass
+    {
+        std::string _name;
+        std::string _empty;
+        Vector3 _colour;
+
+    public:
+        TestEntityClass(const std::string& name) :
+            _name(name)
+        {}
+
+        std::string getModName() const override { return std::string(); }
+        sigc::signal<void> changedSignal() const override { return sigc::signal<void>(); }
+        std::string getName() const override { return _name; }
+        const IEntityClass* getParent() const override { return nullptr; }
+        bool isLight() const override { return false; }
+        bool isFixedSize() const override { return false; }
+        AABB getBounds() const override { return AABB(); }
+        const Vector3& getColour() const override { return _colour; }
+        const std::string& getWireShader() const override { return _empty; }
+        const std::string& getFillShader() const override { return _empty; }
+
+        EntityClassAttribute& getAttribute(const std::string& name) override
+        {
+            throw std::logic_error("No entity class attributes in tests");
+        }
+
+        const EntityClassAttribute& getAttribute(const std::string& name) const override
+        {
+            throw std::logic_error("No entity class attributes in tests");
+        }
+
+        void forEachClassAttribute(std::function<void(const EntityClassAttribute&)> visitor,
+                                   bool editorKeys) const override
+        {}
+
+        const std::string& getModelPath() const override { return _empty; }
+        const std::string& getSkin() const override { return _empty; }
+        bool isOfType(const std::string& className) override { return className == _name; }
+    };
+
+    // Plain spawnargs, the observers are notified of "name" changes
+    class TestEntityNode :
+        public scene::Node,
+        public IEntityNode
+    {
+        class TestEntity :
+            public Entity
+        {
+            IEntityClassPtr _eclass;
+            std::map<std::string, std::string> _keyValues;
+            std::set<Observer*> _observers;
+
+        public:
+            TestEntity(const std::string& className) :
+                _eclass(std::make_shared<TestEntityClass>(className))
+            {}
+
+            IEntityClassPtr getEntityClass() const override { return _eclass; }
+
+            void forEachKeyValue(const KeyValueVisitFunctor& visitor) const override
+            {
+                for (const auto& pair : _keyValues)
+                {
+                    visitor(pair.first, pair.second);
+                }
+            }
+
+            void forEachEntityKeyValue(const EntityKeyValueVisitFunctor& visitor) override
+            {
+                throw std::logic_error("No EntityKeyValues in tests");
+            }
+
+            void setKeyValue(const std::string& key, const std::string& value) override
+            {
+                _keyValues[key] = value;
+
+                for (Observer* observer : _observers)
+                {
+                    observer->onKeyChange(key, value);
+                }
+            }
+
+            std::string getKeyValue(const std::string& key) const override
+            {
+                auto found = _keyValues.find(key);
+                return found != _keyValues.end() ? found->second : std::string();
+            }
+
+            bool isInherited(const std::string& key) const override { return false; }
+
+            KeyValuePairs getKeyValuePairs(const std::string& prefix) const override
+            {
+                throw std::logic_error("No prefix searches in tests");
+            }
+
+            bool isModel() const override { return false; }
+            bool isWorldspawn() const override { return _eclass->getName() == "worldspawn"; }
+            bool isContainer() const override { return true; }
+
+            void attachObserver(Observer* observer) override
+            {
+                _observers.insert(observer);
+                observer->onKeyChange("name", getKeyValue("name"));
+            }
+
+            void detachObserver(Observer* observer) override
+            {
+                _observers.erase(observer);
+            }
+
+            bool isOfType(const std::string& className) override { return _eclass->isOfType(className); }
+        };
+
+        TestEntity _entity;
+        AABB _bounds;
+        Vector3 _direction;
+        ShaderPtr _wireShader;
+
+    public:
+        TestEntityNode(const std::string& className, const std::string& name) :
+            _entity(className)
+        {
+            _entity.setKeyValue("classname", className);
+            _entity.setKeyValue("name", name);
+        }
+
+        std::string name() const override { return _entity.getKeyValue("name"); }
+        Type getNodeType() const override { return Type::Entity; }
+        const AABB& localAABB() const override { return _bounds; }
+
+        void renderSolid(RenderableCollector&, const VolumeTest&) const override {}
+        void renderWireframe(RenderableCollector&, const VolumeTest&) const override {}
+        std::size_t getHighlightFlags() override { return 0; }
+
+        Entity& getEntity() override { return _entity; }
+        void refreshModel() override {}
+
+        float getShaderParm(int parmNum) const override { return 1.0f; }
+        const Vector3& getDirection() const override { return _direction; }
+        const ShaderPtr& getWireShader() const override { return _wireShader; }
+    };
+    typedef std::shared_ptr<TestEntityNode> TestEntityNodePtr;
+
+    // A model without any surfaces, the skin can be changed silently
+    class TestModelNode :
+        public scene::Node,
+        public model::ModelNode,
+        public SkinnedModel
+    {
+        class TestModel :
+            public model::IModel
+        {
+            std::string _path;
+            int _polyCount;
+            AABB _bounds;
+            StringList _materials;
+
+        public:
+            TestModel(const std::string& path, int polyCount) :
+                _path(path),
+                _polyCount(polyCount)
+            {}
+
+            void render(const RenderInfo& info) const override {}
+            const AABB& localAABB() const override { return _bounds; }
+
+            std::string getFilename() const override { return _path; }
+            std::string getModelPath() const override { return _path; }
+            void applySkin(const ModelSkin& skin) override {}
+            int getSurfaceCount() const override { return 0; }
+            int getVertexCount() const override { return 0; }
+            int getPolyCount() const override { return _polyCount; }
+            const StringList& getActiveMaterials() const override { return _materials; }
+
+            const model::IModelSurface& getSurface(unsigned surfaceNum) const override
+            {
+                throw std::logic_error("No model surfaces in tests");
+            }
+        };
+
+        TestModel _model;
+        std::string _skin;
+
+    public:
+        TestModelNode(const std::string& path, int polyCount) :
+            _model(path, polyCount)
+        {}
+
+        Type getNodeType() const override { return Type::Model; }
+        const AABB& localAABB() const override { return _model.localAABB(); }
+
+        void renderSolid(RenderableCollector&, const VolumeTest&) const override {}
+        void renderWireframe(RenderableCollector&, const VolumeTest&) const override {}
+        std::size_t getHighlightFlags() override { return 0; }
+
+        const model::IModel& getIModel() const override { return _model; }
+        model::IModel& getIModel() override { return _model; }
+        bool hasModifiedScale() override { return false; }
+
+        void skinChanged(const std::string& newSkinName) override { _skin = newSkinName; }
+        std::string getSkin() const override { return _skin; }
+    };
+    typedef std::shared_ptr<TestModelNode> TestModelNodePtr;
+
+    // The real patches are too entangled with the UI to be linked into the
+    // tests, this one has a shader only and reports its changes like a Patch
+    class TestPatchNode :
+        public scene::Node,
+        public IPatchNode
+    {
+        class TestPatch :
+            public IPatch
+        {
+            std::string _shader;
+            Subdivisions _subdivisions;
+
+        public:
+            TestPatch(const std::string& shader) :
+                _shader(shader)
+            {}
+
+            void attachObserver(Observer* observer) override {}
+            void detachObserver(Observer* observer) override {}
+
+            void setDims(std::size_t width, std::size_t height) override { throw std::logic_error("No patch geometry in tests"); }
+            std::size_t getWidth() const override { return 0; }
+            std::size_t getHeight() const override { return 0; }
+
+            PatchControl& ctrlAt(std::size_t row, std::size_t col) override { throw std::logic_error("No patch geometry in tests"); }
+            const PatchControl& ctrlAt(std::size_t row, std::size_t col) const override { throw std::logic_error("No patch geometry in tests"); }
+            PatchMesh getTesselatedPatchMesh() const override { throw std::logic_error("No patch geometry in tests"); }
+
+            void insertColumns(std::size_t colIndex) override { throw std::logic_error("No patch geometry in tests"); }
+            void insertRows(std::size_t rowIndex) override { throw std::logic_error("No patch geometry in tests"); }
+            void removePoints(bool columns, std::size_t index) override { throw std::logic_error("No patch geometry in tests"); }
+            void appendPoints(bool columns, bool beginning) override { throw std::logic_error("No patch geometry in tests"); }
+
+            void controlPointsChanged() override {}
+            bool isValid() const override { return true; }
+            bool isDegenerate() const override { return false; }
+
+            const std::string& getShader() const override { return _shader; }
+
+            void setShader(const std::string& name) override
+            {
+                _shader = name;
+                Patch::signal_patchTextureChanged().emit();
+            }
+
+            bool hasVisibleMaterial() const override { return true; }
+
+            bool subdivisionsFixed() const override { return false; }
+            const Subdivisions& getSubdivisions() const override { return _subdivisions; }
+            void setFixedSubdivisions(bool isFixed, const Subdivisions& divisions) override {}
+        };
+
+        TestPatch _patch;
+        AABB _bounds;
+
+    public:
+        TestPatchNode(const std::string& shader) :
+            _patch(shader)
+        {}
+
+        Type getNodeType() const override { return Type::Patch; }
+        const AABB& localAABB() const override { return _bounds; }
+
+        void renderSolid(RenderableCollector&, const VolumeTest&) const override {}
+        void renderWireframe(RenderableCollector&, const VolumeTest&) const override {}
+        std::size_t getHighlightFlags() override { return 0; }
+
+        Patch& getPatchInternal() override { throw std::logic_error("No Patch in tests"); }
+        IPatch& getPatch() override { return _patch; }
+    };
+    typedef std::shared_ptr<TestPatchNode> TestPatchNodePtr;
+
+    // The entity connection lines are nodes of their own
+    class TestConnectionNode :
+        public scene::Node
+    {
+        AABB _bounds;
+
+    public:
+        Type getNodeType() const override { return Type::EntityConnection; }
+        const AABB& localAABB() const override { return _bounds; }
+
+        void renderSolid(RenderableCollector&, const VolumeTest&) const override {}
+        void renderWireframe(RenderableCollector&, const VolumeTest&) const override {}
+        std::size_t getHighlightFlags() override { return 0; }
+    };
+
+    // Registers the modules needed to construct brushes and insert them into the scene
+    void initialiseSceneModules()
+    {
+        test::TestModuleRegistry& registry = test::TestModuleRegistry::Instance();
+
+        if (registry.moduleExists(MODULE_SCENEGRAPH)) return;
+
+        auto xmlRegistry = std::make_shared<test::TestRegistry>();
+        xmlRegistry->set("user/ui/textures/defaultTextureScale", "0.5");
+
+        registry.registerModule(xmlRegistry);
+        registry.registerModule(std::make_shared<test::TestRenderSystem>());
+        registry.registerModule(std::make_shared<test::TestSceneGraph>());
+        registry.registerModule(std::make_shared<test::TestUIManager>());
+        registry.registerModule(std::make_shared<test::TestUndoSystem>());
+        registry.registerModule(std::make_shared<test::TestCounters>());
+
+        // Usually set by the brush module from the game file
+        Brush::m_maxWorldCoord = 65536;
+    }
+
+    // A cube, each face gets the next of the given shaders
+    BrushNodePtr createBrush(const std::vector<std::string>& shaders)
+    {
+        auto node = std::make_shared<BrushNode>();
+
+        for (std::size_t i = 0; i < 6; ++i)
+        {
+            Vector3 normal(0, 0, 0);
+            normal[i / 2] = i % 2 == 0 ? 1 : -1;
+
+            node->getBrush().addFace(Plane3(normal, 64), Matrix4::getIdentity(),
+                                     shaders[i % shaders.size()]);
+        }
+
+        return node;
+    }
+
+    // The breakdowns have to match the ones counting the scene from scratch
+    void checkShaderCounts(map::ShaderBreakdown& breakdown)
+    {
+        map::ShaderBreakdown recount;
+
+        const map::ShaderBreakdown::Map& counts = breakdown.getMap();
+        const map::ShaderBreakdown::Map& expected = recount.getMap();
+
+        BOOST_REQUIRE_EQUAL(counts.size(), expected.size());
+
+        for (auto c = counts.begin(), e = expected.begin(); e != expected.end(); ++c, ++e)
+        {
+            BOOST_CHECK_EQUAL(c->first, e->first);
+            BOOST_CHECK_EQUAL(c->second.faceCount, e->second.faceCount);
+            BOOST_CHECK_EQUAL(c->second.patchCount, e->second.patchCount);
+        }
+    }
+
+    void checkModelCounts(const map::ModelBreakdown& breakdown)
+    {
+        map::ModelBreakdown recount;
+
+        const map::ModelBreakdown::Map& counts = breakdown.getMap();
+        const map::ModelBreakdown::Map& expected = recount.getMap();
+
+        BOOST_REQUIRE_EQUAL(counts.size(), expected.size());
+
+        for (auto c = counts.begin(), e = expected.begin(); e != expected.end(); ++c, ++e)
+        {
+            BOOST_CHECK_EQUAL(c->first, e->first);
+            BOOST_CHECK_EQUAL(c->second.count, e->second.count);
+            BOOST_CHECK_EQUAL(c->second.polyCount, e->second.polyCount);
+            BOOST_CHECK(c->second.skinCount == e->second.skinCount);
+        }
+
+        BOOST_CHECK_EQUAL(breakdown.getNumSkins(), recount.getNumSkins());
+    }
+
+    void checkEntityCounts(map::EntityBreakdown& breakdown)
+    {
+        map::EntityBreakdown recount;
+
+        BOOST_CHECK(breakdown.getMap() == recount.getMap());
+    }
+
+    // A map with a worldspawn, an entity holding patches and one holding a model
+    struct Scene
+    {
+        std::shared_ptr<test::TestRootNode> root;
+        TestEntityNodePtr worldspawn;
+        TestEntityNodePtr door;
+        TestEntityNodePtr statue;
+        std::vector<BrushNodePtr> brushes;
+        std::vector<TestPatchNodePtr> patches;
+
+        Scene()
+        {
+            initialiseSceneModules();
+
+            root = test::createSceneRoot();
+
+            worldspawn = std::make_shared<TestEntityNode>("worldspawn", "world");
+            door = std::make_shared<TestEntityNode>("func_door", "door_1");
+            statue = std::make_shared<TestEntityNode>("func_static", "statue_1");
+
+            root->addChildNode(worldspawn);
+            root->addChildNode(door);
+            root->addChildNode(statue);
+
+            addBrush(worldspawn, { "textures/stone", "textures/wood" });
+            addBrush(worldspawn, { "textures/stone" });
+            addBrush(door, { "textures/metal", "textures/wood" });
+
+            addPatch(door, "textures/metal");
+            addPatch(door, "textures/glass");
+
+            statue->addChildNode(std::make_shared<TestModelNode>("models/statue.lwo", 320));
+        }
+
+        ~Scene()
+        {
+            // Uninstantiate everything, the brushes disconnect from the undo system
+            std::vector<scene::INodePtr> entities;
+
+            root->foreachNode([&](const scene::INodePtr& node)
+            {
+                entities.push_back(node);
+                return true;
+            });
+
+            for (const scene::INodePtr& entity : entities)
+            {
+                root->removeChildNode(entity);
+            }
+
+            GlobalSceneGraph().setRoot(scene::IMapRootNodePtr());
+        }
+
+        const BrushNodePtr& addBrush(const scene::INodePtr& parent, const std::vector<std::string>& shaders)
+        {
+            brushes.push_back(createBrush(shaders));
+            parent->addChildNode(brushes.back());
+            return brushes.back();
+        }
+
+        const TestPatchNodePtr& addPatch(const scene::INodePtr& parent, const std::string& shader)
+        {
+            patches.push_back(std::make_shared<TestPatchNode>(shader));
+            parent->addChildNode(patches.back());
+            return patches.back();
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE(countersFollowInsertAndErase, Scene)
+{
+    map::ShaderBreakdown shaders;
+    map::ModelBreakdown models;
+    map::EntityBreakdown entities;
+
+    checkShaderCounts(shaders);
+    checkModelCounts(models);
+    checkEntityCounts(entities);
+
+    BOOST_CHECK_EQUAL(shaders.getMap().at("textures/stone").faceCount, 9);
+    BOOST_CHECK_EQUAL(shaders.getMap().at("textures/metal").patchCount, 1);
+    BOOST_CHECK_EQUAL(entities.getMap().at("func_door"), 1);
+
+    // Insert primitives, models and entities
+    auto lamp = std::make_shared<TestEntityNode>("func_static", "lamp_1");
+    lamp->addChildNode(std::make_shared<TestModelNode>("models/lamp.ase", 48));
+    root->addChildNode(lamp);
+
+    auto secondStatue = std::make_shared<TestEntityNode>("func_static", "statue_2");
+    secondStatue->addChildNode(std::make_shared<TestModelNode>("models/statue.lwo", 320));
+    root->addChildNode(secondStatue);
+
+    addBrush(statue, { "textures/marble" });
+    addPatch(worldspawn, "textures/glass");
+
+    checkShaderCounts(shaders);
+    checkModelCounts(models);
+    checkEntityCounts(entities);
+
+    BOOST_CHECK_EQUAL(entities.getMap().at("func_static"), 3);
+    BOOST_CHECK_EQUAL(models.getMap().at("models/statue.lwo").count, 2);
+    BOOST_CHECK_EQUAL(shaders.getMap().at("textures/glass").patchCount, 2);
+
+    // Erase the only brush using the marble, the entry is removed
+    statue->removeChildNode(brushes.back());
+
+    checkShaderCounts(shaders);
+    BOOST_CHECK_EQUAL(shaders.getMap().count("textures/marble"), 0);
+
+    // Erasing the door takes its brush and patches along
+    root->removeChildNode(door);
+
+    checkShaderCounts(shaders);
+    checkEntityCounts(entities);
+
+    BOOST_CHECK_EQUAL(shaders.getMap().count("textures/metal"), 0);
+    BOOST_CHECK_EQUAL(shaders.getMap().at("textures/glass").patchCount, 1);
+    BOOST_CHECK_EQUAL(entities.getMap().count("func_door"), 0);
+
+    // The models are gone with their entities
+    root->removeChildNode(lamp);
+    root->removeChildNode(secondStatue);
+
+    checkModelCounts(models);
+    checkEntityCounts(entities);
+
+    BOOST_CHECK_EQUAL(models.getMap().count("models/lamp.ase"), 0);
+    BOOST_CHECK_EQUAL(models.getMap().at("models/statue.lwo").count, 1);
+    BOOST_CHECK_EQUAL(entities.getMap().at("func_static"), 1);
+
+    // Erased nodes inserted again are counted again
+    root->addChildNode(door);
+
+    checkShaderCounts(shaders);
+    checkEntityCounts(entities);
+}
+
+BOOST_FIXTURE_TEST_CASE(changedShadersAreRecounted, Scene)
+{
+    map::ShaderBreakdown shaders;
+
+    Brush& brush = brushes.front()->getBrush();
+
+    // Each change to the faces goes through Brush::signal_facesChanged()
+    brush.getFace(0).setShader("textures/marble");
+    checkShaderCounts(shaders);
+
+    BOOST_CHECK_EQUAL(shaders.getMap().at("textures/marble").faceCount, 1);
+
+    brush.setShader("textures/marble");
+    checkShaderCounts(shaders);
+
+    BOOST_CHECK_EQUAL(shaders.getMap().at("textures/marble").faceCount, 6);
+
+    brush.addFace(Plane3(Vector3(1, 1, 0).getNormalised(), 80), Matrix4::getIdentity(), "textures/trim");
+    checkShaderCounts(shaders);
+
+    BOOST_CHECK_EQUAL(shaders.getMap().at("textures/trim").faceCount, 1);
+
+    // The wood is left on the door's brush only
+    brushes[2]->getBrush().setShader("textures/metal");
+    checkShaderCounts(shaders);
+
+    BOOST_CHECK_EQUAL(shaders.getMap().count("textures/wood"), 0);
+
+    // Changed patches
+    patches.front()->getPatch().setShader("textures/glass");
+    checkShaderCounts(shaders);
+
+    BOOST_CHECK_EQUAL(shaders.getMap().at("textures/glass").patchCount, 2);
+    BOOST_CHECK_EQUAL(shaders.getMap().at("textures/metal").faceCount, 6);
+    BOOST_CHECK_EQUAL(shaders.getMap().at("textures/metal").patchCount, 0);
+
+    // Brushes changed outside the scene are counted as they are inserted
+    BrushNodePtr removed = brushes[1];
+    worldspawn->removeChildNode(removed);
+
+    removed->getBrush().setShader("textures/trim");
+    checkShaderCounts(shaders);
+
+    worldspawn->addChildNode(removed);
+    checkShaderCounts(shaders);
+
+    BOOST_CHECK_EQUAL(shaders.getMap().at("textures/trim").faceCount, 7);
+}
+
+BOOST_FIXTURE_TEST_CASE(changedSkinsAreCollected, Scene)
+{
+    map::ModelBreakdown models;
+
+    auto model = std::make_shared<TestModelNode>("models/statue.lwo", 320);
+    auto secondStatue = std::make_shared<TestEntityNode>("func_static", "statue_2");
+    secondStatue->addChildNode(model);
+    root->addChildNode(secondStatue);
+
+    model->skinChanged("skins/bronze");
+    checkModelCounts(models);
+
+    BOOST_CHECK_EQUAL(models.getNumSkins(), 1);
+    BOOST_CHECK_EQUAL(models.getMap().at("models/statue.lwo").skinCount.at("skins/bronze"), 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(entityListMatchesRefresh, Scene)
+{
+    std::vector<scene::INodePtr> nodes;
+
+    auto collectNodes = [&]()
+    {
+        nodes.clear();
+
+        root->foreachNode([&](const scene::INodePtr& node)
+        {
+            nodes.push_back(node);
+
+            node->foreachNode([&](const scene::INodePtr& child)
+            {
+                nodes.push_back(child);
+                return true;
+            });
+
+            return true;
+        });
+    };
+
+    // The rows inserted by the scene observer have to be the ones of a full refresh
+    auto checkRows = [&](const ui::GraphTreeModel& model)
+    {
+        ui::GraphTreeModel refreshed;
+        refreshed.refresh();
+
+        collectNodes();
+
+        for (const scene::INodePtr& node : nodes)
+        {
+            bool listed = static_cast<bool>(model.find(node));
+
+            BOOST_CHECK_EQUAL(listed, static_cast<bool>(refreshed.find(node)));
+            BOOST_CHECK_EQUAL(listed, model.isListed(node));
+        }
+    };
+
+    ui::GraphTreeModel model;
+    model.refresh();
+    model.connectToSceneGraph();
+
+    checkRows(model);
+
+    // Worldspawn brushes and entity connections are left out
+    BOOST_CHECK(model.find(worldspawn));
+    BOOST_CHECK(!model.find(brushes.front()));
+    BOOST_CHECK(model.find(brushes.back()));
+
+    auto connection = std::make_shared<TestConnectionNode>();
+    root->addChildNode(connection);
+
+    BOOST_CHECK(!model.find(connection));
+
+    addBrush(worldspawn, { "textures/stone" });
+    addBrush(statue, { "textures/marble" });
+    addPatch(worldspawn, "textures/glass");
+
+    auto lamp = std::make_shared<TestEntityNode>("func_static", "lamp_1");
+    lamp->addChildNode(std::make_shared<TestModelNode>("models/lamp.ase", 48));
+    root->addChildNode(lamp);
+
+    checkRows(model);
+
+    root->removeChildNode(door);
+    statue->removeChildNode(brushes.back());
+
+    checkRows(model);
+
+    BOOST_CHECK(!model.find(door));
+    BOOST_CHECK(!model.find(brushes[2]));
+
+    model.disconnectFromSceneGraph();
+}
@@ -0,0 +1,179 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE undoMemoryTest
+#include <boost/test/unit_test.hpp>
+
+#include "radiant/undo/Stack.h"
+
+using undo::UndoStack;
+
+namespace
+{
+    const std::size_t STATE_SIZE = 1000;
+
+    class TestMemento :
+        public IUndoMemento
+    {
+    public:
+        int value;
+
+        TestMemento(int value_) :
+            value(value_)
+        {}
+
+        std::size_t getMemoryUsage() const override
+        {
+            return STATE_SIZE;
+        }
+    };
+
+    // Hands out its last memento again while the value is unchanged,
+    // like the observed undoables do
+    class TestUndoable :
+        public IUndoable
+    {
+        mutable std::shared_ptr<TestMemento> _lastState;
+
+    public:
+        int value = 0;
+
+        IUndoMementoPtr exportState() const override
+        {
+            if (!_lastState || _lastState->value != value)
+            {
+                _lastState = std::make_shared<TestMemento>(value);
+            }
+
+            return _lastState;
+        }
+
+        void importState(const IUndoMementoPtr& state) override
+        {
+            _lastState = std::static_pointer_cast<TestMemento>(state);
+            value = _lastState->value;
+        }
+    };
+
+    // Saves the undoable as an operation of its own
+    void saveOperation(UndoStack& stack, TestUndoable& undoable)
+    {
+        stack.start("change");
+        stack.save(undoable);
+        stack.finish("change");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sharedMementoChargedOnce)
+{
+    TestUndoable undoable;
+    UndoStack stack;
+
+    saveOperation(stack, undoable);
+
+    std::size_t charged = stack.getMemoryUsage();
+    BOOST_CHECK_GT(charged, STATE_SIZE);
+
+    // The unchanged state is shared, the second operation doesn't pay for it
+    saveOperation(stack, undoable);
+
+    std::size_t shared = stack.getMemoryUsage() - charged;
+    BOOST_CHECK_LT(shared, STATE_SIZE);
+
+    // The operations count their mementos in full
+    BOOST_CHECK_EQUAL(stack.front()->getMemoryUsage(), charged);
+    BOOST_CHECK_EQUAL(stack.back()->getMemoryUsage(), charged);
+
+    // A changed state is charged again
+    undoable.value = 1;
+    saveOperation(stack, undoable);
+
+    BOOST_CHECK_EQUAL(stack.getMemoryUsage(), 2 * charged + shared);
+}
+
+BOOST_AUTO_TEST_CASE(releasedMementoChargedAgain)
+{
+    TestUndoable undoable;
+    undoable.value = 2;
+
+    UndoStack stack;
+
+    saveOperation(stack, undoable);
+    std::size_t charged = stack.getMemoryUsage();
+
+    saveOperation(stack, undoable);
+
+    stack.pop_back();
+    BOOST_CHECK_EQUAL(stack.getMemoryUsage(), charged);
+
+    stack.pop_back();
+    BOOST_CHECK_EQUAL(stack.getMemoryUsage(), 0);
+
+    // The undoable still holds the memento, but no operation is charged for it
+    saveOperation(stack, undoable);
+    BOOST_CHECK_EQUAL(stack.getMemoryUsage(), charged);
+}
+
+BOOST_AUTO_TEST_CASE(poppedOperationKeepsSharedMemento)
+{
+    TestUndoable undoable;
+    UndoStack stack;
+
+    saveOperation(stack, undoable);
+    std::size_t charged = stack.getMemoryUsage();
+
+    // The second operation shares the memento of the first one
+    saveOperation(stack, undoable);
+
+    // Dropping the oldest operation, like the memory budget does, leaves
+    // the memento charged to the one still holding it
+    stack.pop_front();
+
+    BOOST_CHECK_EQUAL(stack.size(), 1);
+    BOOST_CHECK_EQUAL(stack.getMemoryUsage(), charged);
+
+    // Saving the memento twice within an operation counts it once too
+    stack.start("twice");
+    stack.save(undoable);
+    stack.save(undoable);
+    stack.finish("twice");
+
+    BOOST_CHECK_LT(stack.getMemoryUsage(), charged + STATE_SIZE);
+
+    stack.pop_front();
+    BOOST_CHECK_GT(stack.getMemoryUsage(), STATE_SIZE);
+
+    stack.pop_front();
+    BOOST_CHECK_EQUAL(stack.getMemoryUsage(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(stackCountsSharedStateOnce)
+{
+    TestUndoable changed;
+    TestUndoable unchanged;
+
+    UndoStack stack;
+
+    // Both operations save both undoables, only one of them is changed
+    for (int i = 0; i < 2; ++i)
+    {
+        stack.start("change");
+        stack.save(changed);
+        stack.save(unchanged);
+        stack.finish("change");
+
+        changed.value = i + 1;
+    }
+
+    BOOST_CHECK_EQUAL(stack.size(), 2);
+    BOOST_CHECK_GT(stack.getMemoryUsage(), 3 * STATE_SIZE);
+    BOOST_CHECK_LT(stack.getMemoryUsage(), 4 * STATE_SIZE);
+
+    // The undoable is restored to the state shared by both operations
+    unchanged.value = 3;
+    stack.back()->restoreSnapshot();
+
+    BOOST_CHECK_EQUAL(changed.value, 1);
+    BOOST_CHECK_EQUAL(unchanged.value, 0);
+
+    stack.clear();
+    BOOST_CHECK_EQUAL(stack.getMemoryUsage(), 0);
+}
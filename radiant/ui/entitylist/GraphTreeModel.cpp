@@ -3,12 +3,41 @@
 #include <iostream>
 #include "iselectable.h"
 #include "iselection.h"
+#include "ientity.h"
 
 #include "GraphTreeModelPopulator.h"
 
 namespace ui
 {
 
+// Forwards changes of an entity's "name" spawnarg to its row
+class GraphTreeModel::EntityNameObserver :
+	public Entity::Observer
+{
+private:
+	GraphTreeModel& _owner;
+	wxDataViewItem _item;
+
+public:
+	EntityNameObserver(GraphTreeModel& owner, const wxDataViewItem& item) :
+		_owner(owner),
+		_item(item)
+	{}
+
+	void onKeyInsert(const std::string& key, EntityKeyValue& value) override
+	{
+		onKeyChange(key, value.get());
+	}
+
+	void onKeyChange(const std::string& key, const std::string& value) override
+	{
+		if (key == "name")
+		{
+			_owner.setName(_item, value);
+		}
+	}
+};
+
 GraphTreeModel::GraphTreeModel() :
 	_model(new wxutil::TreeModel(_columns)),
 	_visibleNodesOnly(false)
@@ -33,6 +62,13 @@ void GraphTreeModel::disconnectFromSceneGraph()
 
 const GraphTreeNodePtr& GraphTreeModel::insert(const scene::INodePtr& node)
 {
+	NodeMap::iterator existing = _nodemap.find(scene::INodeWeakPtr(node));
+
+	if (existing != _nodemap.end())
+	{
+		return existing->second; // already listed
+	}
+
 	// Create a new GraphTreeNode
 	GraphTreeNodePtr gtNode(new GraphTreeNode(node));
 
@@ -48,6 +84,8 @@ const GraphTreeNodePtr& GraphTreeModel::insert(const scene::INodePtr& node)
 
 	row.SendItemAdded();
 
+	attachNameObserver(node, *gtNode);
+
 	// Insert this iterator into the node map to facilitate lookups
 	std::pair<NodeMap::iterator, bool> result = _nodemap.insert(
 		NodeMap::value_type(scene::INodeWeakPtr(node), gtNode)
@@ -63,6 +101,8 @@ void GraphTreeModel::erase(const scene::INodePtr& node)
 
 	if (found != _nodemap.end())
 	{
+		detachNameObserver(node, *found->second);
+
 		// Remove this from the model...
 		_model->RemoveItem(found->second->getIter());
 
@@ -79,6 +119,17 @@ const GraphTreeNodePtr& GraphTreeModel::find(const scene::INodePtr& node) const
 
 void GraphTreeModel::clear()
 {
+	// Stop tracking the entity names of the nodes still alive
+	for (const NodeMap::value_type& pair : _nodemap)
+	{
+		scene::INodePtr node = pair.second->getNode();
+
+		if (node)
+		{
+			detachNameObserver(node, *pair.second);
+		}
+	}
+
 	// Remove everything, wx plus nodemap
 	_nodemap.clear();
 	_model->Clear();
@@ -95,7 +146,7 @@ void GraphTreeModel::refresh()
 
 	// Instantiate a scenegraph walker and visit every node in the graph
 	// The walker also clears the graph in its constructor
-	GraphTreeModelPopulator populator(*this, _visibleNodesOnly);
+	GraphTreeModelPopulator populator(*this);
 	GlobalSceneGraph().root()->traverse(populator);
 
     // Now sort the model once we have all nodes in the tree
@@ -107,6 +158,21 @@ void GraphTreeModel::setConsiderVisibleNodesOnly(bool visibleOnly)
 	_visibleNodesOnly = visibleOnly;
 }
 
+bool GraphTreeModel::isListed(const scene::INodePtr& node) const
+{
+	if (node->getNodeType() == scene::INode::Type::EntityConnection ||
+		(_visibleNodesOnly && !node->visible()))
+	{
+		return false;
+	}
+
+	// Don't list the worldspawn brushes
+	scene::INodePtr parent = node->getParent();
+	Entity* parentEntity = parent ? Node_getEntity(parent) : nullptr;
+
+	return parentEntity == nullptr || !parentEntity->isWorldspawn();
+}
+
 void GraphTreeModel::updateSelectionStatus(const NotifySelectionUpdateFunc& notifySelectionChanged)
 {
     // Don't traverse the entire scenegraph, visit selected nodes only
@@ -142,6 +208,41 @@ void GraphTreeModel::updateSelectionStatus(const scene::INodePtr& node,
 	}
 }
 
+void GraphTreeModel::attachNameObserver(const scene::INodePtr& node, GraphTreeNode& gtNode)
+{
+	Entity* entity = Node_getEntity(node);
+
+	if (entity != nullptr)
+	{
+		gtNode.getNameObserver().reset(new EntityNameObserver(*this, gtNode.getIter()));
+		entity->attachObserver(gtNode.getNameObserver().get());
+	}
+}
+
+void GraphTreeModel::detachNameObserver(const scene::INodePtr& node, GraphTreeNode& gtNode)
+{
+	Entity* entity = Node_getEntity(node);
+
+	if (entity != nullptr && gtNode.getNameObserver())
+	{
+		entity->detachObserver(gtNode.getNameObserver().get());
+	}
+
+	gtNode.getNameObserver().reset();
+}
+
+void GraphTreeModel::setName(const wxDataViewItem& item, const std::string& name)
+{
+	wxutil::TreeModel::Row row(item, *_model);
+
+	// Attaching the observer reports the current name, don't send any events for that
+	if (static_cast<std::string>(row[_columns.name]) != name)
+	{
+		row[_columns.name] = name;
+		row.SendItemChanged();
+	}
+}
+
 const GraphTreeNodePtr& GraphTreeModel::findParentNode(const scene::INodePtr& node) const
 {
 	scene::INodePtr parent = node->getParent();
@@ -181,7 +282,12 @@ wxutil::TreeModel::Ptr GraphTreeModel::getModel()
 // Gets called when a new <instance> is inserted into the scenegraph
 void GraphTreeModel::onSceneNodeInsert(const scene::INodePtr& node)
 {
-	insert(node); // wrap to the actual insert() method
+	// Apply the same rules as the populator, so the incremental
+	// updates are yielding the same rows as a full refresh
+	if (isListed(node))
+	{
+		insert(node);
+	}
 }
 
 // Gets called when <instance> is removed from the scenegraph
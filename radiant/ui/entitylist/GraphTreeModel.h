@@ -16,6 +16,10 @@ namespace ui
  *
  * The class provides basic routines to insert/remove scene::INodePtrs
  * into the model (the lookup should be performed fast).
+ *
+ * While connected to the scenegraph, the rows are updated incrementally
+ * as nodes are inserted or removed, and entity rows are renamed when
+ * their "name" spawnarg changes.
  */
 class GraphTreeModel :
 	public scene::Graph::Observer
@@ -66,6 +70,10 @@ public:
 	// Set whether invisible nodes should be considered, does NOT trigger a refresh!
 	void setConsiderVisibleNodesOnly(bool visibleOnly);
 
+	// Returns true if the given node gets a row in this model: entity connections
+	// and worldspawn primitives are left out, as are hidden nodes if desired
+	bool isListed(const scene::INodePtr& node) const;
+
 	// Rebuilds the entire tree using a scene::Graph::Walker
     // This will clear the internal wxutil::TreeModel and create a new one, so be 
     // sure to associate the TreeView with the new model by calling getModel()
@@ -95,6 +103,15 @@ public:
 	void onSceneNodeErase(const scene::INodePtr& node);
 
 private:
+	class EntityNameObserver;
+
+	// Starts/stops tracking the "name" spawnarg if the node is an entity
+	void attachNameObserver(const scene::INodePtr& node, GraphTreeNode& gtNode);
+	void detachNameObserver(const scene::INodePtr& node, GraphTreeNode& gtNode);
+
+	// Updates the name column of the given row
+	void setName(const wxDataViewItem& item, const std::string& name);
+
 	// Looks up the parent of the given node, can return NULL (empty shared_ptr)
 	const GraphTreeNodePtr& findParentNode(const scene::INodePtr& node) const;
 
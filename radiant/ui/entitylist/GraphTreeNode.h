@@ -1,5 +1,7 @@
 #pragma once
 
+#include "inode.h"
+#include "ientity.h"
 #include "wxutil/TreeModel.h"
 
 namespace ui
@@ -15,10 +17,14 @@ class GraphTreeNode
 {
 private:
 	// A reference to the actual node
-	const scene::INodePtr& _node;
+	scene::INodeWeakPtr _node;
 
 	// The iterator pointing to the row in a wxutil::TreeModel
 	wxDataViewItem _iter;
+
+	// Keeps the row name of an entity up to date, empty for other nodes
+	std::shared_ptr<Entity::Observer> _nameObserver;
+
 public:
 	GraphTreeNode(const scene::INodePtr& node) :
 		_node(node)
@@ -30,12 +36,16 @@ public:
 		return _iter;
 	}
 
-	const scene::INodePtr& getNode() const
+	scene::INodePtr getNode() const
+	{
+		return _node.lock();
+	}
+
+	std::shared_ptr<Entity::Observer>& getNameObserver()
 	{
-		return _node;
+		return _nameObserver;
 	}
 };
 typedef std::shared_ptr<GraphTreeNode> GraphTreeNodePtr;
 
 } // namespace ui
-
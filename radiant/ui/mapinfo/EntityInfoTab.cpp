@@ -18,8 +18,9 @@ namespace
 	const std::string TAB_ICON("cmenu_add_entity.png");
 }
 
-EntityInfoTab::EntityInfoTab(wxWindow* parent) :
-	wxPanel(parent, wxID_ANY)
+EntityInfoTab::EntityInfoTab(wxWindow* parent, map::EntityBreakdown& entityBreakdown) :
+	wxPanel(parent, wxID_ANY),
+	_entityBreakdown(entityBreakdown)
 {
 	// Create all the widgets
 	populateTab();
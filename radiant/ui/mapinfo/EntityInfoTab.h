@@ -13,7 +13,7 @@ class EntityInfoTab :
 {
 private:
 	// The helper class counting the entities in the map
-	map::EntityBreakdown _entityBreakdown;
+	map::EntityBreakdown& _entityBreakdown;
 
 	// Treemodel definition
 	struct ListColumns :
@@ -36,7 +36,7 @@ private:
 
 public:
 	// Constructor
-	EntityInfoTab(wxWindow* parent);
+	EntityInfoTab(wxWindow* parent, map::EntityBreakdown& entityBreakdown);
 
 	std::string getLabel();
 	std::string getIconName();
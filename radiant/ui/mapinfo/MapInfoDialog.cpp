@@ -4,6 +4,7 @@
 #include "ieventmanager.h"
 #include "imainframe.h"
 #include "iuimanager.h"
+#include "iradiant.h"
 
 #include "EntityInfoTab.h"
 #include "ShaderInfoTab.h"
@@ -21,6 +22,38 @@ namespace
 	const int MAPINFO_DEFAULT_SIZE_X = 600;
 	const int MAPINFO_DEFAULT_SIZE_Y = 550;
 	const char* const MAPINFO_WINDOW_TITLE = N_("Map Info");
+
+	// The counters shown in the tabs, they are observing the scene
+	// and kept up to date while the map is edited
+	struct Breakdowns
+	{
+		map::EntityBreakdown entities;
+		map::ModelBreakdown models;
+		map::ShaderBreakdown shaders;
+	};
+
+	std::unique_ptr<Breakdowns>& BreakdownsPtr()
+	{
+		static std::unique_ptr<Breakdowns> _breakdowns;
+		return _breakdowns;
+	}
+
+	// The scene is walked the first time the dialog is shown only
+	Breakdowns& GetBreakdowns()
+	{
+		if (!BreakdownsPtr())
+		{
+			BreakdownsPtr().reset(new Breakdowns);
+
+			// Stop observing the scene before it is shut down
+			GlobalRadiant().signal_radiantShutdown().connect([]()
+			{
+				BreakdownsPtr().reset();
+			});
+		}
+
+		return *BreakdownsPtr();
+	}
 }
 
 MapInfoDialog::MapInfoDialog() :
@@ -47,13 +80,13 @@ void MapInfoDialog::populateWindow()
 
 	SetAffirmativeId(wxID_CLOSE);
 
-	EntityInfoTab* entityTab = new EntityInfoTab(_notebook);
+	EntityInfoTab* entityTab = new EntityInfoTab(_notebook, GetBreakdowns().entities);
 	addTab(entityTab, entityTab->getLabel(), entityTab->getIconName());
 
-	ModelInfoTab* modelTab = new ModelInfoTab(_notebook);
+	ModelInfoTab* modelTab = new ModelInfoTab(_notebook, GetBreakdowns().models);
 	addTab(modelTab, modelTab->getLabel(), modelTab->getIconName());
 
-	ShaderInfoTab* shaderTab = new ShaderInfoTab(_notebook);
+	ShaderInfoTab* shaderTab = new ShaderInfoTab(_notebook, GetBreakdowns().shaders);
 	addTab(shaderTab, shaderTab->getLabel(), shaderTab->getIconName());
 
 	LayerInfoTab* layerTab = new LayerInfoTab(_notebook);
@@ -15,8 +15,9 @@ namespace
 	const std::string TAB_ICON("model16green.png");
 }
 
-ModelInfoTab::ModelInfoTab(wxWindow* parent) :
-	wxPanel(parent, wxID_ANY)
+ModelInfoTab::ModelInfoTab(wxWindow* parent, map::ModelBreakdown& modelBreakdown) :
+	wxPanel(parent, wxID_ANY),
+	_modelBreakdown(modelBreakdown)
 {
 	// Create all the widgets
 	populateTab();
@@ -13,7 +13,7 @@ class ModelInfoTab :
 {
 private:
 	// The helper class counting the models in the map
-	map::ModelBreakdown _modelBreakdown;
+	map::ModelBreakdown& _modelBreakdown;
 
 	// Treemodel definition
 	struct ListColumns :
@@ -40,7 +40,7 @@ private:
 
 public:
 	// Constructor
-	ModelInfoTab(wxWindow* parent);
+	ModelInfoTab(wxWindow* parent, map::ModelBreakdown& modelBreakdown);
 
 	std::string getLabel();
 	std::string getIconName();
@@ -21,8 +21,9 @@ namespace
 	const char* const DESELECT_ITEMS = N_("Deselect elements using this shader");
 }
 
-ShaderInfoTab::ShaderInfoTab(wxWindow* parent) :
+ShaderInfoTab::ShaderInfoTab(wxWindow* parent, map::ShaderBreakdown& shaderBreakdown) :
 	wxPanel(parent, wxID_ANY),
+	_shaderBreakdown(shaderBreakdown),
 	_listStore(new wxutil::TreeModel(_columns, true)),
 	_treeView(wxutil::TreeView::CreateWithModel(this, _listStore)),
 	_popupMenu(new wxutil::PopupMenu)
@@ -14,7 +14,7 @@ class ShaderInfoTab :
 {
 private:
 	// The helper class counting the shaders in the map
-	map::ShaderBreakdown _shaderBreakdown;
+	map::ShaderBreakdown& _shaderBreakdown;
 
 	// Treemodel definition
 	struct ListColumns :
@@ -42,7 +42,7 @@ private:
 
 public:
 	// Constructor
-	ShaderInfoTab(wxWindow* parent);
+	ShaderInfoTab(wxWindow* parent, map::ShaderBreakdown& shaderBreakdown);
 
 	std::string getLabel();
 	std::string getIconName();
@@ -113,7 +113,7 @@ public:
             return;
         }
 
-        TexturePtr texture = material->getEditorImage();
+        TexturePtr texture = material->getEditorImageThumbnail();
         if (!texture) return;
 
         // Is this texture visible?
@@ -661,7 +661,7 @@ void TextureBrowser::performUpdate()
 
         tile.material = mat;
 
-        Texture& texture = *tile.material->getEditorImage();
+        Texture& texture = *tile.material->getEditorImageThumbnail();
 
         tile.position = getPositionForTexture(layout, texture);
         tile.size.x() = getTextureWidth(texture);
@@ -673,6 +673,9 @@ void TextureBrowser::performUpdate()
         );
     });
 
+    // Keep the thumbnails generated for the new tiles
+    GlobalMaterialManager().saveThumbnailCache();
+
     updateScroll();
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -17,10 +18,15 @@ private:
 	// The name of the UndoOperaton
 	std::string _command;
 
+	// The approximate number of bytes used by the snapshot, shared mementos
+	// are included in full
+	std::size_t _memoryUsage;
+
 public:
 	// Constructor
 	Operation(const std::string& command) :
-		_command(command)
+		_command(command),
+		_memoryUsage(sizeof(Operation))
 	{}
 
 	const std::string& getName() const
@@ -33,9 +39,33 @@ public:
 		_command = name;
 	}
 
-	void save(IUndoable& undoable)
+	// Saves the state of the given Undoable, returns the saved memento
+	const IUndoMemento& save(IUndoable& undoable)
+	{
+		const IUndoMemento& memento = _snapshot.save(undoable);
+		_memoryUsage += sizeof(UndoMementoKeeper) + memento.getMemoryUsage();
+
+		return memento;
+	}
+
+	std::size_t getMemoryUsage() const
+	{
+		return _memoryUsage;
+	}
+
+	// The number of Undoables saved by this operation
+	std::size_t getNumStates() const
+	{
+		return _snapshot.size();
+	}
+
+	// Visits the saved mementos, a memento is visited once for each save
+	void foreachMemento(const std::function<void(const IUndoMemento&)>& functor) const
 	{
-		_snapshot.save(undoable);
+		for (const UndoMementoKeeper& keeper : _snapshot)
+		{
+			functor(keeper.getMemento());
+		}
 	}
 
 	void restoreSnapshot()
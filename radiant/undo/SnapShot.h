@@ -1,6 +1,7 @@
 #pragma once
 
 #include "iundo.h"
+#include <list>
 
 namespace undo
 {
@@ -16,6 +17,7 @@ public:
 	IUndoable& _undoable;
 private:
 	IUndoMementoPtr _data;
+
 public:
 	// Constructor
 	UndoMementoKeeper(IUndoable& undoable) :
@@ -27,6 +29,13 @@ public:
 	{
 		_undoable.importState(_data);
 	}
+
+	// Undoables hand out their last memento again as long as their state is
+	// unchanged, several keepers can therefore hold the same memento
+	const IUndoMemento& getMemento() const
+	{
+		return *_data;
+	}
 };
 
 /** 
@@ -45,9 +54,12 @@ class Snapshot :
 public:
 	// Adds a StateApplicator to the internal list. The Undoable pointer is saved as well as
 	// the pointer to its UndoMemento (queried by exportState().
-	void save(IUndoable& undoable)
+	// Returns the saved memento
+	const IUndoMemento& save(IUndoable& undoable)
 	{
-		push_front(UndoMementoKeeper(undoable));
+		emplace_front(undoable);
+
+		return front().getMemento();
 	}
 
 	// Cycles through all the StateApplicators and tells them to restore the state.
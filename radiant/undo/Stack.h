@@ -1,7 +1,9 @@
 #pragma once
 
 #include "debugging/debugging.h"
+#include <functional>
 #include <list>
+#include <map>
 #include "Operation.h"
 
 namespace undo
@@ -26,7 +28,20 @@ class UndoStack
 	// The pending undo operation (a working variable, so to say)
 	OperationPtr _pending;
 
+	// The memory used by all operations on the stack
+	std::size_t _memoryUsage;
+
+	// The number of times each memento has been saved by the operations on
+	// this stack. Undoables hand out their last memento again while their
+	// state is unchanged, a memento is charged when it's saved the first time
+	// and released along with the last operation holding it.
+	typedef std::map<const IUndoMemento*, std::size_t> MementoCounts;
+	MementoCounts _mementoCounts;
+
 public:
+	UndoStack() :
+		_memoryUsage(0)
+	{}
 
 	bool empty() const
 	{
@@ -50,17 +65,36 @@ public:
 
 	void pop_front()
 	{
+		release(*_stack.front());
 		_stack.pop_front();
 	}
 
 	void pop_back()
 	{
+		release(*_stack.back());
 		_stack.pop_back();
 	}
 
 	void clear()
 	{
 		_stack.clear();
+		_mementoCounts.clear();
+		_memoryUsage = 0;
+	}
+
+	// Returns the approximate number of bytes used by the operations on this stack
+	std::size_t getMemoryUsage() const
+	{
+		return _memoryUsage;
+	}
+
+	// Visits the operations, from the oldest to the most recent one
+	void foreachOperation(const std::function<void(const Operation&)>& functor) const
+	{
+		for (const OperationPtr& operation : _stack)
+		{
+			functor(*operation);
+		}
 	}
 
 	// Allocate a new Operation to work with
@@ -98,12 +132,41 @@ public:
 		if (_pending)
 		{
 			// Save the pending undo command
+			_memoryUsage += _pending->getMemoryUsage();
 			_stack.push_back(_pending);
 			_pending.reset();
 		}
 
 		// Save the UndoMemento of the most recently added command into the snapshot
-		back()->save(undoable);
+		const IUndoMemento& memento = back()->save(undoable);
+		_memoryUsage += sizeof(UndoMementoKeeper);
+
+		if (++_mementoCounts[&memento] == 1)
+		{
+			_memoryUsage += memento.getMemoryUsage();
+		}
+	}
+
+private:
+	// Subtracts the memory used by the given operation. The operation counts
+	// its mementos in full, those held by other operations stay charged.
+	void release(const Operation& operation)
+	{
+		_memoryUsage -= operation.getMemoryUsage();
+
+		operation.foreachMemento([&](const IUndoMemento& memento)
+		{
+			MementoCounts::iterator found = _mementoCounts.find(&memento);
+
+			if (--found->second == 0)
+			{
+				_mementoCounts.erase(found);
+			}
+			else
+			{
+				_memoryUsage += memento.getMemoryUsage();
+			}
+		});
 	}
 
 }; // class UndoStack
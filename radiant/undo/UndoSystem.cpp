@@ -7,7 +7,9 @@
 #include "ipreferencesystem.h"
 #include "iscenegraph.h"
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 #include "registry/registry.h"
 #include "modulesystem/StaticModule.h"
@@ -21,12 +23,22 @@ namespace undo
 namespace
 {
 	const std::string RKEY_UNDO_QUEUE_SIZE = "user/ui/undo/queueSize";
+	const std::string RKEY_UNDO_MEMORY_BUDGET = "user/ui/undo/memoryBudget";
 	const std::size_t MAX_UNDO_LEVELS = 16384;
+
+	// The number of operations listed by the memory report
+	const std::size_t NUM_REPORTED_OPERATIONS = 10;
+
+	double toMegabytes(std::size_t bytes)
+	{
+		return bytes / (1024.0 * 1024.0);
+	}
 }
 
 // Constructor
 UndoSystem::UndoSystem() :
-	_undoLevels(64)
+	_undoLevels(64),
+	_memoryBudget(0)
 {}
 
 UndoSystem::~UndoSystem()
@@ -39,6 +51,29 @@ void UndoSystem::keyChanged()
 	_undoLevels = registry::getValue<int>(RKEY_UNDO_QUEUE_SIZE);
 }
 
+void UndoSystem::memoryBudgetChanged()
+{
+	// The registry value is in megabytes
+	_memoryBudget = static_cast<std::size_t>(std::max(registry::getValue<int>(RKEY_UNDO_MEMORY_BUDGET), 0)) * 1024 * 1024;
+
+	trimToMemoryBudget();
+}
+
+void UndoSystem::trimToMemoryBudget()
+{
+	if (_memoryBudget == 0)
+	{
+		return;
+	}
+
+	// Always keep the most recent operation, even if it alone exceeds the budget
+	while (_undoStack.size() > 1 &&
+		_undoStack.getMemoryUsage() + _redoStack.getMemoryUsage() > _memoryBudget)
+	{
+		_undoStack.pop_front();
+	}
+}
+
 IUndoStateSaver* UndoSystem::getStateSaver(IUndoable& undoable, IMapFileChangeTracker& tracker)
 {
     auto result = _undoables.insert(std::make_pair(&undoable, UndoStackFiller(tracker)));
@@ -80,6 +115,8 @@ void UndoSystem::finish(const std::string& command)
 {
 	if (finishUndo(command)) {
 		rMessage() << command << std::endl;
+
+		trimToMemoryBudget();
 	}
 }
 
@@ -100,15 +137,10 @@ void UndoSystem::undo()
 	finishRedo(operation->getName());
 	_undoStack.pop_back();
 
+	// Nodes whose children changed are notified through this signal too,
+	// by their TraversableNodeSet, there's no need to walk the whole scene
 	_signalPostUndo.emit();
 
-	// Trigger the onPostUndo event on all scene nodes
-	GlobalSceneGraph().foreachNode([&] (const scene::INodePtr& node)->bool
-	{
-		node->onPostUndo();
-		return true;
-	});
-
 	GlobalSceneGraph().sceneChanged();
 }
 
@@ -129,15 +161,10 @@ void UndoSystem::redo()
 	finishUndo(operation->getName());
 	_redoStack.pop_back();
 
+	// Nodes whose children changed are notified through this signal too,
+	// by their TraversableNodeSet, there's no need to walk the whole scene
 	_signalPostRedo.emit();
 
-	// Trigger the onPostRedo event on all scene nodes
-	GlobalSceneGraph().foreachNode([&] (const scene::INodePtr& node)->bool
-	{
-		node->onPostRedo();
-		return true;
-	});
-
 	GlobalSceneGraph().sceneChanged();
 }
 
@@ -205,6 +232,7 @@ void UndoSystem::initialiseModule(const ApplicationContext& ctx)
 	// Add commands for console input
 	GlobalCommandSystem().addCommand("Undo", std::bind(&UndoSystem::undoCmd, this, std::placeholders::_1));
 	GlobalCommandSystem().addCommand("Redo", std::bind(&UndoSystem::redoCmd, this, std::placeholders::_1));
+	GlobalCommandSystem().addCommand("UndoMemoryReport", std::bind(&UndoSystem::memoryReportCmd, this, std::placeholders::_1));
 
 	// Bind events to commands
 	GlobalEventManager().addCommand("Undo", "Undo");
@@ -217,6 +245,12 @@ void UndoSystem::initialiseModule(const ApplicationContext& ctx)
         sigc::mem_fun(this, &UndoSystem::keyChanged)
     );
 
+	memoryBudgetChanged();
+
+	GlobalRegistry().signalForKey(RKEY_UNDO_MEMORY_BUDGET).connect(
+		sigc::mem_fun(this, &UndoSystem::memoryBudgetChanged)
+	);
+
 	// add the preference settings
 	constructPreferences();
 
@@ -235,6 +269,45 @@ void UndoSystem::redoCmd(const cmd::ArgumentList& args)
 	redo();
 }
 
+void UndoSystem::memoryReportCmd(const cmd::ArgumentList& args)
+{
+	rMessage() << "Undo stack: " << _undoStack.size() << " operations, "
+		<< toMegabytes(_undoStack.getMemoryUsage()) << " MB" << std::endl;
+	rMessage() << "Redo stack: " << _redoStack.size() << " operations, "
+		<< toMegabytes(_redoStack.getMemoryUsage()) << " MB" << std::endl;
+
+	if (_memoryBudget > 0)
+	{
+		rMessage() << "Memory budget: " << toMegabytes(_memoryBudget) << " MB" << std::endl;
+	}
+	else
+	{
+		rMessage() << "Memory budget: unlimited" << std::endl;
+	}
+
+	// List the largest operations on the undo stack
+	std::vector<const Operation*> operations;
+
+	_undoStack.foreachOperation([&](const Operation& operation)
+	{
+		operations.push_back(&operation);
+	});
+
+	std::size_t numReported = std::min(operations.size(), NUM_REPORTED_OPERATIONS);
+
+	std::partial_sort(operations.begin(), operations.begin() + numReported, operations.end(),
+		[](const Operation* a, const Operation* b)
+	{
+		return a->getMemoryUsage() > b->getMemoryUsage();
+	});
+
+	for (std::size_t i = 0; i < numReported; ++i)
+	{
+		rMessage() << "  " << operations[i]->getName() << ": " << operations[i]->getNumStates()
+			<< " states, " << operations[i]->getMemoryUsage() / 1024.0 << " kB" << std::endl;
+	}
+}
+
 void UndoSystem::onMapEvent(IMap::MapEvent ev)
 {
 	if (ev == IMap::MapUnloaded)
@@ -330,6 +403,7 @@ void UndoSystem::constructPreferences()
 {
 	IPreferencePage& page = GlobalPreferenceSystem().getPage(_("Settings/Undo System"));
 	page.appendSpinner(_("Undo Queue Size"), RKEY_UNDO_QUEUE_SIZE, 0, 1024, 1);
+	page.appendSpinner(_("Undo Memory Budget (MB, 0 = unlimited)"), RKEY_UNDO_MEMORY_BUDGET, 0, 16384, 1);
 }
 
 // Static module instance
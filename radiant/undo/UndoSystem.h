@@ -35,6 +35,9 @@ private:
 
 	std::size_t _undoLevels;
 
+	// The maximum number of bytes used by the undo and redo stacks, 0 = unlimited
+	std::size_t _memoryBudget;
+
 	typedef std::set<Tracker*> Trackers;
 	Trackers _trackers;
 
@@ -86,9 +89,17 @@ private:
 	// This is connected to the CommandSystem
 	void redoCmd(const cmd::ArgumentList& args);
 
+	// Prints the memory used by the undo and redo stacks to the console
+	void memoryReportCmd(const cmd::ArgumentList& args);
+
 	// Gets called as soon as the observed registry key is changed
 	void keyChanged();
 
+	void memoryBudgetChanged();
+
+	// Drops the oldest undo operations until the stacks fit into the memory budget
+	void trimToMemoryBudget();
+
 	void onMapEvent(IMap::MapEvent ev);
 
 	// Sets the size of the undoStack
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "irenderable.h"
+#include "render/frontend/StateSortQueue.h"
 
 class XYRenderer :
 	public RenderableCollector
@@ -27,6 +28,9 @@ class XYRenderer :
 	Shader* _selectedShader;
 	Shader* _selectedShaderGroup;
 
+	// The renderables collected for the shaders, sorted in render()
+	render::StateSortQueue _queue;
+
 public:
 	XYRenderer(RenderStateFlags globalstate, Shader* selected, Shader* selectedGroup) :
 		_globalstate(globalstate),
@@ -82,16 +86,16 @@ public:
 		{
 			if (_stateStack.back().highlightAsGroupMember)
 			{
-				_selectedShaderGroup->addRenderable(renderable, localToWorld);
+				_queue.add(*_selectedShaderGroup, renderable, localToWorld);
 			}
 			else
 			{
-				_selectedShader->addRenderable(renderable, localToWorld);
+				_queue.add(*_selectedShader, renderable, localToWorld);
 			}
 		}
 		else if (_stateStack.back().shader != nullptr)
 		{
-			_stateStack.back().shader->addRenderable(renderable, localToWorld);
+			_queue.add(*_stateStack.back().shader, renderable, localToWorld);
 		}
 	}
 
@@ -103,21 +107,23 @@ public:
 		{
 			if (_stateStack.back().highlightAsGroupMember)
 			{
-				_selectedShaderGroup->addRenderable(renderable, localToWorld, entity);
+				_queue.add(*_selectedShaderGroup, renderable, localToWorld, entity);
 			}
 			else
 			{
-				_selectedShader->addRenderable(renderable, localToWorld, entity);
+				_queue.add(*_selectedShader, renderable, localToWorld, entity);
 			}
 		}
 		else if (_stateStack.back().shader != nullptr)
 		{
-			_stateStack.back().shader->addRenderable(renderable, localToWorld, entity);
+			_queue.add(*_stateStack.back().shader, renderable, localToWorld, entity);
 		}
 	}
 
 	void render(const Matrix4& modelview, const Matrix4& projection)
     {
+		_queue.sort();
+
 		GlobalRenderSystem().render(_globalstate, modelview, projection);
 	}
 }; // class XYRenderer
@@ -35,6 +35,7 @@
 #include "gamelib.h"
 #include "scenelib.h"
 #include "render/frontend/RenderableCollectionWalker.h"
+#include "render/FrameProfiler.h"
 
 #include <fmt/format.h>
 #include <functional>
@@ -42,6 +43,12 @@
 namespace ui
 {
 
+namespace
+{
+    // The name of the ortho view frames in the render profile
+    const char* const PROFILE_FRAME_NAME = "Ortho view";
+}
+
 inline float Betwixt(float f1, float f2) {
     return (f1 + f2) * 0.5f;
 }
@@ -1041,6 +1048,30 @@ void XYWnd::drawCameraIcon(const Vector3& origin, const Vector3& angles)
     glEnd();
 }
 
+void XYWnd::drawFrameProfile()
+{
+    std::vector<std::string> lines = render::FrameProfiler::Instance().getOverlayLines(PROFILE_FRAME_NAME);
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0, _width, 0, _height, 0, 1);
+
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    glColor3dv(ColourSchemes().getColour("grid_text"));
+
+    // The most recent values of the view's own frame are from the last draw
+    float y = 5.0f + 10.0f * lines.size();
+
+    for (const std::string& line : lines)
+    {
+        y -= 10.0f;
+        glRasterPos2f(5.0f, y);
+        GlobalOpenGL().drawString(line);
+    }
+}
+
 // can be greatly simplified but per usual i am in a hurry
 // which is not an excuse, just a fact
 void XYWnd::drawSizeInfo(int nDim1, int nDim2, const Vector3& vMinBounds, const Vector3& vMaxBounds)
@@ -1256,6 +1287,8 @@ void XYWnd::updateModelview() {
 
 void XYWnd::draw()
 {
+    render::ScopedFrameProfile frameProfile(PROFILE_FRAME_NAME);
+
     // clear
     glViewport(0, 0, _width, _height);
     Vector3 colourGridBack = ColourSchemes().getColour("grid_background");
@@ -1292,9 +1325,13 @@ void XYWnd::draw()
 
     XYWndManager& xyWndManager = GlobalXYWnd();
 
-    drawGrid();
-    if (xyWndManager.showBlocks())
-        drawBlockGrid();
+    {
+        render::ScopedProfile profile("Grid");
+
+        drawGrid();
+        if (xyWndManager.showBlocks())
+            drawBlockGrid();
+    }
 
     glLoadMatrixd(_modelView);
 
@@ -1310,17 +1347,21 @@ void XYWnd::draw()
         XYRenderer renderer(flagsMask, _selectedShader.get(), _selectedShaderGroup.get());
 
         // First pass (scenegraph traversal)
-        render::RenderableCollectionWalker::collectRenderablesInScene(renderer,
-                                                                      _view);
+        {
+            render::ScopedProfile profile("Collect");
 
+            render::RenderableCollectionWalker::collectRenderablesInScene(renderer,
+                                                                          _view);
 
-		// Render any active mousetools
-		for (const ActiveMouseTools::value_type& i : _activeMouseTools)
-		{
-			i.second->render(GlobalRenderSystem(), renderer, _view);
-		}
+            // Render any active mousetools
+            for (const ActiveMouseTools::value_type& i : _activeMouseTools)
+            {
+                i.second->render(GlobalRenderSystem(), renderer, _view);
+            }
+        }
 
         // Second pass (GL calls)
+        render::ScopedProfile profile("Submit");
         renderer.render(_modelView, _projection);
     }
 
@@ -1458,6 +1499,11 @@ void XYWnd::draw()
         }
     }
 
+    if (render::FrameProfiler::overlayEnabled())
+    {
+        drawFrameProfile();
+    }
+
     GlobalOpenGL().assertNoErrors();
 
     // Reset the depth mask to its initial value (enabled)
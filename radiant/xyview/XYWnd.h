@@ -176,6 +176,9 @@ private:
     void onContextMenu();
     void drawSizeInfo(int nDim1, int nDim2, const Vector3& vMinBounds, const Vector3& vMaxBounds);
 
+    // Draws the render profile of the ortho views in the lower left corner
+    void drawFrameProfile();
+
     // callbacks
     bool checkChaseMouse(unsigned int state);
     void performChaseMouse();